@@ -0,0 +1,516 @@
+//------------------------------------------------------------------------------
+//  AssetCache.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "AssetCache.h"
+#include "Core/Assertion.h"
+#include "Core/Memory/Memory.h"
+#include "LocalFS/Core/fsWrapper.h"
+#include <algorithm>
+
+namespace Oryol {
+
+namespace {
+
+const uint32_t RecordMagic = 'OACR';
+const uint32_t PackMagic = 'OACP';
+const int RecordAlign = 16;
+const int NumMeshWords = 11;
+const int NumTextureWords = 8;
+
+//------------------------------------------------------------------------------
+inline int
+roundUp(int val, int align) {
+    return (val + (align - 1)) & ~(align - 1);
+}
+
+//------------------------------------------------------------------------------
+inline void
+put(Buffer& buf, uint32_t val) {
+    buf.Add((const uint8_t*)&val, sizeof(val));
+}
+
+//------------------------------------------------------------------------------
+inline void
+pad(Buffer& buf, int align) {
+    const int num = roundUp(buf.Size(), align) - buf.Size();
+    if (num > 0) {
+        Memory::Clear(buf.Add(num), num);
+    }
+}
+
+} // anonymous namespace
+
+//------------------------------------------------------------------------------
+uint64_t
+AssetCache::Hash(const void* ptr, int size, uint64_t seed) {
+    // 64-bit FNV-1a
+    o_assert_dbg(ptr || (0 == size));
+    const uint8_t* bytes = (const uint8_t*) ptr;
+    uint64_t hash = seed;
+    for (int i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+AssetCache::AssetCache(int64_t byteBudget_) :
+byteBudget(byteBudget_),
+numBytes(0),
+useCounter(0),
+numHits(0),
+numMisses(0),
+mapping(nullptr),
+mappingSize(0) {
+    o_assert_dbg(byteBudget_ > 0);
+}
+
+//------------------------------------------------------------------------------
+AssetCache::~AssetCache() {
+    this->Clear();
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::Add(uint64_t key, const MeshSetup& setup, const void* data, int size) {
+    o_assert_dbg(setup.ShouldSetupFromData());
+    const VertexLayout& layout = setup.Layout;
+    Buffer setupRecord;
+    put(setupRecord, setup.VertexUsage);
+    put(setupRecord, setup.IndexUsage);
+    put(setupRecord, setup.IndicesType);
+    put(setupRecord, setup.NumVertices);
+    put(setupRecord, setup.NumIndices);
+    put(setupRecord, setup.DataVertexOffset);
+    put(setupRecord, setup.DataIndexOffset);
+    put(setupRecord, layout.StepFunction);
+    put(setupRecord, layout.StepRate);
+    put(setupRecord, layout.NumComponents());
+    put(setupRecord, setup.NumPrimitiveGroups());
+    for (int i = 0; i < layout.NumComponents(); i++) {
+        const VertexLayout::Component& comp = layout.ComponentAt(i);
+        put(setupRecord, comp.Attr);
+        put(setupRecord, comp.Format);
+    }
+    for (int i = 0; i < setup.NumPrimitiveGroups(); i++) {
+        const PrimitiveGroup& primGroup = setup.PrimitiveGroup(i);
+        put(setupRecord, primGroup.BaseElement);
+        put(setupRecord, primGroup.NumElements);
+    }
+    return this->addRecord(key, meshType, std::move(setupRecord), data, size);
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::Add(uint64_t key, const TextureSetup& setup, const void* data, int size) {
+    o_assert_dbg(setup.ShouldSetupFromPixelData());
+    const ImageDataAttrs& img = setup.ImageData;
+    Buffer setupRecord;
+    put(setupRecord, setup.TextureUsage);
+    put(setupRecord, setup.Type);
+    put(setupRecord, setup.Width);
+    put(setupRecord, setup.Height);
+    put(setupRecord, setup.NumMipMaps);
+    put(setupRecord, setup.ColorFormat);
+    put(setupRecord, img.NumFaces);
+    put(setupRecord, img.NumMipMaps);
+    for (int faceIndex = 0; faceIndex < img.NumFaces; faceIndex++) {
+        for (int mipIndex = 0; mipIndex < img.NumMipMaps; mipIndex++) {
+            put(setupRecord, img.Offsets[faceIndex][mipIndex]);
+            put(setupRecord, img.Sizes[faceIndex][mipIndex]);
+        }
+    }
+    return this->addRecord(key, textureType, std::move(setupRecord), data, size);
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::addRecord(uint64_t key, recordType type, Buffer&& setupRecord, const void* data, int size) {
+    o_assert_dbg(data || (0 == size));
+    recordHeader hdr;
+    hdr.magic = RecordMagic;
+    hdr.version = Version;
+    hdr.key = key;
+    hdr.type = type;
+    hdr.setupSize = setupRecord.Size();
+    hdr.dataOffset = roundUp(sizeof(recordHeader) + setupRecord.Size(), RecordAlign);
+    hdr.dataSize = size;
+
+    Buffer rec;
+    rec.Reserve(roundUp(hdr.dataOffset + size, RecordAlign));
+    rec.Add((const uint8_t*)&hdr, sizeof(hdr));
+    rec.Add(setupRecord.Data(), setupRecord.Size());
+    pad(rec, RecordAlign);
+    if (size > 0) {
+        rec.Add((const uint8_t*)data, size);
+    }
+    pad(rec, RecordAlign);
+    record newRec;
+    newRec.key = key;
+    newRec.ptr = rec.Data();
+    newRec.size = rec.Size();
+    newRec.data = std::move(rec);
+    return this->insert(std::move(newRec));
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::insert(record&& rec) {
+    this->Invalidate(rec.key);
+    if (rec.size > this->byteBudget) {
+        return false;
+    }
+    // drop least recently used records until the new record fits
+    while ((this->numBytes + rec.size) > this->byteBudget) {
+        int lruIndex = 0;
+        for (int i = 1; i < this->records.Size(); i++) {
+            if (this->records[i].lastUse < this->records[lruIndex].lastUse) {
+                lruIndex = i;
+            }
+        }
+        this->erase(lruIndex);
+    }
+    // NOTE: moving the record keeps the Buffer's heap allocation,
+    // so the ptr member stays valid
+    rec.lastUse = ++this->useCounter;
+    this->numBytes += rec.size;
+    this->records.Add(std::move(rec));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+AssetCache::erase(int index) {
+    this->numBytes -= this->records[index].size;
+    this->records.Erase(index);
+}
+
+//------------------------------------------------------------------------------
+const uint32_t*
+AssetCache::validate(const uint8_t* ptr, int size, uint64_t key, recordType type) {
+    if ((size < int(sizeof(recordHeader))) || ((meshType != type) && (textureType != type))) {
+        return nullptr;
+    }
+    const recordHeader* hdr = (const recordHeader*) ptr;
+    if ((RecordMagic != hdr->magic) || (Version != hdr->version) || (key != hdr->key) || (uint32_t(type) != hdr->type)) {
+        return nullptr;
+    }
+    if ((int64_t(hdr->dataOffset) < (int64_t(sizeof(recordHeader)) + int64_t(hdr->setupSize))) ||
+        (0 != (hdr->dataOffset % RecordAlign)) ||
+        (int64_t(hdr->dataOffset) + int64_t(hdr->dataSize) > int64_t(size))) {
+        return nullptr;
+    }
+    const uint32_t* words = (const uint32_t*) (ptr + sizeof(recordHeader));
+    const uint32_t numWords = hdr->setupSize / sizeof(uint32_t);
+    if (meshType == type) {
+        if (numWords < uint32_t(NumMeshWords)) {
+            return nullptr;
+        }
+        const uint32_t numComps = words[9];
+        const uint32_t numPrimGroups = words[10];
+        if ((numComps > uint32_t(GfxConfig::MaxNumVertexLayoutComponents)) ||
+            (numPrimGroups > uint32_t(GfxConfig::MaxNumPrimGroups)) ||
+            (numWords != (NumMeshWords + 2 * (numComps + numPrimGroups)))) {
+            return nullptr;
+        }
+    }
+    else {
+        if (numWords < uint32_t(NumTextureWords)) {
+            return nullptr;
+        }
+        const int width = int(words[2]);
+        const int height = int(words[3]);
+        const int numMips = int(words[4]);
+        const uint32_t numFaces = words[6];
+        const uint32_t numImageMips = words[7];
+        if ((width <= 0) || (height <= 0) ||
+            (numMips <= 0) || (numMips >= GfxConfig::MaxNumTextureMipMaps) ||
+            !PixelFormat::IsValidTextureColorFormat(PixelFormat::Code(words[5])) ||
+            (numFaces > uint32_t(GfxConfig::MaxNumTextureFaces)) ||
+            (numImageMips > uint32_t(GfxConfig::MaxNumTextureMipMaps)) ||
+            (numWords != (NumTextureWords + 2 * numFaces * numImageMips))) {
+            return nullptr;
+        }
+    }
+    return words;
+}
+
+//------------------------------------------------------------------------------
+int
+AssetCache::find(uint64_t key) const {
+    for (int i = 0; i < this->records.Size(); i++) {
+        if (key == this->records[i].key) {
+            return i;
+        }
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+const uint32_t*
+AssetCache::lookup(uint64_t key, recordType type, const uint8_t*& outData, int& outSize) {
+    const int index = this->find(key);
+    if (InvalidIndex != index) {
+        record& rec = this->records[index];
+        const uint32_t* words = validate(rec.ptr, rec.size, key, type);
+        if (words) {
+            const recordHeader* hdr = (const recordHeader*) rec.ptr;
+            outData = rec.ptr + hdr->dataOffset;
+            outSize = hdr->dataSize;
+            rec.lastUse = ++this->useCounter;
+            this->numHits++;
+            return words;
+        }
+        // a record of the wrong type is useless
+        this->Invalidate(key);
+    }
+    this->numMisses++;
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::Lookup(uint64_t key, MeshSetup& inOutSetup, const uint8_t*& outData, int& outSize) {
+    o_assert_dbg(inOutSetup.ShouldSetupFromData());
+    o_assert_dbg(0 == inOutSetup.NumPrimitiveGroups());
+    const uint32_t* words = this->lookup(key, meshType, outData, outSize);
+    if (!words) {
+        return false;
+    }
+    inOutSetup.VertexUsage = Usage::Code(words[0]);
+    inOutSetup.IndexUsage = Usage::Code(words[1]);
+    inOutSetup.IndicesType = IndexType::Code(words[2]);
+    inOutSetup.NumVertices = int(words[3]);
+    inOutSetup.NumIndices = int(words[4]);
+    inOutSetup.DataVertexOffset = int(words[5]);
+    inOutSetup.DataIndexOffset = int(words[6]);
+    inOutSetup.Layout.Clear();
+    inOutSetup.Layout.StepFunction = VertexStepFunction::Code(words[7]);
+    inOutSetup.Layout.StepRate = uint8_t(words[8]);
+    const int numComps = int(words[9]);
+    const int numPrimGroups = int(words[10]);
+    const uint32_t* ptr = words + NumMeshWords;
+    for (int i = 0; i < numComps; i++, ptr += 2) {
+        inOutSetup.Layout.Add(VertexAttr::Code(ptr[0]), VertexFormat::Code(ptr[1]));
+    }
+    for (int i = 0; i < numPrimGroups; i++, ptr += 2) {
+        inOutSetup.AddPrimitiveGroup(PrimitiveGroup(int(ptr[0]), int(ptr[1])));
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::Lookup(uint64_t key, TextureSetup& inOutSetup, const uint8_t*& outData, int& outSize) {
+    const uint32_t* words = this->lookup(key, textureType, outData, outSize);
+    if (!words) {
+        return false;
+    }
+    TextureSetup setup = TextureSetup::FromPixelData(int(words[2]), int(words[3]), int(words[4]),
+        TextureType::Code(words[1]), PixelFormat::Code(words[5]), inOutSetup);
+    setup.TextureUsage = Usage::Code(words[0]);
+    setup.ImageData.NumFaces = int(words[6]);
+    setup.ImageData.NumMipMaps = int(words[7]);
+    const uint32_t* ptr = words + NumTextureWords;
+    for (int faceIndex = 0; faceIndex < setup.ImageData.NumFaces; faceIndex++) {
+        for (int mipIndex = 0; mipIndex < setup.ImageData.NumMipMaps; mipIndex++, ptr += 2) {
+            setup.ImageData.Offsets[faceIndex][mipIndex] = int(ptr[0]);
+            setup.ImageData.Sizes[faceIndex][mipIndex] = int(ptr[1]);
+        }
+    }
+    inOutSetup = setup;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::Contains(uint64_t key) const {
+    return InvalidIndex != this->find(key);
+}
+
+//------------------------------------------------------------------------------
+void
+AssetCache::Invalidate(uint64_t key) {
+    const int index = this->find(key);
+    if (InvalidIndex != index) {
+        this->erase(index);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+AssetCache::Clear() {
+    this->records.Clear();
+    this->numBytes = 0;
+    this->Unmap();
+}
+
+//------------------------------------------------------------------------------
+Buffer
+AssetCache::Save() const {
+    // records are written least recently used first, so that
+    // Load() restores the use order
+    Array<int> order;
+    order.Reserve(this->records.Size());
+    for (int i = 0; i < this->records.Size(); i++) {
+        order.Add(i);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return this->records[a].lastUse < this->records[b].lastUse;
+    });
+
+    Buffer pack;
+    pack.Reserve(RecordAlign + int(this->numBytes));
+    put(pack, PackMagic);
+    put(pack, Version);
+    put(pack, this->records.Size());
+    put(pack, 0);
+    for (int index : order) {
+        const record& rec = this->records[index];
+        pack.Add(rec.ptr, rec.size);
+    }
+    return pack;
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::Load(const void* ptr, int size) {
+    o_assert_dbg(ptr || (0 == size));
+    return this->addPack((const uint8_t*)ptr, size, false);
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::Map(const char* path) {
+    o_assert_dbg(path);
+    this->Unmap();
+    this->mapping = (const uint8_t*) _priv::fsWrapper::map(path, this->mappingSize);
+    if (!this->mapping) {
+        // fallback: read the pack file into memory and use that in place
+        _priv::fsWrapper::handle f = _priv::fsWrapper::openRead(path);
+        if (_priv::fsWrapper::invalidHandle == f) {
+            return false;
+        }
+        const int64_t fileSize = _priv::fsWrapper::size(f);
+        if ((fileSize > 0) && (fileSize <= Buffer::MaxSize)) {
+            uint8_t* dst = this->packData.Add(int(fileSize));
+            if (_priv::fsWrapper::read(f, dst, int(fileSize)) == int(fileSize)) {
+                this->mapping = dst;
+                this->mappingSize = fileSize;
+            }
+        }
+        _priv::fsWrapper::close(f);
+        if (!this->mapping) {
+            this->packData = Buffer();
+            return false;
+        }
+    }
+    if ((this->mappingSize > Buffer::MaxSize) ||
+        !this->addPack(this->mapping, int(this->mappingSize), true)) {
+        this->Unmap();
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+AssetCache::Unmap() {
+    if (!this->mapping) {
+        return;
+    }
+    // drop the records which live in the mapping
+    const uint8_t* end = this->mapping + this->mappingSize;
+    for (int i = this->records.Size() - 1; i >= 0; i--) {
+        const uint8_t* ptr = this->records[i].ptr;
+        if ((ptr >= this->mapping) && (ptr < end)) {
+            this->erase(i);
+        }
+    }
+    if (this->packData.Empty()) {
+        _priv::fsWrapper::unmap(this->mapping, this->mappingSize);
+    }
+    else {
+        this->packData = Buffer();
+    }
+    this->mapping = nullptr;
+    this->mappingSize = 0;
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::IsMapped() const {
+    return nullptr != this->mapping;
+}
+
+//------------------------------------------------------------------------------
+bool
+AssetCache::addPack(const uint8_t* ptr, int size, bool inPlace) {
+    if (size < RecordAlign) {
+        return false;
+    }
+    const uint32_t* packHdr = (const uint32_t*) ptr;
+    if ((PackMagic != packHdr[0]) || (Version != packHdr[1])) {
+        return false;
+    }
+    const int numRecords = int(packHdr[2]);
+    const uint8_t* cur = (const uint8_t*)ptr + RecordAlign;
+    const uint8_t* end = (const uint8_t*)ptr + size;
+    for (int i = 0; (i < numRecords) && ((end - cur) >= int(sizeof(recordHeader))); i++) {
+        const recordHeader* hdr = (const recordHeader*) cur;
+        const int64_t recSize = (int64_t(hdr->dataOffset) + hdr->dataSize + (RecordAlign - 1)) & ~int64_t(RecordAlign - 1);
+        if ((0 == recSize) || (recSize > (end - cur))) {
+            // truncated pack, the remaining records can't be located
+            break;
+        }
+        if (validate(cur, int(recSize), hdr->key, recordType(hdr->type))) {
+            record rec;
+            rec.key = hdr->key;
+            rec.size = int(recSize);
+            if (inPlace) {
+                rec.ptr = cur;
+            }
+            else {
+                rec.data.Add(cur, int(recSize));
+                rec.ptr = rec.data.Data();
+            }
+            this->insert(std::move(rec));
+        }
+        cur += recSize;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int
+AssetCache::NumRecords() const {
+    return this->records.Size();
+}
+
+//------------------------------------------------------------------------------
+int64_t
+AssetCache::NumBytes() const {
+    return this->numBytes;
+}
+
+//------------------------------------------------------------------------------
+int64_t
+AssetCache::ByteBudget() const {
+    return this->byteBudget;
+}
+
+//------------------------------------------------------------------------------
+int
+AssetCache::NumHits() const {
+    return this->numHits;
+}
+
+//------------------------------------------------------------------------------
+int
+AssetCache::NumMisses() const {
+    return this->numMisses;
+}
+
+} // namespace Oryol
@@ -0,0 +1,215 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::AssetCache
+    @ingroup Assets
+    @brief cache of cooked mesh and texture setups with their data
+
+    The AssetCache stores the result of parsing or building a mesh or
+    texture (the MeshSetup or TextureSetup object and the data blob which
+    goes with it) as a cooked binary record, so that the next time the
+    same asset is needed, the setup object and a pointer to the data can
+    be handed to Gfx::CreateResource() without parsing or building
+    anything.
+
+    Records are identified by a 64-bit key, which should be computed with
+    AssetCache::Hash() from the source data (e.g. the content of an
+    .omsh or .dds file) and the parameters used to build the asset (e.g.
+    the ShapeBuilder parameters). A record is only found if its key and
+    the cooked format version match, so changing the source data, the
+    build parameters or the format version invalidates the record.
+
+    The cache has a byte budget, if adding a record would exceed the
+    budget, the least recently used records are dropped. The whole cache
+    can be saved into a single pack and restored from it. A pack of
+    another format version is rejected as a whole, broken records in a
+    pack are skipped.
+
+    Map() maps a pack file read-only into memory, its records are used
+    in place and lookups return pointers into the mapping, so restoring
+    a pack doesn't copy any asset data. Mapped records count against
+    the byte budget like other records, dropping one only forgets it.
+    The mapping is released by Unmap(), Clear() or the destructor. Don't
+    overwrite the pack file while it is mapped, Save() copies all
+    records, so the cache can be unmapped before the new pack is written.
+    On platforms without memory-mapped files Map() reads the pack file
+    into memory instead. Load() restores a pack from memory owned by
+    the caller (for instance the Data of an IORead) and must copy the
+    records, since that memory usually goes away after the call.
+
+    MeshLoader and TextureLoader can be given an AssetCache, they key
+    the cooked setup and data by the content of the loaded file, the
+    cooked blueprint fields and the format version, and skip parsing
+    the file on a hit.
+
+    The AssetCache is not thread-safe, use it from the main thread.
+
+    @code
+    AssetCache cache(16 * 1024 * 1024);
+    // at startup: cache.Map(IO::ResolveAssigns("cache:assets.oac").AsCStr())
+
+    const uint64_t key = AssetCache::Hash(&shapeParams, sizeof(shapeParams));
+    MeshSetup setup = MeshSetup::FromData();
+    const uint8_t* data = nullptr;
+    int size = 0;
+    if (!cache.Lookup(key, setup, data, size)) {
+        auto shape = shapeBuilder.Build();
+        cache.Add(key, shape.Setup, shape.Data.Data(), shape.Data.Size());
+        cache.Lookup(key, setup, data, size);
+    }
+    Id mesh = Gfx::CreateResource(setup, data, size);
+
+    // at shutdown: Buffer pack = cache.Save(); cache.Unmap();
+    // IO::WriteFile("cache:assets.oac", std::move(pack))
+    @endcode
+
+    Cooked record format (all values are uint32 unless noted otherwise):
+
+    struct {
+        uint32 magic = 'OACR';
+        uint32 version;
+        uint64 key;
+        uint32 type;            // 1: mesh, 2: texture
+        uint32 setupSize;       // byte size of the setup record
+        uint32 dataOffset;      // byte offset of data from start of record, multiple of 16
+        uint32 dataSize;
+        union {
+            struct {
+                uint32 vertexUsage, indexUsage, indicesType;
+                uint32 numVertices, numIndices;
+                uint32 dataVertexOffset, dataIndexOffset;
+                uint32 stepFunction, stepRate;
+                uint32 numComponents, numPrimGroups;
+                struct { uint32 attr, format; } components[numComponents];
+                struct { uint32 baseElement, numElements; } primGroups[numPrimGroups];
+            } mesh;
+            struct {
+                uint32 textureUsage, type, width, height, numMipMaps, colorFormat;
+                uint32 numFaces, numImageMipMaps;
+                struct { uint32 offset, size; } images[numFaces * numImageMipMaps];
+            } texture;
+        } setup;
+        - zero-padding to dataOffset
+        uint8 data[dataSize];
+        - zero-padding to a multiple of 16 bytes
+    };
+
+    A pack is a 16-byte header (uint32 magic = 'OACP', version,
+    numRecords, 0) followed by the records.
+*/
+#include "Core/Types.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "Gfx/Setup/MeshSetup.h"
+#include "Gfx/Setup/TextureSetup.h"
+
+namespace Oryol {
+
+class AssetCache {
+public:
+    /// the cooked format version, bump when the record format changes
+    static const uint32_t Version = 1;
+    /// the default seed for Hash()
+    static const uint64_t HashSeed = 0xcbf29ce484222325ULL;
+
+    /// compute a key hash over a piece of memory, chain calls through the seed
+    static uint64_t Hash(const void* ptr, int size, uint64_t seed=HashSeed);
+
+    /// constructor with byte budget
+    AssetCache(int64_t byteBudget);
+    /// destructor, unmaps a mapped pack
+    ~AssetCache();
+    /// copying is not allowed
+    AssetCache(const AssetCache& rhs) = delete;
+    /// copy-assignment is not allowed
+    void operator=(const AssetCache& rhs) = delete;
+
+    /// cook and add a mesh (setup must be FromData), replaces an existing record
+    bool Add(uint64_t key, const MeshSetup& setup, const void* data, int size);
+    /// cook and add a texture (setup must be FromPixelData), replaces an existing record
+    bool Add(uint64_t key, const TextureSetup& setup, const void* data, int size);
+    /// lookup a mesh, inOutSetup must be FromData, data pointer is valid until record is dropped
+    bool Lookup(uint64_t key, MeshSetup& inOutSetup, const uint8_t*& outData, int& outSize);
+    /// lookup a texture, inOutSetup is the blueprint, data pointer is valid until record is dropped
+    bool Lookup(uint64_t key, TextureSetup& inOutSetup, const uint8_t*& outData, int& outSize);
+    /// return true if a record exists for key
+    bool Contains(uint64_t key) const;
+    /// drop the record for key (if exists)
+    void Invalidate(uint64_t key);
+    /// drop all records, and unmap a mapped pack
+    void Clear();
+
+    /// save all records into a pack
+    Buffer Save() const;
+    /// add the records from a pack by copying them, return false if the pack is invalid or of another version
+    bool Load(const void* ptr, int size);
+    /// map a pack file (native path) and use its records in place, return false if failed
+    bool Map(const char* path);
+    /// drop the records of a mapped pack and unmap it
+    void Unmap();
+    /// return true if a pack is mapped
+    bool IsMapped() const;
+
+    /// get number of records
+    int NumRecords() const;
+    /// get number of bytes used by records
+    int64_t NumBytes() const;
+    /// get the byte budget
+    int64_t ByteBudget() const;
+    /// get number of lookups which found a record
+    int NumHits() const;
+    /// get number of lookups which didn't find a record
+    int NumMisses() const;
+
+private:
+    enum recordType {
+        meshType = 1,
+        textureType = 2,
+    };
+    struct record {
+        uint64_t key = 0;
+        uint64_t lastUse = 0;
+        /// the cooked record, points into data or into the mapped pack
+        const uint8_t* ptr = nullptr;
+        int size = 0;
+        /// owns the cooked record if it isn't used in place
+        Buffer data;
+    };
+    /// the fixed-size record header
+    struct recordHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t type;
+        uint32_t setupSize;
+        uint32_t dataOffset;
+        uint32_t dataSize;
+    };
+    /// finish a cooked record (write header and data) and add it
+    bool addRecord(uint64_t key, recordType type, Buffer&& setupRecord, const void* data, int size);
+    /// add a complete cooked record, drop least recently used records to stay in budget
+    bool insert(record&& rec);
+    /// add the valid records of a pack, either copied or in place
+    bool addPack(const uint8_t* ptr, int size, bool inPlace);
+    /// drop a record by index
+    void erase(int index);
+    /// validate a cooked record, return setup record pointer or nullptr
+    static const uint32_t* validate(const uint8_t* ptr, int size, uint64_t key, recordType type);
+    /// find record index by key, or InvalidIndex
+    int find(uint64_t key) const;
+    /// find and validate a record for lookup, return setup record pointer or nullptr
+    const uint32_t* lookup(uint64_t key, recordType type, const uint8_t*& outData, int& outSize);
+
+    int64_t byteBudget;
+    int64_t numBytes;
+    uint64_t useCounter;
+    int numHits;
+    int numMisses;
+    Array<record> records;
+    /// the mapped pack (or the pack file data if mapping isn't supported)
+    const uint8_t* mapping;
+    int64_t mappingSize;
+    Buffer packData;
+};
+
+} // namespace Oryol
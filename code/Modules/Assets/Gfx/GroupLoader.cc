@@ -0,0 +1,339 @@
+//------------------------------------------------------------------------------
+//  GroupLoader.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "GroupLoader.h"
+#include "Assets/Gfx/OmshParser.h"
+#include "Assets/Gfx/TextureLoader.h"
+#include "Core/Log.h"
+#include "Gfx/Gfx.h"
+#include "IO/IO.h"
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+GroupLoader::GroupLoader() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+GroupLoader::GroupLoader(DoneFunc onDone_) :
+onDone(onDone_) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+GroupLoader::~GroupLoader() {
+    o_assert_dbg(!this->state);
+}
+
+//------------------------------------------------------------------------------
+int
+GroupLoader::find(const class Locator& loc) const {
+    for (int i = 0; i < this->members.Size(); i++) {
+        if (this->members[i].Locator == loc) {
+            return i;
+        }
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+int
+GroupLoader::add(GfxResourceType::Code type, const class Locator& loc, std::initializer_list<class Locator> dependencies) {
+    o_assert_dbg(!this->label.IsValid());
+    o_assert_dbg(loc.HasValidLocation());
+
+    // a shared locator which is added twice is the same member,
+    // only its dependencies are merged
+    int index = loc.IsShared() ? this->find(loc) : InvalidIndex;
+    if (InvalidIndex == index) {
+        member m;
+        m.Type = type;
+        m.Locator = loc;
+        this->members.Add(std::move(m));
+        index = this->members.Size() - 1;
+    }
+    member& m = this->members[index];
+    o_assert_dbg(type == m.Type);
+    for (const auto& dep : dependencies) {
+        if (InvalidIndex == m.Dependencies.FindIndexLinear(dep)) {
+            m.Dependencies.Add(dep);
+        }
+    }
+    return index;
+}
+
+//------------------------------------------------------------------------------
+int
+GroupLoader::Add(const MeshSetup& setup, std::initializer_list<class Locator> dependencies) {
+    o_assert_dbg(setup.ShouldSetupFromFile());
+    const int num = this->members.Size();
+    const int index = this->add(GfxResourceType::Mesh, setup.Locator, dependencies);
+    if (index == num) {
+        this->members[index].MeshBlueprint = setup;
+    }
+    return index;
+}
+
+//------------------------------------------------------------------------------
+int
+GroupLoader::Add(const TextureSetup& setup, std::initializer_list<class Locator> dependencies) {
+    o_assert_dbg(setup.ShouldSetupFromFile());
+    const int num = this->members.Size();
+    const int index = this->add(GfxResourceType::Texture, setup.Locator, dependencies);
+    if (index == num) {
+        this->members[index].TextureBlueprint = setup;
+    }
+    return index;
+}
+
+//------------------------------------------------------------------------------
+int
+GroupLoader::NumMembers() const {
+    return this->members.Size();
+}
+
+//------------------------------------------------------------------------------
+const Id&
+GroupLoader::MemberId(int index) const {
+    return this->members[index].ResId;
+}
+
+//------------------------------------------------------------------------------
+ResourceLabel
+GroupLoader::Label() const {
+    return this->label;
+}
+
+//------------------------------------------------------------------------------
+Locator
+GroupLoader::Locator() const {
+    return Oryol::Locator::NonShared();
+}
+
+//------------------------------------------------------------------------------
+bool
+GroupLoader::CanWakeup() const {
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+GroupLoader::sortMembers() {
+    // resolve the dependency locators into member indices
+    const int num = this->members.Size();
+    Array<int> numOpenDeps;
+    numOpenDeps.Reserve(num);
+    for (auto& m : this->members) {
+        for (const auto& dep : m.Dependencies) {
+            const int depIndex = this->find(dep);
+            if (InvalidIndex == depIndex) {
+                o_error("GroupLoader: '%s' depends on '%s' which is not in the group!\n",
+                    m.Locator.Location().AsCStr(), dep.Location().AsCStr());
+            }
+            m.DependencyIndices.Add(depIndex);
+        }
+        numOpenDeps.Add(m.DependencyIndices.Size());
+    }
+
+    // topological sort, members without open dependencies are
+    // created first, in the order they have been added
+    this->order.Clear();
+    this->order.Reserve(num);
+    Array<bool> sorted;
+    sorted.Reserve(num);
+    for (int i = 0; i < num; i++) {
+        sorted.Add(false);
+    }
+    while (this->order.Size() < num) {
+        int next = InvalidIndex;
+        for (int i = 0; i < num; i++) {
+            if (!sorted[i] && (0 == numOpenDeps[i])) {
+                next = i;
+                break;
+            }
+        }
+        if (InvalidIndex == next) {
+            o_error("GroupLoader: dependency cycle in resource group!\n");
+        }
+        sorted[next] = true;
+        this->order.Add(next);
+        for (int i = 0; i < num; i++) {
+            for (int depIndex : this->members[i].DependencyIndices) {
+                if (depIndex == next) {
+                    numOpenDeps[i]--;
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+Id
+GroupLoader::Start() {
+    o_assert_dbg(!this->members.Empty());
+    o_assert_dbg(!this->state);
+    this->sortMembers();
+
+    // create the member resources in the Pending state under the group's label,
+    // and prepare the parse results (written on the IO threads), members
+    // which already exist (e.g. shared textures) are reused and not loaded
+    Ptr<loadState> st = loadState::Create();
+    Array<URL> urls;
+    Array<int> loadIndices;
+    Array<GfxResourceType::Code> types;
+    urls.Reserve(this->members.Size());
+    loadIndices.Reserve(this->members.Size());
+    types.Reserve(this->members.Size());
+    this->label = Gfx::PushResourceLabel();
+    for (int index = 0; index < this->members.Size(); index++) {
+        member& m = this->members[index];
+        m.ResId = Gfx::resource().Lookup(m.Locator);
+        if (m.ResId.IsValid()) {
+            o_assert_dbg(m.Type == m.ResId.Type);
+            m.Reused = true;
+        }
+        else if (GfxResourceType::Mesh == m.Type) {
+            m.ResId = Gfx::resource().prepareAsync(m.MeshBlueprint);
+        }
+        else {
+            m.ResId = Gfx::resource().prepareAsync(m.TextureBlueprint);
+        }
+        st->MeshSetups.Add(MeshSetup::FromData(m.MeshBlueprint));
+        st->TextureSetups.Add(m.TextureBlueprint);
+        st->Data.Add(Buffer());
+        if (!m.Reused) {
+            urls.Add(m.Locator.Location());
+            loadIndices.Add(index);
+            types.Add(m.Type);
+        }
+    }
+    Gfx::PopResourceLabel();
+    this->state = st;
+    if (urls.Empty()) {
+        // all members already exist, nothing to load
+        st->Done = true;
+        this->wakeupFunc();
+        return this->members[0].ResId;
+    }
+
+    // load all files at once, each file is parsed on the IO thread as soon as it arrives
+    std::function<void()> wakeup = this->wakeupFunc;
+    IO::LoadGroup(urls,
+        [st, loadIndices, types](int urlIndex, IORead* req) {
+            // NOTE: this is called on an IO thread, only touch the parse result of this member
+            const int index = loadIndices[urlIndex];
+            bool parsed = false;
+            if (GfxResourceType::Mesh == types[urlIndex]) {
+                parsed = OmshParser::Parse(req->Data.Data(), req->Data.Size(), st->MeshSetups[index]);
+            }
+            else {
+                parsed = TextureLoader::Parse(req->Data.Data(), req->Data.Size(), st->TextureSetups[index]);
+            }
+            if (!parsed) {
+                req->Status = IOStatus::UnsupportedMediaType;
+                req->ErrorDesc = "Failed to parse resource data";
+            }
+        },
+        [st, loadIndices, wakeup](Array<IO::LoadResult> results) {
+            if (!st->Cancelled) {
+                for (int i = 0; i < results.Size(); i++) {
+                    st->Data[loadIndices[i]] = std::move(results[i].Data);
+                }
+                st->Done = true;
+                wakeup();
+            }
+        },
+        [st, wakeup](const URL& url, IOStatus::Code ioStatus) {
+            o_warn("GroupLoader: failed to load '%s' with '%s'\n", url.AsCStr(), IOStatus::ToString(ioStatus));
+            if (!st->Cancelled && !st->Done) {
+                // the first failure fails the whole group
+                st->Failed = true;
+                st->Done = true;
+                wakeup();
+            }
+        });
+    return this->members[0].ResId;
+}
+
+//------------------------------------------------------------------------------
+ResourceState::Code
+GroupLoader::Continue() {
+    o_assert_dbg(this->state);
+
+    if (!this->state->Done) {
+        return ResourceState::Pending;
+    }
+    if (this->state->Failed) {
+        return this->fail();
+    }
+
+    // all files have been loaded and parsed, create the GPU resources
+    // in dependency order, a member whose dependencies have failed
+    // fails without being created
+    bool success = true;
+    for (int index : this->order) {
+        member& m = this->members[index];
+        if (m.Reused) {
+            // a reused resource which is still loading elsewhere counts as satisfied
+            const ResourceState::Code resState = Gfx::resource().QueryResourceInfo(m.ResId).State;
+            m.State = (ResourceState::Pending == resState) ? ResourceState::Valid : resState;
+        }
+        else {
+            bool depsValid = true;
+            for (int depIndex : m.DependencyIndices) {
+                if (ResourceState::Valid != this->members[depIndex].State) {
+                    depsValid = false;
+                    break;
+                }
+            }
+            const Buffer& data = this->state->Data[index];
+            if (!depsValid) {
+                m.State = Gfx::resource().failedAsync(m.ResId);
+            }
+            // NOTE: the prepared resource may have been destroyed in the
+            // meantime, then initAsync() returns InvalidState
+            else if (GfxResourceType::Mesh == m.Type) {
+                m.State = Gfx::resource().initAsync(m.ResId, this->state->MeshSetups[index], data.Data(), data.Size());
+            }
+            else {
+                m.State = Gfx::resource().initAsync(m.ResId, this->state->TextureSetups[index], data.Data(), data.Size());
+            }
+        }
+        if (ResourceState::Valid != m.State) {
+            success = false;
+        }
+    }
+    this->state = nullptr;
+    if (this->onDone) {
+        this->onDone(success, *this);
+    }
+    return success ? ResourceState::Valid : ResourceState::Failed;
+}
+
+//------------------------------------------------------------------------------
+ResourceState::Code
+GroupLoader::fail() {
+    for (auto& m : this->members) {
+        if (!m.Reused) {
+            m.State = Gfx::resource().failedAsync(m.ResId);
+        }
+    }
+    this->state = nullptr;
+    if (this->onDone) {
+        this->onDone(false, *this);
+    }
+    return ResourceState::Failed;
+}
+
+//------------------------------------------------------------------------------
+void
+GroupLoader::Cancel() {
+    if (this->state) {
+        this->state->Cancelled = true;
+        this->state = nullptr;
+    }
+}
+
+} // namespace Oryol
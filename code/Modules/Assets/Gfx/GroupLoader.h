@@ -0,0 +1,132 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::GroupLoader
+    @ingroup Assets
+    @brief load a group of related meshes and textures as one unit
+
+    The members of a group are added with their setup objects (created
+    with MeshSetup::FromFile() or TextureSetup::FromFile()), and the
+    Locators of the members they depend on. A shared Locator which is
+    added twice is the same member. When the loader is started with
+    Gfx::LoadResource(), members which already exist (for instance a
+    texture shared with another group) are reused as they are, all other
+    member resources are created in the Pending state under a new
+    resource label, and their files are loaded with a single
+    IO::LoadGroup() call. Each file is parsed on the IO thread as soon as
+    it arrives, and once the whole group has been loaded, the GPU
+    resources are created in dependency order: a member is created after
+    all its dependencies, and fails without being created if one of its
+    dependencies has failed. A reused member counts as a satisfied
+    dependency unless it has failed.
+
+    The group reports a single result: the optional DoneFunc is called
+    once with true if all members are valid, or false if any member
+    failed. If any file fails to load or parse, no member is created and
+    all members which are not reused fail. All resources created by the
+    group can be destroyed with Gfx::DestroyResources(Label()), and
+    Gfx::AwaitResources(Label()) returns a ResourceGroup for them, reused
+    members are not part of the label.
+
+    @code
+    Ptr<GroupLoader> loader = GroupLoader::Create([](bool success, const GroupLoader& group) {
+        ...
+    });
+    loader->Add(TextureSetup::FromFile("tex:car_diffuse.dds"));
+    loader->Add(TextureSetup::FromFile("tex:car_normal.dds"));
+    loader->Add(MeshSetup::FromFile("msh:car.omsh"), { "tex:car_diffuse.dds", "tex:car_normal.dds" });
+    Gfx::LoadResource(loader);
+    ...
+    Gfx::DestroyResources(loader->Label());
+    @endcode
+
+    Start() returns the resource id of the first member, the ids of
+    all members are returned by MemberId().
+*/
+#include "Resource/Core/ResourceLoader.h"
+#include "Resource/ResourceLabel.h"
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "Gfx/Setup/MeshSetup.h"
+#include "Gfx/Setup/TextureSetup.h"
+#include "Gfx/Core/Enums.h"
+#include <functional>
+#include <initializer_list>
+
+namespace Oryol {
+
+class GroupLoader : public ResourceLoader {
+    OryolClassDecl(GroupLoader);
+public:
+    /// called once when the group has been loaded or has failed
+    typedef std::function<void(bool success, const GroupLoader& group)> DoneFunc;
+
+    /// constructor without done-callback
+    GroupLoader();
+    /// constructor with done-callback
+    GroupLoader(DoneFunc onDone);
+    /// destructor
+    ~GroupLoader();
+
+    /// add a mesh member with optional dependencies, return member index
+    int Add(const MeshSetup& setup, std::initializer_list<class Locator> dependencies=std::initializer_list<class Locator>());
+    /// add a texture member with optional dependencies, return member index
+    int Add(const TextureSetup& setup, std::initializer_list<class Locator> dependencies=std::initializer_list<class Locator>());
+    /// get number of members
+    int NumMembers() const;
+    /// get the resource id of a member (valid after Start())
+    const Id& MemberId(int index) const;
+    /// get the resource label of the group (valid after Start())
+    ResourceLabel Label() const;
+
+    /// return a non-shared locator, the members are shared by their own locators
+    virtual class Locator Locator() const override;
+    /// start loading, return the resource id of the first member
+    virtual Id Start() override;
+    /// continue loading, return resource state (Pending, Valid, Failed)
+    virtual ResourceState::Code Continue() override;
+    /// cancel the load process
+    virtual void Cancel() override;
+    /// return true, the loader wakes up when the group has been loaded
+    virtual bool CanWakeup() const override;
+
+private:
+    /// find a member by locator, or InvalidIndex
+    int find(const class Locator& loc) const;
+    /// add a member, or merge the dependencies into an existing shared member
+    int add(GfxResourceType::Code type, const class Locator& loc, std::initializer_list<class Locator> dependencies);
+    /// resolve the dependencies and compute the creation order
+    void sortMembers();
+    /// fail all members which are not reused after a load failure, and call the done-callback
+    ResourceState::Code fail();
+
+    struct member {
+        GfxResourceType::Code Type = GfxResourceType::InvalidResourceType;
+        class Locator Locator;
+        Array<class Locator> Dependencies;
+        Array<int> DependencyIndices;
+        MeshSetup MeshBlueprint;
+        TextureSetup TextureBlueprint;
+        Id ResId;
+        bool Reused = false;
+        ResourceState::Code State = ResourceState::Pending;
+    };
+    /// the load results, written by the IO threads and callbacks
+    class loadState : public RefCounted {
+        OryolClassDecl(loadState);
+    public:
+        Array<MeshSetup> MeshSetups;
+        Array<TextureSetup> TextureSetups;
+        Array<Buffer> Data;
+        bool Done = false;
+        bool Failed = false;
+        bool Cancelled = false;
+    };
+    DoneFunc onDone;
+    Array<member> members;
+    Array<int> order;
+    ResourceLabel label;
+    Ptr<loadState> state;
+};
+
+} // namespace Oryol
@@ -11,19 +11,36 @@ namespace Oryol {
 
 //------------------------------------------------------------------------------
 MeshLoader::MeshLoader(const MeshSetup& setup_) :
-MeshLoaderBase(setup_) {
+MeshLoaderBase(setup_),
+cache(nullptr) {
     // empty
 }
 
 //------------------------------------------------------------------------------
 MeshLoader::MeshLoader(const MeshSetup& setup_, LoadedFunc loadedFunc_) :
-MeshLoaderBase(setup_, loadedFunc_) {
+MeshLoaderBase(setup_, loadedFunc_),
+cache(nullptr) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+MeshLoader::MeshLoader(const MeshSetup& setup_, AssetCache* cache_) :
+MeshLoaderBase(setup_),
+cache(cache_) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+MeshLoader::MeshLoader(const MeshSetup& setup_, AssetCache* cache_, LoadedFunc loadedFunc_) :
+MeshLoaderBase(setup_, loadedFunc_),
+cache(cache_) {
     // empty
 }
 
 //------------------------------------------------------------------------------
 MeshLoader::~MeshLoader() {
     o_assert_dbg(!this->ioRequest);
+    o_assert_dbg(!this->parsed);
 }
 
 //------------------------------------------------------------------------------
@@ -32,6 +49,7 @@ MeshLoader::Cancel() {
     if (this->ioRequest) {
         this->ioRequest->Cancelled = true;
         this->ioRequest = nullptr;
+        this->parsed = nullptr;
     }
 }
 
@@ -39,10 +57,65 @@ MeshLoader::Cancel() {
 Id
 MeshLoader::Start() {
     this->resId = Gfx::resource().prepareAsync(this->setup);
-    this->ioRequest = IO::LoadFile(setup.Locator.Location());
+    this->startLoading();
     return this->resId;
 }
 
+//------------------------------------------------------------------------------
+uint64_t
+MeshLoader::cacheKey(const MeshSetup& blueprint, const uint8_t* data, int size) {
+    const uint32_t params[] = {
+        AssetCache::Version,
+        uint32_t(blueprint.VertexUsage),
+        uint32_t(blueprint.IndexUsage),
+        uint32_t(blueprint.Layout.StepFunction),
+        uint32_t(blueprint.Layout.StepRate)
+    };
+    return AssetCache::Hash(data, size, AssetCache::Hash(params, sizeof(params)));
+}
+
+//------------------------------------------------------------------------------
+void
+MeshLoader::startLoading() {
+    Ptr<parsedMesh> result = parsedMesh::Create();
+    result->Setup = MeshSetup::FromData(this->setup);
+    this->parsed = result;
+    const bool useCache = nullptr != this->cache;
+    this->ioRequest = IO::LoadFile(this->setup.Locator.Location(), [result, useCache](IORead* req) {
+        // NOTE: this is called on the IO thread, use OmshParser to
+        // create a MeshSetup object from the loaded data, with an
+        // asset cache the file is only hashed here, since the cache
+        // can only be accessed from the main thread
+        if (useCache) {
+            result->Key = cacheKey(result->Setup, req->Data.Data(), req->Data.Size());
+        }
+        else if (!OmshParser::Parse(req->Data.Data(), req->Data.Size(), result->Setup)) {
+            req->Status = IOStatus::UnsupportedMediaType;
+            req->ErrorDesc = "Failed to parse .omsh data";
+        }
+    }, this->wakeupFunc);
+}
+
+//------------------------------------------------------------------------------
+bool
+MeshLoader::CanReload() const {
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+MeshLoader::Reload(const Id& id) {
+    o_assert_dbg(!this->ioRequest);
+    this->resId = id;
+    this->startLoading();
+}
+
+//------------------------------------------------------------------------------
+bool
+MeshLoader::CanWakeup() const {
+    return true;
+}
+
 //------------------------------------------------------------------------------
 ResourceState::Code
 MeshLoader::Continue() {
@@ -53,36 +126,51 @@ MeshLoader::Continue() {
     
     if (this->ioRequest->Handled) {
         if (IOStatus::OK == this->ioRequest->Status) {
-            // async loading has finished, use OmshParser to
-            // create a MeshSetup object from the loaded data
-            const void* data = this->ioRequest->Data.Data();
-            const int numBytes = this->ioRequest->Data.Size();
-
-            MeshSetup meshSetup = MeshSetup::FromData(this->setup);
-            if (OmshParser::Parse(data, numBytes, meshSetup)) {
-
-                // call the Loaded callback if defined, this
-                // gives the app a chance to look at the
-                // setup object, and possibly modify it
-                if (this->onLoaded) {
-                    this->onLoaded(meshSetup);
-                }
+            // async loading and parsing has finished, only the
+            // GPU resource must be created on the main thread
+            const uint8_t* data = this->ioRequest->Data.Data();
+            int numBytes = this->ioRequest->Data.Size();
+            MeshSetup& meshSetup = this->parsed->Setup;
 
-                // NOTE: the prepared resource might have already been
-                // destroyed at this point, if this happens, initAsync will
-                // silently fail and return ResourceState::InvalidState
-                // (the same for failedAsync)
-                result = Gfx::resource().initAsync(this->resId, meshSetup, data, numBytes);
+            // with an asset cache, use the cooked mesh, or parse the
+            // file and add it to the cache before the app modifies it
+            if (this->cache) {
+                const uint64_t key = this->parsed->Key;
+                const uint8_t* cachedData = nullptr;
+                int cachedSize = 0;
+                if (this->cache->Lookup(key, meshSetup, cachedData, cachedSize)) {
+                    data = cachedData;
+                    numBytes = cachedSize;
+                }
+                else if (OmshParser::Parse(data, numBytes, meshSetup)) {
+                    this->cache->Add(key, meshSetup, data, numBytes);
+                }
+                else {
+                    this->ioRequest = nullptr;
+                    this->parsed = nullptr;
+                    return Gfx::resource().failedAsync(this->resId);
+                }
             }
-            else {
-                result = Gfx::resource().failedAsync(this->resId);
+
+            // call the Loaded callback if defined, this
+            // gives the app a chance to look at the
+            // setup object, and possibly modify it
+            if (this->onLoaded) {
+                this->onLoaded(meshSetup);
             }
+
+            // NOTE: the prepared resource might have already been
+            // destroyed at this point, if this happens, initAsync will
+            // silently fail and return ResourceState::InvalidState
+            // (the same for failedAsync)
+            result = Gfx::resource().initAsync(this->resId, meshSetup, data, numBytes);
         }
         else {
-            // IO had failed
+            // IO or parsing had failed
             result = Gfx::resource().failedAsync(this->resId);
         }
         this->ioRequest = nullptr;
+        this->parsed = nullptr;
     }
     return result;
 }
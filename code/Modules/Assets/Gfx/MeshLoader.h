@@ -5,11 +5,23 @@
     @ingroup Assets
     @brief standard mesh loader for loading .omsh files
     
+    The .omsh data is parsed on the IO thread which loaded the file,
+    the main thread only creates the GPU resource.
+
+    With an AssetCache, the IO thread only hashes the loaded file, and
+    the main thread takes the cooked mesh from the cache, or parses the
+    file and adds the result to the cache. The cache key is built from
+    the file content, the blueprint fields which are cooked into the
+    record (vertex and index usage, vertex step function and rate) and
+    AssetCache::Version, so a changed file or blueprint gets its own
+    record. The file is always loaded, a cache hit skips the parsing.
+
     NOTE: .omsh files are created by the oryol-exporter tool
     in the project https://github.com/floooh/oryol-tools
 */
 #include "Gfx/Resource/MeshLoaderBase.h"
 #include "IO/FS/ioRequests.h"
+#include "Assets/Gfx/AssetCache.h"
 
 namespace Oryol {
 
@@ -20,6 +32,10 @@ public:
     MeshLoader(const MeshSetup& setup);
     /// constructor with success callback
     MeshLoader(const MeshSetup& setup, LoadedFunc onLoaded);
+    /// constructor with asset cache (must outlive the loader)
+    MeshLoader(const MeshSetup& setup, AssetCache* cache);
+    /// constructor with asset cache (must outlive the loader) and success callback
+    MeshLoader(const MeshSetup& setup, AssetCache* cache, LoadedFunc onLoaded);
     /// destructor
     ~MeshLoader();
     /// start loading, return a resource id
@@ -28,9 +44,29 @@ public:
     virtual ResourceState::Code Continue() override;
     /// cancel the load process
     virtual void Cancel() override;
+    /// return true, the loader can reload evicted resources
+    virtual bool CanReload() const override;
+    /// reload an evicted mesh into its existing resource id
+    virtual void Reload(const Id& id) override;
+    /// return true, the loader wakes up when its IO request is handled
+    virtual bool CanWakeup() const override;
 private:
+    /// start the IO request, the file is parsed on the IO thread
+    void startLoading();
+    /// compute the asset cache key of a mesh file (thread-safe)
+    static uint64_t cacheKey(const MeshSetup& blueprint, const uint8_t* data, int size);
+
+    /// the parse result, written on the IO thread
+    class parsedMesh : public RefCounted {
+        OryolClassDecl(parsedMesh);
+    public:
+        MeshSetup Setup;
+        uint64_t Key = 0;
+    };
     Id resId;
+    AssetCache* cache;
     Ptr<IORead> ioRequest;
+    Ptr<parsedMesh> parsed;
 };
 
 } // namespace Oryol
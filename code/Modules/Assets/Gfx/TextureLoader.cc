@@ -12,19 +12,36 @@ namespace Oryol {
 
 //------------------------------------------------------------------------------
 TextureLoader::TextureLoader(const TextureSetup& setup_) :
-TextureLoaderBase(setup_) {
+TextureLoaderBase(setup_),
+cache(nullptr) {
     // empty
 }
 
 //------------------------------------------------------------------------------
 TextureLoader::TextureLoader(const TextureSetup& setup_, LoadedFunc loadedFunc_) :
-TextureLoaderBase(setup_, loadedFunc_) {
+TextureLoaderBase(setup_, loadedFunc_),
+cache(nullptr) {
   // empty
 }
 
+//------------------------------------------------------------------------------
+TextureLoader::TextureLoader(const TextureSetup& setup_, AssetCache* cache_) :
+TextureLoaderBase(setup_),
+cache(cache_) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+TextureLoader::TextureLoader(const TextureSetup& setup_, AssetCache* cache_, LoadedFunc loadedFunc_) :
+TextureLoaderBase(setup_, loadedFunc_),
+cache(cache_) {
+    // empty
+}
+
 //------------------------------------------------------------------------------
 TextureLoader::~TextureLoader() {
     o_assert_dbg(!this->ioRequest);
+    o_assert_dbg(!this->parsed);
 }
 
 //------------------------------------------------------------------------------
@@ -33,6 +50,7 @@ TextureLoader::Cancel() {
     if (this->ioRequest) {
         this->ioRequest->Cancelled = true;
         this->ioRequest = nullptr;
+        this->parsed = nullptr;
     }
 }
 
@@ -40,10 +58,73 @@ TextureLoader::Cancel() {
 Id
 TextureLoader::Start() {
     this->resId = Gfx::resource().prepareAsync(this->setup);
-    this->ioRequest = IO::LoadFile(setup.Locator.Location());
+    this->startLoading();
     return this->resId;
 }
 
+//------------------------------------------------------------------------------
+uint64_t
+TextureLoader::cacheKey(const TextureSetup& blueprint, const uint8_t* data, int size) {
+    const uint32_t params[] = { AssetCache::Version, uint32_t(blueprint.TextureUsage) };
+    return AssetCache::Hash(data, size, AssetCache::Hash(params, sizeof(params)));
+}
+
+//------------------------------------------------------------------------------
+void
+TextureLoader::startLoading() {
+    Ptr<parsedTexture> result = parsedTexture::Create();
+    result->Setup = this->setup;
+    this->parsed = result;
+    const bool useCache = nullptr != this->cache;
+    this->ioRequest = IO::LoadFile(this->setup.Locator.Location(), [result, useCache](IORead* req) {
+        // NOTE: this is called on the IO thread, with an asset cache
+        // the file is only hashed here, since the cache can only be
+        // accessed from the main thread
+        if (useCache) {
+            result->Key = cacheKey(result->Setup, req->Data.Data(), req->Data.Size());
+        }
+        else if (!Parse(req->Data.Data(), req->Data.Size(), result->Setup)) {
+            req->Status = IOStatus::UnsupportedMediaType;
+            req->ErrorDesc = "Failed to parse texture data";
+        }
+    }, this->wakeupFunc);
+}
+
+//------------------------------------------------------------------------------
+bool
+TextureLoader::Parse(const uint8_t* data, int size, TextureSetup& inOutSetup) {
+    // let gliml parse the texture data and build the texture setup object
+    gliml::context ctx;
+    ctx.enable_dxt(true);
+    ctx.enable_pvrtc(true);
+    ctx.enable_etc2(true);
+    if (ctx.load(data, size)) {
+        inOutSetup = buildSetup(inOutSetup, &ctx, data);
+        return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool
+TextureLoader::CanReload() const {
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+TextureLoader::Reload(const Id& id) {
+    o_assert_dbg(!this->ioRequest);
+    this->resId = id;
+    this->startLoading();
+}
+
+//------------------------------------------------------------------------------
+bool
+TextureLoader::CanWakeup() const {
+    return true;
+}
+
 //------------------------------------------------------------------------------
 ResourceState::Code
 TextureLoader::Continue() {
@@ -54,40 +135,50 @@ TextureLoader::Continue() {
     
     if (this->ioRequest->Handled) {
         if (IOStatus::OK == this->ioRequest->Status) {
-            // yeah, IO is done, let gliml parse the texture data
-            // and create the texture resource
+            // yeah, IO and parsing is done, create the texture resource
             const uint8_t* data = this->ioRequest->Data.Data();
-            const int numBytes = this->ioRequest->Data.Size();
-            
-            gliml::context ctx;
-            ctx.enable_dxt(true);
-            ctx.enable_pvrtc(true);
-            ctx.enable_etc2(true);
-            if (ctx.load(data, numBytes)) {
-                TextureSetup texSetup = this->buildSetup(this->setup, &ctx, data);
-
-                // call the Loaded callback if defined, this
-                // gives the app a chance to look at the
-                // setup object, and possibly modify it
-                if (this->onLoaded) {
-                  this->onLoaded(texSetup);
-                }
+            int numBytes = this->ioRequest->Data.Size();
+            TextureSetup& texSetup = this->parsed->Setup;
 
-                // NOTE: the prepared texture resource might have already been
-                // destroyed at this point, if this happens, initAsync will
-                // silently fail and return ResourceState::InvalidState
-                // (the same for failedAsync)
-                result = Gfx::resource().initAsync(this->resId, texSetup, data, numBytes);
+            // with an asset cache, use the cooked texture, or parse the
+            // file and add it to the cache before the app modifies it
+            if (this->cache) {
+                const uint64_t key = this->parsed->Key;
+                const uint8_t* cachedData = nullptr;
+                int cachedSize = 0;
+                if (this->cache->Lookup(key, texSetup, cachedData, cachedSize)) {
+                    data = cachedData;
+                    numBytes = cachedSize;
+                }
+                else if (Parse(data, numBytes, texSetup)) {
+                    this->cache->Add(key, texSetup, data, numBytes);
+                }
+                else {
+                    this->ioRequest = nullptr;
+                    this->parsed = nullptr;
+                    return Gfx::resource().failedAsync(this->resId);
+                }
             }
-            else {
-                result = Gfx::resource().failedAsync(this->resId);
+
+            // call the Loaded callback if defined, this
+            // gives the app a chance to look at the
+            // setup object, and possibly modify it
+            if (this->onLoaded) {
+              this->onLoaded(texSetup);
             }
+
+            // NOTE: the prepared texture resource might have already been
+            // destroyed at this point, if this happens, initAsync will
+            // silently fail and return ResourceState::InvalidState
+            // (the same for failedAsync)
+            result = Gfx::resource().initAsync(this->resId, texSetup, data, numBytes);
         }
         else {
-            // IO had failed
+            // IO or parsing had failed
             result = Gfx::resource().failedAsync(this->resId);
         }
         this->ioRequest = nullptr;
+        this->parsed = nullptr;
     }
     return result;
 }
@@ -172,7 +263,7 @@ TextureLoader::buildSetup(const TextureSetup& blueprint, const gliml::context* c
             o_error("Unknown texture type!\n");
             break;
     }
-    TextureSetup newSetup = TextureSetup::FromPixelData(w, h, numMips, type, pixelFormat, this->setup);
+    TextureSetup newSetup = TextureSetup::FromPixelData(w, h, numMips, type, pixelFormat, blueprint);
     
     // setup mipmap offsets
     o_assert_dbg(GfxConfig::MaxNumTextureMipMaps >= ctx->num_mipmaps(0));
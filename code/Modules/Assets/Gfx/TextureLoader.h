@@ -4,9 +4,21 @@
     @class Oryol::TextureLoader
     @ingroup Assets
     @brief standard texture loader for most block-compressed texture file formats
+
+    The texture data is parsed on the IO thread which loaded the file,
+    the main thread only creates the GPU resource.
+
+    With an AssetCache, the IO thread only hashes the loaded file, and
+    the main thread takes the cooked texture from the cache, or parses
+    the file and adds the result to the cache. The cache key is built
+    from the file content, the blueprint's TextureUsage (which is cooked
+    into the record) and AssetCache::Version, so a changed file or
+    blueprint gets its own record. The file is always loaded, a cache
+    hit skips the parsing.
 */
 #include "Gfx/Resource/TextureLoaderBase.h"
 #include "IO/FS/ioRequests.h"
+#include "Assets/Gfx/AssetCache.h"
 
 namespace gliml {
 class context;
@@ -21,6 +33,10 @@ public:
     TextureLoader(const TextureSetup& setup);
     /// constructor with success callback
     TextureLoader(const TextureSetup& setup, LoadedFunc onLoaded);
+    /// constructor with asset cache (must outlive the loader)
+    TextureLoader(const TextureSetup& setup, AssetCache* cache);
+    /// constructor with asset cache (must outlive the loader) and success callback
+    TextureLoader(const TextureSetup& setup, AssetCache* cache, LoadedFunc onLoaded);
     /// destructor
     ~TextureLoader();
     /// start loading, return a resource id
@@ -29,13 +45,35 @@ public:
     virtual ResourceState::Code Continue() override;
     /// cancel the load process
     virtual void Cancel() override;
+    /// return true, the loader can reload evicted resources
+    virtual bool CanReload() const override;
+    /// reload an evicted texture into its existing resource id
+    virtual void Reload(const Id& id) override;
+    /// return true, the loader wakes up when its IO request is handled
+    virtual bool CanWakeup() const override;
+    
+    /// parse texture file data into a setup object (thread-safe, called on IO threads)
+    static bool Parse(const uint8_t* data, int size, TextureSetup& inOutSetup);
 
 private:
+    /// start the IO request, the file is parsed on the IO thread
+    void startLoading();
+    /// compute the asset cache key of a texture file (thread-safe)
+    static uint64_t cacheKey(const TextureSetup& blueprint, const uint8_t* data, int size);
     /// convert gliml context attrs into a TextureSetup object
-    TextureSetup buildSetup(const TextureSetup& blueprint, const gliml::context* ctx, const uint8_t* data);
-    
+    static TextureSetup buildSetup(const TextureSetup& blueprint, const gliml::context* ctx, const uint8_t* data);
+
+    /// the parse result, written on the IO thread
+    class parsedTexture : public RefCounted {
+        OryolClassDecl(parsedTexture);
+    public:
+        TextureSetup Setup;
+        uint64_t Key = 0;
+    };
     Id resId;
+    AssetCache* cache;
     Ptr<IORead> ioRequest;
+    Ptr<parsedTexture> parsed;
 };
 
 } // namespace Oryol
\ No newline at end of file
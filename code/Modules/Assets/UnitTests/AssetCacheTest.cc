@@ -0,0 +1,293 @@
+//------------------------------------------------------------------------------
+//  AssetCacheTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Assets/Gfx/AssetCache.h"
+#include "Assets/Gfx/ShapeBuilder.h"
+#include "Core/Log.h"
+#include "Core/Time/Clock.h"
+#include "LocalFS/Core/fsWrapper.h"
+#include <cstring>
+
+using namespace Oryol;
+
+//------------------------------------------------------------------------------
+static SetupAndData<MeshSetup>
+buildShapes(int slices) {
+    ShapeBuilder shapeBuilder;
+    shapeBuilder.Layout
+        .Add(VertexAttr::Position, VertexFormat::Float3)
+        .Add(VertexAttr::Normal, VertexFormat::Byte4N);
+    shapeBuilder.Box(1.0f, 1.0f, 1.0f, 4)
+        .Sphere(0.75f, slices, slices / 2)
+        .Cylinder(0.5f, 1.0f, slices, 4);
+    return shapeBuilder.Build();
+}
+
+//------------------------------------------------------------------------------
+TEST(AssetCacheMeshTest) {
+    struct { int slices = 64; } params;
+    const uint64_t key = AssetCache::Hash(&params, sizeof(params));
+    CHECK(key != AssetCache::Hash(&params, sizeof(params), key));
+
+    // build the shapes, and compare with loading them from the cache
+    TimePoint start = Clock::Now();
+    auto shapes = buildShapes(params.slices);
+    const Duration buildTime = Clock::Since(start);
+
+    AssetCache cache(16 * 1024 * 1024);
+    CHECK(!cache.Contains(key));
+    CHECK(cache.Add(key, shapes.Setup, shapes.Data.Data(), shapes.Data.Size()));
+    CHECK(cache.Contains(key));
+    CHECK(cache.NumRecords() == 1);
+    CHECK(cache.NumBytes() > shapes.Data.Size());
+
+    start = Clock::Now();
+    MeshSetup setup = MeshSetup::FromData();
+    const uint8_t* data = nullptr;
+    int size = 0;
+    const bool found = cache.Lookup(key, setup, data, size);
+    const Duration lookupTime = Clock::Since(start);
+    Log::Info("AssetCacheMeshTest: build %.3fms, cached %.3fms\n", buildTime.AsMilliSeconds(), lookupTime.AsMilliSeconds());
+    CHECK(found);
+    CHECK(cache.NumHits() == 1);
+    CHECK(cache.NumMisses() == 0);
+
+    // the setup and data must be identical, and the data 16-byte aligned
+    const MeshSetup& orig = shapes.Setup;
+    CHECK(setup.ShouldSetupFromData());
+    CHECK(setup.VertexUsage == orig.VertexUsage);
+    CHECK(setup.IndexUsage == orig.IndexUsage);
+    CHECK(setup.IndicesType == orig.IndicesType);
+    CHECK(setup.NumVertices == orig.NumVertices);
+    CHECK(setup.NumIndices == orig.NumIndices);
+    CHECK(setup.DataVertexOffset == orig.DataVertexOffset);
+    CHECK(setup.DataIndexOffset == orig.DataIndexOffset);
+    CHECK(setup.Layout.StepFunction == orig.Layout.StepFunction);
+    CHECK(setup.Layout.StepRate == orig.Layout.StepRate);
+    CHECK(setup.Layout.NumComponents() == 2);
+    CHECK(setup.Layout.ByteSize() == orig.Layout.ByteSize());
+    for (int i = 0; i < setup.Layout.NumComponents(); i++) {
+        CHECK(setup.Layout.ComponentAt(i).Attr == orig.Layout.ComponentAt(i).Attr);
+        CHECK(setup.Layout.ComponentAt(i).Format == orig.Layout.ComponentAt(i).Format);
+    }
+    CHECK(setup.NumPrimitiveGroups() == 3);
+    for (int i = 0; i < setup.NumPrimitiveGroups(); i++) {
+        CHECK(setup.PrimitiveGroup(i).BaseElement == orig.PrimitiveGroup(i).BaseElement);
+        CHECK(setup.PrimitiveGroup(i).NumElements == orig.PrimitiveGroup(i).NumElements);
+    }
+    CHECK(size == shapes.Data.Size());
+    CHECK(0 == (intptr_t(data) & 15));
+    CHECK(0 == std::memcmp(data, shapes.Data.Data(), size));
+
+    // a lookup with the wrong type fails and drops the record
+    TextureSetup texSetup;
+    CHECK(!cache.Lookup(key, texSetup, data, size));
+    CHECK(!cache.Contains(key));
+    CHECK(cache.NumMisses() == 1);
+    CHECK(cache.NumBytes() == 0);
+
+    // other build parameters result in another key
+    MeshSetup setup1 = MeshSetup::FromData();
+    params.slices = 32;
+    CHECK(!cache.Lookup(AssetCache::Hash(&params, sizeof(params)), setup1, data, size));
+    CHECK(cache.NumMisses() == 2);
+}
+
+//------------------------------------------------------------------------------
+TEST(AssetCacheTextureTest) {
+    uint8_t pixels[4 * 4 * 4 + 2 * 2 * 4];
+    for (int i = 0; i < int(sizeof(pixels)); i++) {
+        pixels[i] = uint8_t(i);
+    }
+    TextureSetup orig = TextureSetup::FromPixelData(4, 4, 2, TextureType::Texture2D, PixelFormat::RGBA8);
+    orig.ImageData.Offsets[0][0] = 0;
+    orig.ImageData.Sizes[0][0] = 64;
+    orig.ImageData.Offsets[0][1] = 64;
+    orig.ImageData.Sizes[0][1] = 16;
+    const uint64_t key = AssetCache::Hash(pixels, sizeof(pixels));
+
+    AssetCache cache(1024);
+    CHECK(cache.Add(key, orig, pixels, sizeof(pixels)));
+
+    // the lookup keeps the blueprint's sampler state
+    TextureSetup setup;
+    setup.Sampler.MinFilter = TextureFilterMode::Nearest;
+    const uint8_t* data = nullptr;
+    int size = 0;
+    CHECK(cache.Lookup(key, setup, data, size));
+    CHECK(setup.ShouldSetupFromPixelData());
+    CHECK(setup.Sampler.MinFilter == TextureFilterMode::Nearest);
+    CHECK(setup.TextureUsage == orig.TextureUsage);
+    CHECK(setup.Type == TextureType::Texture2D);
+    CHECK(setup.Width == 4);
+    CHECK(setup.Height == 4);
+    CHECK(setup.NumMipMaps == 2);
+    CHECK(setup.ColorFormat == PixelFormat::RGBA8);
+    CHECK(setup.ImageData.NumFaces == 1);
+    CHECK(setup.ImageData.NumMipMaps == 2);
+    CHECK(setup.ImageData.Offsets[0][1] == 64);
+    CHECK(setup.ImageData.Sizes[0][1] == 16);
+    CHECK(size == int(sizeof(pixels)));
+    CHECK(0 == std::memcmp(data, pixels, size));
+
+    cache.Invalidate(key);
+    CHECK(!cache.Contains(key));
+    CHECK(cache.NumRecords() == 0);
+    CHECK(cache.NumBytes() == 0);
+}
+
+//------------------------------------------------------------------------------
+TEST(AssetCacheBudgetTest) {
+    uint8_t data[256] = { };
+    TextureSetup setup = TextureSetup::FromPixelData(8, 8, 1, TextureType::Texture2D, PixelFormat::RGBA8);
+    setup.ImageData.Sizes[0][0] = sizeof(data);
+
+    // each record is 80 bytes of header and setup, and 256 bytes of data
+    AssetCache cache(1100);
+    CHECK(cache.Add(1, setup, data, sizeof(data)));
+    CHECK(cache.Add(2, setup, data, sizeof(data)));
+    CHECK(cache.Add(3, setup, data, sizeof(data)));
+    CHECK(cache.NumRecords() == 3);
+    CHECK(cache.NumBytes() == 1008);
+
+    // using record 1 makes record 2 the least recently used one
+    TextureSetup lookupSetup;
+    const uint8_t* ptr = nullptr;
+    int size = 0;
+    CHECK(cache.Lookup(1, lookupSetup, ptr, size));
+    CHECK(cache.Add(4, setup, data, sizeof(data)));
+    CHECK(cache.NumRecords() == 3);
+    CHECK(cache.NumBytes() <= cache.ByteBudget());
+    CHECK(cache.Contains(1));
+    CHECK(!cache.Contains(2));
+    CHECK(cache.Contains(3));
+    CHECK(cache.Contains(4));
+
+    // replacing a record doesn't grow the cache
+    CHECK(cache.Add(4, setup, data, sizeof(data)));
+    CHECK(cache.NumRecords() == 3);
+
+    // a record which is bigger than the budget isn't added
+    uint8_t bigData[1024] = { };
+    CHECK(!cache.Add(5, setup, bigData, sizeof(bigData)));
+    CHECK(!cache.Contains(5));
+
+    cache.Clear();
+    CHECK(cache.NumRecords() == 0);
+    CHECK(cache.NumBytes() == 0);
+}
+
+//------------------------------------------------------------------------------
+TEST(AssetCachePackTest) {
+    auto shapes = buildShapes(16);
+    uint8_t pixels[64];
+    for (int i = 0; i < int(sizeof(pixels)); i++) {
+        pixels[i] = uint8_t(i);
+    }
+    TextureSetup texSetup = TextureSetup::FromPixelData(4, 4, 1, TextureType::Texture2D, PixelFormat::RGBA8);
+    texSetup.ImageData.Sizes[0][0] = sizeof(pixels);
+
+    AssetCache cache(1024 * 1024);
+    cache.Add(1, shapes.Setup, shapes.Data.Data(), shapes.Data.Size());
+    cache.Add(2, texSetup, pixels, sizeof(pixels));
+    Buffer pack = cache.Save();
+    CHECK(pack.Size() == 16 + cache.NumBytes());
+
+    // restore the pack into a new cache
+    AssetCache restored(1024 * 1024);
+    CHECK(restored.Load(pack.Data(), pack.Size()));
+    CHECK(restored.NumRecords() == 2);
+    CHECK(restored.NumBytes() == cache.NumBytes());
+    MeshSetup meshSetup = MeshSetup::FromData();
+    const uint8_t* data = nullptr;
+    int size = 0;
+    CHECK(restored.Lookup(1, meshSetup, data, size));
+    CHECK(meshSetup.NumVertices == shapes.Setup.NumVertices);
+    CHECK(size == shapes.Data.Size());
+    CHECK(0 == std::memcmp(data, shapes.Data.Data(), size));
+    TextureSetup lookupSetup;
+    CHECK(restored.Lookup(2, lookupSetup, data, size));
+    CHECK(size == int(sizeof(pixels)));
+    CHECK(0 == std::memcmp(data, pixels, size));
+
+    // a truncated pack keeps the complete records
+    AssetCache truncated(1024 * 1024);
+    CHECK(truncated.Load(pack.Data(), pack.Size() - 16));
+    CHECK(truncated.NumRecords() == 1);
+    CHECK(truncated.Contains(1));
+
+    // a broken record is skipped
+    uint32_t* firstMagic = (uint32_t*) (pack.Data() + 16);
+    *firstMagic = 0;
+    AssetCache broken(1024 * 1024);
+    CHECK(broken.Load(pack.Data(), pack.Size()));
+    CHECK(broken.NumRecords() == 1);
+    CHECK(broken.Contains(2));
+
+    // a pack of another format version is rejected
+    uint32_t* version = (uint32_t*) (pack.Data() + 4);
+    *version = AssetCache::Version + 1;
+    AssetCache stale(1024 * 1024);
+    CHECK(!stale.Load(pack.Data(), pack.Size()));
+    CHECK(stale.NumRecords() == 0);
+}
+
+//------------------------------------------------------------------------------
+TEST(AssetCacheMapTest) {
+    auto shapes = buildShapes(16);
+    AssetCache cache(1024 * 1024);
+    cache.Add(1, shapes.Setup, shapes.Data.Data(), shapes.Data.Size());
+    Buffer pack = cache.Save();
+
+    // write the pack to a file and map it
+    const char* path = "AssetCacheMapTest.oac";
+    _priv::fsWrapper::handle f = _priv::fsWrapper::openWrite(path);
+    CHECK(_priv::fsWrapper::invalidHandle != f);
+    CHECK(_priv::fsWrapper::write(f, pack.Data(), pack.Size()) == pack.Size());
+    _priv::fsWrapper::close(f);
+
+    AssetCache mapped(1024 * 1024);
+    CHECK(!mapped.Map("AssetCacheMapTest_missing.oac"));
+    CHECK(!mapped.IsMapped());
+    CHECK(mapped.Map(path));
+    CHECK(mapped.IsMapped());
+    CHECK(mapped.NumRecords() == 1);
+    CHECK(mapped.NumBytes() == cache.NumBytes());
+    MeshSetup setup = MeshSetup::FromData();
+    const uint8_t* data = nullptr;
+    int size = 0;
+    CHECK(mapped.Lookup(1, setup, data, size));
+    CHECK(setup.NumVertices == shapes.Setup.NumVertices);
+    CHECK(size == shapes.Data.Size());
+    CHECK(0 == (intptr_t(data) & 15));
+    CHECK(0 == std::memcmp(data, shapes.Data.Data(), size));
+
+    // added records live next to the mapped ones, saving copies both
+    uint8_t pixels[64] = { };
+    TextureSetup texSetup = TextureSetup::FromPixelData(4, 4, 1, TextureType::Texture2D, PixelFormat::RGBA8);
+    texSetup.ImageData.Sizes[0][0] = sizeof(pixels);
+    CHECK(mapped.Add(2, texSetup, pixels, sizeof(pixels)));
+    Buffer pack2 = mapped.Save();
+    CHECK(pack2.Size() == 16 + mapped.NumBytes());
+
+    // unmapping drops only the mapped records
+    mapped.Unmap();
+    CHECK(!mapped.IsMapped());
+    CHECK(!mapped.Contains(1));
+    CHECK(mapped.Contains(2));
+    CHECK(mapped.NumRecords() == 1);
+    AssetCache restored(1024 * 1024);
+    CHECK(restored.Load(pack2.Data(), pack2.Size()));
+    CHECK(restored.Contains(1));
+    CHECK(restored.Contains(2));
+
+    // a file which isn't a pack is rejected
+    f = _priv::fsWrapper::openWrite(path);
+    CHECK(_priv::fsWrapper::write(f, pixels, sizeof(pixels)) == int(sizeof(pixels)));
+    _priv::fsWrapper::close(f);
+    CHECK(!mapped.Map(path));
+    CHECK(!mapped.IsMapped());
+    CHECK(_priv::fsWrapper::remove(path));
+}
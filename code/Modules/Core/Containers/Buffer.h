@@ -4,6 +4,11 @@
     @class Oryol::Buffer
     @ingroup Core
     @brief growable memory buffer for raw data
+
+    Buffer sizes are limited to Buffer::MaxSize bytes (the largest
+    positive int), data which may be bigger (like large files) must
+    be processed in pieces. Growing a buffer beyond the limit
+    is a fatal error.
 */
 #include "Core/Types.h"
 #include "Core/Assertion.h"
@@ -13,6 +18,9 @@ namespace Oryol {
 
 class Buffer {
 public:
+    /// maximum size of a buffer in bytes
+    static const int MaxSize = 0x7FFFFFFF;
+
     /// default constructor
     Buffer();
     /// move constructor
@@ -167,6 +175,8 @@ Buffer::Spare() const {
 //------------------------------------------------------------------------------
 inline void
 Buffer::Reserve(int numBytes) {
+    // check for int overflow before computing the new size
+    o_assert((numBytes >= 0) && (numBytes <= (MaxSize - this->size)));
     // need to grow?
     if ((this->size + numBytes) > this->capacity) {
         const int newCapacity = this->size + numBytes;
@@ -3,8 +3,14 @@
 /**
     @class Oryol::GfxFrameInfo
     @brief per-frame stats of the Gfx module
+
+    The resource destroy stats describe the deferred destruction of
+    released resources in the last resource update: the number of
+    resources still waiting in the destroy queue, and the number of
+    resources destroyed and the time it took.
 */
 #include "Core/Types.h"
+#include "Core/Time/Duration.h"
 
 namespace Oryol {
 
@@ -19,6 +25,9 @@ struct GfxFrameInfo {
     int NumUpdateTextures = 0;
     int NumDraw = 0;
     int NumDrawInstanced = 0;
+    int ResourceDestroyQueueDepth = 0;
+    int NumResourcesDestroyed = 0;
+    Duration ResourceDestroyTime;
 };
 
 } // namespace Oryol
@@ -0,0 +1,36 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::GfxResourceStats
+    @brief live resource stats of the Gfx module
+
+    The resource counts and memory sizes are current, the created,
+    destroyed and loaded counts are for the last completed frame, and
+    the average load time is the time from the start of a load until
+    the resource is valid over all loads since Gfx::Setup(). The per-pool
+    details are returned by Gfx::QueryResourcePoolInfo().
+*/
+#include "Core/Types.h"
+#include "Core/Containers/StaticArray.h"
+#include "Core/Time/Duration.h"
+#include "Resource/ResourceState.h"
+
+namespace Oryol {
+
+struct GfxResourceStats {
+    GfxResourceStats() {
+        this->NumResourcesByState.Fill(0);
+    }
+    /// number of resources by state (all resource types)
+    StaticArray<int, ResourceState::NumStates> NumResourcesByState;
+    int NumCreated = 0;
+    int NumDestroyed = 0;
+    int NumLoaded = 0;
+    Duration AverageLoadTime;
+    int64_t NumVertexBytes = 0;
+    int64_t NumIndexBytes = 0;
+    int64_t NumTextureBytes = 0;
+    int64_t NumRenderTargetBytes = 0;
+};
+
+} // namespace Oryol
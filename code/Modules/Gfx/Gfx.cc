@@ -41,7 +41,7 @@ Gfx::Setup(const class GfxSetup& setup) {
 void
 Gfx::Discard() {
     o_assert_dbg(IsValid());
-    state->resourceContainer.Destroy(ResourceLabel::All);
+    state->resourceContainer.Destroy(ResourceLabel::All, true);
     Core::PreRunLoop()->Remove(state->runLoopId);
     state->renderer.discard();
     state->resourceContainer.discard();
@@ -102,7 +102,11 @@ Gfx::RenderTargetAttrs() {
 const GfxFrameInfo&
 Gfx::FrameInfo() {
     o_assert_dbg(IsValid());
-    return state->gfxFrameInfo;
+    GfxFrameInfo& info = state->gfxFrameInfo;
+    info.ResourceDestroyQueueDepth = state->resourceContainer.DestroyQueueDepth();
+    info.NumResourcesDestroyed = state->resourceContainer.NumDestroyed();
+    info.ResourceDestroyTime = state->resourceContainer.DestroyTime();
+    return info;
 }
 
 //------------------------------------------------------------------------------
@@ -226,6 +230,13 @@ Gfx::LoadResource(const Ptr<ResourceLoader>& loader) {
     return state->resourceContainer.Load(loader);
 }
 
+//------------------------------------------------------------------------------
+Array<Id>
+Gfx::LoadResources(const Array<Ptr<ResourceLoader>>& loaders) {
+    o_assert_dbg(IsValid());
+    return state->resourceContainer.LoadBatch(loaders);
+}
+
 //------------------------------------------------------------------------------
 Id
 Gfx::LookupResource(const Locator& locator) {
@@ -254,6 +265,13 @@ Gfx::QueryResourcePoolInfo(GfxResourceType::Code resType) {
     return state->resourceContainer.QueryPoolInfo(resType);
 }
 
+//------------------------------------------------------------------------------
+GfxResourceStats
+Gfx::QueryResourceStats() {
+    o_assert_dbg(IsValid());
+    return state->resourceContainer.QueryStats();
+}
+
 //------------------------------------------------------------------------------
 void
 Gfx::DestroyResources(ResourceLabel label) {
@@ -261,6 +279,48 @@ Gfx::DestroyResources(ResourceLabel label) {
     return state->resourceContainer.Destroy(label);
 }
 
+//------------------------------------------------------------------------------
+void
+Gfx::AcquireResource(const Id& id) {
+    o_assert_dbg(IsValid());
+    state->resourceContainer.Acquire(id);
+}
+
+//------------------------------------------------------------------------------
+void
+Gfx::ReleaseResource(const Id& id) {
+    o_assert_dbg(IsValid());
+    state->resourceContainer.Release(id);
+}
+
+//------------------------------------------------------------------------------
+Gfx::ResourceStateHandlerId
+Gfx::SubscribeResource(const Id& id, ResourceStateHandler handler) {
+    o_assert_dbg(IsValid());
+    return state->resourceContainer.Subscribe(id, handler);
+}
+
+//------------------------------------------------------------------------------
+Gfx::ResourceStateHandlerId
+Gfx::SubscribeResources(ResourceLabel label, ResourceStateHandler handler) {
+    o_assert_dbg(IsValid());
+    return state->resourceContainer.Subscribe(label, handler);
+}
+
+//------------------------------------------------------------------------------
+void
+Gfx::UnsubscribeResources(ResourceStateHandlerId id) {
+    o_assert_dbg(IsValid());
+    state->resourceContainer.Unsubscribe(id);
+}
+
+//------------------------------------------------------------------------------
+Ptr<ResourceGroup>
+Gfx::AwaitResources(ResourceLabel label, ResourceGroup::DoneFunc onDone) {
+    o_assert_dbg(IsValid());
+    return state->resourceContainer.Await(label, onDone);
+}
+
 //------------------------------------------------------------------------------
 _priv::gfxResourceContainer&
 Gfx::resource() {
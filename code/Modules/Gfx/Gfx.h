@@ -18,7 +18,9 @@
 #include "Gfx/Core/PrimitiveGroup.h"
 #include "Gfx/Core/renderer.h"
 #include "Gfx/Core/GfxFrameInfo.h"
+#include "Gfx/Core/GfxResourceStats.h"
 #include "Resource/Core/SetupAndData.h"
+#include "Resource/ResourceHandle.h"
 #include "glm/vec4.hpp"
 
 namespace Oryol {
@@ -67,12 +69,35 @@ public:
     template<class SETUP> static Id CreateResource(const SETUP& setup, const Buffer& data);
     /// create a resource object with raw pointer to associated data
     template<class SETUP> static Id CreateResource(const SETUP& setup, const void* data, int size);
+    /// create a batch of resource objects without associated data (meshes and textures)
+    template<class SETUP> static Array<Id> CreateResources(const Array<SETUP>& setups);
+    /// create a batch of resource objects with associated data (meshes and textures)
+    template<class SETUP> static Array<Id> CreateResources(const Array<SetupAndData<SETUP>>& setupsAndData);
     /// asynchronously load resource object
     static Id LoadResource(const Ptr<ResourceLoader>& loader);
+    /// asynchronously load a batch of resource objects
+    static Array<Id> LoadResources(const Array<Ptr<ResourceLoader>>& loaders);
     /// lookup a resource Id by Locator
     static Id LookupResource(const Locator& locator);
-    /// destroy one or several resources by matching label
+    /// destroy one or several resources by matching label (resources referenced by handles are kept)
     static void DestroyResources(ResourceLabel label);
+    /// acquire a reference to a resource (called by ResourceHandle<Gfx>)
+    static void AcquireResource(const Id& id);
+    /// release a reference to a resource, destroyed in a later frame when unreferenced (called by ResourceHandle<Gfx>)
+    static void ReleaseResource(const Id& id);
+
+    /// resource state change callback typedef
+    typedef _priv::gfxResourceContainer::stateHandler ResourceStateHandler;
+    /// resource state change handler id typedef
+    typedef _priv::gfxResourceContainer::stateHandlerId ResourceStateHandlerId;
+    /// subscribe to the state changes of a resource (ends when the resource is destroyed)
+    static ResourceStateHandlerId SubscribeResource(const Id& id, ResourceStateHandler handler);
+    /// subscribe to the state changes of all resources with a label
+    static ResourceStateHandlerId SubscribeResources(ResourceLabel label, ResourceStateHandler handler);
+    /// unsubscribe from resource state changes
+    static void UnsubscribeResources(ResourceStateHandlerId id);
+    /// get a group which is done when all resources with a label are valid or failed
+    static Ptr<ResourceGroup> AwaitResources(ResourceLabel label, ResourceGroup::DoneFunc onDone=ResourceGroup::DoneFunc());
 
     /// test if an optional feature is supported
     static bool QueryFeature(GfxFeature::Code feat);
@@ -80,8 +105,10 @@ public:
     static int QueryFreeResourceSlots(GfxResourceType::Code resourceType);
     /// query resource info (fast)
     static ResourceInfo QueryResourceInfo(const Id& id);
-    /// query resource pool info (slow)
+    /// query resource pool info (live counters, cheap enough for each frame)
     static ResourcePoolInfo QueryResourcePoolInfo(GfxResourceType::Code resType);
+    /// query resource stats of all pools (resource counts, memory by usage, last frame activity)
+    static GfxResourceStats QueryResourceStats();
 
     /// apply the default render target and perform clear-actions
     static void ApplyDefaultRenderTarget(const ClearState& clearState=ClearState());
@@ -178,4 +205,18 @@ Gfx::CreateResource(const SETUP& setup, const void* data, int size) {
     return state->resourceContainer.Create(setup, data, size);
 }
 
+//------------------------------------------------------------------------------
+template<class SETUP> inline Array<Id>
+Gfx::CreateResources(const Array<SETUP>& setups) {
+    o_assert_dbg(IsValid());
+    return state->resourceContainer.CreateBatch(setups);
+}
+
+//------------------------------------------------------------------------------
+template<class SETUP> inline Array<Id>
+Gfx::CreateResources(const Array<SetupAndData<SETUP>>& setupsAndData) {
+    o_assert_dbg(IsValid());
+    return state->resourceContainer.CreateBatch(setupsAndData);
+}
+
 } // namespace Oryol
@@ -5,13 +5,19 @@
 #include "Core/Core.h"
 #include "gfxResourceContainerBase.h"
 #include "Gfx/Core/displayMgr.h"
+#include "Core/Time/Clock.h"
 
 namespace Oryol {
 namespace _priv {
 
 //------------------------------------------------------------------------------
 gfxResourceContainerBase::gfxResourceContainerBase() :
-runLoopId(RunLoop::InvalidId) {
+runLoopId(RunLoop::InvalidId),
+numDestroyed(0),
+numVertexBytes(0),
+numIndexBytes(0),
+numTextureBytes(0),
+numRenderTargetBytes(0) {
     // empty
 }
 
@@ -26,6 +32,16 @@ gfxResourceContainerBase::setup(const GfxSetup& setup, const gfxPointers& ptrs)
     this->shaderPool.Setup(GfxResourceType::Shader, setup.PoolSize(GfxResourceType::Shader));
     this->texturePool.Setup(GfxResourceType::Texture, setup.PoolSize(GfxResourceType::Texture));
     this->pipelinePool.Setup(GfxResourceType::Pipeline, setup.PoolSize(GfxResourceType::Pipeline));
+    this->meshPool.SetByteBudget(setup.MemoryBudget(GfxResourceType::Mesh));
+    this->texturePool.SetByteBudget(setup.MemoryBudget(GfxResourceType::Texture));
+    this->destroyBudget = setup.ResourceDestroyBudget;
+    auto stateFunc = [this](const Id& id, ResourceState::Code oldState, ResourceState::Code newState) {
+        this->notifyStateChange(id, oldState, newState);
+    };
+    this->meshPool.SetStateFunc(stateFunc);
+    this->shaderPool.SetStateFunc(stateFunc);
+    this->texturePool.SetStateFunc(stateFunc);
+    this->pipelinePool.SetStateFunc(stateFunc);
 
     this->meshFactory.Setup(this->pointers);
     this->shaderFactory.Setup(this->pointers);
@@ -45,10 +61,8 @@ gfxResourceContainerBase::discard() {
     o_assert_dbg(this->isValid());
     
     Core::PostRunLoop()->Remove(this->runLoopId);
-    for (const auto& loader : this->pendingLoaders) {
-        loader->Cancel();
-    }
-    this->pendingLoaders.Clear();
+    this->evicted.Clear();
+    this->destroyQueue.Clear();
     
     resourceContainerBase::discard();
 
@@ -63,6 +77,38 @@ gfxResourceContainerBase::discard() {
     this->pointers = gfxPointers();
 }
 
+//------------------------------------------------------------------------------
+template<class POOL> void
+gfxResourceContainerBase::setByteSize(POOL& pool, const Id& resId, int numBytes) {
+    const auto* res = pool.Get(resId);
+    o_assert_dbg(res);
+    this->countBytes(*res, -1);
+    pool.SetByteSize(resId, numBytes);
+    this->countBytes(*res, 1);
+}
+
+//------------------------------------------------------------------------------
+void
+gfxResourceContainerBase::countBytes(const mesh& msh, int sign) {
+    int indexBytes = 0;
+    if (IndexType::None != msh.Setup.IndicesType) {
+        indexBytes = std::min(msh.ByteSize, msh.Setup.NumIndices * IndexType::ByteSize(msh.Setup.IndicesType));
+    }
+    this->numIndexBytes += sign * indexBytes;
+    this->numVertexBytes += sign * (msh.ByteSize - indexBytes);
+}
+
+//------------------------------------------------------------------------------
+void
+gfxResourceContainerBase::countBytes(const texture& tex, int sign) {
+    if (tex.Setup.ShouldSetupAsRenderTarget()) {
+        this->numRenderTargetBytes += sign * tex.ByteSize;
+    }
+    else {
+        this->numTextureBytes += sign * tex.ByteSize;
+    }
+}
+
 //------------------------------------------------------------------------------
 template<> Id
 gfxResourceContainerBase::Create(const MeshSetup& setup) {
@@ -80,6 +126,9 @@ gfxResourceContainerBase::Create(const MeshSetup& setup) {
         const ResourceState::Code newState = this->meshFactory.SetupResource(res);
         o_assert((newState == ResourceState::Valid) || (newState == ResourceState::Failed));
         this->meshPool.UpdateState(resId, newState);
+        if (ResourceState::Valid == newState) {
+            this->setByteSize(this->meshPool, resId, byteSize(setup, 0));
+        }
     }
     return resId;
 }
@@ -103,6 +152,9 @@ gfxResourceContainerBase::Create(const MeshSetup& setup, const void* data, int s
         const ResourceState::Code newState = this->meshFactory.SetupResource(res, data, size);
         o_assert((newState == ResourceState::Valid) || (newState == ResourceState::Failed));
         this->meshPool.UpdateState(resId, newState);
+        if (ResourceState::Valid == newState) {
+            this->setByteSize(this->meshPool, resId, byteSize(setup, size));
+        }
     }
     return resId;
 }
@@ -124,6 +176,9 @@ gfxResourceContainerBase::Create(const TextureSetup& setup) {
         const ResourceState::Code newState = this->textureFactory.SetupResource(res);
         o_assert((newState == ResourceState::Valid) || (newState == ResourceState::Failed));
         this->texturePool.UpdateState(resId, newState);
+        if (ResourceState::Valid == newState) {
+            this->setByteSize(this->texturePool, resId, byteSize(setup, 0));
+        }
     }
     return resId;
 }
@@ -147,10 +202,93 @@ gfxResourceContainerBase::Create(const TextureSetup& setup, const void* data, in
         const ResourceState::Code newState = this->textureFactory.SetupResource(res, data, size);
         o_assert((newState == ResourceState::Valid) || (newState == ResourceState::Failed));
         this->texturePool.UpdateState(resId, newState);
+        if (ResourceState::Valid == newState) {
+            this->setByteSize(this->texturePool, resId, byteSize(setup, size));
+        }
     }
     return resId;
 }
 
+//------------------------------------------------------------------------------
+template<class POOL, class FACTORY, class SETUP> void
+gfxResourceContainerBase::setupBatchItem(POOL& pool, FACTORY& factory, const Id& resId, const SETUP& setup, const void* data, int size) {
+    o_assert_dbg(!setup.ShouldSetupFromFile());
+    auto& res = pool.Assign(resId, setup, ResourceState::Setup);
+    const ResourceState::Code newState = data ? factory.SetupResource(res, data, size) : factory.SetupResource(res);
+    o_assert((newState == ResourceState::Valid) || (newState == ResourceState::Failed));
+    pool.UpdateState(resId, newState);
+    if (ResourceState::Valid == newState) {
+        this->setByteSize(pool, resId, byteSize(setup, size));
+    }
+}
+
+//------------------------------------------------------------------------------
+template<> Array<Id>
+gfxResourceContainerBase::CreateBatch(const Array<MeshSetup>& setups) {
+    o_assert_dbg(this->isValid());
+
+    // reserve a vertex and an index buffer for each mesh
+    this->meshFactory.BeginBatch(2 * setups.Size());
+    Array<Id> ids = this->createBatch(this->meshPool, setups.Size(),
+        [&setups](int i) -> const Locator& {
+            return setups[i].Locator;
+        },
+        [this, &setups](int i, const Id& resId) {
+            this->setupBatchItem(this->meshPool, this->meshFactory, resId, setups[i], nullptr, 0);
+        });
+    this->meshFactory.EndBatch();
+    return ids;
+}
+
+//------------------------------------------------------------------------------
+template<> Array<Id>
+gfxResourceContainerBase::CreateBatch(const Array<SetupAndData<MeshSetup>>& setupsAndData) {
+    o_assert_dbg(this->isValid());
+
+    this->meshFactory.BeginBatch(2 * setupsAndData.Size());
+    Array<Id> ids = this->createBatch(this->meshPool, setupsAndData.Size(),
+        [&setupsAndData](int i) -> const Locator& {
+            return setupsAndData[i].Setup.Locator;
+        },
+        [this, &setupsAndData](int i, const Id& resId) {
+            const auto& item = setupsAndData[i];
+            o_assert_dbg(!item.Data.Empty());
+            this->setupBatchItem(this->meshPool, this->meshFactory, resId, item.Setup, item.Data.Data(), item.Data.Size());
+        });
+    this->meshFactory.EndBatch();
+    return ids;
+}
+
+//------------------------------------------------------------------------------
+template<> Array<Id>
+gfxResourceContainerBase::CreateBatch(const Array<TextureSetup>& setups) {
+    o_assert_dbg(this->isValid());
+
+    return this->createBatch(this->texturePool, setups.Size(),
+        [&setups](int i) -> const Locator& {
+            return setups[i].Locator;
+        },
+        [this, &setups](int i, const Id& resId) {
+            this->setupBatchItem(this->texturePool, this->textureFactory, resId, setups[i], nullptr, 0);
+        });
+}
+
+//------------------------------------------------------------------------------
+template<> Array<Id>
+gfxResourceContainerBase::CreateBatch(const Array<SetupAndData<TextureSetup>>& setupsAndData) {
+    o_assert_dbg(this->isValid());
+
+    return this->createBatch(this->texturePool, setupsAndData.Size(),
+        [&setupsAndData](int i) -> const Locator& {
+            return setupsAndData[i].Setup.Locator;
+        },
+        [this, &setupsAndData](int i, const Id& resId) {
+            const auto& item = setupsAndData[i];
+            o_assert_dbg(!item.Data.Empty());
+            this->setupBatchItem(this->texturePool, this->textureFactory, resId, item.Setup, item.Data.Data(), item.Data.Size());
+        });
+}
+
 //------------------------------------------------------------------------------
 template<> Id
 gfxResourceContainerBase::prepareAsync(const MeshSetup& setup) {
@@ -173,6 +311,9 @@ gfxResourceContainerBase::initAsync(const Id& resId, const MeshSetup& setup, con
         const ResourceState::Code newState = this->meshFactory.SetupResource(res, data, size);
         o_assert((newState == ResourceState::Valid) || (newState == ResourceState::Failed));
         this->meshPool.UpdateState(resId, newState);
+        if (ResourceState::Valid == newState) {
+            this->setByteSize(this->meshPool, resId, byteSize(setup, size));
+        }
         return newState;
     }
     else {
@@ -205,6 +346,9 @@ gfxResourceContainerBase::initAsync(const Id& resId, const TextureSetup& setup,
         const ResourceState::Code newState = this->textureFactory.SetupResource(res, data, size);
         o_assert((newState == ResourceState::Valid) || (newState == ResourceState::Failed));
         this->texturePool.UpdateState(resId, newState);
+        if (ResourceState::Valid == newState) {
+            this->setByteSize(this->texturePool, resId, byteSize(setup, size));
+        }
         return newState;
     }
     else {
@@ -296,94 +440,345 @@ gfxResourceContainerBase::Load(const Ptr<ResourceLoader>& loader) {
         return resId;
     }
     else {
-        this->pendingLoaders.Add(loader);
+        this->addLoader(loader);
         resId = loader->Start();
+        
+        // resources of reloadable loaders can be evicted
+        if (loader->CanReload()) {
+            switch (resId.Type) {
+                case GfxResourceType::Mesh:
+                    this->meshPool.Get(resId)->Loader = loader;
+                    break;
+                case GfxResourceType::Texture:
+                    this->texturePool.Get(resId)->Loader = loader;
+                    break;
+                default:
+                    break;
+            }
+        }
         return resId;
     }
 }
 
 //------------------------------------------------------------------------------
-void
-gfxResourceContainerBase::Destroy(ResourceLabel label) {
+Array<Id>
+gfxResourceContainerBase::LoadBatch(const Array<Ptr<ResourceLoader>>& loaders) {
     o_assert_dbg(this->isValid());
-    
-    Array<Id> ids = this->registry.Remove(label);
-    for (const Id& id : ids) {
-        switch (id.Type) {
-            case GfxResourceType::Texture:
-            {
-                if (ResourceState::Valid == this->texturePool.QueryState(id)) {
-                    texture* tex = this->texturePool.Lookup(id);
-                    if (tex) {
-                        this->textureFactory.DestroyResource(*tex);
-                    }
+
+    // the loaders allocate and register their resources in Start(),
+    // make room in the registry for the whole batch up front
+    this->registry.Reserve(loaders.Size());
+    Array<Id> ids;
+    ids.Reserve(loaders.Size());
+    for (const auto& loader : loaders) {
+        ids.Add(this->Load(loader));
+    }
+    return ids;
+}
+
+//------------------------------------------------------------------------------
+void
+gfxResourceContainerBase::destroyResource(const Id& resId) {
+    switch (resId.Type) {
+        case GfxResourceType::Texture:
+        {
+            if (ResourceState::Valid == this->texturePool.QueryState(resId)) {
+                texture* tex = this->texturePool.Peek(resId);
+                if (tex) {
+                    this->countBytes(*tex, -1);
+                    this->textureFactory.DestroyResource(*tex);
                 }
-                this->texturePool.Unassign(id);
             }
-            break;
-                
-            case GfxResourceType::Mesh:
-            {
-                if (ResourceState::Valid == this->meshPool.QueryState(id)) {
-                    mesh* msh = this->meshPool.Lookup(id);
-                    if (msh) {
-                        this->meshFactory.DestroyResource(*msh);
-                    }
+            this->texturePool.Unassign(resId);
+        }
+        break;
+            
+        case GfxResourceType::Mesh:
+        {
+            if (ResourceState::Valid == this->meshPool.QueryState(resId)) {
+                mesh* msh = this->meshPool.Peek(resId);
+                if (msh) {
+                    this->countBytes(*msh, -1);
+                    this->meshFactory.DestroyResource(*msh);
                 }
-                this->meshPool.Unassign(id);
             }
-            break;
-                
-            case GfxResourceType::Shader:
-            {
-                if (ResourceState::Valid == this->shaderPool.QueryState(id)) {
-                    shader* shd = this->shaderPool.Lookup(id);
-                    if (shd) {
-                        this->shaderFactory.DestroyResource(*shd);
-                    }
+            this->meshPool.Unassign(resId);
+        }
+        break;
+            
+        case GfxResourceType::Shader:
+        {
+            if (ResourceState::Valid == this->shaderPool.QueryState(resId)) {
+                shader* shd = this->shaderPool.Peek(resId);
+                if (shd) {
+                    this->shaderFactory.DestroyResource(*shd);
                 }
-                this->shaderPool.Unassign(id);
             }
-            break;
-                
-            case GfxResourceType::Pipeline:
-            {
-                if (ResourceState::Valid == this->pipelinePool.QueryState(id)) {
-                    pipeline* pip = this->pipelinePool.Lookup(id);
-                    if (pip) {
-                        this->pipelineFactory.DestroyResource(*pip);
-                    }
+            this->shaderPool.Unassign(resId);
+        }
+        break;
+            
+        case GfxResourceType::Pipeline:
+        {
+            if (ResourceState::Valid == this->pipelinePool.QueryState(resId)) {
+                pipeline* pip = this->pipelinePool.Peek(resId);
+                if (pip) {
+                    this->pipelineFactory.DestroyResource(*pip);
                 }
-                this->pipelinePool.Unassign(id);
             }
+            this->pipelinePool.Unassign(resId);
+        }
+        break;
+
+        default:
+            o_assert(false);
             break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+gfxResourceContainerBase::Destroy(ResourceLabel label, bool force) {
+    o_assert_dbg(this->isValid());
+    
+    // NOTE: the resources are removed from the registry after they
+    // have been destroyed, so that the state change handlers of
+    // the label are notified
+    Array<Id> ids = this->registry.GetIds(label);
+    for (const Id& id : ids) {
+        // resources which are still referenced are destroyed
+        // when the last reference is released
+        if (force || (this->queryRefCount(id) <= 0)) {
+            this->destroyResource(id);
+            this->registry.RemoveId(id);
+        }
+    }
+    if (force && (ResourceLabel::All == label)) {
+        this->destroyQueue.Clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+gfxResourceContainerBase::queryRefCount(const Id& resId) const {
+    switch (resId.Type) {
+        case GfxResourceType::Texture:
+            return this->texturePool.GetRefCount(resId);
+        case GfxResourceType::Mesh:
+            return this->meshPool.GetRefCount(resId);
+        case GfxResourceType::Shader:
+            return this->shaderPool.GetRefCount(resId);
+        case GfxResourceType::Pipeline:
+            return this->pipelinePool.GetRefCount(resId);
+        default:
+            o_assert(false);
+            return InvalidIndex;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+gfxResourceContainerBase::Acquire(const Id& resId) {
+    o_assert_dbg(this->isValid());
+    
+    int refCount = InvalidIndex;
+    switch (resId.Type) {
+        case GfxResourceType::Texture:  refCount = this->texturePool.AddRef(resId); break;
+        case GfxResourceType::Mesh:     refCount = this->meshPool.AddRef(resId); break;
+        case GfxResourceType::Shader:   refCount = this->shaderPool.AddRef(resId); break;
+        case GfxResourceType::Pipeline: refCount = this->pipelinePool.AddRef(resId); break;
+        default: o_assert(false); break;
+    }
+    if (InvalidIndex == refCount) {
+        o_warn("gfxResourceContainer::Acquire(): resource doesn't exist (type: %d, slot: %d)\n", resId.Type, resId.SlotIndex);
+    }
+}
 
-            default:
-                o_assert(false);
-                break;
+//------------------------------------------------------------------------------
+void
+gfxResourceContainerBase::Release(const Id& resId) {
+    o_assert_dbg(this->isValid());
+    
+    int refCount = InvalidIndex;
+    switch (resId.Type) {
+        case GfxResourceType::Texture:  refCount = this->texturePool.Release(resId); break;
+        case GfxResourceType::Mesh:     refCount = this->meshPool.Release(resId); break;
+        case GfxResourceType::Shader:   refCount = this->shaderPool.Release(resId); break;
+        case GfxResourceType::Pipeline: refCount = this->pipelinePool.Release(resId); break;
+        default: o_assert(false); break;
+    }
+    // NOTE: releasing a resource which has already been destroyed
+    // (e.g. through Destroy() with force) is not an error
+    if (0 == refCount) {
+        this->destroyQueue.Enqueue(resId);
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+gfxResourceContainerBase::DestroyQueueDepth() const {
+    return this->destroyQueue.Size();
+}
+
+//------------------------------------------------------------------------------
+int
+gfxResourceContainerBase::NumDestroyed() const {
+    return this->numDestroyed;
+}
+
+//------------------------------------------------------------------------------
+Duration
+gfxResourceContainerBase::DestroyTime() const {
+    return this->destroyTime;
+}
+
+//------------------------------------------------------------------------------
+void
+gfxResourceContainerBase::destroyReleased() {
+    this->numDestroyed = 0;
+    this->destroyTime = Duration();
+    if (this->destroyQueue.Empty()) {
+        return;
+    }
+    
+    // destroy at least one resource per frame, so that the
+    // queue drains even with a tiny budget
+    const TimePoint start = Clock::Now();
+    do {
+        const Id resId = this->destroyQueue.Dequeue();
+        // the resource may have been acquired again or destroyed since
+        if (0 == this->queryRefCount(resId)) {
+            this->destroyResource(resId);
+            this->registry.RemoveId(resId);
+            this->numDestroyed++;
         }
     }
+    while (!this->destroyQueue.Empty() && (Clock::Since(start) < this->destroyBudget));
+    this->destroyTime = Clock::Since(start);
+}
+
+//------------------------------------------------------------------------------
+Ptr<ResourceGroup>
+gfxResourceContainerBase::Await(ResourceLabel label, ResourceGroup::DoneFunc onDone) {
+    o_assert_dbg(this->isValid());
+
+    Ptr<ResourceGroup> group = ResourceGroup::Create();
+    group->Label = label;
+    group->OnDone = onDone;
+    Array<Id> ids = this->registry.GetIds(label);
+    for (const Id& id : ids) {
+        group->Count(this->QueryResourceInfo(id).State, 1);
+    }
+    this->addGroup(group);
+    return group;
 }
     
+//------------------------------------------------------------------------------
+template<class POOL, class FACTORY> void
+gfxResourceContainerBase::evict(POOL& pool, FACTORY& factory) {
+    Array<Id> ids = pool.SelectEvictions();
+    for (const Id& resId : ids) {
+        // keep the setup object, it has the placeholder
+        auto* res = pool.Get(resId);
+        this->countBytes(*res, -1);
+        const auto setup = res->Setup;
+        factory.DestroyResource(*res);
+        res->Setup = setup;
+        pool.Evict(resId);
+        this->evicted.Add(resId);
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class POOL> bool
+gfxResourceContainerBase::reload(POOL& pool, const Id& resId) {
+    auto* res = pool.Get(resId);
+    if ((nullptr == res) || !res->Evicted) {
+        // resource has been destroyed in the meantime
+        return true;
+    }
+    if (res->LastUseFrame > res->StateStartFrame) {
+        // Lookup() has been called since the eviction, the resource
+        // will be valid again once the loader calls initAsync()
+        this->addLoader(res->Loader);
+        res->Loader->Reload(resId);
+        return true;
+    }
+    return false;
+}
+
 //------------------------------------------------------------------------------
 void
 gfxResourceContainerBase::update() {
     o_assert_dbg(this->isValid());
     
+    // reload evicted resources which have been used since their eviction
+    for (int i = this->evicted.Size() - 1; i >= 0; i--) {
+        const Id& resId = this->evicted[i];
+        const bool done = (GfxResourceType::Mesh == resId.Type) ?
+            this->reload(this->meshPool, resId) :
+            this->reload(this->texturePool, resId);
+        if (done) {
+            this->evicted.EraseSwapBack(i);
+        }
+    }
+    
+    // evict least recently used resources from pools over budget
+    // (before the pool update, so that resources used in this
+    // frame are not evicted)
+    this->evict(this->meshPool, this->meshFactory);
+    this->evict(this->texturePool, this->textureFactory);
+    
     /// call update method on resource pools (this is cheap)
     this->meshPool.Update();
     this->shaderPool.Update();
     this->texturePool.Update();
     this->pipelinePool.Update();
 
-    // trigger loaders, and remove from pending array if finished
-    for (int i = this->pendingLoaders.Size() - 1; i >= 0; i--) {
-        const auto& loader = this->pendingLoaders[i];
-        ResourceState::Code state = loader->Continue();
-        if (ResourceState::Pending != state) {
-            this->pendingLoaders.Erase(i);
+    // continue loaders which have woken up, and polled loaders
+    this->updateLoaders();
+    
+    // destroy released resources
+    this->destroyReleased();
+}
+
+//------------------------------------------------------------------------------
+int
+gfxResourceContainerBase::byteSize(const MeshSetup& setup, int dataSize) {
+    if (dataSize > 0) {
+        return dataSize;
+    }
+    int size = setup.NumVertices * setup.Layout.ByteSize();
+    if (IndexType::None != setup.IndicesType) {
+        size += setup.NumIndices * IndexType::ByteSize(setup.IndicesType);
+    }
+    return size;
+}
+
+//------------------------------------------------------------------------------
+int
+gfxResourceContainerBase::byteSize(const TextureSetup& setup, int dataSize) {
+    if (dataSize > 0) {
+        return dataSize;
+    }
+    // textures without data: compute from the dimensions (display-relative
+    // render targets and compressed formats are not tracked)
+    int size = 0;
+    const PixelFormat::Code fmt = setup.ColorFormat;
+    if ((PixelFormat::InvalidPixelFormat != fmt) && !PixelFormat::IsCompressedFormat(fmt)) {
+        const int numFaces = (TextureType::TextureCube == setup.Type) ? 6 : 1;
+        int w = setup.Width;
+        int h = setup.Height;
+        for (int mipIndex = 0; mipIndex < setup.NumMipMaps; mipIndex++) {
+            size += w * h * PixelFormat::ByteSize(fmt) * numFaces;
+            w = (w > 1) ? w / 2 : 1;
+            h = (h > 1) ? h / 2 : 1;
         }
     }
+    if (setup.ShouldSetupAsRenderTarget() && setup.HasDepth() && !setup.HasSharedDepth()) {
+        size += setup.Width * setup.Height * PixelFormat::ByteSize(setup.DepthFormat);
+    }
+    return size;
 }
 
 //------------------------------------------------------------------------------
@@ -426,6 +821,41 @@ gfxResourceContainerBase::QueryPoolInfo(GfxResourceType::Code resType) const {
     }
 }
 
+//------------------------------------------------------------------------------
+GfxResourceStats
+gfxResourceContainerBase::QueryStats() const {
+    o_assert_dbg(this->isValid());
+    
+    GfxResourceStats stats;
+    Duration loadTime;
+    int numTimedLoads = 0;
+    const ResourcePoolInfo poolInfos[] = {
+        this->meshPool.QueryPoolInfo(),
+        this->shaderPool.QueryPoolInfo(),
+        this->texturePool.QueryPoolInfo(),
+        this->pipelinePool.QueryPoolInfo()
+    };
+    for (const auto& poolInfo : poolInfos) {
+        // Initial are the unassigned slots
+        for (int state = ResourceState::Initial + 1; state < ResourceState::NumStates; state++) {
+            stats.NumResourcesByState[state] += poolInfo.NumSlotsByState[state];
+        }
+        stats.NumCreated += poolInfo.NumCreatedLastFrame;
+        stats.NumDestroyed += poolInfo.NumDestroyedLastFrame;
+        stats.NumLoaded += poolInfo.NumLoadedLastFrame;
+        loadTime += poolInfo.LoadTime;
+        numTimedLoads += poolInfo.NumTimedLoads;
+    }
+    if (numTimedLoads > 0) {
+        stats.AverageLoadTime = Duration(loadTime.getRaw() / numTimedLoads);
+    }
+    stats.NumVertexBytes = this->numVertexBytes;
+    stats.NumIndexBytes = this->numIndexBytes;
+    stats.NumTextureBytes = this->numTextureBytes;
+    stats.NumRenderTargetBytes = this->numRenderTargetBytes;
+    return stats;
+}
+
 //------------------------------------------------------------------------------
 int
 gfxResourceContainerBase::QueryFreeSlots(GfxResourceType::Code resourceType) const {
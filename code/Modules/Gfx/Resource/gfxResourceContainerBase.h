@@ -4,15 +4,45 @@
     @class Oryol::gfxResourceContainerBase
     @ingroup _priv
     @brief resource container base implementation of the Gfx module
+
+    Meshes and textures are tracked with their memory size, and their
+    pools may have a memory budget (see GfxSetup::SetMemoryBudget()).
+    Once per frame, the least recently used meshes and textures which
+    were loaded by a reloadable loader are evicted to stay in budget.
+    Lookups of loading or evicted resources return the placeholder
+    resource from their setup object, and evicted resources are
+    reloaded when they are looked up again.
+
+    The state changes of all resource pools are forwarded to the
+    state change subscribers and resource groups.
+
+    Batches of meshes and textures can be created with CreateBatch(),
+    this allocates the resource ids and registry entries for the
+    whole batch at once, and lets the mesh factory batch its
+    backend calls.
+
+    Resources can be reference counted with Acquire() and Release(),
+    resources with references are not destroyed by Destroy(). When the
+    last reference is released, the resource goes into a destroy queue,
+    and the queued resources are destroyed in update() within a time
+    budget per frame (see GfxSetup::ResourceDestroyBudget).
+
+    The memory size of meshes and textures is also tracked by usage
+    (vertices, indices, textures and render targets) for the resource
+    stats, the split is computed from the setup object of a resource.
 */
 #include "Core/Core.h"
 #include "Core/RunLoop.h"
 #include "Core/Threading/RWLock.h"
 #include "Core/Containers/Array.h"
+#include "Core/Containers/Queue.h"
+#include "Core/Time/Duration.h"
 #include "Core/Containers/KeyValuePair.h"
 #include "Resource/Core/resourceContainerBase.h"
+#include "Resource/Core/SetupAndData.h"
 #include "Resource/ResourceInfo.h"
 #include "Gfx/Setup/GfxSetup.h"
+#include "Gfx/Core/GfxResourceStats.h"
 #include "Gfx/Resource/resourcePools.h"
 #include "Gfx/Resource/factory.h"
 #include "Gfx/Resource/MeshLoaderBase.h"
@@ -39,16 +69,36 @@ public:
     template<class SETUP> Id Create(const SETUP& setup);
     /// create a resource object with data
     template<class SETUP> Id Create(const SETUP& setup, const void* data, int size);
+    /// create a batch of resource objects
+    template<class SETUP> Array<Id> CreateBatch(const Array<SETUP>& setups);
+    /// create a batch of resource objects with data
+    template<class SETUP> Array<Id> CreateBatch(const Array<SetupAndData<SETUP>>& setupsAndData);
     /// asynchronously load resource object
     Id Load(const Ptr<ResourceLoader>& loader);
+    /// asynchronously load a batch of resource objects
+    Array<Id> LoadBatch(const Array<Ptr<ResourceLoader>>& loaders);
     /// query number of free slots for resource type
     int QueryFreeSlots(GfxResourceType::Code resourceType) const;
     /// query resource info (fast)
     ResourceInfo QueryResourceInfo(const Id& id) const;
-    /// query resource pool info (slow)
+    /// query resource pool info
     ResourcePoolInfo QueryPoolInfo(GfxResourceType::Code resType) const;
-    /// destroy resources by label
-    void Destroy(ResourceLabel label);
+    /// query the resource stats of all pools
+    GfxResourceStats QueryStats() const;
+    /// destroy resources by label, referenced resources are kept unless force is true
+    void Destroy(ResourceLabel label, bool force=false);
+    /// acquire a reference to a resource
+    void Acquire(const Id& id);
+    /// release a reference to a resource, the last release queues the resource for destruction
+    void Release(const Id& id);
+    /// number of released resources waiting for destruction
+    int DestroyQueueDepth() const;
+    /// number of resources destroyed from the destroy queue in the last update
+    int NumDestroyed() const;
+    /// time spent destroying released resources in the last update
+    Duration DestroyTime() const;
+    /// get a resource group which is done when all resources with a label are valid or failed
+    Ptr<ResourceGroup> Await(ResourceLabel label, ResourceGroup::DoneFunc onDone);
     
     /// prepare async creation (usually called at start of async Load)
     template<class SETUP> Id prepareAsync(const SETUP& setup);
@@ -68,6 +118,29 @@ public:
 
     /// per-frame update (update resource pools and pending loaders)
     void update();
+    
+    /// get the tracked memory size of a mesh
+    static int byteSize(const MeshSetup& setup, int dataSize);
+    /// get the tracked memory size of a texture
+    static int byteSize(const TextureSetup& setup, int dataSize);
+    /// set the tracked memory size of a mesh or texture
+    template<class POOL> void setByteSize(POOL& pool, const Id& resId, int numBytes);
+    /// add or subtract the memory size of a mesh to the usage counters
+    void countBytes(const mesh& msh, int sign);
+    /// add or subtract the memory size of a texture to the usage counters
+    void countBytes(const texture& tex, int sign);
+    /// evict resources from a pool which is over budget
+    template<class POOL, class FACTORY> void evict(POOL& pool, FACTORY& factory);
+    /// start reloading an evicted resource if it was used, return false if it is still evicted
+    template<class POOL> bool reload(POOL& pool, const Id& resId);
+    /// get the reference count of a resource, InvalidIndex if the resource doesn't exist
+    int queryRefCount(const Id& resId) const;
+    /// destroy a single resource (backend object and pool slot, not the registry entry)
+    void destroyResource(const Id& resId);
+    /// destroy released resources from the destroy queue within the time budget
+    void destroyReleased();
+    /// assign and setup a new mesh or texture of a batch
+    template<class POOL, class FACTORY, class SETUP> void setupBatchItem(POOL& pool, FACTORY& factory, const Id& resId, const SETUP& setup, const void* data, int size);
 
     gfxPointers pointers;
     class meshFactory meshFactory;
@@ -79,14 +152,30 @@ public:
     class texturePool texturePool;
     class pipelinePool pipelinePool;
     RunLoop::Id runLoopId;
-    Array<Ptr<ResourceLoader>> pendingLoaders;
+    Array<Id> evicted;
+    Queue<Id> destroyQueue;
+    Duration destroyBudget;
+    int numDestroyed;
+    Duration destroyTime;
+    int64_t numVertexBytes;
+    int64_t numIndexBytes;
+    int64_t numTextureBytes;
+    int64_t numRenderTargetBytes;
 };
 
 //------------------------------------------------------------------------------
 inline mesh*
 gfxResourceContainerBase::lookupMesh(const Id& resId) {
     o_assert_dbg(this->valid);
-    return this->meshPool.Lookup(resId);
+    mesh* msh = this->meshPool.Lookup(resId);
+    if (nullptr == msh) {
+        // fall back to the placeholder while the mesh is loading or evicted
+        const mesh* pending = this->meshPool.Get(resId);
+        if (pending && pending->Setup.Placeholder.IsValid()) {
+            msh = this->meshPool.Lookup(pending->Setup.Placeholder);
+        }
+    }
+    return msh;
 }
 
 //------------------------------------------------------------------------------
@@ -100,7 +189,15 @@ gfxResourceContainerBase::lookupShader(const Id& resId) {
 inline texture*
 gfxResourceContainerBase::lookupTexture(const Id& resId) {
     o_assert_dbg(this->valid);
-    return this->texturePool.Lookup(resId);
+    texture* tex = this->texturePool.Lookup(resId);
+    if (nullptr == tex) {
+        // fall back to the placeholder while the texture is loading or evicted
+        const texture* pending = this->texturePool.Get(resId);
+        if (pending && pending->Setup.Placeholder.IsValid()) {
+            tex = this->texturePool.Lookup(pending->Setup.Placeholder);
+        }
+    }
+    return tex;
 }
 
 //------------------------------------------------------------------------------
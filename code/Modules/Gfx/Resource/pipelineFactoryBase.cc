@@ -46,7 +46,7 @@ pipelineFactoryBase::IsValid() const {
 ResourceState::Code
 pipelineFactoryBase::SetupResource(pipeline& pip) {
     o_assert_dbg(this->isValid);
-    pip.shd = this->pointers.shaderPool->Lookup(pip.Setup.Shader);
+    pip.shd = this->pointers.shaderPool->Peek(pip.Setup.Shader);
     o_assert_dbg(pip.shd && (ResourceState::Valid == pip.shd->State));
     return ResourceState::Valid;
 }
@@ -12,6 +12,7 @@ GfxSetup::GfxSetup() {
     for (int i = 0; i < GfxResourceType::NumResourceTypes; i++) {
         this->poolSizes[i] = GfxConfig::DefaultResourcePoolSize;
         this->throttling[i] = 0;    // unthrottled
+        this->memoryBudgets[i] = 0; // unlimited
     }
 }
 
@@ -105,4 +106,20 @@ GfxSetup::Throttling(GfxResourceType::Code type) const {
     return this->throttling[type];
 }
     
+//------------------------------------------------------------------------------
+void
+GfxSetup::SetMemoryBudget(GfxResourceType::Code type, int64_t numBytes) {
+    o_assert_range(type, GfxResourceType::NumResourceTypes);
+    o_assert((GfxResourceType::Mesh == type) || (GfxResourceType::Texture == type));
+    o_assert(numBytes >= 0);
+    this->memoryBudgets[type] = numBytes;
+}
+
+//------------------------------------------------------------------------------
+int64_t
+GfxSetup::MemoryBudget(GfxResourceType::Code type) const {
+    o_assert_range(type, GfxResourceType::NumResourceTypes);
+    return this->memoryBudgets[type];
+}
+    
 } // namespace Oryol
@@ -13,6 +13,7 @@
     @see Gfx, DisplayAttrs
 */
 #include "Core/Containers/Array.h"
+#include "Core/Time/Duration.h"
 #include "Gfx/Core/Enums.h"
 #include "Gfx/Core/GfxConfig.h"
 #include "Gfx/Core/ClearState.h"
@@ -52,19 +53,25 @@ public:
     /// enable to render full-res on HighDPI displays (not supported on all platforms)
     bool HighDPI = false;
     
-    /// tweak resource pool size for a rendering resource type
+    /// tweak initial resource pool size for a rendering resource type (pools grow on demand)
     void SetPoolSize(GfxResourceType::Code type, int poolSize);
-    /// get resource pool size for a rendering resource type
+    /// get initial resource pool size for a rendering resource type
     int PoolSize(GfxResourceType::Code type) const;
     /// tweak resource throttling value for a resource type, 0 means unthrottled
     void SetThrottling(GfxResourceType::Code type, int maxCreatePerFrame);
     /// get resource throttling value
     int Throttling(GfxResourceType::Code type) const;
+    /// set memory budget in bytes for a resource type (only meshes and textures, 0 means unlimited)
+    void SetMemoryBudget(GfxResourceType::Code type, int64_t numBytes);
+    /// get memory budget for a resource type
+    int64_t MemoryBudget(GfxResourceType::Code type) const;
     
     /// initial resource label stack capacity
     int ResourceLabelStackCapacity = 256;
     /// initial resource registry capacity
     int ResourceRegistryCapacity = 256;
+    /// max time per frame for destroying released resources (at least one is destroyed per frame)
+    Duration ResourceDestroyBudget = Duration::FromMilliSeconds(1.0);
     /// size of the global uniform buffer (only relevant on some platforms)
     int GlobalUniformBufferSize = GfxConfig::DefaultGlobalUniformBufferSize;
     /// max number of drawcalls per frame (only relevant on some platforms)
@@ -81,6 +88,7 @@ public:
 private:
     int poolSizes[GfxResourceType::NumResourceTypes];
     int throttling[GfxResourceType::NumResourceTypes];
+    int64_t memoryBudgets[GfxResourceType::NumResourceTypes];
 };
     
 } // namespace Oryol
@@ -76,6 +76,18 @@ d3d11MeshFactory::DestroyResource(mesh& mesh) {
     mesh.Clear();
 }
 
+//------------------------------------------------------------------------------
+void
+d3d11MeshFactory::BeginBatch(int /*numBuffers*/) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+d3d11MeshFactory::EndBatch() {
+    // empty
+}
+
 //------------------------------------------------------------------------------
 ID3D11Buffer*
 d3d11MeshFactory::createBuffer(const void* data, uint32_t dataSize, uint32_t d3d11BindFlags, Usage::Code usage) {
@@ -33,6 +33,10 @@ public:
     ResourceState::Code SetupResource(mesh& mesh, const void* data, int size);
     /// discard the resource
     void DestroyResource(mesh& mesh);
+    /// begin a batch of resource creations (no-op)
+    void BeginBatch(int numBuffers);
+    /// end a batch of resource creations (no-op)
+    void EndBatch();
 
     /// helper method to setup a mesh object as fullscreen quad
     ResourceState::Code createFullscreenQuad(mesh& mesh);
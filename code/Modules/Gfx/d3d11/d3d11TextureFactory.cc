@@ -133,7 +133,7 @@ d3d11TextureFactory::createRenderTarget(texture& tex) {
     else if (setup.HasSharedDepth()) {
         // a shared-depth-buffer render target, obtain width and height
         // from the original render target
-        sharedDepthProvider = this->pointers.texturePool->Lookup(setup.DepthRenderTarget);
+        sharedDepthProvider = this->pointers.texturePool->Peek(setup.DepthRenderTarget);
         o_assert_dbg(nullptr != sharedDepthProvider);
         width = sharedDepthProvider->textureAttrs.Width;
         height = sharedDepthProvider->textureAttrs.Height;
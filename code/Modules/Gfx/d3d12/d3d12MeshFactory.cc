@@ -85,6 +85,18 @@ d3d12MeshFactory::DestroyResource(mesh& msh) {
     msh.Clear();
 }
 
+//------------------------------------------------------------------------------
+void
+d3d12MeshFactory::BeginBatch(int /*numBuffers*/) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+d3d12MeshFactory::EndBatch() {
+    // empty
+}
+
 //------------------------------------------------------------------------------
 void
 d3d12MeshFactory::setupAttrs(mesh& msh) {
@@ -130,7 +130,7 @@ d3d12TextureFactory::createRenderTarget(texture& tex) {
         height = int(dispAttrs.FramebufferHeight * setup.RelHeight);
     }
     else if (setup.HasSharedDepth()) {
-        sharedDepthProvider = this->pointers.texturePool->Lookup(setup.DepthRenderTarget);
+        sharedDepthProvider = this->pointers.texturePool->Peek(setup.DepthRenderTarget);
         o_assert_dbg(nullptr != sharedDepthProvider);
         width = sharedDepthProvider->textureAttrs.Width;
         height = sharedDepthProvider->textureAttrs.Height;
@@ -15,7 +15,9 @@ namespace _priv {
 
 //------------------------------------------------------------------------------
 glMeshFactory::glMeshFactory() :
-isValid(false) {
+isValid(false),
+inBatch(false),
+batchBufferIndex(0) {
     // empty
 }
 
@@ -36,6 +38,7 @@ glMeshFactory::Setup(const gfxPointers& ptrs) {
 void
 glMeshFactory::Discard() {
     o_assert_dbg(this->isValid);
+    o_assert_dbg(!this->inBatch);
     this->pointers = gfxPointers();
     this->isValid = false;
 }
@@ -84,6 +87,55 @@ glMeshFactory::DestroyResource(mesh& mesh) {
     mesh.Clear();
 }
 
+//------------------------------------------------------------------------------
+void
+glMeshFactory::BeginBatch(int numBuffers) {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(!this->inBatch);
+    o_assert_dbg(numBuffers >= 0);
+
+    this->inBatch = true;
+    this->pointers.renderer->invalidateMeshState();
+    this->batchBuffers.Clear();
+    this->batchBufferIndex = 0;
+    if (numBuffers > 0) {
+        this->batchBuffers.Reserve(numBuffers);
+        for (int i = 0; i < numBuffers; i++) {
+            this->batchBuffers.Add(0);
+        }
+        ::glGenBuffers(numBuffers, this->batchBuffers.begin());
+        ORYOL_GL_CHECK_ERROR();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+glMeshFactory::EndBatch() {
+    o_assert_dbg(this->inBatch);
+
+    const int numUnused = this->batchBuffers.Size() - this->batchBufferIndex;
+    if (numUnused > 0) {
+        ::glDeleteBuffers(numUnused, this->batchBuffers.begin() + this->batchBufferIndex);
+        ORYOL_GL_CHECK_ERROR();
+    }
+    this->batchBuffers.Clear();
+    this->batchBufferIndex = 0;
+    this->pointers.renderer->invalidateMeshState();
+    this->inBatch = false;
+}
+
+//------------------------------------------------------------------------------
+GLuint
+glMeshFactory::genBuffer() {
+    if (this->batchBufferIndex < this->batchBuffers.Size()) {
+        return this->batchBuffers[this->batchBufferIndex++];
+    }
+    GLuint buf = 0;
+    ::glGenBuffers(1, &buf);
+    ORYOL_GL_CHECK_ERROR();
+    return buf;
+}
+
 //------------------------------------------------------------------------------
 /**
  NOTE: this method can be called with a nullptr for vertexData, in this case
@@ -93,15 +145,18 @@ GLuint
 glMeshFactory::createVertexBuffer(const void* vertexData, uint32_t vertexDataSize, Usage::Code usage) {
     o_assert_dbg(vertexDataSize > 0);
     
-    this->pointers.renderer->invalidateMeshState();
-    GLuint vb = 0;
-    ::glGenBuffers(1, &vb);
-    ORYOL_GL_CHECK_ERROR();
+    // in a batch, the mesh state is invalidated in BeginBatch/EndBatch
+    if (!this->inBatch) {
+        this->pointers.renderer->invalidateMeshState();
+    }
+    GLuint vb = this->genBuffer();
     o_assert_dbg(0 != vb);
     this->pointers.renderer->bindVertexBuffer(vb);
     ::glBufferData(GL_ARRAY_BUFFER, vertexDataSize, vertexData, glTypes::asGLBufferUsage(usage));
     ORYOL_GL_CHECK_ERROR();
-    this->pointers.renderer->invalidateMeshState();
+    if (!this->inBatch) {
+        this->pointers.renderer->invalidateMeshState();
+    }
     return vb;
 }
 
@@ -114,15 +169,17 @@ GLuint
 glMeshFactory::createIndexBuffer(const void* indexData, uint32_t indexDataSize, Usage::Code usage) {
     o_assert_dbg(indexDataSize > 0);
     
-    this->pointers.renderer->invalidateMeshState();
-    GLuint ib = 0;
-    ::glGenBuffers(1, &ib);
-    ORYOL_GL_CHECK_ERROR();
+    if (!this->inBatch) {
+        this->pointers.renderer->invalidateMeshState();
+    }
+    GLuint ib = this->genBuffer();
     o_assert_dbg(0 != ib);
     this->pointers.renderer->bindIndexBuffer(ib);
     ::glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexDataSize, indexData, glTypes::asGLBufferUsage(usage));
     ORYOL_GL_CHECK_ERROR();
-    this->pointers.renderer->invalidateMeshState();
+    if (!this->inBatch) {
+        this->pointers.renderer->invalidateMeshState();
+    }
     return ib;
 }
 
@@ -4,11 +4,17 @@
     @class Oryol::_priv::glMeshFactory
     @ingroup _priv
     @brief GL implementation of meshFactory
+
+    Meshes created between BeginBatch() and EndBatch() take their GL
+    buffer names from a single glGenBuffers() call, and the renderer's
+    mesh state is only invalidated once for the whole batch instead of
+    twice per buffer.
 */
 #include "Resource/ResourceState.h"
 #include "Gfx/gl/gl_decl.h"
 #include "Gfx/Core/Enums.h"
 #include "Gfx/Core/gfxPointers.h"
+#include "Core/Containers/Array.h"
 
 namespace Oryol {
 namespace _priv {
@@ -35,6 +41,10 @@ public:
     ResourceState::Code SetupResource(mesh& mesh, const void* data, int size);
     /// discard the resource
     void DestroyResource(mesh& mesh);
+    /// begin a batch of resource creations, reserve GL names for numBuffers buffers
+    void BeginBatch(int numBuffers);
+    /// end a batch of resource creations, deletes unused GL buffer names
+    void EndBatch();
     
     /// helper method to setup a mesh object as fullscreen quad
     ResourceState::Code createFullscreenQuad(mesh& mesh);
@@ -48,6 +58,8 @@ private:
     void setupAttrs(mesh& msh);
     /// helper method to populate primitive groups
     void setupPrimGroups(mesh& msh);
+    /// get a new GL buffer name, from the batch if possible
+    GLuint genBuffer();
     /// helper method to create vertex buffer in mesh
     GLuint createVertexBuffer(const void* vertexData, uint32_t vertexDataSize, Usage::Code usage);
     /// helper method to create index buffer in mesh
@@ -55,6 +67,9 @@ private:
 
     gfxPointers pointers;
     bool isValid;
+    bool inBatch;
+    Array<GLuint> batchBuffers;
+    int batchBufferIndex;
 };
     
 } // namespace _priv
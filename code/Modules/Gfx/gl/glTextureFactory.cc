@@ -146,7 +146,7 @@ glTextureFactory::createRenderTarget(texture& tex) {
     else if (setup.HasSharedDepth()) {
         // a shared-depth-buffer render target, obtain width and height
         // from the original render target
-        texture* sharedDepthProvider = this->pointers.texturePool->Lookup(setup.DepthRenderTarget);
+        texture* sharedDepthProvider = this->pointers.texturePool->Peek(setup.DepthRenderTarget);
         o_assert_dbg(nullptr != sharedDepthProvider);
         width = sharedDepthProvider->textureAttrs.Width;
         height = sharedDepthProvider->textureAttrs.Height;
@@ -81,6 +81,18 @@ mtlMeshFactory::DestroyResource(mesh& msh) {
     msh.Clear();
 }
 
+//------------------------------------------------------------------------------
+void
+mtlMeshFactory::BeginBatch(int /*numBuffers*/) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+mtlMeshFactory::EndBatch() {
+    // empty
+}
+
 //------------------------------------------------------------------------------
 /**
     NOTE: data pointer can be a nullptr
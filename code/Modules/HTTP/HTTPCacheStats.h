@@ -0,0 +1,34 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::HTTPCacheStats
+    @ingroup HTTP
+    @brief statistics of the persistent HTTP response cache
+
+    @see HTTPFileSystem::SetupCache(), HTTPFileSystem::QueryCacheStats()
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+
+class HTTPCacheStats {
+public:
+    /// number of reads served from fresh cache entries without a request
+    int NumHits = 0;
+    /// number of reads served from the cache after a 304 Not Modified response
+    int NumRevalidated = 0;
+    /// number of reads which downloaded the complete response
+    int NumMisses = 0;
+    /// number of responses written to the cache
+    int NumWrites = 0;
+    /// number of entries evicted to stay in the byte budget
+    int NumEvictions = 0;
+    /// current number of cache entries
+    int NumEntries = 0;
+    /// current number of response body bytes in the cache
+    int64_t NumBytes = 0;
+    /// byte budget of the cache
+    int64_t Budget = 0;
+};
+
+} // namespace Oryol
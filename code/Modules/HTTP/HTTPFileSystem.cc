@@ -5,14 +5,157 @@
 #include "HTTPFileSystem.h"
 
 namespace Oryol {
+
+//------------------------------------------------------------------------------
+HTTPFileSystem::HTTPFileSystem() {
+    this->cache = _priv::httpCache::acquire();
+}
+
+//------------------------------------------------------------------------------
+HTTPFileSystem::~HTTPFileSystem() {
+    // the loader cancels the internal requests, which won't finish anymore
+    for (const auto& cacheRead : this->cacheReads) {
+        cacheRead->Original->Status = IOStatus::Cancelled;
+        cacheRead->Original->Handled = true;
+    }
+    this->cacheReads.Clear();
+    if (this->cache) {
+        this->cache = nullptr;
+        _priv::httpCache::release();
+    }
+}
     
+//------------------------------------------------------------------------------
+void
+HTTPFileSystem::SetConnectionLimits(int maxConnectionsPerHost, int maxConnections) {
+    _priv::urlLoader::setConnectionLimits(maxConnectionsPerHost, maxConnections);
+}
+
+//------------------------------------------------------------------------------
+void
+HTTPFileSystem::SetRetryPolicy(const HTTPRetryPolicy& policy) {
+    _priv::urlLoader::setRetryPolicy(policy);
+}
+
+//------------------------------------------------------------------------------
+HTTPRetryStats
+HTTPFileSystem::QueryRetryStats() {
+    return _priv::urlLoader::retryStats();
+}
+
+//------------------------------------------------------------------------------
+void
+HTTPFileSystem::SetupCache(const String& dir, int64_t budget) {
+    _priv::httpCache::setup(dir, budget);
+}
+
+//------------------------------------------------------------------------------
+void
+HTTPFileSystem::DiscardCache() {
+    _priv::httpCache::setup(String(), 0);
+}
+
+//------------------------------------------------------------------------------
+HTTPCacheStats
+HTTPFileSystem::QueryCacheStats() {
+    return _priv::httpCache::stats();
+}
+
 //------------------------------------------------------------------------------
 void
 HTTPFileSystem::onMsg(const Ptr<IORequest>& ioReq) {
-    Ptr<IORead> ioReadRequest = ioReq->DynamicCast<IORead>();
-    if (ioReadRequest.isValid()) {
-        this->loader.doRequest(ioReadRequest);
+    if (ioReq->isRead()) {
+        Ptr<IORead> ioReadRequest = _priv::ioMsgCast<IORead>(ioReq);
+        const bool cacheable = this->cache && _priv::httpCache::isCacheable(ioReadRequest) && !ioReadRequest->Cancelled;
+        if (cacheable || ioReadRequest->CountWhenHandled) {
+            // forward an internal request which carries the cache validators,
+            // fresh cache entries are served without request, requests which
+            // must be counted for the IO metrics are finished the same way,
+            // since the loader would flag them as handled directly
+            Ptr<_priv::httpCacheRead> cacheRead = _priv::httpCacheRead::Create();
+            cacheRead->Url = ioReadRequest->Url;
+            cacheRead->StartOffset = ioReadRequest->StartOffset;
+            cacheRead->EndOffset = ioReadRequest->EndOffset;
+            cacheRead->Original = ioReadRequest;
+            cacheRead->Cacheable = cacheable;
+            if (cacheable && this->cache->lookup(cacheRead.get())) {
+                cacheRead->Handled = true;
+                this->finishCacheRead(cacheRead);
+            }
+            else {
+                this->loader.doRequest(cacheRead);
+                if (cacheRead->Handled) {
+                    if (cacheable) {
+                        this->cache->finish(cacheRead.get());
+                    }
+                    this->finishCacheRead(cacheRead);
+                }
+                else {
+                    this->cacheReads.Add(cacheRead);
+                }
+            }
+        }
+        else {
+            this->loader.doRequest(ioReadRequest);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+HTTPFileSystem::update() {
+    // forward cancellation to the internal requests
+    for (const auto& cacheRead : this->cacheReads) {
+        if (cacheRead->Original->Cancelled) {
+            cacheRead->Cancelled = true;
+        }
+    }
+    bool inFlight = this->loader.update();
+    for (int i = this->cacheReads.Size() - 1; i >= 0; i--) {
+        Ptr<_priv::httpCacheRead> cacheRead = this->cacheReads[i];
+        if (cacheRead->Handled) {
+            this->cacheReads.Erase(i);
+            if (cacheRead->Cacheable) {
+                this->cache->finish(cacheRead.get());
+            }
+            this->finishCacheRead(cacheRead);
+        }
+    }
+    return inFlight || !this->cacheReads.Empty();
+}
+
+//------------------------------------------------------------------------------
+bool
+HTTPFileSystem::wait(Duration timeout) {
+    return this->loader.wait(timeout);
+}
+
+//------------------------------------------------------------------------------
+void
+HTTPFileSystem::wakeup() {
+    this->loader.wakeup();
+}
+
+//------------------------------------------------------------------------------
+void
+HTTPFileSystem::finishCacheRead(const Ptr<_priv::httpCacheRead>& cacheRead) {
+    o_assert_dbg(cacheRead->Handled);
+    const Ptr<IORead>& req = cacheRead->Original;
+    req->Status = cacheRead->Status;
+    req->ErrorDesc = cacheRead->ErrorDesc;
+    if (IOStatus::OK == cacheRead->Status) {
+        if (req->HasDest()) {
+            const Buffer& data = cacheRead->Data;
+            if (!req->SetResult(data.Empty() ? nullptr : data.Data(), data.Size())) {
+                req->Status = IOStatus::RequestEntityTooLarge;
+                req->ErrorDesc = "Destination buffer too small";
+            }
+        }
+        else {
+            req->Data = std::move(cacheRead->Data);
+        }
     }
+    this->setHandled(req);
 }
 
 } // namespace Oryol
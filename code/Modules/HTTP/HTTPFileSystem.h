@@ -9,11 +9,30 @@
     @brief implements a simple HTTP-based filesystem
     @see HTTPClient, FileSystem
     
+    The HTTPFileSystem uses the platform's HTTP stack. With libcurl,
+    all IO lanes share one curl multi handle, so that many transfers
+    run concurrently on few pooled keep-alive connections, the
+    number of connections can be limited with SetConnectionLimits().
+
+    With SetupCache(), responses are stored in a persistent cache in
+    a local directory. Fresh cache entries are served without request,
+    stale entries are revalidated with If-None-Match/If-Modified-Since
+    and served from the cache on '304 Not Modified'. Only complete
+    reads (no byte range, no decompression) go through the cache.
+
+    Request timeouts, retries of failed requests and hedging of slow
+    requests are configured with SetRetryPolicy() (see HTTPRetryPolicy).
+    
     @todo: HTTPFileSystem description
 */
 #include "IO/FS/FileSystem.h"
 #include "Core/Creator.h"
+#include "Core/Containers/Array.h"
 #include "HTTP/urlLoader.h"
+#include "HTTP/HTTPCacheStats.h"
+#include "HTTP/HTTPRetryPolicy.h"
+#include "HTTP/HTTPRetryStats.h"
+#include "HTTP/base/httpCache.h"
 
 namespace Oryol {
     
@@ -21,11 +40,40 @@ class HTTPFileSystem : public FileSystem {
     OryolClassDecl(HTTPFileSystem);
     OryolClassCreator(HTTPFileSystem);
 public:
+    /// constructor
+    HTTPFileSystem();
+    /// destructor
+    virtual ~HTTPFileSystem();
+
+    /// set max number of connections per host and in total (can be called at any time)
+    static void SetConnectionLimits(int maxConnectionsPerHost, int maxConnections);
+    /// set request timeouts, retries and hedging (can be called at any time)
+    static void SetRetryPolicy(const HTTPRetryPolicy& policy);
+    /// query retry and hedging statistics
+    static HTTPRetryStats QueryRetryStats();
+    /// enable the persistent response cache in an existing local directory (call before IO::Setup())
+    static void SetupCache(const String& dir, int64_t budget);
+    /// disable the persistent response cache (call after IO::Discard())
+    static void DiscardCache();
+    /// query response cache statistics
+    static HTTPCacheStats QueryCacheStats();
+
     /// called when IO message should be handled
     virtual void onMsg(const Ptr<IORequest>& ioReq) override;
+    /// called on the IO lane thread while requests are in flight
+    virtual bool update() override;
+    /// called on the IO lane thread, wait until requests make progress
+    virtual bool wait(Duration timeout) override;
+    /// called on the main thread to end a wait()
+    virtual void wakeup() override;
 
 private:
+    /// finish a request which went through the cache
+    void finishCacheRead(const Ptr<_priv::httpCacheRead>& cacheRead);
+
     _priv::urlLoader loader;
+    _priv::httpCache* cache;
+    Array<Ptr<_priv::httpCacheRead>> cacheReads;
 };
     
 } // namespace Oryol
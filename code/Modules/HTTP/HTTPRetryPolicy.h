@@ -0,0 +1,51 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::HTTPRetryPolicy
+    @ingroup HTTP
+    @brief timeouts, retries and request hedging of HTTP reads
+
+    Each IORead gets a total time budget (Timeout), a single attempt
+    is abandoned after AttemptTimeout. Failed attempts (connection
+    errors, timeouts and the responses 408, 429, 500, 502, 503 and
+    504) are retried up to MaxRetries times after a jittered
+    exponential backoff, as long as the time budget allows it.
+
+    With hedging enabled, a duplicate request is started when no
+    response has arrived after the HedgePercentile response latency
+    of recent requests (but at least HedgeMinDelay), the first
+    response wins and the other request is aborted. Hedging starts
+    once enough response latencies have been measured.
+
+    Only used by the libcurl URL loader, other platforms only
+    apply the Timeout.
+
+    @see HTTPFileSystem::SetRetryPolicy(), HTTPRetryStats
+*/
+#include "Core/Time/Duration.h"
+
+namespace Oryol {
+
+class HTTPRetryPolicy {
+public:
+    /// total time budget of a request, including all retries
+    Duration Timeout = Duration::FromSeconds(30.0);
+    /// max duration of a single attempt
+    Duration AttemptTimeout = Duration::FromSeconds(10.0);
+    /// max duration to establish a connection
+    Duration ConnectTimeout = Duration::FromSeconds(5.0);
+    /// max number of retries of a failed request
+    int MaxRetries = 3;
+    /// backoff delay before the first retry, doubled with each retry
+    Duration RetryBaseDelay = Duration::FromMilliSeconds(100.0);
+    /// max backoff delay before a retry
+    Duration RetryMaxDelay = Duration::FromSeconds(2.0);
+    /// start a duplicate request if a response takes unusually long
+    bool HedgingEnabled = false;
+    /// the response latency percentile after which a request is hedged
+    int HedgePercentile = 95;
+    /// min delay before a request is hedged
+    Duration HedgeMinDelay = Duration::FromMilliSeconds(50.0);
+};
+
+} // namespace Oryol
@@ -0,0 +1,28 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::HTTPRetryStats
+    @ingroup HTTP
+    @brief retry and hedging statistics of HTTP reads
+
+    @see HTTPFileSystem::SetRetryPolicy(), HTTPFileSystem::QueryRetryStats()
+*/
+#include "Core/Time/Duration.h"
+
+namespace Oryol {
+
+class HTTPRetryStats {
+public:
+    /// number of retried attempts
+    int NumRetries = 0;
+    /// number of attempts which were abandoned after a timeout
+    int NumTimeouts = 0;
+    /// number of hedged requests
+    int NumHedges = 0;
+    /// number of hedged requests which won over the original request
+    int NumHedgesWon = 0;
+    /// the current delay after which requests are hedged
+    Duration HedgeDelay;
+};
+
+} // namespace Oryol
@@ -0,0 +1,198 @@
+//------------------------------------------------------------------------------
+//  HTTPCacheTest.cc
+//  Test the persistent HTTP response cache against a local HTTP server.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Core.h"
+#include "Core/RunLoop.h"
+#include "Core/String/StringBuilder.h"
+#include "HTTP/HTTPFileSystem.h"
+#include "IO/IO.h"
+
+#if ORYOL_USE_LIBCURL && ORYOL_POSIX
+#include "testHTTPServer.h"
+#include <dirent.h>
+
+using namespace Oryol;
+
+// create an empty temporary cache directory
+static String
+makeCacheDir() {
+    char path[] = "/tmp/oryol_http_cache_XXXXXX";
+    return String(mkdtemp(path));
+}
+
+// remove the cache directory and its files
+static void
+removeCacheDir(const String& dir) {
+    DIR* d = opendir(dir.AsCStr());
+    if (d) {
+        struct dirent* ent;
+        while (nullptr != (ent = readdir(d))) {
+            if ('.' != ent->d_name[0]) {
+                StringBuilder strBuilder;
+                strBuilder.Format(1024, "%s/%s", dir.AsCStr(), ent->d_name);
+                unlink(strBuilder.AsCStr());
+            }
+        }
+        closedir(d);
+    }
+    rmdir(dir.AsCStr());
+}
+
+static void
+setupIO(const String& cacheDir, int64_t budget) {
+    Core::Setup();
+    HTTPFileSystem::SetupCache(cacheDir, budget);
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("http", HTTPFileSystem::Creator());
+    IO::Setup(ioSetup);
+}
+
+static void
+discardIO() {
+    IO::Discard();
+    Core::Discard();
+    HTTPFileSystem::DiscardCache();
+}
+
+// load file '/N' and check the content for a server version
+static bool
+load(const testHTTPServer& server, int index, int version) {
+    StringBuilder strBuilder;
+    strBuilder.Format(128, "http://127.0.0.1:%d/%d", server.Port, index);
+    Ptr<IORead> req = IO::LoadFile(strBuilder.GetString());
+    while (!req->Handled) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bool ok = (IOStatus::OK == req->Status) && (req->Data.Size() == server.FileSize);
+    for (int i = 0; ok && (i < server.FileSize); i++) {
+        ok = req->Data.Data()[i] == uint8_t(index + version + i);
+    }
+    return ok;
+}
+
+TEST(HTTPCacheRevalidateTest) {
+    const String cacheDir = makeCacheDir();
+    testHTTPServer server;
+    server.CacheControl = "no-cache";
+    server.start();
+    setupIO(cacheDir, 1024 * 1024);
+
+    // the first load downloads and stores the response
+    CHECK(load(server, 1, 0));
+    HTTPCacheStats stats = HTTPFileSystem::QueryCacheStats();
+    CHECK(stats.NumMisses == 1);
+    CHECK(stats.NumWrites == 1);
+    CHECK(stats.NumEntries == 1);
+    CHECK(stats.NumBytes == 1024);
+
+    // 'no-cache' responses are revalidated, and served from the cache on 304
+    CHECK(load(server, 1, 0));
+    stats = HTTPFileSystem::QueryCacheStats();
+    CHECK(stats.NumRevalidated == 1);
+    CHECK(stats.NumMisses == 1);
+    CHECK(server.NumNotModified == 1);
+    CHECK(server.NumRequests == 2);
+
+    // a changed resource is downloaded again
+    server.Version = 1;
+    CHECK(load(server, 1, 1));
+    stats = HTTPFileSystem::QueryCacheStats();
+    CHECK(stats.NumMisses == 2);
+    CHECK(stats.NumWrites == 2);
+    CHECK(stats.NumEntries == 1);
+    CHECK(server.NumNotModified == 1);
+
+    // the cache persists across IO sessions
+    discardIO();
+    setupIO(cacheDir, 1024 * 1024);
+    CHECK(load(server, 1, 1));
+    stats = HTTPFileSystem::QueryCacheStats();
+    CHECK(stats.NumEntries == 1);
+    CHECK(stats.NumRevalidated == 1);
+    CHECK(server.NumNotModified == 2);
+
+    discardIO();
+    server.stop();
+    removeCacheDir(cacheDir);
+}
+
+TEST(HTTPCacheFreshTest) {
+    const String cacheDir = makeCacheDir();
+    testHTTPServer server;
+    server.CacheControl = "max-age=3600";
+    server.start();
+    setupIO(cacheDir, 1024 * 1024);
+
+    // fresh entries are served without request
+    CHECK(load(server, 2, 0));
+    CHECK(load(server, 2, 0));
+    HTTPCacheStats stats = HTTPFileSystem::QueryCacheStats();
+    CHECK(stats.NumHits == 1);
+    CHECK(stats.NumMisses == 1);
+    CHECK(server.NumRequests == 1);
+
+    // ...also after a restart
+    discardIO();
+    setupIO(cacheDir, 1024 * 1024);
+    CHECK(load(server, 2, 0));
+    CHECK(HTTPFileSystem::QueryCacheStats().NumHits == 1);
+    CHECK(server.NumRequests == 1);
+
+    discardIO();
+    server.stop();
+    removeCacheDir(cacheDir);
+}
+
+TEST(HTTPCacheBudgetTest) {
+    const String cacheDir = makeCacheDir();
+    testHTTPServer server;
+    server.CacheControl = "max-age=3600";
+    server.start();
+    setupIO(cacheDir, 4 * 1024);
+
+    // the least recently used entries are evicted
+    for (int i = 0; i < 4; i++) {
+        CHECK(load(server, i, 0));
+    }
+    CHECK(load(server, 0, 0));
+    CHECK(load(server, 4, 0));
+    HTTPCacheStats stats = HTTPFileSystem::QueryCacheStats();
+    CHECK(stats.NumEntries == 4);
+    CHECK(stats.NumBytes == 4 * 1024);
+    CHECK(stats.NumEvictions == 1);
+    CHECK(server.NumRequests == 5);
+    // file 0 was used recently and is still cached, file 1 was evicted
+    CHECK(load(server, 0, 0));
+    CHECK(server.NumRequests == 5);
+    CHECK(load(server, 1, 0));
+    CHECK(server.NumRequests == 6);
+
+    // responses which must not be stored, and byte ranges bypass the cache
+    server.CacheControl = "no-store";
+    CHECK(load(server, 10, 0));
+    stats = HTTPFileSystem::QueryCacheStats();
+    CHECK(stats.NumMisses == 7);
+    CHECK(stats.NumWrites == 6);
+    StringBuilder strBuilder;
+    strBuilder.Format(128, "http://127.0.0.1:%d/0", server.Port);
+    Ptr<IORead> req = IORead::Create();
+    req->Url = strBuilder.GetString();
+    req->StartOffset = 16;
+    IO::Put(req);
+    while (!req->Handled) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(req->Status == IOStatus::OK);
+    CHECK(req->Data.Size() == 1024 - 16);
+    CHECK(server.NumRequests == 8);
+
+    discardIO();
+    server.stop();
+    removeCacheDir(cacheDir);
+}
+#endif
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+//  HTTPRangeTest.cc
+//  Test byte range reads from a local HTTP server.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Core.h"
+#include "Core/RunLoop.h"
+#include "Core/String/StringBuilder.h"
+#include "HTTP/HTTPFileSystem.h"
+#include "IO/IO.h"
+
+#if ORYOL_USE_LIBCURL && ORYOL_POSIX
+#include "testHTTPServer.h"
+
+using namespace Oryol;
+
+// read a byte range of file '/7', and wait for the result
+static Ptr<IORead>
+read(const testHTTPServer& server, int64_t startOffset, int64_t endOffset, uint8_t* dest=nullptr, int destCapacity=0) {
+    StringBuilder strBuilder;
+    strBuilder.Format(128, "http://127.0.0.1:%d/7", server.Port);
+    auto req = IORead::Create();
+    req->Url = strBuilder.GetString();
+    req->StartOffset = startOffset;
+    req->EndOffset = endOffset;
+    req->DestPtr = dest;
+    req->DestCapacity = destCapacity;
+    IO::Put(req);
+    while (!req->Handled) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return req;
+}
+
+// check that the result contains the bytes from startOffset of file '/7'
+static bool
+checkResult(const Ptr<IORead>& req, int64_t startOffset, int size) {
+    if ((IOStatus::OK != req->Status) || (req->ResultSize() != size)) {
+        return false;
+    }
+    for (int i = 0; i < size; i++) {
+        if (req->ResultData()[i] != uint8_t(7 + startOffset + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void
+testRanges(testHTTPServer& server) {
+    // the complete file
+    CHECK(checkResult(read(server, 0, EndOfFile), 0, 1024));
+    // a range in the middle
+    CHECK(checkResult(read(server, 100, 200), 100, 100));
+    // from an offset to the end of file
+    CHECK(checkResult(read(server, 1000, EndOfFile), 1000, 24));
+    // ranges past the end of file are clamped
+    CHECK(checkResult(read(server, 1000, 2000), 1000, 24));
+    // an empty range
+    CHECK(checkResult(read(server, 10, 10), 10, 0));
+    // a range starting at the end of file is empty
+    CHECK(checkResult(read(server, 1024, EndOfFile), 1024, 0));
+    // ranges starting past the end of file fail
+    CHECK(read(server, 2000, EndOfFile)->Status == IOStatus::RequestedRangeNotSatisfiable);
+    // invalid ranges fail
+    CHECK(read(server, 200, 100)->Status == IOStatus::RequestedRangeNotSatisfiable);
+    CHECK(read(server, -1, 100)->Status == IOStatus::RequestedRangeNotSatisfiable);
+
+    // ranges into caller-owned memory only need room for the range
+    uint8_t dest[64];
+    CHECK(checkResult(read(server, 500, 564, dest, sizeof(dest)), 500, 64));
+    CHECK(read(server, 500, 600, dest, sizeof(dest))->Status == IOStatus::RequestEntityTooLarge);
+}
+
+TEST(HTTPRangeTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("http", HTTPFileSystem::Creator());
+    IO::Setup(ioSetup);
+
+    // a server which supports range requests
+    testHTTPServer server;
+    server.start();
+    testRanges(server);
+    CHECK(server.NumRangeRequests > 0);
+    server.stop();
+
+    // a server which ignores the Range header and always sends the complete file
+    testHTTPServer ignoringServer;
+    ignoringServer.IgnoreRanges = true;
+    ignoringServer.start();
+    testRanges(ignoringServer);
+    CHECK(ignoringServer.NumRangeRequests == 0);
+
+    IO::Discard();
+    Core::Discard();
+    ignoringServer.stop();
+}
+#endif
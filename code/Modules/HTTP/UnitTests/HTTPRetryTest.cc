@@ -0,0 +1,166 @@
+//------------------------------------------------------------------------------
+//  HTTPRetryTest.cc
+//  Test timeouts, retries and hedging against a local HTTP server which
+//  injects failures and delays.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Core.h"
+#include "Core/RunLoop.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/StringBuilder.h"
+#include "HTTP/HTTPFileSystem.h"
+#include "IO/IO.h"
+
+#if ORYOL_USE_LIBCURL && ORYOL_POSIX
+#include "testHTTPServer.h"
+
+using namespace Oryol;
+
+static void
+setupIO(const HTTPRetryPolicy& policy) {
+    Core::Setup();
+    HTTPFileSystem::SetRetryPolicy(policy);
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("http", HTTPFileSystem::Creator());
+    IO::Setup(ioSetup);
+}
+
+static void
+discardIO() {
+    IO::Discard();
+    Core::Discard();
+    HTTPFileSystem::SetRetryPolicy(HTTPRetryPolicy());
+}
+
+// load file '/N', return the request after it has been handled
+static Ptr<IORead>
+load(const testHTTPServer& server, int index) {
+    StringBuilder strBuilder;
+    strBuilder.Format(128, "http://127.0.0.1:%d/%d", server.Port, index);
+    Ptr<IORead> req = IO::LoadFile(strBuilder.GetString());
+    while (!req->Handled) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return req;
+}
+
+// check that a request has loaded the content of file '/N'
+static bool
+isValid(const testHTTPServer& server, const Ptr<IORead>& req, int index) {
+    bool ok = (IOStatus::OK == req->Status) && (req->Data.Size() == server.FileSize);
+    for (int i = 0; ok && (i < server.FileSize); i++) {
+        ok = req->Data.Data()[i] == uint8_t(index + i);
+    }
+    return ok;
+}
+
+TEST(HTTPRetryFailureTest) {
+    testHTTPServer server;
+    server.start();
+    HTTPRetryPolicy policy;
+    policy.MaxRetries = 3;
+    policy.RetryBaseDelay = Duration::FromMilliSeconds(10.0);
+    policy.RetryMaxDelay = Duration::FromMilliSeconds(40.0);
+    setupIO(policy);
+
+    // failed requests are retried
+    server.NumFailures = 2;
+    CHECK(isValid(server, load(server, 1), 1));
+    CHECK(server.NumRequests == 3);
+    CHECK(HTTPFileSystem::QueryRetryStats().NumRetries == 2);
+
+    // ...until the max number of retries is reached
+    server.NumFailures = 10;
+    Ptr<IORead> req = load(server, 2);
+    CHECK(req->Status == IOStatus::ServiceUnavailable);
+    CHECK(server.NumRequests == 7);
+    CHECK(HTTPFileSystem::QueryRetryStats().NumRetries == 5);
+
+    // client errors are not retried
+    server.NumFailures = 0;
+    StringBuilder strBuilder;
+    strBuilder.Format(128, "http://127.0.0.1:%d/3", server.Port);
+    Ptr<IORead> badReq = IORead::Create();
+    badReq->Url = strBuilder.GetString();
+    badReq->StartOffset = 2048;
+    badReq->EndOffset = 4096;
+    IO::Put(badReq);
+    while (!badReq->Handled) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(badReq->Status == IOStatus::RequestedRangeNotSatisfiable);
+    CHECK(server.NumRequests == 8);
+    CHECK(HTTPFileSystem::QueryRetryStats().NumRetries == 5);
+
+    discardIO();
+    server.stop();
+}
+
+TEST(HTTPRetryTimeoutTest) {
+    testHTTPServer server;
+    server.StallMs = 5000;
+    server.start();
+    HTTPRetryPolicy policy;
+    policy.AttemptTimeout = Duration::FromMilliSeconds(200.0);
+    policy.RetryBaseDelay = Duration::FromMilliSeconds(10.0);
+    setupIO(policy);
+
+    // a stalled attempt is abandoned and retried
+    server.NumStalls = 1;
+    TimePoint start = Clock::Now();
+    CHECK(isValid(server, load(server, 1), 1));
+    CHECK(Clock::Since(start).AsSeconds() < 2.0);
+    HTTPRetryStats stats = HTTPFileSystem::QueryRetryStats();
+    CHECK(stats.NumTimeouts == 1);
+    CHECK(stats.NumRetries == 1);
+    discardIO();
+
+    // the total time budget limits the retries
+    policy.Timeout = Duration::FromMilliSeconds(500.0);
+    setupIO(policy);
+    server.NumStalls = 10;
+    start = Clock::Now();
+    Ptr<IORead> req = load(server, 2);
+    CHECK(req->Status == IOStatus::RequestTimeout);
+    CHECK(Clock::Since(start).AsSeconds() < 2.0);
+    CHECK(HTTPFileSystem::QueryRetryStats().NumTimeouts >= 2);
+
+    discardIO();
+    server.stop();
+}
+
+TEST(HTTPHedgeTest) {
+    testHTTPServer server;
+    server.StallMs = 5000;
+    server.start();
+    HTTPRetryPolicy policy;
+    policy.HedgingEnabled = true;
+    policy.HedgeMinDelay = Duration::FromMilliSeconds(50.0);
+    setupIO(policy);
+
+    // measure the response latency, no hedges needed
+    for (int i = 0; i < 32; i++) {
+        CHECK(isValid(server, load(server, i), i));
+    }
+    HTTPRetryStats stats = HTTPFileSystem::QueryRetryStats();
+    CHECK(stats.NumHedges == 0);
+    CHECK(stats.HedgeDelay >= policy.HedgeMinDelay);
+
+    // a stalled request is hedged, and the hedge wins
+    server.NumStalls = 1;
+    TimePoint start = Clock::Now();
+    CHECK(isValid(server, load(server, 7), 7));
+    CHECK(Clock::Since(start).AsSeconds() < 2.0);
+    stats = HTTPFileSystem::QueryRetryStats();
+    CHECK(stats.NumHedges == 1);
+    CHECK(stats.NumHedgesWon == 1);
+    CHECK(stats.NumRetries == 0);
+    CHECK(server.NumRequests == 34);
+
+    discardIO();
+    server.stop();
+}
+#endif
@@ -0,0 +1,72 @@
+//------------------------------------------------------------------------------
+//  HTTPThroughputTest.cc
+//  Load many small files from a local HTTP server.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Core.h"
+#include "Core/RunLoop.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/StringBuilder.h"
+#include "HTTP/HTTPFileSystem.h"
+#include "IO/IO.h"
+
+#if ORYOL_USE_LIBCURL && ORYOL_POSIX
+#include "testHTTPServer.h"
+
+using namespace Oryol;
+
+static const int fileSize = 1024;
+
+// load numFiles files, return the number of correctly loaded files
+static int
+loadFiles(const testHTTPServer& server, int numFiles) {
+    Array<Ptr<IORead>> reqs;
+    for (int i = 0; i < numFiles; i++) {
+        StringBuilder strBuilder;
+        strBuilder.Format(128, "http://127.0.0.1:%d/%d", server.Port, i);
+        reqs.Add(IO::LoadFile(strBuilder.GetString()));
+    }
+    int numOk = 0;
+    for (int i = 0; i < numFiles; i++) {
+        while (!reqs[i]->Handled) {
+            Core::PreRunLoop()->Run();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        bool ok = (IOStatus::OK == reqs[i]->Status) && (reqs[i]->Data.Size() == fileSize);
+        for (int j = 0; ok && (j < fileSize); j++) {
+            ok = reqs[i]->Data.Data()[j] == uint8_t(i + j);
+        }
+        numOk += ok ? 1 : 0;
+    }
+    return numOk;
+}
+
+TEST(HTTPThroughputTest) {
+    const int numFiles = 512;
+    const int limits[] = { 1, 8 };
+    for (int maxPerHost : limits) {
+        testHTTPServer server;
+        server.start();
+        Core::Setup();
+        HTTPFileSystem::SetConnectionLimits(maxPerHost, 32);
+        IOSetup ioSetup;
+        ioSetup.FileSystems.Add("http", HTTPFileSystem::Creator());
+        IO::Setup(ioSetup);
+
+        TimePoint start = Clock::Now();
+        const int numOk = loadFiles(server, numFiles);
+        Duration dur = Clock::Since(start);
+        CHECK(numOk == numFiles);
+        // all IO lanes share the connections
+        CHECK(server.NumConnections <= maxPerHost);
+        Log::Info("HTTPThroughputTest: %d files of %d bytes, %d connection(s): %.3fms (%.0f files/sec)\n",
+            numFiles, fileSize, int(server.NumConnections), dur.AsMilliSeconds(), numFiles / dur.AsSeconds());
+
+        IO::Discard();
+        Core::Discard();
+        server.stop();
+    }
+    HTTPFileSystem::SetConnectionLimits(6, 32);
+}
+#endif
@@ -0,0 +1,195 @@
+#pragma once
+//------------------------------------------------------------------------------
+//  testHTTPServer.h
+//  A minimal HTTP/1.1 keep-alive server on the loopback interface for
+//  the HTTP module tests, serves 'FileSize' bytes for each path '/N',
+//  each byte is (N + Version + offset). Answers 'Range: bytes=a-b'
+//  requests with '206 Partial Content' unless IgnoreRanges is set.
+//  If CacheControl is set, responses carry an ETag (derived from
+//  Version) and the Cache-Control header, and conditional requests
+//  with a matching If-None-Match are answered with '304 Not Modified'.
+//  Failures and delays can be injected: the next NumFailures requests
+//  are answered with '503 Service Unavailable', the next NumStalls
+//  requests are answered after StallMs milliseconds.
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+class testHTTPServer {
+public:
+    // start listening on an ephemeral port
+    void start() {
+        this->listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(this->listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        bind(this->listenSocket, (sockaddr*)&addr, sizeof(addr));
+        listen(this->listenSocket, 64);
+        socklen_t addrLen = sizeof(addr);
+        getsockname(this->listenSocket, (sockaddr*)&addr, &addrLen);
+        this->Port = ntohs(addr.sin_port);
+        this->acceptThread = std::thread([this] { this->acceptLoop(); });
+    }
+    // stop the server, and wait until all connections are closed
+    void stop() {
+        this->stopRequested = true;
+        shutdown(this->listenSocket, SHUT_RDWR);
+        close(this->listenSocket);
+        this->acceptThread.join();
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (int s : this->sockets) {
+            shutdown(s, SHUT_RDWR);
+        }
+        for (auto& thread : this->connThreads) {
+            thread.join();
+        }
+    }
+    int Port = 0;
+    int FileSize = 1024;
+    bool IgnoreRanges = false;
+    const char* CacheControl = nullptr;
+    std::atomic<int> Version{0};
+    std::atomic<int> NumConnections{0};
+    std::atomic<int> NumRequests{0};
+    std::atomic<int> NumRangeRequests{0};
+    std::atomic<int> NumNotModified{0};
+    std::atomic<int> NumFailures{0};
+    std::atomic<int> NumStalls{0};
+    int StallMs = 0;
+
+private:
+    void acceptLoop() {
+        while (!this->stopRequested) {
+            int s = accept(this->listenSocket, nullptr, nullptr);
+            if (s < 0) {
+                break;
+            }
+            this->NumConnections++;
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->sockets.push_back(s);
+            this->connThreads.push_back(std::thread([this, s] { this->serve(s); }));
+        }
+    }
+    void serve(int s) {
+        char buf[4096];
+        int len = 0;
+        std::vector<char> response;
+        while (true) {
+            int n = int(recv(s, buf + len, sizeof(buf) - len - 1, 0));
+            if (n <= 0) {
+                break;
+            }
+            len += n;
+            buf[len] = 0;
+            char* end;
+            while (nullptr != (end = std::strstr(buf, "\r\n\r\n"))) {
+                // answer the request, and remove it from the buffer
+                *end = 0;
+                const int index = std::atoi(buf + 5);
+                this->NumRequests++;
+                if (this->NumStalls.fetch_sub(1) > 0) {
+                    this->stall();
+                }
+                this->respond(index, std::strstr(buf, "Range: bytes="), std::strstr(buf, "If-None-Match: "), response);
+                // NOTE: header and body must go out in a single send(),
+                // otherwise Nagle's algorithm delays the body
+                send(s, response.data(), response.size(), MSG_NOSIGNAL);
+                const int reqLen = int(end + 4 - buf);
+                std::memmove(buf, buf + reqLen, len - reqLen + 1);
+                len -= reqLen;
+            }
+        }
+        close(s);
+    }
+    // wait StallMs milliseconds, or until the server is stopped
+    void stall() {
+        for (int i = 0; (i < this->StallMs) && !this->stopRequested; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    void respond(int index, const char* range, const char* ifNoneMatch, std::vector<char>& response) {
+        if (this->NumFailures.fetch_sub(1) > 0) {
+            static const char failure[] = "HTTP/1.1 503 Service Unavailable\r\n"
+                "Content-Length: 0\r\nConnection: keep-alive\r\n\r\n";
+            response.assign(failure, failure + sizeof(failure) - 1);
+            return;
+        }
+        const int version = this->Version;
+        char cacheHeaders[128] = { };
+        if (this->CacheControl) {
+            char etag[32];
+            std::snprintf(etag, sizeof(etag), "\"v%d-%d\"", version, index);
+            if (ifNoneMatch && (0 == std::strncmp(ifNoneMatch + 15, etag, std::strlen(etag)))) {
+                this->NumNotModified++;
+                char header[256];
+                const int headerLen = std::snprintf(header, sizeof(header),
+                    "HTTP/1.1 304 Not Modified\r\nETag: %s\r\nCache-Control: %s\r\n"
+                    "Connection: keep-alive\r\n\r\n", etag, this->CacheControl);
+                response.assign(header, header + headerLen);
+                return;
+            }
+            std::snprintf(cacheHeaders, sizeof(cacheHeaders), "ETag: %s\r\nCache-Control: %s\r\n", etag, this->CacheControl);
+        }
+        int first = 0;
+        int last = this->FileSize - 1;
+        bool partial = false;
+        if (range && !this->IgnoreRanges) {
+            this->NumRangeRequests++;
+            const char* ptr = range + 13;
+            first = std::atoi(ptr);
+            const char* dash = std::strchr(ptr, '-');
+            if (dash && (dash[1] >= '0') && (dash[1] <= '9')) {
+                last = std::atoi(dash + 1);
+            }
+            if (last > this->FileSize - 1) {
+                last = this->FileSize - 1;
+            }
+            partial = true;
+        }
+        char header[256];
+        int headerLen = 0;
+        if (partial && (first >= this->FileSize)) {
+            headerLen = std::snprintf(header, sizeof(header),
+                "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */%d\r\n"
+                "Content-Length: 0\r\nConnection: keep-alive\r\n\r\n", this->FileSize);
+            first = 0;
+            last = -1;
+        }
+        else if (partial) {
+            headerLen = std::snprintf(header, sizeof(header),
+                "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes %d-%d/%d\r\n"
+                "Content-Length: %d\r\n%sConnection: keep-alive\r\n\r\n",
+                first, last, this->FileSize, last - first + 1, cacheHeaders);
+        }
+        else {
+            headerLen = std::snprintf(header, sizeof(header),
+                "HTTP/1.1 200 OK\r\nContent-Length: %d\r\n%sConnection: keep-alive\r\n\r\n",
+                this->FileSize, cacheHeaders);
+        }
+        response.assign(header, header + headerLen);
+        for (int i = first; i <= last; i++) {
+            response.push_back(char(index + version + i));
+        }
+    }
+
+    int listenSocket = -1;
+    std::atomic<bool> stopRequested{false};
+    std::thread acceptThread;
+    std::mutex mutex;
+    std::vector<int> sockets;
+    std::vector<std::thread> connThreads;
+};
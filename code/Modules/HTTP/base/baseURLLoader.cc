@@ -7,6 +7,12 @@
 namespace Oryol {
 namespace _priv {
 
+std::mutex baseURLLoader::settingsMutex;
+std::atomic<int> baseURLLoader::curSettingsVersion(0);
+int baseURLLoader::maxConnectionsPerHost = 6;
+int baseURLLoader::maxConnections = 32;
+HTTPRetryPolicy baseURLLoader::curRetryPolicy;
+
 //------------------------------------------------------------------------------
 bool
 baseURLLoader::doRequest(const Ptr<IORead>& ioReq) {
@@ -22,5 +28,74 @@ baseURLLoader::doRequest(const Ptr<IORead>& ioReq) {
     }
 }
 
+//------------------------------------------------------------------------------
+bool
+baseURLLoader::update() {
+    // synchronous loaders have no requests in flight
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool
+baseURLLoader::wait(Duration timeout) {
+    // synchronous loaders have nothing to wait for
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+baseURLLoader::wakeup() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+baseURLLoader::setConnectionLimits(int maxPerHost, int maxTotal) {
+    o_assert((maxPerHost > 0) && (maxTotal >= maxPerHost));
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    maxConnectionsPerHost = maxPerHost;
+    maxConnections = maxTotal;
+    curSettingsVersion++;
+}
+
+//------------------------------------------------------------------------------
+void
+baseURLLoader::connectionLimits(int& outMaxPerHost, int& outMaxTotal) {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    outMaxPerHost = maxConnectionsPerHost;
+    outMaxTotal = maxConnections;
+}
+
+//------------------------------------------------------------------------------
+void
+baseURLLoader::setRetryPolicy(const HTTPRetryPolicy& policy) {
+    o_assert(policy.Timeout.AsTicks() > 0);
+    o_assert(policy.AttemptTimeout.AsTicks() > 0);
+    o_assert(policy.MaxRetries >= 0);
+    o_assert((policy.HedgePercentile > 0) && (policy.HedgePercentile <= 100));
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    curRetryPolicy = policy;
+    curSettingsVersion++;
+}
+
+//------------------------------------------------------------------------------
+HTTPRetryPolicy
+baseURLLoader::retryPolicy() {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    return curRetryPolicy;
+}
+
+//------------------------------------------------------------------------------
+int
+baseURLLoader::settingsVersion() {
+    return curSettingsVersion;
+}
+
+//------------------------------------------------------------------------------
+HTTPRetryStats
+baseURLLoader::retryStats() {
+    return HTTPRetryStats();
+}
+
 } // namespace _priv
 } // namespace Oryol
\ No newline at end of file
@@ -7,6 +7,11 @@
     @see urlLoader, HTTPClient
 */
 #include "IO/FS/ioRequests.h"
+#include "HTTP/HTTPRetryPolicy.h"
+#include "HTTP/HTTPRetryStats.h"
+#include "Core/Time/Duration.h"
+#include <atomic>
+#include <mutex>
 
 namespace Oryol {
 namespace _priv {
@@ -15,6 +20,34 @@ class baseURLLoader {
 public:
     /// process one HTTPRequest
     bool doRequest(const Ptr<IORead>& ioRequest);
+    /// finish asynchronous requests, return true if requests are in flight
+    bool update();
+    /// wait on the IO lane thread until requests make progress, return false if not supported
+    bool wait(Duration timeout);
+    /// wake up a lane which waits in wait(), may be called from any thread
+    void wakeup();
+
+    /// set the connection limits (only used by loaders which manage their own connections)
+    static void setConnectionLimits(int maxConnectionsPerHost, int maxConnections);
+    /// get the connection limits
+    static void connectionLimits(int& outMaxConnectionsPerHost, int& outMaxConnections);
+    /// set the timeouts, retry and hedging policy
+    static void setRetryPolicy(const HTTPRetryPolicy& policy);
+    /// get a copy of the timeouts, retry and hedging policy
+    static HTTPRetryPolicy retryPolicy();
+    /// get the settings version, changes when the connection limits or retry policy change
+    static int settingsVersion();
+    /// get retry statistics (only loaders which implement retries have stats)
+    static HTTPRetryStats retryStats();
+
+private:
+    // NOTE: the settings are written on the main thread and read on
+    // the IO threads, so they are guarded by a mutex
+    static std::mutex settingsMutex;
+    static std::atomic<int> curSettingsVersion;
+    static int maxConnectionsPerHost;
+    static int maxConnections;
+    static HTTPRetryPolicy curRetryPolicy;
 };
 } // namespace _priv
 } // namespace Oryol
\ No newline at end of file
@@ -0,0 +1,540 @@
+//------------------------------------------------------------------------------
+//  httpCache.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "httpCache.h"
+#include "Core/String/StringBuilder.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <ctime>
+
+namespace Oryol {
+namespace _priv {
+
+#if ORYOL_HAS_THREADS
+std::mutex httpCache::instanceMutex;
+#define LOCK_INSTANCE() std::lock_guard<std::mutex> lock(instanceMutex)
+#define LOCK_CACHE() std::lock_guard<std::mutex> lock(this->mutex)
+#else
+#define LOCK_INSTANCE()
+#define LOCK_CACHE()
+#endif
+httpCache* httpCache::instance = nullptr;
+int httpCache::instanceRefCount = 0;
+String httpCache::cacheDir;
+int64_t httpCache::cacheBudget = 0;
+
+static const char* entryMagic = "ORYHTTP1";
+static const char* indexMagic = "ORYHTTPINDEX1";
+
+//------------------------------------------------------------------------------
+/// compare a header line's name case-insensitively, return pointer to the trimmed value
+static const char*
+headerValue(const char* line, int len, const char* name, int& outValueLen) {
+    const int nameLen = int(std::strlen(name));
+    if ((len <= nameLen) || (':' != line[nameLen])) {
+        return nullptr;
+    }
+    for (int i = 0; i < nameLen; i++) {
+        if (std::tolower(line[i]) != name[i]) {
+            return nullptr;
+        }
+    }
+    const char* start = line + nameLen + 1;
+    const char* end = line + len;
+    while ((start < end) && ((' ' == *start) || ('\t' == *start))) {
+        start++;
+    }
+    while ((end > start) && std::isspace(end[-1])) {
+        end--;
+    }
+    outValueLen = int(end - start);
+    return start;
+}
+
+//------------------------------------------------------------------------------
+/// assign a string which may be empty
+static void
+assignString(String& str, const char* ptr, int len) {
+    if (len > 0) {
+        str.Assign(ptr, 0, len);
+    }
+    else {
+        str.Clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+httpCacheRead::parseHeader(const char* line, int len) {
+    // a new status line starts the headers of another response (e.g. after a redirect)
+    if ((len > 5) && (0 == std::strncmp(line, "HTTP/", 5))) {
+        this->ETag.Clear();
+        this->LastModified.Clear();
+        this->CacheControl.Clear();
+        return;
+    }
+    int valueLen = 0;
+    const char* value = nullptr;
+    if ((value = headerValue(line, len, "etag", valueLen))) {
+        assignString(this->ETag, value, valueLen);
+    }
+    else if ((value = headerValue(line, len, "last-modified", valueLen))) {
+        assignString(this->LastModified, value, valueLen);
+    }
+    else if ((value = headerValue(line, len, "cache-control", valueLen))) {
+        assignString(this->CacheControl, value, valueLen);
+    }
+}
+
+//------------------------------------------------------------------------------
+httpCache::httpCache() :
+budget(0),
+curTick(0),
+tmpCounter(0) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+httpCache::~httpCache() {
+    LOCK_CACHE();
+    this->writeIndex();
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::setup(const String& dir, int64_t budget) {
+    o_assert(budget >= 0);
+    LOCK_INSTANCE();
+    o_assert(nullptr == instance);
+    #if ORYOL_EMSCRIPTEN || ORYOL_PNACL
+    // the browser already caches and revalidates HTTP responses
+    if (!dir.Empty()) {
+        Log::Warn("httpCache: not supported on this platform, using the browser cache\n");
+    }
+    #else
+    cacheDir = dir;
+    cacheBudget = budget;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+httpCache*
+httpCache::acquire() {
+    LOCK_INSTANCE();
+    if (cacheDir.Empty()) {
+        return nullptr;
+    }
+    if (nullptr == instance) {
+        instance = Memory::New<httpCache>();
+        StringBuilder builder(cacheDir);
+        if (('/' != cacheDir.Back()) && ('\\' != cacheDir.Back())) {
+            builder.Append('/');
+        }
+        instance->dir = builder.GetString();
+        builder.Append("index.http");
+        instance->indexPath = builder.GetString();
+        instance->budget = cacheBudget;
+        instance->curStats.Budget = cacheBudget;
+        instance->loadIndex();
+    }
+    instanceRefCount++;
+    return instance;
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::release() {
+    LOCK_INSTANCE();
+    o_assert(instanceRefCount > 0);
+    if (0 == --instanceRefCount) {
+        Memory::Delete(instance);
+        instance = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+HTTPCacheStats
+httpCache::stats() {
+    LOCK_INSTANCE();
+    if (instance) {
+        #if ORYOL_HAS_THREADS
+        std::lock_guard<std::mutex> cacheLock(instance->mutex);
+        #endif
+        return instance->curStats;
+    }
+    else {
+        HTTPCacheStats emptyStats;
+        emptyStats.Budget = cacheBudget;
+        return emptyStats;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+httpCache::isCacheable(const Ptr<IORead>& req) {
+    // only complete, uncompressed resources are cached
+    return (0 == req->StartOffset) && (EndOfFile == req->EndOffset) && !req->DecompressEnabled;
+}
+
+//------------------------------------------------------------------------------
+uint64_t
+httpCache::hashURL(const URL& url) {
+    // FNV-1a hash of the URL
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char* p = url.AsCStr(); *p; p++) {
+        hash ^= uint8_t(*p);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+String
+httpCache::entryPath(uint64_t hash) const {
+    StringBuilder builder;
+    builder.Format(4096, "%s%08x%08x.http", this->dir.AsCStr(), uint32_t(hash >> 32), uint32_t(hash));
+    return builder.GetString();
+}
+
+//------------------------------------------------------------------------------
+bool
+httpCache::lookup(httpCacheRead* req) {
+    const uint64_t hash = hashURL(req->Url);
+    {
+        LOCK_CACHE();
+        if (!this->entries.Contains(hash)) {
+            return false;
+        }
+    }
+    fileHeader header;
+    String etag, lastModified;
+    if (!this->readEntry(hash, req->Url, header, etag, lastModified, &req->CachedBody)) {
+        LOCK_CACHE();
+        this->removeEntry(hash);
+        return false;
+    }
+    const int64_t now = int64_t(std::time(nullptr));
+    if ((header.maxAge > 0) && (now >= header.storeTime) && (now < (header.storeTime + header.maxAge))) {
+        // a fresh entry, serve without request
+        req->Data = std::move(req->CachedBody);
+        req->Status = IOStatus::OK;
+        LOCK_CACHE();
+        this->touchEntry(hash);
+        this->curStats.NumHits++;
+        return true;
+    }
+    else {
+        // a stale entry, must be revalidated
+        req->IfNoneMatch = etag;
+        req->IfModifiedSince = lastModified;
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::finish(httpCacheRead* req) {
+    const uint64_t hash = hashURL(req->Url);
+    const int64_t now = int64_t(std::time(nullptr));
+    if ((IOStatus::NotModified == req->Status) &&
+        (!req->IfNoneMatch.Empty() || !req->IfModifiedSince.Empty())) {
+
+        // serve the cached body, and store the refreshed metadata
+        const String etag = req->ETag.Empty() ? req->IfNoneMatch : req->ETag;
+        const String lastModified = req->LastModified.Empty() ? req->IfModifiedSince : req->LastModified;
+        const int64_t age = maxAge(req->CacheControl);
+        req->Data = std::move(req->CachedBody);
+        req->Status = IOStatus::OK;
+        bool written = false;
+        if (age >= 0) {
+            // only the metadata has changed, unless the server sent new validators
+            if ((etag == req->IfNoneMatch) && (lastModified == req->IfModifiedSince)) {
+                written = this->refreshEntry(hash, now, age);
+            }
+            else {
+                const uint8_t* body = req->Data.Empty() ? nullptr : req->Data.Data();
+                written = this->writeEntry(hash, req->Url, now, age, etag, lastModified, body, req->Data.Size());
+            }
+        }
+        LOCK_CACHE();
+        if (written) {
+            this->touchEntry(hash);
+        }
+        else {
+            this->removeEntry(hash);
+        }
+        this->curStats.NumRevalidated++;
+    }
+    else if (IOStatus::OK == req->Status) {
+        req->CachedBody.Clear();
+        const int64_t age = maxAge(req->CacheControl);
+        const bool hasValidator = !req->ETag.Empty() || !req->LastModified.Empty();
+        const int64_t size = req->Data.Size();
+        bool stored = false;
+        if ((age >= 0) && (hasValidator || (age > 0)) && (size <= this->budget)) {
+            const uint8_t* body = req->Data.Empty() ? nullptr : req->Data.Data();
+            stored = this->writeEntry(hash, req->Url, now, age, req->ETag, req->LastModified, body, size);
+        }
+        LOCK_CACHE();
+        if (stored) {
+            this->addEntry(hash, size);
+            this->curStats.NumWrites++;
+        }
+        else if (this->entries.Contains(hash)) {
+            // the new response isn't cacheable, drop the old entry
+            this->removeEntry(hash);
+        }
+        this->curStats.NumMisses++;
+    }
+    else {
+        req->CachedBody.Clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+int64_t
+httpCache::maxAge(const String& cacheControl) {
+    // looking for 'no-store', 'no-cache' and 'max-age=N'
+    int64_t age = 0;
+    const char* ptr = cacheControl.AsCStr();
+    while (*ptr) {
+        while (*ptr && ((' ' == *ptr) || (',' == *ptr))) {
+            ptr++;
+        }
+        const char* token = ptr;
+        while (*ptr && (',' != *ptr)) {
+            ptr++;
+        }
+        const int len = int(ptr - token);
+        if ((len >= 8) && (0 == std::strncmp(token, "no-store", 8))) {
+            return -1;
+        }
+        else if ((len >= 8) && (0 == std::strncmp(token, "no-cache", 8))) {
+            return 0;
+        }
+        else if ((len > 8) && (0 == std::strncmp(token, "max-age=", 8))) {
+            age = std::strtoll(token + 8, nullptr, 10);
+        }
+    }
+    return age > 0 ? age : 0;
+}
+
+//------------------------------------------------------------------------------
+bool
+httpCache::readEntry(uint64_t hash, const URL& url, fileHeader& outHeader, String& outETag, String& outLastModified, Buffer* outBody) const {
+    const String path = this->entryPath(hash);
+    FILE* fp = std::fopen(path.AsCStr(), "rb");
+    if (nullptr == fp) {
+        return false;
+    }
+    bool ok = (1 == std::fread(&outHeader, sizeof(outHeader), 1, fp)) &&
+              (0 == std::memcmp(outHeader.magic, entryMagic, sizeof(outHeader.magic))) &&
+              (outHeader.urlLength < 0x10000) &&
+              (outHeader.etagLength < 0x10000) &&
+              (outHeader.lastModifiedLength < 0x10000) &&
+              (outHeader.bodySize >= 0) && (outHeader.bodySize <= Buffer::MaxSize);
+    if (ok) {
+        const int stringsLength = int(outHeader.urlLength + outHeader.etagLength + outHeader.lastModifiedLength);
+        Buffer strings;
+        char* ptr = (char*) strings.Add(stringsLength + 1);
+        ok = (stringsLength == int(std::fread(ptr, 1, stringsLength, fp))) &&
+             (int(outHeader.urlLength) == url.Get().Length()) &&
+             (0 == std::memcmp(ptr, url.AsCStr(), outHeader.urlLength));
+        if (ok) {
+            assignString(outETag, ptr + outHeader.urlLength, outHeader.etagLength);
+            assignString(outLastModified, ptr + outHeader.urlLength + outHeader.etagLength, outHeader.lastModifiedLength);
+        }
+    }
+    if (ok && outBody) {
+        const int bodySize = int(outHeader.bodySize);
+        outBody->Clear();
+        if (bodySize > 0) {
+            uint8_t* dst = outBody->Add(bodySize);
+            ok = (bodySize == int(std::fread(dst, 1, bodySize, fp)));
+        }
+    }
+    std::fclose(fp);
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+bool
+httpCache::writeEntry(uint64_t hash, const URL& url, int64_t storeTime, int64_t maxAge, const String& etag, const String& lastModified, const uint8_t* body, int64_t bodySize) {
+    // write to a temporary file first, so that concurrent readers
+    // never see a partially written entry
+    uint32_t tmpIndex = 0;
+    {
+        LOCK_CACHE();
+        tmpIndex = this->tmpCounter++;
+    }
+    StringBuilder builder;
+    builder.Format(4096, "%s%08x%08x.%u.tmp", this->dir.AsCStr(), uint32_t(hash >> 32), uint32_t(hash), tmpIndex);
+    const String tmpPath = builder.GetString();
+    FILE* fp = std::fopen(tmpPath.AsCStr(), "wb");
+    if (nullptr == fp) {
+        Log::Warn("httpCache: failed to write '%s'\n", tmpPath.AsCStr());
+        return false;
+    }
+    fileHeader header;
+    Memory::Clear(&header, sizeof(header));
+    Memory::Copy(entryMagic, header.magic, sizeof(header.magic));
+    header.storeTime = storeTime;
+    header.maxAge = maxAge;
+    header.bodySize = bodySize;
+    header.urlLength = uint32_t(url.Get().Length());
+    header.etagLength = uint32_t(etag.Length());
+    header.lastModifiedLength = uint32_t(lastModified.Length());
+    bool ok = (1 == std::fwrite(&header, sizeof(header), 1, fp)) &&
+              (header.urlLength == std::fwrite(url.AsCStr(), 1, header.urlLength, fp)) &&
+              (header.etagLength == std::fwrite(etag.AsCStr(), 1, header.etagLength, fp)) &&
+              (header.lastModifiedLength == std::fwrite(lastModified.AsCStr(), 1, header.lastModifiedLength, fp));
+    if (ok && (bodySize > 0)) {
+        ok = (size_t(bodySize) == std::fwrite(body, 1, size_t(bodySize), fp));
+    }
+    ok &= (0 == std::fclose(fp));
+    if (ok) {
+        LOCK_CACHE();
+        const String path = this->entryPath(hash);
+        std::remove(path.AsCStr());
+        ok = (0 == std::rename(tmpPath.AsCStr(), path.AsCStr()));
+    }
+    if (!ok) {
+        std::remove(tmpPath.AsCStr());
+    }
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+bool
+httpCache::refreshEntry(uint64_t hash, int64_t storeTime, int64_t maxAge) {
+    const String path = this->entryPath(hash);
+    FILE* fp = std::fopen(path.AsCStr(), "r+b");
+    if (nullptr == fp) {
+        return false;
+    }
+    fileHeader header;
+    bool ok = (1 == std::fread(&header, sizeof(header), 1, fp)) &&
+              (0 == std::memcmp(header.magic, entryMagic, sizeof(header.magic)));
+    if (ok) {
+        header.storeTime = storeTime;
+        header.maxAge = maxAge;
+        ok = (0 == std::fseek(fp, 0, SEEK_SET)) && (1 == std::fwrite(&header, sizeof(header), 1, fp));
+    }
+    ok &= (0 == std::fclose(fp));
+    return ok;
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::addEntry(uint64_t hash, int64_t size) {
+    if (this->entries.Contains(hash)) {
+        this->curStats.NumBytes -= this->entries[hash].size;
+        this->curStats.NumEntries--;
+        this->entries.Erase(hash);
+    }
+    // evict least recently used entries until the new entry fits
+    while (!this->entries.Empty() && ((this->curStats.NumBytes + size) > this->budget)) {
+        this->evictLRU();
+    }
+    entry e;
+    e.hash = hash;
+    e.size = size;
+    e.useTick = ++this->curTick;
+    this->entries.Add(hash, e);
+    this->curStats.NumEntries++;
+    this->curStats.NumBytes += size;
+    this->writeIndex();
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::removeEntry(uint64_t hash) {
+    if (this->entries.Contains(hash)) {
+        this->curStats.NumBytes -= this->entries[hash].size;
+        this->curStats.NumEntries--;
+        this->entries.Erase(hash);
+        std::remove(this->entryPath(hash).AsCStr());
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::evictLRU() {
+    o_assert_dbg(!this->entries.Empty());
+    // NOTE: evictions are rare, a linear search is good enough
+        int lruIndex = 0;
+        for (int i = 1; i < this->entries.Size(); i++) {
+            if (this->entries.ValueAtIndex(i).useTick < this->entries.ValueAtIndex(lruIndex).useTick) {
+                lruIndex = i;
+            }
+        }
+        this->removeEntry(this->entries.KeyAtIndex(lruIndex));
+        this->curStats.NumEvictions++;
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::touchEntry(uint64_t hash) {
+    if (this->entries.Contains(hash)) {
+        this->entries[hash].useTick = ++this->curTick;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::loadIndex() {
+    FILE* fp = std::fopen(this->indexPath.AsCStr(), "rb");
+    if (nullptr == fp) {
+        return;
+    }
+    char line[128];
+    if (std::fgets(line, sizeof(line), fp) && (0 == std::strncmp(line, indexMagic, std::strlen(indexMagic)))) {
+        // one line per entry: hash, LRU tick, body size
+        unsigned long long hash, tick;
+        long long size;
+        while (std::fgets(line, sizeof(line), fp)) {
+            if ((3 == std::sscanf(line, "%llx %llu %lld", &hash, &tick, &size)) && (size >= 0)) {
+                entry e;
+                e.hash = hash;
+                e.size = size;
+                e.useTick = tick;
+                if (!this->entries.Contains(e.hash)) {
+                    this->entries.Add(e.hash, e);
+                    this->curStats.NumEntries++;
+                    this->curStats.NumBytes += e.size;
+                }
+                if (e.useTick > this->curTick) {
+                    this->curTick = e.useTick;
+                }
+            }
+        }
+    }
+    std::fclose(fp);
+
+    // the budget may have shrunk since the last run
+    while (!this->entries.Empty() && (this->curStats.NumBytes > this->budget)) {
+        this->evictLRU();
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+httpCache::writeIndex() {
+    FILE* fp = std::fopen(this->indexPath.AsCStr(), "wb");
+    if (nullptr == fp) {
+        Log::Warn("httpCache: failed to write '%s'\n", this->indexPath.AsCStr());
+        return;
+    }
+    std::fprintf(fp, "%s\n", indexMagic);
+    for (const auto& kvp : this->entries) {
+        const entry& e = kvp.Value();
+        std::fprintf(fp, "%016llx %llu %lld\n", (unsigned long long) e.hash, (unsigned long long) e.useTick, (long long) e.size);
+    }
+    std::fclose(fp);
+}
+
+} // namespace _priv
+} // namespace Oryol
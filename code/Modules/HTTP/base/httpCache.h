@@ -0,0 +1,156 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::httpCache
+    @ingroup _priv
+    @brief persistent HTTP response cache in a local directory
+
+    The httpCache stores the response bodies of HTTP reads in a local
+    directory (one file per URL), together with the ETag, Last-Modified
+    and Cache-Control metadata of the response. A cached response is
+    served without request while it is fresh (Cache-Control: max-age),
+    otherwise the URL is requested with If-None-Match/If-Modified-Since
+    and a '304 Not Modified' response is served from the cache.
+    Responses with 'Cache-Control: no-store', or without validators
+    and max-age, are not cached. The Expires header is not evaluated,
+    responses without max-age are revalidated on each read.
+
+    The total size of the cached response bodies is kept below a
+    byte budget by evicting the least recently used entries, the
+    entry sizes and LRU order are persisted in an index file.
+
+    All HTTPFileSystem instances (one per IO lane) share one httpCache,
+    the cache is thread-safe.
+
+    @class Oryol::_priv::httpCacheRead
+    @ingroup _priv
+    @brief an internal IORead with the cache validators and response headers
+
+    The HTTPFileSystem forwards cacheable IORead requests as an
+    httpCacheRead to the URL loader, which adds the conditional
+    request headers and picks up the caching response headers.
+*/
+#include "Core/Containers/Map.h"
+#include "Core/String/String.h"
+#include "IO/FS/ioRequests.h"
+#include "HTTP/HTTPCacheStats.h"
+#if ORYOL_HAS_THREADS
+#include <mutex>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+class httpCacheRead : public IORead {
+    OryolClassDecl(httpCacheRead);
+    OryolTypeDecl(httpCacheRead, IORead);
+public:
+    /// the original request
+    Ptr<IORead> Original;
+    /// true if the response goes through the cache
+    bool Cacheable = false;
+    /// If-None-Match request header value (empty if none)
+    String IfNoneMatch;
+    /// If-Modified-Since request header value (empty if none)
+    String IfModifiedSince;
+    /// the body of the stale cache entry, served on 304
+    Buffer CachedBody;
+    /// ETag response header value
+    String ETag;
+    /// Last-Modified response header value
+    String LastModified;
+    /// Cache-Control response header value
+    String CacheControl;
+
+    /// parse a response header line, picks up the caching headers
+    void parseHeader(const char* line, int len);
+};
+
+class httpCache {
+public:
+    /// constructor
+    httpCache();
+    /// destructor
+    ~httpCache();
+
+    /// configure the cache directory and byte budget (empty dir disables the cache)
+    static void setup(const String& dir, int64_t budget);
+    /// get the shared instance, creates it on first call, nullptr if the cache is disabled
+    static httpCache* acquire();
+    /// release the shared instance, destroyed with the last release
+    static void release();
+    /// get a copy of the cache stats
+    static HTTPCacheStats stats();
+
+    /// return true if a request can be served through the cache
+    static bool isCacheable(const Ptr<IORead>& req);
+    /// serve a fresh entry (return true), or setup the validators of a stale entry
+    bool lookup(httpCacheRead* req);
+    /// handle the response of a forwarded request, stores or serves the response
+    void finish(httpCacheRead* req);
+
+private:
+    struct entry {
+        uint64_t hash = 0;
+        int64_t size = 0;
+        uint64_t useTick = 0;
+    };
+    /// the fixed-size part of a cache entry file
+    struct fileHeader {
+        char magic[8];
+        int64_t storeTime;
+        int64_t maxAge;
+        int64_t bodySize;
+        uint32_t urlLength;
+        uint32_t etagLength;
+        uint32_t lastModifiedLength;
+        uint32_t pad;
+    };
+
+    /// hash an URL
+    static uint64_t hashURL(const URL& url);
+    /// get the path of an entry file
+    String entryPath(uint64_t hash) const;
+    /// read an entry file, return false if missing or damaged
+    bool readEntry(uint64_t hash, const URL& url, fileHeader& outHeader, String& outETag, String& outLastModified, Buffer* outBody) const;
+    /// write an entry file
+    bool writeEntry(uint64_t hash, const URL& url, int64_t storeTime, int64_t maxAge, const String& etag, const String& lastModified, const uint8_t* body, int64_t bodySize);
+    /// update the store time and max-age of an entry file
+    bool refreshEntry(uint64_t hash, int64_t storeTime, int64_t maxAge);
+    /// parse the max-age of a Cache-Control value, return -1 if the response must not be stored
+    static int64_t maxAge(const String& cacheControl);
+    /// add or update an index entry, evicts entries to stay in the budget (must be locked)
+    void addEntry(uint64_t hash, int64_t size);
+    /// evict the least recently used entry (must be locked)
+    void evictLRU();
+    /// remove an index entry and its file (must be locked)
+    void removeEntry(uint64_t hash);
+    /// mark an entry as recently used (must be locked)
+    void touchEntry(uint64_t hash);
+    /// load the index file
+    void loadIndex();
+    /// write the index file (must be locked)
+    void writeIndex();
+
+    #if ORYOL_HAS_THREADS
+    static std::mutex instanceMutex;
+    #endif
+    static httpCache* instance;
+    static int instanceRefCount;
+    static String cacheDir;
+    static int64_t cacheBudget;
+
+    #if ORYOL_HAS_THREADS
+    std::mutex mutex;
+    #endif
+    String dir;
+    String indexPath;
+    int64_t budget;
+    Map<uint64_t, entry> entries;
+    uint64_t curTick;
+    uint32_t tmpCounter;
+    HTTPCacheStats curStats;
+};
+
+} // namespace _priv
+} // namespace Oryol
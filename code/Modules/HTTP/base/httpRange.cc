@@ -0,0 +1,180 @@
+//------------------------------------------------------------------------------
+//  httpRange.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "httpRange.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+bool
+httpRange::setup(const IORead* req) {
+    *this = httpRange();
+    this->startOffset = req->StartOffset;
+    this->endOffset = req->EndOffset;
+    this->active = (0 != this->startOffset) || (EndOfFile != this->endOffset);
+    this->badRange = (this->startOffset < 0) ||
+                     ((EndOfFile != this->endOffset) && (this->endOffset < this->startOffset));
+    return this->active;
+}
+
+//------------------------------------------------------------------------------
+void
+httpRange::rangeValue(char* buf, int bufSize) const {
+    o_assert_dbg(this->active && !this->badRange);
+    if (EndOfFile == this->endOffset) {
+        std::snprintf(buf, bufSize, "%lld-", (long long) this->startOffset);
+    }
+    else {
+        // NOTE: HTTP byte positions are inclusive, an empty range
+        // still asks for one byte, so that the server validates the start
+        const int64_t last = this->endOffset > this->startOffset ? this->endOffset - 1 : this->startOffset;
+        std::snprintf(buf, bufSize, "%lld-%lld", (long long) this->startOffset, (long long) last);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+httpRange::parseHeader(const char* line, int len) {
+    // a new status line starts the headers of another response (e.g. after a redirect)
+    if ((len > 5) && (0 == std::strncmp(line, "HTTP/", 5))) {
+        this->rangeStart = -1;
+        this->totalSize = -1;
+        return;
+    }
+    // looking for 'Content-Range: bytes 100-199/1000' or 'Content-Range: bytes */1000'
+    static const char* name = "content-range:";
+    const int nameLen = int(std::strlen(name));
+    if (len <= nameLen) {
+        return;
+    }
+    for (int i = 0; i < nameLen; i++) {
+        if (std::tolower(line[i]) != name[i]) {
+            return;
+        }
+    }
+    char buf[128];
+    const int valueLen = (len - nameLen) < int(sizeof(buf) - 1) ? (len - nameLen) : int(sizeof(buf) - 1);
+    Memory::Copy(line + nameLen, buf, valueLen);
+    buf[valueLen] = 0;
+    const char* ptr = std::strstr(buf, "bytes");
+    if (nullptr == ptr) {
+        return;
+    }
+    ptr += 5;
+    while (' ' == *ptr) {
+        ptr++;
+    }
+    if ('*' != *ptr) {
+        this->rangeStart = std::strtoll(ptr, nullptr, 10);
+    }
+    const char* slash = std::strchr(ptr, '/');
+    if (slash && ('*' != slash[1])) {
+        this->totalSize = std::strtoll(slash + 1, nullptr, 10);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+httpRange::begin(IORead* req, int httpStatus, int64_t contentLength) {
+    this->numSkip = 0;
+    this->numRemaining = -1;
+    if (this->active && ((IOStatus::OK == httpStatus) || (IOStatus::PartialContent == httpStatus))) {
+        if (IOStatus::OK == httpStatus) {
+            // the server has ignored the range, skip the bytes before the range
+            this->numSkip = this->startOffset;
+        }
+        else if ((this->rangeStart >= 0) && (this->rangeStart < this->startOffset)) {
+            // the server has sent a larger range than requested
+            this->numSkip = this->startOffset - this->rangeStart;
+        }
+        if (EndOfFile != this->endOffset) {
+            this->numRemaining = this->endOffset - this->startOffset;
+        }
+    }
+
+    // validate (or obtain) the destination memory for the
+    // whole result before the first bytes are written
+    if (contentLength >= 0) {
+        int64_t size = contentLength > this->numSkip ? contentLength - this->numSkip : 0;
+        if ((this->numRemaining >= 0) && (size > this->numRemaining)) {
+            size = this->numRemaining;
+        }
+        if ((size > 0) && req->HasDest() && !req->ReserveResult(size)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+httpRange::write(IORead* req, const uint8_t* ptr, int numBytes) {
+    if (this->numSkip > 0) {
+        const int skip = this->numSkip < numBytes ? int(this->numSkip) : numBytes;
+        ptr += skip;
+        numBytes -= skip;
+        this->numSkip -= skip;
+    }
+    if ((this->numRemaining >= 0) && (numBytes > this->numRemaining)) {
+        numBytes = int(this->numRemaining);
+    }
+    if (numBytes > 0) {
+        uint8_t* dst = req->AddResult(numBytes);
+        if (nullptr == dst) {
+            return false;
+        }
+        Memory::Copy(ptr, dst, numBytes);
+        if (this->numRemaining >= 0) {
+            this->numRemaining -= numBytes;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool
+httpRange::complete() const {
+    return (0 == this->numRemaining) && (0 == this->numSkip);
+}
+
+//------------------------------------------------------------------------------
+void
+httpRange::finish(IORead* req, int httpStatus) {
+    if (!this->active) {
+        return;
+    }
+    if (IOStatus::PartialContent == httpStatus) {
+        if (this->rangeStart > this->startOffset) {
+            req->TruncateResult(0);
+            req->Status = IOStatus::DownloadError;
+            req->ErrorDesc = "Unexpected Content-Range in response";
+        }
+        else {
+            req->Status = IOStatus::OK;
+        }
+    }
+    else if (IOStatus::OK == httpStatus) {
+        if (this->numSkip > 0) {
+            // the resource is shorter than the start of the range
+            req->Status = IOStatus::RequestedRangeNotSatisfiable;
+            req->ErrorDesc = "Range outside of file";
+        }
+    }
+    else if (IOStatus::RequestedRangeNotSatisfiable == httpStatus) {
+        // drop the error page, a range starting exactly at
+        // the end of the resource returns an empty result
+        req->TruncateResult(0);
+        if (this->totalSize == this->startOffset) {
+            req->Status = IOStatus::OK;
+        }
+    }
+}
+
+} // namespace _priv
+} // namespace Oryol
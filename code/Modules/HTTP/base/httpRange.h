@@ -0,0 +1,71 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::httpRange
+    @ingroup _priv
+    @brief map the byte range of an IORead to an HTTP range request
+
+    If an IORead asks for a byte range (StartOffset/EndOffset), the
+    URL loaders send a 'Range: bytes=start-end' request header. Servers
+    which support ranges answer with '206 Partial Content' and only
+    the requested bytes, servers which ignore the Range header answer
+    with '200 OK' and the complete resource, in this case the received
+    body is cut down to the requested range. Like the LocalFileSystem,
+    ranges reaching past the end of the resource are clamped, and a
+    range starting exactly at the end returns an empty result.
+
+    The URL loaders pass the response body through begin(), write()
+    and finish(), loaders which only get the complete body write it
+    as a single chunk.
+*/
+#include "IO/FS/ioRequests.h"
+
+namespace Oryol {
+namespace _priv {
+
+class httpRange {
+public:
+    /// setup from a request, return true if a byte range is requested
+    bool setup(const IORead* req);
+    /// return true if a byte range is requested
+    bool isRange() const;
+    /// return false if the requested range is invalid (the request must fail with 416)
+    bool isValid() const;
+    /// write the byte positions of the range (e.g. "100-199") into buf
+    void rangeValue(char* buf, int bufSize) const;
+    /// parse a response header line, picks up the Content-Range header
+    void parseHeader(const char* line, int len);
+    /// start receiving the response body, return false if the destination memory is too small
+    bool begin(IORead* req, int httpStatus, int64_t contentLength);
+    /// write a chunk of the response body to the request result, return false if the destination memory is too small
+    bool write(IORead* req, const uint8_t* ptr, int numBytes);
+    /// return true if the rest of the response body isn't needed
+    bool complete() const;
+    /// set the final request status after the body has been received
+    void finish(IORead* req, int httpStatus);
+
+private:
+    int64_t startOffset = 0;
+    int64_t endOffset = EndOfFile;
+    int64_t rangeStart = -1;        // first byte position from Content-Range
+    int64_t totalSize = -1;         // resource size from Content-Range
+    int64_t numSkip = 0;            // number of body bytes before the range
+    int64_t numRemaining = -1;      // number of range bytes still expected (-1 if open-ended)
+    bool active = false;
+    bool badRange = false;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+httpRange::isRange() const {
+    return this->active;
+}
+
+//------------------------------------------------------------------------------
+inline bool
+httpRange::isValid() const {
+    return !this->badRange;
+}
+
+} // namespace _priv
+} // namespace Oryol
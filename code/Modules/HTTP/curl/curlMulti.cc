@@ -0,0 +1,759 @@
+//------------------------------------------------------------------------------
+//  curlMulti.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "curlMulti.h"
+#include "HTTP/base/baseURLLoader.h"
+#include "HTTP/base/httpRange.h"
+#include "HTTP/base/httpCache.h"
+#include "Core/String/StringBuilder.h"
+#include "Core/String/StringConverter.h"
+#include "Core/Time/Clock.h"
+#include "curl/curl.h"
+#include <algorithm>
+#include <cstring>
+#if ORYOL_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+std::mutex curlMulti::instanceMutex;
+curlMulti* curlMulti::instance = nullptr;
+int curlMulti::instanceRefCount = 0;
+
+//------------------------------------------------------------------------------
+struct curlMulti::transfer {
+    Ptr<IORead> req;
+    Ptr<httpCacheRead> cacheRead;
+    std::atomic<int>* numInFlight = nullptr;
+    std::atomic<bool>* wakeupFlag = nullptr;
+    httpRange range;
+    attempt* primary = nullptr;
+    attempt* hedge = nullptr;
+    TimePoint deadline;
+    TimePoint retryTime;
+    int numRetries = 0;
+    bool hedged = false;
+};
+
+//------------------------------------------------------------------------------
+struct curlMulti::attempt {
+    CURL* handle = nullptr;
+    transfer* owner = nullptr;
+    Ptr<IORead> target;             // the request, or the shadow request of a hedge
+    Ptr<httpCacheRead> cacheRead;   // the target if it is an httpCacheRead
+    struct curl_slist* requestHeaders = nullptr;
+    char curlError[CURL_ERROR_SIZE] = { };
+    httpRange range;
+    TimePoint startTime;
+    TimePoint responseTime;
+    bool isHedge = false;
+    bool bodyStarted = false;
+    bool rangeComplete = false;
+    bool destTooSmall = false;
+};
+
+//------------------------------------------------------------------------------
+curlMulti*
+curlMulti::acquire() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (nullptr == instance) {
+        instance = Memory::New<curlMulti>();
+    }
+    instanceRefCount++;
+    return instance;
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::release() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    o_assert(instanceRefCount > 0);
+    if (0 == --instanceRefCount) {
+        Memory::Delete(instance);
+        instance = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+curlMulti::curlMulti() :
+numLockRequests(0),
+multi(nullptr),
+settingsVersion(-1),
+numLatencies(0),
+latencyIndex(0),
+randomState(0x9E3779B97F4A7C15ULL) {
+    this->wakeupPipe[0] = this->wakeupPipe[1] = -1;
+    #if ORYOL_POSIX
+    // the wakeup pipe ends a curl_multi_wait(), both ends are non-blocking
+    // so that a full pipe never blocks, and a wait can drain it
+    if (0 == pipe(this->wakeupPipe)) {
+        fcntl(this->wakeupPipe[0], F_SETFL, fcntl(this->wakeupPipe[0], F_GETFL) | O_NONBLOCK);
+        fcntl(this->wakeupPipe[1], F_SETFL, fcntl(this->wakeupPipe[1], F_GETFL) | O_NONBLOCK);
+    }
+    else {
+        o_warn("curlMulti: failed to create wakeup pipe, IO lanes will poll\n");
+        this->wakeupPipe[0] = this->wakeupPipe[1] = -1;
+    }
+    #endif
+    this->multi = curl_multi_init();
+    o_assert(nullptr != this->multi);
+    this->applySettings();
+    #if LIBCURL_VERSION_NUM >= 0x072b00
+    curl_multi_setopt(this->multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    #endif
+    // seed the backoff jitter, so that processes don't retry in lockstep
+    this->randomState ^= uint64_t(Clock::Now().getRaw());
+}
+
+//------------------------------------------------------------------------------
+curlMulti::~curlMulti() {
+    // all loaders must have cancelled their transfers
+    o_assert(this->transfers.Empty());
+    for (void* handle : this->freeHandles) {
+        curl_easy_cleanup(handle);
+    }
+    this->freeHandles.Clear();
+    curl_multi_cleanup(this->multi);
+    this->multi = nullptr;
+    #if ORYOL_POSIX
+    if (-1 != this->wakeupPipe[0]) {
+        close(this->wakeupPipe[0]);
+        close(this->wakeupPipe[1]);
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::applySettings() {
+    const int version = baseURLLoader::settingsVersion();
+    if (version != this->settingsVersion) {
+        this->settingsVersion = version;
+        this->policy = baseURLLoader::retryPolicy();
+        int maxPerHost = 0;
+        int maxTotal = 0;
+        baseURLLoader::connectionLimits(maxPerHost, maxTotal);
+        curl_multi_setopt(this->multi, CURLMOPT_MAX_HOST_CONNECTIONS, long(maxPerHost));
+        curl_multi_setopt(this->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, long(maxTotal));
+        curl_multi_setopt(this->multi, CURLMOPT_MAXCONNECTS, long(maxTotal));
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::interruptWait() {
+    #if ORYOL_POSIX
+    if (-1 != this->wakeupPipe[1]) {
+        const char c = 0;
+        // NOTE: if the pipe is full, a wakeup is already pending
+        ssize_t res = write(this->wakeupPipe[1], &c, 1);
+        (void)res;
+    }
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::wakeup(std::atomic<bool>* wakeupFlag) {
+    *wakeupFlag = true;
+    this->interruptWait();
+}
+
+//------------------------------------------------------------------------------
+int64_t
+curlMulti::msUntilTimers(int64_t maxMs) const {
+    // NOTE: must be in sync with updateTimers()
+    const bool hedging = this->policy.HedgingEnabled && (this->numLatencies >= MinHedgeLatencies);
+    const TimePoint now = Clock::Now();
+    int64_t ms = maxMs;
+    for (const transfer* t : this->transfers) {
+        TimePoint due;
+        if ((nullptr == t->primary) && (nullptr == t->hedge)) {
+            due = t->retryTime;
+        }
+        else if (hedging && !t->hedged && t->primary && !t->primary->bodyStarted) {
+            due = t->primary->startTime + this->hedgeDelay;
+        }
+        else {
+            continue;
+        }
+        // round up, so that the timer is due when the wait is over
+        const int64_t dueMs = int64_t((due - now).AsMilliSeconds()) + 1;
+        if (dueMs < ms) {
+            ms = dueMs > 0 ? dueMs : 0;
+        }
+    }
+    return ms;
+}
+
+//------------------------------------------------------------------------------
+bool
+curlMulti::wait(Duration timeout, std::atomic<bool>* wakeupFlag) {
+    if ((-1 == this->wakeupPipe[0]) || (nullptr == this->multi)) {
+        return false;
+    }
+    #if ORYOL_POSIX
+    if (wakeupFlag->exchange(false)) {
+        return true;
+    }
+    // if another lane is already waiting on the multi handle, wait for
+    // the lock, that lane is woken up by activity on the sockets
+    std::unique_lock<std::timed_mutex> lock(this->mutex, std::defer_lock);
+    if (!lock.try_lock_for(std::chrono::microseconds(int64_t(timeout.AsMicroSeconds())))) {
+        return true;
+    }
+    if (wakeupFlag->exchange(false) || (this->numLockRequests > 0)) {
+        return true;
+    }
+    this->applySettings();
+
+    // don't wait past curl's own timeouts and the next retry or hedge
+    int64_t timeoutMs = this->msUntilTimers(int64_t(timeout.AsMilliSeconds()));
+    long curlTimeoutMs = -1;
+    curl_multi_timeout(this->multi, &curlTimeoutMs);
+    if ((curlTimeoutMs >= 0) && (curlTimeoutMs < timeoutMs)) {
+        timeoutMs = curlTimeoutMs;
+    }
+    if (timeoutMs > 0) {
+        struct curl_waitfd wakeupFd;
+        wakeupFd.fd = this->wakeupPipe[0];
+        wakeupFd.events = CURL_WAIT_POLLIN;
+        wakeupFd.revents = 0;
+        int numFds = 0;
+        curl_multi_wait(this->multi, &wakeupFd, 1, int(timeoutMs), &numFds);
+
+        // drain the wakeup pipe, the wakeup flags tell which lanes must wake up
+        char buf[64];
+        while (read(this->wakeupPipe[0], buf, sizeof(buf)) > 0) {
+            // empty
+        }
+    }
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+HTTPRetryStats
+curlMulti::stats() {
+    std::lock_guard<std::mutex> lock(instanceMutex);
+    if (instance) {
+        instance->numLockRequests++;
+        instance->interruptWait();
+        std::lock_guard<std::timed_mutex> multiLock(instance->mutex);
+        instance->numLockRequests--;
+        HTTPRetryStats result = instance->curStats;
+        result.HedgeDelay = instance->hedgeDelay;
+        return result;
+    }
+    else {
+        return HTTPRetryStats();
+    }
+}
+
+//------------------------------------------------------------------------------
+size_t
+curlMulti::curlWriteDataCallback(char* ptr, size_t size, size_t nmemb, void* userData) {
+    // userData is expected to point to the attempt object
+    attempt* a = (attempt*) userData;
+    IORead* req = a->target.get();
+    int bytesToWrite = (int) (size * nmemb);
+    if (bytesToWrite > 0) {
+        // NOTE: returning a different size aborts the transfer
+        if (!a->bodyStarted) {
+            a->bodyStarted = true;
+            a->responseTime = Clock::Now();
+            long httpCode = 0;
+            double contentLength = -1.0;
+            curl_easy_getinfo(a->handle, CURLINFO_RESPONSE_CODE, &httpCode);
+            curl_easy_getinfo(a->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &contentLength);
+            if (!a->range.begin(req, int(httpCode), int64_t(contentLength))) {
+                a->destTooSmall = true;
+                return 0;
+            }
+        }
+        if (a->range.complete()) {
+            // the server has ignored the range, and the range
+            // has been received, the rest of the body isn't needed
+            a->rangeComplete = true;
+            return 0;
+        }
+        if (!a->range.write(req, (const uint8_t*)ptr, bytesToWrite)) {
+            a->destTooSmall = true;
+            return 0;
+        }
+        return bytesToWrite;
+    }
+    else {
+        return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+size_t
+curlMulti::curlHeaderCallback(char* ptr, size_t size, size_t nmemb, void* userData) {
+    attempt* a = (attempt*) userData;
+    const int len = (int) (size * nmemb);
+    a->range.parseHeader(ptr, len);
+    if (a->cacheRead) {
+        a->cacheRead->parseHeader(ptr, len);
+    }
+    return len;
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::setupAttempt(attempt* a) {
+    CURL* handle = a->handle;
+    const transfer* t = a->owner;
+
+    // set session options
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 1L);
+    curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, a->curlError);
+    curl_easy_setopt(handle, CURLOPT_PRIVATE, a);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, curlWriteDataCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, a);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, curlHeaderCallback);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, a);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, 10L);
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, 10L);
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    #if LIBCURL_VERSION_NUM >= 0x072f00
+    // use HTTP/2 where the server supports it, and rather wait for
+    // a connection which can be multiplexed than open a new one
+    curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, long(CURL_HTTP_VERSION_2TLS));
+    curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+    #endif
+
+    // an attempt may not take longer than the remaining time budget of the request
+    const HTTPRetryPolicy& policy = this->policy;
+    int64_t timeout = (t->deadline - a->startTime).AsTicks();
+    if (timeout > policy.AttemptTimeout.AsTicks()) {
+        timeout = policy.AttemptTimeout.AsTicks();
+    }
+    int64_t connectTimeout = policy.ConnectTimeout.AsTicks();
+    if (connectTimeout > timeout) {
+        connectTimeout = timeout;
+    }
+    curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, long(timeout > 1000 ? timeout / 1000 : 1));
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT_MS, long(connectTimeout > 1000 ? connectTimeout / 1000 : 1));
+
+    // set URL in curl
+    const URL& url = t->req->Url;
+    o_assert(url.Scheme() == "http");
+    curl_easy_setopt(handle, CURLOPT_URL, url.AsCStr());
+    if (url.HasPort()) {
+        uint16_t port = StringConverter::FromString<uint16_t>(url.Port());
+        curl_easy_setopt(handle, CURLOPT_PORT, long(port));
+    }
+    curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+
+    // byte ranges are requested with a Range header
+    if (a->range.isRange()) {
+        char rangeValue[64];
+        a->range.rangeValue(rangeValue, sizeof(rangeValue));
+        curl_easy_setopt(handle, CURLOPT_RANGE, rangeValue);
+    }
+
+    // add standard request headers:
+    //  User-Agent: need a 'standard' user-agent, otherwise some HTTP servers
+    //              won't accept Connection: keep-alive
+    //  Connection: keep-alive, don't open/close the connection all the time
+    //  Accept-Encoding:    gzip, deflate (not for reads into caller memory, where
+    //                      the Content-Length must match the size of the body,
+    //                      and not for ranges, which would be ranges of the
+    //                      encoded data)
+    //
+    a->requestHeaders = curl_slist_append(a->requestHeaders, "User-Agent: Mozilla/5.0");
+    a->requestHeaders = curl_slist_append(a->requestHeaders, "Connection: keep-alive");
+    if (t->req->HasDest() || a->range.isRange()) {
+        curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, nullptr);
+    }
+    else {
+        a->requestHeaders = curl_slist_append(a->requestHeaders, "Accept-Encoding: gzip, deflate");
+        curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");   // all encodings supported by curl
+    }
+
+    // conditional request headers to revalidate a cached response
+    if (t->cacheRead) {
+        StringBuilder strBuilder;
+        if (!t->cacheRead->IfNoneMatch.Empty()) {
+            strBuilder.Set("If-None-Match: ");
+            strBuilder.Append(t->cacheRead->IfNoneMatch);
+            a->requestHeaders = curl_slist_append(a->requestHeaders, strBuilder.AsCStr());
+        }
+        if (!t->cacheRead->IfModifiedSince.Empty()) {
+            strBuilder.Set("If-Modified-Since: ");
+            strBuilder.Append(t->cacheRead->IfModifiedSince);
+            a->requestHeaders = curl_slist_append(a->requestHeaders, strBuilder.AsCStr());
+        }
+    }
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, a->requestHeaders);
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::add(const Ptr<IORead>& req, std::atomic<int>* numInFlight, std::atomic<bool>* wakeupFlag) {
+    // invalid ranges fail without a transfer
+    httpRange range;
+    range.setup(req.get());
+    if (!range.isValid()) {
+        req->Status = IOStatus::RequestedRangeNotSatisfiable;
+        req->ErrorDesc = "Invalid range";
+        req->Handled = true;
+        return;
+    }
+
+    this->numLockRequests++;
+    this->interruptWait();
+    std::lock_guard<std::timed_mutex> lock(this->mutex);
+    this->numLockRequests--;
+    this->applySettings();
+    transfer* t = Memory::New<transfer>();
+    t->req = req;
+    t->cacheRead = req->DynamicCast<httpCacheRead>();
+    t->numInFlight = numInFlight;
+    t->wakeupFlag = wakeupFlag;
+    t->range = range;
+    t->deadline = Clock::Now() + this->policy.Timeout;
+    this->transfers.Add(t);
+    (*numInFlight)++;
+    this->startAttempt(t, false);
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::startAttempt(transfer* t, bool hedge) {
+    attempt* a = Memory::New<attempt>();
+    a->owner = t;
+    a->isHedge = hedge;
+    a->range = t->range;
+    a->startTime = Clock::Now();
+    if (hedge) {
+        // a hedge downloads into a shadow request, which is copied
+        // to the original request if the hedge wins
+        Ptr<IORead> shadow;
+        if (t->cacheRead) {
+            Ptr<httpCacheRead> cacheShadow = httpCacheRead::Create();
+            cacheShadow->IfNoneMatch = t->cacheRead->IfNoneMatch;
+            cacheShadow->IfModifiedSince = t->cacheRead->IfModifiedSince;
+            shadow = cacheShadow;
+        }
+        else {
+            shadow = IORead::Create();
+        }
+        shadow->Url = t->req->Url;
+        shadow->StartOffset = t->req->StartOffset;
+        shadow->EndOffset = t->req->EndOffset;
+        a->target = shadow;
+        o_assert_dbg(nullptr == t->hedge);
+        t->hedge = a;
+        t->hedged = true;
+    }
+    else {
+        // a retry discards the result of the failed attempt
+        a->target = t->req;
+        if (t->req->ResultSize() > 0) {
+            t->req->TruncateResult(0);
+        }
+        t->req->ErrorDesc.Clear();
+        o_assert_dbg(nullptr == t->primary);
+        t->primary = a;
+    }
+    a->cacheRead = a->target->DynamicCast<httpCacheRead>();
+
+    // easy handles are reused, the connections are owned by the multi handle
+    if (this->freeHandles.Empty()) {
+        a->handle = curl_easy_init();
+        o_assert(nullptr != a->handle);
+    }
+    else {
+        a->handle = this->freeHandles.PopBack();
+        curl_easy_reset(a->handle);
+    }
+    this->setupAttempt(a);
+    curl_multi_add_handle(this->multi, a->handle);
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::stopAttempt(attempt* a) {
+    // recycle the easy handle, free the request headers, and unlink from the transfer
+    curl_multi_remove_handle(this->multi, a->handle);
+    this->freeHandles.Add(a->handle);
+    if (a->requestHeaders) {
+        curl_slist_free_all(a->requestHeaders);
+        a->requestHeaders = nullptr;
+    }
+    transfer* t = a->owner;
+    if (t->primary == a) {
+        t->primary = nullptr;
+    }
+    else {
+        o_assert_dbg(t->hedge == a);
+        t->hedge = nullptr;
+    }
+    Memory::Delete(a);
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::update() {
+    // if another IO lane is already performing the transfers, there's nothing to do
+    std::unique_lock<std::timed_mutex> lock(this->mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+    this->applySettings();
+
+    // first abort the transfers of cancelled requests
+    for (int i = this->transfers.Size() - 1; i >= 0; i--) {
+        if (this->transfers[i]->req->Cancelled) {
+            this->finishTransfer(this->transfers[i]);
+        }
+    }
+
+    // start retries and hedges
+    this->updateTimers();
+
+    // perform transfers and handle the finished ones
+    int numRunning = 0;
+    curl_multi_perform(this->multi, &numRunning);
+    int numMsgs = 0;
+    CURLMsg* msg = nullptr;
+    while (nullptr != (msg = curl_multi_info_read(this->multi, &numMsgs))) {
+        if (CURLMSG_DONE == msg->msg) {
+            attempt* a = nullptr;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&a);
+            o_assert_dbg(a);
+            this->attemptDone(a, msg->data.result);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::cancel(std::atomic<int>* numInFlight) {
+    this->numLockRequests++;
+    this->interruptWait();
+    std::lock_guard<std::timed_mutex> lock(this->mutex);
+    this->numLockRequests--;
+    for (int i = this->transfers.Size() - 1; i >= 0; i--) {
+        if (this->transfers[i]->numInFlight == numInFlight) {
+            this->transfers[i]->req->Cancelled = true;
+            this->finishTransfer(this->transfers[i]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::updateTimers() {
+    const bool hedging = this->policy.HedgingEnabled && (this->numLatencies >= MinHedgeLatencies);
+    const TimePoint now = Clock::Now();
+    for (transfer* t : this->transfers) {
+        if ((nullptr == t->primary) && (nullptr == t->hedge)) {
+            // waiting for a retry
+            if (now >= t->retryTime) {
+                this->startAttempt(t, false);
+            }
+        }
+        else if (hedging && !t->hedged && t->primary && !t->primary->bodyStarted) {
+            // no response after the hedge delay, start a duplicate request
+            if (((now - t->primary->startTime) >= this->hedgeDelay) && ((now + this->hedgeDelay) < t->deadline)) {
+                this->curStats.NumHedges++;
+                this->startAttempt(t, true);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::attemptDone(attempt* a, int curlResult) {
+    transfer* t = a->owner;
+    IORead* req = a->target.get();
+
+    // query the http code
+    long curlHttpCode = 0;
+    curl_easy_getinfo(a->handle, CURLINFO_RESPONSE_CODE, &curlHttpCode);
+    req->Status = (IOStatus::Code) curlHttpCode;
+    if (!a->bodyStarted) {
+        // a response without body
+        a->responseTime = Clock::Now();
+        a->range.begin(req, int(curlHttpCode), 0);
+    }
+
+    // check for error codes, and whether the request may be retried
+    bool retry = false;
+    if (a->destTooSmall) {
+        req->Status = IOStatus::RequestEntityTooLarge;
+        req->ErrorDesc = "Destination buffer too small";
+    }
+    else if ((CURLE_OK == curlResult) || a->rangeComplete) {
+        // map the response status of range requests
+        a->range.finish(req, int(curlHttpCode));
+        retry = (408 == curlHttpCode) || (429 == curlHttpCode) || (500 == curlHttpCode) ||
+                (502 == curlHttpCode) || (503 == curlHttpCode) || (504 == curlHttpCode);
+    }
+    else if (CURLE_PARTIAL_FILE == curlResult) {
+        // this seems to happen quite often even though all data has been received,
+        // not sure what to do about this, but don't treat it as an error
+        Log::Warn("curlURLLoader: CURLE_PARTIAL_FILE received for '%s', httpStatus='%ld'\n", req->Url.AsCStr(), curlHttpCode);
+        req->ErrorDesc = a->curlError;
+        a->range.finish(req, int(curlHttpCode));
+    }
+    else {
+        // some other curl error
+        Log::Warn("curlURLLoader: transfer failed with '%s' for '%s', httpStatus='%ld'\n",
+            a->curlError, req->Url.AsCStr(), curlHttpCode);
+        req->ErrorDesc = a->curlError;
+        if (CURLE_OPERATION_TIMEDOUT == curlResult) {
+            this->curStats.NumTimeouts++;
+            if (0 == curlHttpCode) {
+                req->Status = IOStatus::RequestTimeout;
+            }
+        }
+        else if (0 == curlHttpCode) {
+            req->Status = IOStatus::DownloadError;
+        }
+        retry = true;
+    }
+    const bool isHedge = a->isHedge;
+    const bool destTooSmall = a->destTooSmall;
+    const Duration latency = a->responseTime - a->startTime;
+    Ptr<IORead> target = a->target;
+    this->stopAttempt(a);
+
+    if (retry) {
+        // if the other attempt is still running, it carries on alone
+        if (t->primary || t->hedge) {
+            return;
+        }
+        // ...otherwise retry after a backoff, if the time budget allows it
+        if (t->numRetries < this->policy.MaxRetries) {
+            const TimePoint now = Clock::Now();
+            const Duration delay = this->backoff(t->numRetries);
+            if ((now + delay + this->policy.RetryBaseDelay) < t->deadline) {
+                Log::Dbg("curlURLLoader: retry %d for '%s' in %.0fms\n", t->numRetries + 1, req->Url.AsCStr(), delay.AsMilliSeconds());
+                t->numRetries++;
+                t->retryTime = now + delay;
+                this->curStats.NumRetries++;
+                return;
+            }
+        }
+    }
+    else if (!destTooSmall) {
+        this->addLatency(latency);
+    }
+
+    // this attempt wins, abort the other one
+    if (t->primary) {
+        this->stopAttempt(t->primary);
+    }
+    if (t->hedge) {
+        this->stopAttempt(t->hedge);
+    }
+    if (isHedge) {
+        if (!retry) {
+            this->curStats.NumHedgesWon++;
+        }
+        // copy the result of the shadow request
+        const Ptr<IORead>& origReq = t->req;
+        origReq->Status = target->Status;
+        origReq->ErrorDesc = target->ErrorDesc;
+        if (origReq->HasDest()) {
+            const int size = target->ResultSize();
+            if (!origReq->SetResult(target->ResultData(), size) && (IOStatus::OK == origReq->Status)) {
+                origReq->Status = IOStatus::RequestEntityTooLarge;
+                origReq->ErrorDesc = "Destination buffer too small";
+            }
+        }
+        else {
+            origReq->Data = std::move(target->Data);
+        }
+        if (t->cacheRead) {
+            Ptr<httpCacheRead> cacheShadow = target->DynamicCast<httpCacheRead>();
+            t->cacheRead->ETag = cacheShadow->ETag;
+            t->cacheRead->LastModified = cacheShadow->LastModified;
+            t->cacheRead->CacheControl = cacheShadow->CacheControl;
+        }
+    }
+    this->finishTransfer(t);
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::finishTransfer(transfer* t) {
+    // abort the running attempts
+    if (t->primary) {
+        this->stopAttempt(t->primary);
+    }
+    if (t->hedge) {
+        this->stopAttempt(t->hedge);
+    }
+    if (t->req->Cancelled) {
+        t->req->Status = IOStatus::Cancelled;
+    }
+    this->transfers.EraseSwap(this->transfers.FindIndexLinear(t));
+    (*t->numInFlight)--;
+    t->req->Handled = true;
+    // wake up the lane of the request if it is waiting for the lock
+    *t->wakeupFlag = true;
+    Memory::Delete(t);
+}
+
+//------------------------------------------------------------------------------
+void
+curlMulti::addLatency(Duration latency) {
+    // the hedge delay is a percentile of the recent response latencies
+    this->latencies[this->latencyIndex] = latency.AsTicks();
+    this->latencyIndex = (this->latencyIndex + 1) % NumLatencies;
+    if (this->numLatencies < NumLatencies) {
+        this->numLatencies++;
+    }
+    const HTTPRetryPolicy& policy = this->policy;
+    if (policy.HedgingEnabled && (this->numLatencies >= MinHedgeLatencies)) {
+        int64_t sorted[NumLatencies];
+        std::memcpy(sorted, this->latencies, this->numLatencies * sizeof(int64_t));
+        int index = (this->numLatencies * policy.HedgePercentile + 99) / 100 - 1;
+        index = index < 0 ? 0 : index;
+        std::nth_element(sorted, sorted + index, sorted + this->numLatencies);
+        this->hedgeDelay = Duration(sorted[index]);
+        if (this->hedgeDelay < policy.HedgeMinDelay) {
+            this->hedgeDelay = policy.HedgeMinDelay;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+Duration
+curlMulti::backoff(int numRetries) {
+    // exponential backoff with jitter in the upper half of the delay
+    const HTTPRetryPolicy& policy = this->policy;
+    const int64_t maxDelay = policy.RetryMaxDelay.AsTicks();
+    int64_t delay = policy.RetryBaseDelay.AsTicks();
+    for (int i = 0; (i < numRetries) && (delay < maxDelay); i++) {
+        delay *= 2;
+    }
+    if (delay > maxDelay) {
+        delay = maxDelay;
+    }
+    // xorshift64
+    uint64_t x = this->randomState;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    this->randomState = x;
+    return Duration(delay / 2 + int64_t(x % uint64_t(delay / 2 + 1)));
+}
+
+} // namespace _priv
+} // namespace Oryol
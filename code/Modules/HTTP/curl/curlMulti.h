@@ -0,0 +1,125 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::curlMulti
+    @ingroup _priv
+    @brief a curl multi handle shared by the curlURLLoaders of all IO lanes
+
+    All transfers of all IO lanes run on one curl multi handle, which
+    owns the connection cache, so that keep-alive connections are
+    reused by all lanes, and the per-host and total connection limits
+    (see HTTPFileSystem::SetConnectionLimits()) apply to the whole
+    process. Transfers which exceed the connection limits are queued
+    by curl until a connection is free. If the curl version supports
+    it, transfers to HTTP/2 servers are multiplexed over a single
+    connection per host.
+
+    The multi handle is guarded by a mutex, each IO lane with transfers
+    in flight calls update() regularly, if another lane is already
+    performing the transfers, update() returns immediately. Between the
+    updates, a lane waits in curl_multi_wait() until there's activity on
+    the sockets, or a retry or hedge is due, while other lanes wait for
+    the lock. A lane is woken up through a pipe when new messages arrive
+    for it, when one of its transfers has been finished by another lane,
+    or when another thread needs the lock.
+
+    The connection limits and the retry policy are read from the
+    baseURLLoader settings, and are applied to the live multi handle
+    when they change.
+
+    Each transfer runs one or more attempts (see HTTPRetryPolicy):
+    failed attempts are retried after a jittered exponential backoff,
+    and a slow attempt may be hedged by a duplicate attempt which
+    downloads into a shadow request, the first response wins.
+*/
+#include "Core/Containers/Array.h"
+#include "Core/Time/TimePoint.h"
+#include "IO/FS/ioRequests.h"
+#include "HTTP/HTTPRetryPolicy.h"
+#include "HTTP/HTTPRetryStats.h"
+#include <atomic>
+#include <mutex>
+
+namespace Oryol {
+namespace _priv {
+
+class curlMulti {
+public:
+    /// constructor
+    curlMulti();
+    /// destructor
+    ~curlMulti();
+
+    /// get the shared instance, create on first call
+    static curlMulti* acquire();
+    /// release the shared instance, destroyed with the last release
+    static void release();
+
+    /// start a transfer, the counter is decremented and the flag is set when the request is handled
+    void add(const Ptr<IORead>& req, std::atomic<int>* numInFlight, std::atomic<bool>* wakeupFlag);
+    /// perform transfers, and handle completed or cancelled requests
+    void update();
+    /// wait until transfers make progress, the wakeup flag is set or the timeout expires, return false if not supported
+    bool wait(Duration timeout, std::atomic<bool>* wakeupFlag);
+    /// set a wakeup flag, and end the current wait(), may be called from any thread
+    void wakeup(std::atomic<bool>* wakeupFlag);
+    /// cancel all transfers counted by a counter
+    void cancel(std::atomic<int>* numInFlight);
+    /// get a copy of the retry stats
+    static HTTPRetryStats stats();
+
+private:
+    struct transfer;
+    struct attempt;
+
+    /// apply changed connection limits and retry policy (called with locked mutex)
+    void applySettings();
+    /// end the wait() of another lane, so that the mutex can be locked
+    void interruptWait();
+    /// get the number of milliseconds until the next retry or hedge is due (max maxMs)
+    int64_t msUntilTimers(int64_t maxMs) const;
+    /// start an attempt of a transfer (the original, a retry or a hedge)
+    void startAttempt(transfer* t, bool hedge);
+    /// setup the easy handle of an attempt
+    void setupAttempt(attempt* a);
+    /// stop an attempt, and recycle its easy handle
+    void stopAttempt(attempt* a);
+    /// handle a completed attempt, finishes, retries or drops it
+    void attemptDone(attempt* a, int curlResult);
+    /// abort the running attempts of a transfer, and flag its request as handled
+    void finishTransfer(transfer* t);
+    /// start retries and hedges which are due
+    void updateTimers();
+    /// add a response latency sample and update the hedge delay
+    void addLatency(Duration latency);
+    /// get a jittered backoff delay before a retry
+    Duration backoff(int numRetries);
+    /// curl write-data callback
+    static size_t curlWriteDataCallback(char* ptr, size_t size, size_t nmemb, void* userData);
+    /// curl header-data callback
+    static size_t curlHeaderCallback(char* ptr, size_t size, size_t nmemb, void* userData);
+
+    static std::mutex instanceMutex;
+    static curlMulti* instance;
+    static int instanceRefCount;
+
+    std::timed_mutex mutex;
+    std::atomic<int> numLockRequests;
+    int wakeupPipe[2];
+    void* multi;
+    int settingsVersion;
+    HTTPRetryPolicy policy;
+    Array<transfer*> transfers;
+    Array<void*> freeHandles;
+    static const int NumLatencies = 64;
+    static const int MinHedgeLatencies = 16;
+    int64_t latencies[NumLatencies];
+    int numLatencies;
+    int latencyIndex;
+    Duration hedgeDelay;
+    uint64_t randomState;
+    HTTPRetryStats curStats;
+};
+
+} // namespace _priv
+} // namespace Oryol
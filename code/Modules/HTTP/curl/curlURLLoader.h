@@ -5,38 +5,46 @@
     @ingroup _priv
     @brief urlLoader implementation on top of curl
     @see urlLoader
+
+    Requests are started on the curl multi handle shared by all
+    IO lanes (see curlMulti) and are handled asynchronously in update(),
+    between the updates the IO lane waits in curl until the transfers
+    make progress.
+    Failed requests are retried, and slow requests may be hedged
+    according to the HTTPRetryPolicy.
 */
 #include "HTTP/base/baseURLLoader.h"
+#include <atomic>
 #include <mutex>
 
 namespace Oryol {
 namespace _priv {
 
+class curlMulti;
+
 class curlURLLoader : public baseURLLoader {
 public:
     /// constructor
     curlURLLoader();
     /// destructor
     ~curlURLLoader();
-    /// process one request
+    /// start processing one request
     bool doRequest(const Ptr<IORead>& req);
+    /// perform transfers, return true if requests are in flight
+    bool update();
+    /// wait until transfers make progress, or wakeup() is called
+    bool wait(Duration timeout);
+    /// end a wait(), may be called from any thread
+    void wakeup();
+    /// get retry statistics
+    static HTTPRetryStats retryStats();
 
 private:
-    /// setup curl session
-    void setupCurlSession();
-    /// discard the curl session
-    void discardCurlSession();
-    /// process one request (internal)
-    void doRequestInternal(const Ptr<IORead>& req);
-    /// curl write-data callback
-    static size_t curlWriteDataCallback(char* ptr, size_t size, size_t nmemb, void* userData);
-    /// curl header-data callback
-    static size_t curlHeaderCallback(char* ptr, size_t size, size_t nmenb, void* userData);
-
     static bool curlInitCalled;
     static std::mutex curlInitMutex;
-    void* curlSession;
-    char* curlError;
+    curlMulti* multi;
+    std::atomic<int> numInFlight;
+    std::atomic<bool> wakeupFlag;
 };
 
 } // namespace _priv
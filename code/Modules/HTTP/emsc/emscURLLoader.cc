@@ -3,6 +3,7 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "emscURLLoader.h"
+#include "HTTP/base/httpRange.h"
 #include <emscripten/emscripten.h>
 
 namespace Oryol {
@@ -26,6 +27,16 @@ void
 emscURLLoader::startRequest(const Ptr<IORead>& req) {
     o_assert(req.isValid() && !req->Handled);
 
+    // invalid byte ranges fail without a request
+    httpRange range;
+    range.setup(req.get());
+    if (!range.isValid()) {
+        req->Status = IOStatus::RequestedRangeNotSatisfiable;
+        req->ErrorDesc = "Invalid range";
+        req->Handled = true;
+        return;
+    }
+
     // bump the requests refcount and get a raw pointer
     IORead* reqPtr = req.get();
     reqPtr->addRef();
@@ -46,8 +57,19 @@ emscURLLoader::onLoaded(void* userData, void* buffer, int size) {
 
     Ptr<IORead> req = userData;
     req->release();
+    // NOTE: emscripten_async_wget_data() can't send a Range header,
+    // the requested byte range is cut out of the complete file
+    httpRange range;
+    range.setup(req.get());
     req->Status = IOStatus::OK;
-    req->Data.Add((const uint8_t*)buffer, size);
+    if (range.begin(req.get(), IOStatus::OK, size) &&
+        range.write(req.get(), (const uint8_t*)buffer, size)) {
+        range.finish(req.get(), IOStatus::OK);
+    }
+    else {
+        req->Status = IOStatus::RequestEntityTooLarge;
+        req->ErrorDesc = "Destination buffer too small";
+    }
     req->Handled = true;
 }
 
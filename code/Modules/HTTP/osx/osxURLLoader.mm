@@ -3,6 +3,8 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "osxURLLoader.h"
+#include "HTTP/base/httpRange.h"
+#include "HTTP/base/httpCache.h"
 #include <Foundation/Foundation.h>
 #include <atomic>
 
@@ -39,6 +41,15 @@ osxURLLoader::doRequest(const Ptr<IORead>& req) {
 //------------------------------------------------------------------------------
 void
 osxURLLoader::doRequestInternal(const Ptr<IORead>& req) {
+    // invalid byte ranges fail without a request
+    httpRange range;
+    range.setup(req.get());
+    if (!range.isValid()) {
+        req->Status = IOStatus::RequestedRangeNotSatisfiable;
+        req->ErrorDesc = "Invalid range";
+        return;
+    }
+
     @autoreleasepool {
         
         // build an URL request
@@ -47,6 +58,7 @@ osxURLLoader::doRequestInternal(const Ptr<IORead>& req) {
         NSURL* url = [NSURL URLWithString:urlString];
         [urlRequest setURL:url];
         [urlRequest setHTTPMethod:@"GET"];
+        [urlRequest setTimeoutInterval:baseURLLoader::retryPolicy().Timeout.AsSeconds()];
         #if ORYOL_DEBUG
         [urlRequest setCachePolicy:NSURLRequestReloadIgnoringLocalCacheData];
         #endif
@@ -56,11 +68,26 @@ osxURLLoader::doRequestInternal(const Ptr<IORead>& req) {
         //              won't accept Connection: keep-alive
         //  Connection: keep-alive, don't open/close the connection all the time
         //  Accept-Encoding:    gzip, deflate
+        //  Range:      bytes=start-end if a byte range is requested
         //
         // FIXME: is this actually necessary on iOS?
         [urlRequest setValue:@"Mozilla/5.0" forHTTPHeaderField:@"User-Agent"];
         [urlRequest setValue:@"keep-alive" forHTTPHeaderField:@"Connection"];
         [urlRequest setValue:@"gzip, deflate" forHTTPHeaderField:@"Accept-Encoding"];
+        if (range.isRange()) {
+            char rangeValue[64];
+            range.rangeValue(rangeValue, sizeof(rangeValue));
+            NSString* rangeString = [NSString stringWithFormat:@"bytes=%s", rangeValue];
+            [urlRequest setValue:rangeString forHTTPHeaderField:@"Range"];
+        }
+        // conditional request headers to revalidate a cached response
+        Ptr<httpCacheRead> cacheRead = req->DynamicCast<httpCacheRead>();
+        if (cacheRead && !cacheRead->IfNoneMatch.Empty()) {
+            [urlRequest setValue:[NSString stringWithUTF8String:cacheRead->IfNoneMatch.AsCStr()] forHTTPHeaderField:@"If-None-Match"];
+        }
+        if (cacheRead && !cacheRead->IfModifiedSince.Empty()) {
+            [urlRequest setValue:[NSString stringWithUTF8String:cacheRead->IfModifiedSince.AsCStr()] forHTTPHeaderField:@"If-Modified-Since"];
+        }
 
         // now perform a synchronous request
         NSHTTPURLResponse* urlResponse = nil;
@@ -72,11 +99,28 @@ osxURLLoader::doRequestInternal(const Ptr<IORead>& req) {
             // extract HTTP status...
             req->Status = (IOStatus::Code) [urlResponse statusCode];
             
-            // extract response body...
+            // pick up the Content-Range of partial responses, and the caching headers
+            NSDictionary* headerFields = [urlResponse allHeaderFields];
+            for (NSString* name in headerFields) {
+                NSString* line = [NSString stringWithFormat:@"%@: %@", name, [headerFields objectForKey:name]];
+                const char* lineStr = [line UTF8String];
+                range.parseHeader(lineStr, (int) strlen(lineStr));
+                if (cacheRead) {
+                    cacheRead->parseHeader(lineStr, (int) strlen(lineStr));
+                }
+            }
+
+            // extract response body (cut down to the requested byte range)...
+            const int httpStatus = (int) [urlResponse statusCode];
             const uint8_t* responseBytes = (const uint8_t*) [responseData bytes];
             const int responseLength = (const int) [responseData length];
-            if (responseLength > 0) {
-                req->Data.Add(responseBytes, responseLength);
+            if (range.begin(req.get(), httpStatus, responseLength) &&
+                range.write(req.get(), responseBytes, responseLength)) {
+                range.finish(req.get(), httpStatus);
+            }
+            else {
+                req->Status = IOStatus::RequestEntityTooLarge;
+                req->ErrorDesc = "Destination buffer too small";
             }
         }
         else {
@@ -3,12 +3,16 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "pnaclURLLoader.h"
+#include "HTTP/base/httpRange.h"
+#include "Core/String/StringBuilder.h"
 #include "Core/pnacl/pnaclInstance.h"
 #include <ppapi/cpp/module.h>
 #include <ppapi/cpp/completion_callback.h>
 #include <ppapi/cpp/url_request_info.h>
 #include <ppapi/cpp/url_response_info.h>
 #include <ppapi/cpp/url_loader.h>
+#include <ppapi/cpp/var.h>
+#include <string>
 
 namespace Oryol {
 namespace _priv {
@@ -24,6 +28,13 @@ public:
         this->ppUrlRequestInfo.SetMethod("GET");
         String urlPath = req->Url.PathToEnd();
         this->ppUrlRequestInfo.SetURL(urlPath.AsCStr());
+        if (this->range.setup(req.get())) {
+            char rangeValue[64];
+            this->range.rangeValue(rangeValue, sizeof(rangeValue));
+            StringBuilder strBuilder;
+            strBuilder.Format(128, "Range: bytes=%s", rangeValue);
+            this->ppUrlRequestInfo.SetHeaders(strBuilder.AsCStr());
+        }
         this->ppUrlLoader = pp::URLLoader(ppInst);
     };
     virtual ~pnaclRequestWrapper() {
@@ -32,14 +43,26 @@ public:
         this->ppUrlRequestInfo = pp::URLRequestInfo();
     }
 
+    bool addBodyData(int32_t size) {
+        if (!this->range.write(this->ioRequest.get(), this->readBuffer, size)) {
+            this->ioRequest->ErrorDesc = "Destination buffer too small";
+            return false;
+        }
+        return true;
+    }
+
     void readBodyData() {
-        auto& responseBody = this->ioRequest->Data;
         pp::CompletionCallback cc = pp::CompletionCallback(pnaclURLLoader::cbOnRead, this);
         int32_t result = PP_OK;
         do {
+            if (this->range.complete()) {
+                // the server has ignored the range, the rest isn't needed
+                result = PP_OK;
+                break;
+            }
             result = this->ppUrlLoader.ReadResponseBody(this->readBuffer, ReadBufferSize, cc);
-            if (result > 0) {
-                responseBody.Add(this->readBuffer, result);
+            if ((result > 0) && !this->addBodyData(result)) {
+                result = PP_ERROR_NOMEMORY;
             }
         }
         while (result > 0);
@@ -51,6 +74,7 @@ public:
     Ptr<IORead> ioRequest;
     pp::URLRequestInfo ppUrlRequestInfo;
     pp::URLLoader ppUrlLoader;
+    httpRange range;
     static const int ReadBufferSize = 4096;
     uint8_t readBuffer[ReadBufferSize];
 };
@@ -73,6 +97,16 @@ void
 pnaclURLLoader::startRequest(const Ptr<IORead>& req) {
     o_assert(req.isValid() && !req->Handled);
 
+    // invalid byte ranges fail without a request
+    httpRange range;
+    range.setup(req.get());
+    if (!range.isValid()) {
+        req->Status = IOStatus::RequestedRangeNotSatisfiable;
+        req->ErrorDesc = "Invalid range";
+        req->Handled = true;
+        return;
+    }
+
     // bump the requests refcount and get a raw pointer
     IORead* reqPtr = req.get();
     reqPtr->addRef();
@@ -107,7 +141,24 @@ pnaclURLLoader::cbRequestComplete(void* data, int32_t result) {
     o_assert(!req->ppUrlLoader.GetResponseInfo().is_null());
     IOStatus::Code httpStatus = (IOStatus::Code) req->ppUrlLoader.GetResponseInfo().GetStatusCode();
     req->ioRequest->Status = httpStatus;
-    if (httpStatus == IOStatus::OK) {
+    if (req->range.isRange()) {
+        // pick up the Content-Range of partial responses
+        pp::Var headers = req->ppUrlLoader.GetResponseInfo().GetHeaders();
+        if (headers.is_string()) {
+            const std::string str = headers.AsString();
+            size_t lineStart = 0;
+            while (lineStart < str.size()) {
+                size_t lineEnd = str.find('\n', lineStart);
+                if (std::string::npos == lineEnd) {
+                    lineEnd = str.size();
+                }
+                req->range.parseHeader(str.c_str() + lineStart, int(lineEnd - lineStart));
+                lineStart = lineEnd + 1;
+            }
+        }
+    }
+    if ((httpStatus == IOStatus::OK) || (httpStatus == IOStatus::PartialContent)) {
+        req->range.begin(req->ioRequest.get(), httpStatus, -1);
         // response header received ok, start loading response body,
         // first get the immediately available data now, and maybe
         // do async call to fetch the rest
@@ -118,6 +169,7 @@ pnaclURLLoader::cbRequestComplete(void* data, int32_t result) {
         // HTTP error, dump a warning, and cleanup
         Log::Warn("pnaclURLLoader::cbRequestComplete: GET '%s' returned with '%d'\n", 
             req->ioRequest->Url.AsCStr(), httpStatus);
+        req->range.finish(req->ioRequest.get(), httpStatus);
         req->ioRequest->Handled = true;
         req->release();
     }
@@ -129,7 +181,8 @@ pnaclURLLoader::cbOnRead(void* data, int32_t result) {
     Ptr<pnaclRequestWrapper> req((pnaclRequestWrapper*)data);
     if (PP_OK == result)
     {
-        // all data received
+        // all data received (or the complete byte range)
+        req->range.finish(req->ioRequest.get(), req->ioRequest->Status);
         req->ioRequest->Handled = true;
         req->release();
     }
@@ -137,14 +190,26 @@ pnaclURLLoader::cbOnRead(void* data, int32_t result) {
     {
         // read all available data..., do not release the pnaclRequestWrapper
         // since it is still needed in the following callbacks
-        req->ioRequest->Data.Add(req->readBuffer, result);
-        req->readBodyData();
+        if (req->addBodyData(result)) {
+            req->readBodyData();
+        }
+        else {
+            req->ioRequest->Status = IOStatus::RequestEntityTooLarge;
+            req->ioRequest->Handled = true;
+            req->release();
+        }
     }
     else
     {
         // an error occurred
         Log::Warn("pnaclURLLoader::cbOnRead: Error while reading body data.\n");
-        req->ioRequest->Status = IOStatus::DownloadError;
+        if (PP_ERROR_NOMEMORY == result) {
+            // destination memory too small, see addBodyData()
+            req->ioRequest->Status = IOStatus::RequestEntityTooLarge;
+        }
+        else {
+            req->ioRequest->Status = IOStatus::DownloadError;
+        }
         req->ioRequest->Handled = true;
         req->release();
     }
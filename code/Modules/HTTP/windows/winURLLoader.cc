@@ -3,6 +3,8 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "winURLLoader.h"
+#include "HTTP/base/httpRange.h"
+#include "HTTP/base/httpCache.h"
 #include "Core/String/StringConverter.h"
 #define VC_EXTRALEAN (1)
 #define WIN32_LEAN_AND_MEAN (1)
@@ -53,6 +55,15 @@ void
 winURLLoader::doRequestInternal(const Ptr<IORead>& req) {
     Log::Info("winURLLoader::doOneRequest() start: %s\n", req->Url.AsCStr());
 
+    // invalid byte ranges fail without a request
+    httpRange range;
+    range.setup(req.get());
+    if (!range.isValid()) {
+        req->Status = IOStatus::RequestedRangeNotSatisfiable;
+        req->ErrorDesc = "Invalid range";
+        return;
+    }
+
     // obtain a connection
     HINTERNET hConn = this->obtainConnection(req->Url);
     if (NULL != hConn) {
@@ -68,15 +79,40 @@ winURLLoader::doRequestInternal(const Ptr<IORead>& req) {
             WINHTTP_DEFAULT_ACCEPT_TYPES,   // pwszAcceptTypes
             WINHTTP_FLAG_ESCAPE_PERCENT);   // dwFlags
         if (NULL != hRequest) {
+
+            // apply the request timeouts (retries are only implemented by the curl loader)
+            const HTTPRetryPolicy policy = baseURLLoader::retryPolicy();
+            const int timeoutMs = int(policy.Timeout.AsMilliSeconds());
+            const int connectTimeoutMs = int(policy.ConnectTimeout.AsMilliSeconds());
+            WinHttpSetTimeouts(hRequest, connectTimeoutMs, connectTimeoutMs, timeoutMs, timeoutMs);
             
-            // add request headers to the request
-            const wchar_t* reqHeaders = 
-                L"User-Agent: Mozilla/5.0\r\n"
-                L"Connection: keep-alive\r\n"
-                L"Accept-Encoding: gzip, deflate";
+            // add request headers to the request (no content encoding
+            // for reads into caller memory and byte ranges, the Content-Length
+            // and Content-Range must match the body)
+            this->stringBuilder.Set("User-Agent: Mozilla/5.0\r\nConnection: keep-alive");
+            if (!req->HasDest() && !range.isRange()) {
+                this->stringBuilder.Append("\r\nAccept-Encoding: gzip, deflate");
+            }
+            if (range.isRange()) {
+                char rangeValue[64];
+                range.rangeValue(rangeValue, sizeof(rangeValue));
+                this->stringBuilder.Append("\r\nRange: bytes=");
+                this->stringBuilder.Append(rangeValue);
+            }
+            // conditional request headers to revalidate a cached response
+            Ptr<httpCacheRead> cacheRead = req->DynamicCast<httpCacheRead>();
+            if (cacheRead && !cacheRead->IfNoneMatch.Empty()) {
+                this->stringBuilder.Append("\r\nIf-None-Match: ");
+                this->stringBuilder.Append(cacheRead->IfNoneMatch);
+            }
+            if (cacheRead && !cacheRead->IfModifiedSince.Empty()) {
+                this->stringBuilder.Append("\r\nIf-Modified-Since: ");
+                this->stringBuilder.Append(cacheRead->IfModifiedSince);
+            }
+            WideString reqHeaders(StringConverter::UTF8ToWide(this->stringBuilder.GetString()));
             BOOL headerResult = WinHttpAddRequestHeaders(
                 hRequest, 
-                reqHeaders, -1L, 
+                reqHeaders.AsCStr(), -1L, 
                 WINHTTP_ADDREQ_FLAG_ADD|WINHTTP_ADDREQ_FLAG_REPLACE);
             o_assert(headerResult);
 
@@ -105,22 +141,78 @@ winURLLoader::doRequestInternal(const Ptr<IORead>& req) {
                         NULL);
                     req->Status = (IOStatus::Code) dwStatusCode;
 
+                    // pick up the Content-Range of partial responses
+                    if (range.isRange()) {
+                        wchar_t contentRange[128];
+                        dwTemp = sizeof(contentRange);
+                        if (WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_CONTENT_RANGE,
+                                WINHTTP_HEADER_NAME_BY_INDEX, contentRange, &dwTemp, WINHTTP_NO_HEADER_INDEX)) {
+                            this->stringBuilder.Set("Content-Range: ");
+                            this->stringBuilder.Append(StringConverter::WideToUTF8(contentRange));
+                            range.parseHeader(this->stringBuilder.AsCStr(), this->stringBuilder.Length());
+                        }
+                    }
+
+                    // pick up the caching headers of responses to be cached
+                    if (cacheRead) {
+                        static const struct { DWORD query; const char* name; } cacheHeaders[] = {
+                            { WINHTTP_QUERY_ETAG, "ETag: " },
+                            { WINHTTP_QUERY_LAST_MODIFIED, "Last-Modified: " },
+                            { WINHTTP_QUERY_CACHE_CONTROL, "Cache-Control: " },
+                        };
+                        for (const auto& header : cacheHeaders) {
+                            wchar_t value[512];
+                            dwTemp = sizeof(value);
+                            if (WinHttpQueryHeaders(hRequest, header.query,
+                                    WINHTTP_HEADER_NAME_BY_INDEX, value, &dwTemp, WINHTTP_NO_HEADER_INDEX)) {
+                                this->stringBuilder.Set(header.name);
+                                this->stringBuilder.Append(StringConverter::WideToUTF8(value));
+                                cacheRead->parseHeader(this->stringBuilder.AsCStr(), this->stringBuilder.Length());
+                            }
+                        }
+                    }
+
+                    // validate (or obtain) caller-provided destination memory
+                    // for the whole body if the content length is known
+                    DWORD contentLength = 0;
+                    dwTemp = sizeof(contentLength);
+                    int64_t bodySize = -1;
+                    if (WinHttpQueryHeaders(hRequest,
+                            WINHTTP_QUERY_CONTENT_LENGTH|WINHTTP_QUERY_FLAG_NUMBER,
+                            NULL, &contentLength, &dwTemp, NULL)) {
+                        bodySize = contentLength;
+                    }
+                    bool destTooSmall = !range.begin(req.get(), dwStatusCode, bodySize);
+
                     // extract body data
                     DWORD bytesToRead = 0;
                     do {
                         // how much data available?
                         BOOL queryDataResult = WinHttpQueryDataAvailable(hRequest, &bytesToRead);
                         o_assert(queryDataResult);
-                        if (bytesToRead > 0) {
-                            uint8_t* dstPtr = req->Data.Add(bytesToRead);
-                            o_assert(nullptr != dstPtr);
+                        if ((bytesToRead > 0) && !destTooSmall) {
+                            if (range.complete()) {
+                                // the server has ignored the range, the rest isn't needed
+                                break;
+                            }
+                            this->readBuffer.Clear();
+                            uint8_t* dstPtr = this->readBuffer.Add(int(bytesToRead));
                             DWORD bytesRead = 0;
                             BOOL readDataResult = WinHttpReadData(hRequest, dstPtr, bytesToRead, &bytesRead);
                             o_assert(readDataResult);
                             o_assert(bytesRead == bytesToRead);
+                            destTooSmall = !range.write(req.get(), dstPtr, bytesRead);
+                        }
+                        if (destTooSmall) {
+                            req->Status = IOStatus::RequestEntityTooLarge;
+                            req->ErrorDesc = "Destination buffer too small";
+                            break;
                         }
                     }
                     while (bytesToRead > 0);
+                    if (!destTooSmall) {
+                        range.finish(req.get(), dwStatusCode);
+                    }
 
                     // @todo: write error desc to msg if something went wrong
                 }
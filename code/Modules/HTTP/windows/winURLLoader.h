@@ -10,6 +10,7 @@
     which will expire after a couple of seconds.
  */
 #include "HTTP/base/baseURLLoader.h"
+#include "Core/Containers/Buffer.h"
 #include "Core/String/StringBuilder.h"
 #include <chrono>
 
@@ -44,6 +45,7 @@ private:
     };
     Map<String, connection> connections;
     StringBuilder stringBuilder;
+    Buffer readBuffer;
 };
     
 } // namespace _priv
@@ -0,0 +1,34 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::IOCacheStats
+    @ingroup IO
+    @brief statistics of the IO read cache
+
+    @see IO::QueryCacheStats()
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+
+class IOCacheStats {
+public:
+    /// number of reads served from the in-memory cache
+    int NumHits = 0;
+    /// number of reads not found in the in-memory cache
+    int NumMisses = 0;
+    /// number of reads served from the on-disk cache
+    int NumDiskHits = 0;
+    /// number of entries written to the on-disk cache
+    int NumDiskWrites = 0;
+    /// number of entries evicted from the in-memory cache
+    int NumEvictions = 0;
+    /// current number of entries in the in-memory cache
+    int NumEntries = 0;
+    /// current number of bytes in the in-memory cache
+    int NumBytes = 0;
+    /// byte budget of the in-memory cache
+    int Budget = 0;
+};
+
+} // namespace Oryol
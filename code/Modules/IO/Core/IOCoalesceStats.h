@@ -0,0 +1,24 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::IOCoalesceStats
+    @ingroup IO
+    @brief statistics of IORead coalescing in the IO workers
+
+    @see IO::QueryCoalesceStats(), IOSetup::CoalesceReads
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+
+class IOCoalesceStats {
+public:
+    /// number of IORead requests served by an identical in-flight request
+    int NumCoalesced = 0;
+    /// number of IORead requests served by a merged read of a larger range
+    int NumMerged = 0;
+    /// number of filesystem reads issued for coalesced or merged requests
+    int NumGroupReads = 0;
+};
+
+} // namespace Oryol
@@ -13,6 +13,14 @@ class IOConfig {
 public:
     /// number of IO workers (== number of HTTP connections)
     static const int NumWorkers = 4;
+    /// size of chunks read from the filesystem for decompressed IORead requests
+    static const int DecompressChunkSize = 64 * 1024;
+    /// default max number of in-flight chunk reads per IO::LoadStream()
+    static const int MaxStreamChunksInFlight = 4;
+    /// max size of a merged range read (see IOSetup::MergeReads)
+    static const int MaxMergedReadSize = 1024 * 1024;
+    /// max time in milliseconds an IO worker waits in a busy asynchronous filesystem
+    static const int MaxFileSystemWaitMs = 100;
 };
 
 } // namespace Oryol
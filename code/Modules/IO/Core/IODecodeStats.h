@@ -0,0 +1,47 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::IODecodeStats
+    @ingroup IO
+    @brief statistics of the IO decompression stage
+
+    @see IO::QueryDecodeStats()
+*/
+#include "Core/Types.h"
+#include "Core/Time/Duration.h"
+
+namespace Oryol {
+
+class IODecodeStats {
+public:
+    /// number of successfully decompressed IORead requests
+    int NumDecoded = 0;
+    /// number of IORead requests which failed to decompress
+    int NumFailed = 0;
+    /// number of compressed bytes consumed
+    int64_t NumBytesIn = 0;
+    /// number of decompressed bytes produced
+    int64_t NumBytesOut = 0;
+    /// accumulated time spent decompressing (excluding IO)
+    Duration DecodeTime;
+
+    /// get the compression ratio (decompressed / compressed size)
+    double Ratio() const;
+    /// get the decode throughput in decompressed MBytes per second
+    double Throughput() const;
+};
+
+//------------------------------------------------------------------------------
+inline double
+IODecodeStats::Ratio() const {
+    return (this->NumBytesIn > 0) ? double(this->NumBytesOut) / double(this->NumBytesIn) : 0.0;
+}
+
+//------------------------------------------------------------------------------
+inline double
+IODecodeStats::Throughput() const {
+    const double s = this->DecodeTime.AsSeconds();
+    return (s > 0.0) ? (double(this->NumBytesOut) / (1024.0 * 1024.0)) / s : 0.0;
+}
+
+} // namespace Oryol
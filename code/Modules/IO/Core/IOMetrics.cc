@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+//  IOMetrics.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "IOMetrics.h"
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+void
+IOLatencyHistogram::Add(Duration d) {
+    const int64_t us = int64_t(d.AsMicroSeconds());
+    int bucketIndex = 0;
+    while ((bucketIndex < (NumBuckets - 1)) && (us >= (int64_t(1) << bucketIndex))) {
+        bucketIndex++;
+    }
+    this->Buckets[bucketIndex]++;
+    this->Count++;
+    this->Total += d;
+    if (d > this->Max) {
+        this->Max = d;
+    }
+}
+
+//------------------------------------------------------------------------------
+Duration
+IOLatencyHistogram::Average() const {
+    if (this->Count > 0) {
+        return Duration::FromMicroSeconds(this->Total.AsMicroSeconds() / this->Count);
+    }
+    else {
+        return Duration();
+    }
+}
+
+//------------------------------------------------------------------------------
+Duration
+IOLatencyHistogram::Percentile(float p) const {
+    if (0 == this->Count) {
+        return Duration();
+    }
+    // find the bucket which contains the requested sample, and return
+    // its upper limit (but never more than the longest sample)
+    int sampleIndex = int((p / 100.0f) * this->Count);
+    if (sampleIndex >= this->Count) {
+        sampleIndex = this->Count - 1;
+    }
+    int num = 0;
+    for (int i = 0; i < NumBuckets; i++) {
+        num += this->Buckets[i];
+        if (num > sampleIndex) {
+            const Duration limit = BucketLimit(i);
+            return limit < this->Max ? limit : this->Max;
+        }
+    }
+    return this->Max;
+}
+
+//------------------------------------------------------------------------------
+Duration
+IOLatencyHistogram::BucketLimit(int bucketIndex) {
+    o_assert_dbg((bucketIndex >= 0) && (bucketIndex < NumBuckets));
+    return Duration::FromMicroSeconds(double(int64_t(1) << bucketIndex));
+}
+
+} // namespace Oryol
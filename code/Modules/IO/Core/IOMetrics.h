@@ -0,0 +1,101 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::IOMetrics
+    @ingroup IO
+    @brief throughput, latency and queue depth metrics of the IO system
+
+    Requests are counted when they are handled by an IO worker, per URL
+    scheme and per worker. Latencies are measured for each request
+    from IO::Put() until a worker starts to handle the request
+    (QueueWait), from then until the request is handled (Service),
+    and for IO::Load(), IO::LoadGroup() and IO::LoadStream() requests
+    from IO::Put() until the result is delivered on the main thread
+    (EndToEnd).
+
+    @see IO::QueryMetrics(), IO::ResetMetrics(), IO::LogMetrics(), IOSetup::MetricsEnabled
+*/
+#include "Core/Types.h"
+#include "Core/Time/Duration.h"
+#include "Core/String/String.h"
+#include "Core/Containers/Map.h"
+#include "Core/Containers/StaticArray.h"
+#include "IO/Core/IOConfig.h"
+
+namespace Oryol {
+
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::IOLatencyHistogram
+    @ingroup IO
+    @brief a latency histogram with power-of-2 microsecond buckets
+
+    Bucket 0 counts latencies below 1 microsecond, bucket i counts
+    latencies from 2^(i-1) up to 2^i microseconds, the last bucket
+    also counts all longer latencies.
+*/
+class IOLatencyHistogram {
+public:
+    /// number of histogram buckets
+    static const int NumBuckets = 32;
+    /// number of samples per bucket
+    int Buckets[NumBuckets] = { };
+    /// total number of samples
+    int Count = 0;
+    /// sum of all samples
+    Duration Total;
+    /// longest sample
+    Duration Max;
+
+    /// add a sample
+    void Add(Duration d);
+    /// get the average latency
+    Duration Average() const;
+    /// get the approximate latency percentile (p in 0..100) as bucket upper limit
+    Duration Percentile(float p) const;
+    /// get the upper limit of a bucket
+    static Duration BucketLimit(int bucketIndex);
+};
+
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::IORequestCounters
+    @ingroup IO
+    @brief request counters of the IO system
+*/
+class IORequestCounters {
+public:
+    /// number of handled requests (including failed and cancelled requests)
+    int NumRequests = 0;
+    /// number of failed requests
+    int NumFailed = 0;
+    /// number of cancelled requests
+    int NumCancelled = 0;
+    /// number of read and written bytes of successful requests
+    int64_t NumBytes = 0;
+};
+
+//------------------------------------------------------------------------------
+class IOMetrics {
+public:
+    /// request counters of all schemes and workers
+    IORequestCounters Total;
+    /// request counters by URL scheme
+    Map<String, IORequestCounters> Schemes;
+    /// request counters by IO worker
+    StaticArray<IORequestCounters, IOConfig::NumWorkers> Workers;
+    /// current number of requests waiting in each IO worker's queue
+    int QueueDepths[IOConfig::NumWorkers] = { };
+    /// current number of pending IO::Load(), LoadGroup() and LoadStream() actions
+    int NumPendingLoads = 0;
+    /// time from IO::Put() until a worker starts handling the request
+    IOLatencyHistogram QueueWait;
+    /// time from start of handling until the request is handled
+    IOLatencyHistogram Service;
+    /// time from IO::Put() until the result is delivered on the main thread
+    IOLatencyHistogram EndToEnd;
+    /// time span covered by the metrics (since setup or last reset)
+    Duration Elapsed;
+};
+
+} // namespace Oryol
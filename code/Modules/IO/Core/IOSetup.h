@@ -19,6 +19,16 @@ public:
     Map<String, String> Assigns;
     /// initial file systems
     Map<StringAtom, std::function<Ptr<FileSystem>()>> FileSystems;
+    /// byte budget of the in-memory read cache (0 disables the memory cache)
+    int CacheBudget = 0;
+    /// optional directory URL of a persistent read cache (directory must exist)
+    String CacheDir;
+    /// serve identical IORead requests which are in flight at the same time with a single read
+    bool CoalesceReads = true;
+    /// also merge in-flight reads of overlapping or adjacent ranges of the same file into one read
+    bool MergeReads = false;
+    /// record request counters and latencies (see IO::QueryMetrics())
+    bool MetricsEnabled = true;
 };
     
 } // namespace Oryol
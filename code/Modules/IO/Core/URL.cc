@@ -6,6 +6,7 @@
 #include "Core/String/StringBuilder.h"
 #include "Core/Log.h"
 #include "IO/IO.h"
+#include <cstring>
 
 namespace Oryol {
 
@@ -58,14 +59,13 @@ valid(false) {
 //------------------------------------------------------------------------------
 URL::URL(const StringAtom& rhs) :
 valid(false) {
-    this->crack(rhs.AsString());
+    this->crack(rhs.AsCStr());
 }
     
 //------------------------------------------------------------------------------
 URL::URL(const String& rhs) :
-content(rhs),
 valid(false) {
-    this->crack(rhs);
+    this->crack(rhs.AsCStr());
 }
     
 //------------------------------------------------------------------------------
@@ -94,22 +94,19 @@ URL::operator=(URL&& rhs) {
 //------------------------------------------------------------------------------
 void
 URL::operator=(const char* rhs) {
-    this->content = rhs;
     this->crack(rhs);
 }
     
 //------------------------------------------------------------------------------
 void
 URL::operator=(const StringAtom& rhs) {
-    this->content = rhs;
-    this->crack(rhs.AsString());
+    this->crack(rhs.AsCStr());
 }
     
 //------------------------------------------------------------------------------
 void
 URL::operator=(const String& rhs) {
-    this->content = rhs;
-    this->crack(rhs);
+    this->crack(rhs.AsCStr());
 }
     
 //------------------------------------------------------------------------------
@@ -150,119 +147,129 @@ URL::Empty() const {
 
 //------------------------------------------------------------------------------
 void
-URL::crack(String urlString) {
+URL::crack(const char* str) {
 
-    this->content.Clear();
     this->clearIndices();
     this->valid = false;
-    
+
+    // resolve assigns into a stack buffer, only very long
+    // URLs need to be resolved into a temporary String
+    char buf[MaxResolvedLength];
+    String longUrlString;
+    const char* urlString = str ? str : "";
     if (IO::IsValid()) {
-        urlString = IO::ResolveAssigns(urlString);
+        urlString = IO::state->assignReg.ResolveAssigns(urlString, buf, sizeof(buf));
+        if (nullptr == urlString) {
+            longUrlString = IO::state->assignReg.ResolveAssigns(String(str));
+            urlString = longUrlString.AsCStr();
+        }
+    }
+    if (0 == urlString[0]) {
+        this->content.Clear();
+        return;
+    }
+
+    // NOTE: this only allocates if the string isn't interned yet
+    this->content = urlString;
+    const char* ptr = this->content.AsCStr();
+    const int length = int(std::strlen(ptr));
+
+    // extract scheme
+    this->indices[schemeStart] = 0;
+    this->indices[schemeEnd] = StringBuilder::FindSubString(ptr, 0, 8, "://");
+    if (EndOfString == this->indices[schemeEnd]) {
+        o_warn("URL::crack(): '%s' is not a valid URL!\n", ptr);
+        this->clearIndices();
+        return;
     }
-    if (urlString.IsValid()) {
     
-        StringBuilder builder;
-        builder.Set(urlString);
-        this->content = urlString;
+    // extract host fields
+    int leftStartIndex = this->indices[schemeEnd] + 3;
+    int leftEndIndex = StringBuilder::FindFirstOf(ptr, leftStartIndex, EndOfString, "/");
+    if (EndOfString == leftEndIndex) {
+        leftEndIndex = length;
+    }
+    if (leftStartIndex != leftEndIndex) {
+        // extract user and password
+        int userAndPwdEndIndex = StringBuilder::FindFirstOf(ptr, leftStartIndex, leftEndIndex, "@");
+        if (EndOfString != userAndPwdEndIndex) {
+            // only user, or user:pwd?
+            int userEndIndex = StringBuilder::FindFirstOf(ptr, leftStartIndex, userAndPwdEndIndex, ":");
+            if (EndOfString != userEndIndex) {
+                // user and password
+                this->indices[userStart] = leftStartIndex;
+                this->indices[userEnd]   = userEndIndex;
+                this->indices[pwdStart]  = userEndIndex + 1;
+                this->indices[pwdEnd]    = userAndPwdEndIndex;
+            }
+            else {
+                // only user
+                this->indices[userStart] = leftStartIndex;
+                this->indices[userEnd]   = userAndPwdEndIndex;
+            }
+            leftStartIndex = userAndPwdEndIndex + 1;
+        }
         
-        // extract scheme
-        this->indices[schemeStart] = 0;
-        this->indices[schemeEnd] = builder.FindSubString(0, 8, "://");
-        if (EndOfString == this->indices[schemeEnd]) {
-            o_warn("URL::crack(): '%s' is not a valid URL!\n", this->content.AsCStr());
-            this->clearIndices();
-            return;
+        // extract host and port
+        int hostEndIndex = StringBuilder::FindFirstOf(ptr, leftStartIndex, leftEndIndex, ":");
+        if (EndOfString != hostEndIndex) {
+            // host and port
+            this->indices[hostStart] = leftStartIndex;
+            this->indices[hostEnd]   = hostEndIndex;
+            this->indices[portStart] = hostEndIndex + 1;
+            this->indices[portEnd]   = leftEndIndex;
+        }
+        else {
+            // only host name, no port
+            this->indices[hostStart] = leftStartIndex;
+            this->indices[hostEnd]   = leftEndIndex;
         }
+    }
+    
+    // is there any path component?
+    if (leftEndIndex != length) {
+        // extract right-hand-side (path, fragment, query)
+        int rightStartIndex = leftEndIndex + 1;
+        int rightEndIndex = length;
         
-        // extract host fields
-        int leftStartIndex = this->indices[schemeEnd] + 3;
-        int leftEndIndex = builder.FindFirstOf(leftStartIndex, EndOfString, "/");
-        if (EndOfString == leftEndIndex) {
-            leftEndIndex = builder.Length();
+        int pathStartIndex = rightStartIndex;
+        int pathEndIndex = StringBuilder::FindFirstOf(ptr, rightStartIndex, rightEndIndex, "#?");
+        if (EndOfString == pathEndIndex) {
+            pathEndIndex = rightEndIndex;
+        }
+        if (pathStartIndex != pathEndIndex) {
+            this->indices[pathStart] = pathStartIndex;
+            this->indices[pathEnd]   = pathEndIndex;
         }
-        if (leftStartIndex != leftEndIndex) {
-            // extract user and password
-            int userAndPwdEndIndex = builder.FindFirstOf(leftStartIndex, leftEndIndex, "@");
-            if (EndOfString != userAndPwdEndIndex) {
-                // only user, or user:pwd?
-                int userEndIndex = builder.FindFirstOf(leftStartIndex, userAndPwdEndIndex, ":");
-                if (EndOfString != userEndIndex) {
-                    // user and password
-                    this->indices[userStart] = leftStartIndex;
-                    this->indices[userEnd]   = userEndIndex;
-                    this->indices[pwdStart]  = userEndIndex + 1;
-                    this->indices[pwdEnd]    = userAndPwdEndIndex;
-                }
-                else {
-                    // only user
-                    this->indices[userStart] = leftStartIndex;
-                    this->indices[userEnd]   = userAndPwdEndIndex;
-                }
-                leftStartIndex = userAndPwdEndIndex + 1;
+
+        // extract query
+        if ((pathEndIndex != rightEndIndex) && (ptr[pathEndIndex] == '?')) {
+            int queryStartIndex = pathEndIndex + 1;
+            int queryEndIndex = StringBuilder::FindFirstOf(ptr, queryStartIndex, rightEndIndex, "#");
+            if (EndOfString == queryEndIndex) {
+                queryEndIndex = rightEndIndex;
             }
-            
-            // extract host and port
-            int hostEndIndex = builder.FindFirstOf(leftStartIndex, leftEndIndex, ":");
-            if (EndOfString != hostEndIndex) {
-                // host and port
-                this->indices[hostStart] = leftStartIndex;
-                this->indices[hostEnd]   = hostEndIndex;
-                this->indices[portStart] = hostEndIndex + 1;
-                this->indices[portEnd]   = leftEndIndex;
-            }
-            else {
-                // only host name, no port
-                this->indices[hostStart] = leftStartIndex;
-                this->indices[hostEnd]   = leftEndIndex;
+            if (queryStartIndex != queryEndIndex) {
+                this->indices[queryStart] = queryStartIndex;
+                this->indices[queryEnd] = queryEndIndex;
             }
+            pathEndIndex = queryEndIndex;
         }
         
-        // is there any path component?
-        if (leftEndIndex != builder.Length()) {
-            // extract right-hand-side (path, fragment, query)
-            int rightStartIndex = leftEndIndex + 1;
-            int rightEndIndex = builder.Length();
-            
-            int pathStartIndex = rightStartIndex;
-            int pathEndIndex = builder.FindFirstOf(rightStartIndex, rightEndIndex, "#?");
-            if (EndOfString == pathEndIndex) {
-                pathEndIndex = rightEndIndex;
-            }
-            if (pathStartIndex != pathEndIndex) {
-                this->indices[pathStart] = pathStartIndex;
-                this->indices[pathEnd]   = pathEndIndex;
-            }
-
-            // extract query
-            if ((pathEndIndex != rightEndIndex) && (builder.At(pathEndIndex) == '?')) {
-                int queryStartIndex = pathEndIndex + 1;
-                int queryEndIndex = builder.FindFirstOf(queryStartIndex, rightEndIndex, "#");
-                if (EndOfString == queryEndIndex) {
-                    queryEndIndex = rightEndIndex;
-                }
-                if (queryStartIndex != queryEndIndex) {
-                    this->indices[queryStart] = queryStartIndex;
-                    this->indices[queryEnd] = queryEndIndex;
-                }
-                pathEndIndex = queryEndIndex;
+        // extract fragment
+        if ((pathEndIndex != rightEndIndex) && (ptr[pathEndIndex] == '#')) {
+            int fragStartIndex = pathEndIndex + 1;
+            int fragEndIndex = StringBuilder::FindFirstOf(ptr, fragStartIndex, rightEndIndex, "?");
+            if (EndOfString == fragEndIndex) {
+                fragEndIndex = rightEndIndex;
             }
-            
-            // extract fragment
-            if ((pathEndIndex != rightEndIndex) && (builder.At(pathEndIndex) == '#')) {
-                int fragStartIndex = pathEndIndex + 1;
-                int fragEndIndex = builder.FindFirstOf(fragStartIndex, rightEndIndex, "?");
-                if (EndOfString == fragEndIndex) {
-                    fragEndIndex = rightEndIndex;
-                }
-                if (fragStartIndex != fragEndIndex) {
-                    this->indices[fragStart] = fragStartIndex;
-                    this->indices[fragEnd] = fragEndIndex;
-                }
+            if (fragStartIndex != fragEndIndex) {
+                this->indices[fragStart] = fragStartIndex;
+                this->indices[fragEnd] = fragEndIndex;
             }
         }
-        this->valid = true;
     }
-    // fallthrough if valid or empty URL
+    this->valid = true;
 }
 
 //------------------------------------------------------------------------------
@@ -271,6 +278,20 @@ URL::HasScheme() const {
     return InvalidIndex != this->indices[schemeStart];
 }
 
+//------------------------------------------------------------------------------
+bool
+URL::HasScheme(const char* scheme) const {
+    o_assert_dbg(scheme);
+    if (this->HasScheme()) {
+        const int len = this->indices[schemeEnd] - this->indices[schemeStart];
+        const char* ptr = this->content.AsCStr() + this->indices[schemeStart];
+        return (0 == std::strncmp(ptr, scheme, len)) && (0 == scheme[len]);
+    }
+    else {
+        return false;
+    }
+}
+
 //------------------------------------------------------------------------------
 String
 URL::Scheme() const {
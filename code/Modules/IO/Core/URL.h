@@ -10,7 +10,9 @@
     parsed and indices to its parts will be stored internally, this
     is quite fast. The actual URL string will be stored as a StringAtom.
     Expensive String construction only happens when actually getting
-    the URL parts. 
+    the URL parts. Resolving assigns and parsing doesn't allocate
+    memory unless the URL string isn't interned yet, or the resolved
+    URL is longer than URL::MaxResolvedLength.
     
     @see URLBuilder
 */
@@ -24,6 +26,9 @@ namespace Oryol {
 class URL
 {
 public:
+    /// max length of resolved URLs which are resolved without allocation
+    static const int MaxResolvedLength = 1024;
+
     /// default constructor
     URL();
     /// copy constructor
@@ -64,6 +69,8 @@ public:
     
     /// test if the URL has a scheme
     bool HasScheme() const;
+    /// test if the URL has a specific scheme (without allocation)
+    bool HasScheme(const char* scheme) const;
     /// get the scheme string
     String Scheme() const;
     /// test if the URL has a user string
@@ -100,8 +107,8 @@ public:
     String PathToEnd() const;
     
 private:
-    /// crack URL, populates string indices
-    void crack(String urlString);
+    /// resolve assigns and crack URL, populates string indices
+    void crack(const char* str);
     /// clear string indices
     void clearIndices();
     /// copy string indices
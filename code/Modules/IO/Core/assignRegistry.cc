@@ -4,6 +4,8 @@
 #include "Pre.h"
 #include "assignRegistry.h"
 #include "Core/String/StringBuilder.h"
+#include "Core/Memory/Memory.h"
+#include <cstring>
 
 namespace Oryol {
 namespace _priv {
@@ -23,6 +25,7 @@ assignRegistry::SetAssign(const String& assign, const String& path) {
     else {
         this->assigns.Add(assign, path);
     }
+    this->updateResolved();
     this->rwLock.UnlockWrite();
 }
 
@@ -51,35 +54,125 @@ assignRegistry::LookupAssign(const String& assign) const {
 }
 
 //------------------------------------------------------------------------------
-String
-assignRegistry::ResolveAssigns(const String& str) const {
+void
+assignRegistry::updateResolved() {
+    this->resolved.Clear();
+    this->resolved.BeginBulk();
+    for (const auto& kvp : this->assigns) {
+        StringBuilder builder;
+        builder.Set(kvp.Value());
 
-    this->rwLock.LockRead();
-    
-    StringBuilder builder;
-    builder.Set(str);
-    
-    // while there are assigns to replace...
-    int index;
-    while ((index = builder.FindFirstOf(0, EndOfString, ":")) != EndOfString) {
-        // ignore DOS drive letters
-        if (index > 1) {
-            String assignString = builder.GetSubString(0, index + 1);
+        // while there are assigns to replace (with a limit for cyclic assigns)...
+        int index;
+        int depth = 0;
+        while ((index = builder.FindFirstOf(0, EndOfString, ":")) != EndOfString) {
+            // ignore DOS drive letters
+            if ((index > 1) && (depth++ < 16)) {
+                String assignString = builder.GetSubString(0, index + 1);
 
-            // lookup the assign, ignore unknown assigns, may be URL schemes
-            if (this->assigns.Contains(assignString)) {
-                
-                // replace assign string
-                builder.SubstituteFirst(assignString, this->assigns[assignString]);
+                // lookup the assign, ignore unknown assigns, may be URL schemes
+                if (this->assigns.Contains(assignString)) {
+                    
+                    // replace assign string
+                    builder.SubstituteFirst(assignString, this->assigns[assignString]);
+                }
+                else break;
             }
             else break;
         }
-        else break;
+        this->resolved.AddBulk(KeyValuePair<String, String>(kvp.Key(), builder.GetString()));
+    }
+    this->resolved.EndBulk();
+}
+
+//------------------------------------------------------------------------------
+int
+assignRegistry::assignLength(const char* str) {
+    const char* colon = std::strchr(str, ':');
+    // ignore DOS drive letters
+    if ((nullptr != colon) && ((colon - str) > 1)) {
+        return int(colon - str) + 1;
+    }
+    else {
+        return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+int
+assignRegistry::findResolved(const char* name, int len) const {
+    // binary search without creating a String from the name
+    int lo = 0;
+    int hi = this->resolved.Size() - 1;
+    while (lo <= hi) {
+        const int mid = (lo + hi) / 2;
+        const String& key = this->resolved.KeyAtIndex(mid);
+        int cmp = std::strncmp(key.AsCStr(), name, len);
+        if ((0 == cmp) && (key.Length() > len)) {
+            cmp = 1;
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        }
+        else if (cmp > 0) {
+            hi = mid - 1;
+        }
+        else {
+            return mid;
+        }
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+String
+assignRegistry::ResolveAssigns(const String& str) const {
+    const int len = assignLength(str.AsCStr());
+    if (0 == len) {
+        return str;
+    }
+    String result;
+    this->rwLock.LockRead();
+    const int index = this->findResolved(str.AsCStr(), len);
+    if (InvalidIndex != index) {
+        StringBuilder builder(this->resolved.ValueAtIndex(index));
+        builder.Append(str.AsCStr() + len);
+        result = builder.GetString();
+    }
+    else {
+        // unknown assigns may be URL schemes
+        result = str;
+    }
+    this->rwLock.UnlockRead();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+const char*
+assignRegistry::ResolveAssigns(const char* str, char* buf, int bufSize) const {
+    o_assert_dbg(str && buf);
+    const int len = assignLength(str);
+    if (0 == len) {
+        return str;
+    }
+    const char* result = str;
+    this->rwLock.LockRead();
+    const int index = this->findResolved(str, len);
+    if (InvalidIndex != index) {
+        const String& path = this->resolved.ValueAtIndex(index);
+        const int restLength = int(std::strlen(str + len));
+        if ((path.Length() + restLength) < bufSize) {
+            Memory::Copy(path.AsCStr(), buf, path.Length());
+            Memory::Copy(str + len, buf + path.Length(), restLength + 1);
+            result = buf;
+        }
+        else {
+            result = nullptr;
+        }
     }
-    String result = builder.GetString();
     this->rwLock.UnlockRead();
     return result;
 }
 
 } // namespace _priv
-} // namespace Oryol
\ No newline at end of file
+} // namespace Oryol
@@ -7,6 +7,11 @@
  
     Central registry for assign definitions. Assigns are
     path aliases (google for AmigaOS assign).
+
+    The registry keeps a second table with the fully resolved
+    path of each assign (with nested assigns replaced), which is
+    rebuilt whenever an assign changes, so that resolving the
+    assign in a URL is a single lookup and copy.
 */
 #include "Core/Containers/Map.h"
 #include "Core/String/String.h"
@@ -25,14 +30,23 @@ public:
     String LookupAssign(const String& assign) const;
     /// resolve assigns in the provided string
     String ResolveAssigns(const String& str) const;
+    /// resolve assigns without allocation, returns str, buf, or nullptr if buf is too small
+    const char* ResolveAssigns(const char* str, char* buf, int bufSize) const;
     
 private:
     /// setup the standard assigns
     void setStandardAssigns();
+    /// rebuild the table of resolved assigns (call with write lock)
+    void updateResolved();
+    /// get length of the assign at the start of a string, or 0 if not an assign
+    static int assignLength(const char* str);
+    /// find resolved assign by name (call with read lock)
+    int findResolved(const char* name, int len) const;
     
     mutable RWLock rwLock;
     Map<String, String> assigns;
+    Map<String, String> resolved;
 };
     
 } // namespace _priv
-} // namespace Oryol
\ No newline at end of file
+} // namespace Oryol
@@ -0,0 +1,386 @@
+//------------------------------------------------------------------------------
+//  ioCache.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "ioCache.h"
+#include "Core/String/StringBuilder.h"
+#include <cstring>
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+ioCache::ioCache() :
+valid(false),
+budget(0),
+lruHead(InvalidIndex),
+lruTail(InvalidIndex) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+ioCache::~ioCache() {
+    o_assert_dbg(!this->valid);
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::setup(int budget_, const URL& dir_) {
+    o_assert_dbg(!this->valid);
+    o_assert_dbg(budget_ >= 0);
+    o_assert(dir_.Empty() || (dir_.IsValid() && dir_.HasPath()));
+    this->budget = budget_;
+    this->dir = dir_;
+    this->dirScheme = dir_.Scheme();
+    this->curStats = IOCacheStats();
+    this->curStats.Budget = budget_;
+    this->valid = true;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::discard() {
+    o_assert_dbg(this->valid);
+    this->clear();
+    this->entries.Clear();
+    this->freeEntries.Clear();
+    this->urlIndex.Clear();
+    this->generations.Clear();
+    this->dir = URL();
+    this->dirScheme.Clear();
+    this->budget = 0;
+    this->valid = false;
+}
+
+//------------------------------------------------------------------------------
+bool
+ioCache::isValid() const {
+    return this->valid;
+}
+
+//------------------------------------------------------------------------------
+bool
+ioCache::isEnabled() const {
+    return this->valid && ((this->budget > 0) || this->hasDiskCache());
+}
+
+//------------------------------------------------------------------------------
+bool
+ioCache::hasDiskCache() const {
+    return !this->dir.Empty();
+}
+
+//------------------------------------------------------------------------------
+bool
+ioCache::useDiskCache(const URL& url) const {
+    // caching files which already live in the cache directory's
+    // filesystem would only add overhead, and HTTP responses
+    // must be revalidated, which is done by the HTTP response cache
+    return this->hasDiskCache() &&
+           !url.HasScheme(this->dirScheme.AsCStr()) &&
+           !url.HasScheme("http") &&
+           !url.HasScheme("https");
+}
+
+//------------------------------------------------------------------------------
+String
+ioCache::key(const URL& url, int64_t startOffset, int64_t endOffset) {
+    if ((0 == startOffset) && (EndOfFile == endOffset)) {
+        return url.Get().AsString();
+    }
+    else {
+        StringBuilder builder;
+        builder.Format(4096, "%s|%lld-%lld", url.AsCStr(), (long long)startOffset, (long long)endOffset);
+        return builder.GetString();
+    }
+}
+
+//------------------------------------------------------------------------------
+uint64_t
+ioCache::urlHash(const char* key) {
+    // FNV-1a hash, NOTE: the URL of a key which contains a '|' hashes
+    // the same as the part before the '|', invalidate() sorts this out
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char* p = key; *p && ('|' != *p); p++) {
+        hash ^= uint8_t(*p);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------
+URL
+ioCache::hashedURL(const char* str, const char* suffix) const {
+    o_assert_dbg(this->hasDiskCache());
+
+    // FNV-1a hash of the string is used as filename
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char* p = str; *p; p++) {
+        hash ^= uint8_t(*p);
+        hash *= 1099511628211ULL;
+    }
+    StringBuilder builder;
+    builder.Format(4096, "%s%08x%08x%s", this->dir.AsCStr(), uint32_t(hash >> 32), uint32_t(hash), suffix);
+    return URL(builder.GetString());
+}
+
+//------------------------------------------------------------------------------
+URL
+ioCache::diskURL(const String& key, uint32_t generation) const {
+    StringBuilder builder;
+    builder.Format(32, ".%u.cache", generation);
+    return this->hashedURL(key.AsCStr(), builder.AsCStr());
+}
+
+//------------------------------------------------------------------------------
+URL
+ioCache::generationURL(const URL& url) const {
+    return this->hashedURL(url.AsCStr(), ".gen");
+}
+
+//------------------------------------------------------------------------------
+bool
+ioCache::generation(const URL& url, uint32_t& outGeneration) const {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    const int mapIndex = this->generations.FindIndex(url.Get().AsString());
+    if (InvalidIndex != mapIndex) {
+        outGeneration = this->generations.ValueAtIndex(mapIndex);
+        return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::setGeneration(const URL& url, uint32_t generation) {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    const String key = url.Get().AsString();
+    if (this->generations.Contains(key)) {
+        this->generations[key] = generation;
+    }
+    else {
+        this->generations.Add(key, generation);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+ioCache::read(const String& key, Buffer& outData) {
+    o_assert_dbg(this->valid);
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    const int mapIndex = this->index.FindIndex(key);
+    if (InvalidIndex != mapIndex) {
+        const int entryIndex = this->index.ValueAtIndex(mapIndex);
+        const entry& e = this->entries[entryIndex];
+        outData.Clear();
+        if (!e.data.Empty()) {
+            outData.Add(e.data.Data(), e.data.Size());
+        }
+        // move entry to front of LRU list
+        this->unlink(entryIndex);
+        this->linkFront(entryIndex);
+        this->curStats.NumHits++;
+        return true;
+    }
+    else {
+        this->curStats.NumMisses++;
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::write(const String& key, const uint8_t* data, int size) {
+    o_assert_dbg(this->valid);
+    o_assert_dbg(size >= 0);
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+
+    // drop an existing entry with the same key
+    if (this->index.Contains(key)) {
+        this->removeEntry(this->index[key]);
+    }
+
+    // entries which don't fit into the budget at all are not cached
+    if ((0 == this->budget) || (size > this->budget)) {
+        return;
+    }
+    while ((this->curStats.NumBytes + size) > this->budget) {
+        this->evictLRU();
+    }
+
+    int entryIndex;
+    if (this->freeEntries.Empty()) {
+        this->entries.Add(entry());
+        entryIndex = this->entries.Size() - 1;
+    }
+    else {
+        entryIndex = this->freeEntries.PopBack();
+    }
+    entry& e = this->entries[entryIndex];
+    e.key = key;
+    e.data.Clear();
+    if (size > 0) {
+        e.data.Add(data, size);
+    }
+    this->linkFront(entryIndex);
+    this->index.Add(key, entryIndex);
+
+    // link to the front of the URL chain
+    e.urlHash = urlHash(key.AsCStr());
+    e.urlPrev = InvalidIndex;
+    const int chainIndex = this->urlIndex.FindIndex(e.urlHash);
+    if (InvalidIndex != chainIndex) {
+        e.urlNext = this->urlIndex.ValueAtIndex(chainIndex);
+        this->entries[e.urlNext].urlPrev = entryIndex;
+        this->urlIndex.ValueAtIndex(chainIndex) = entryIndex;
+    }
+    else {
+        e.urlNext = InvalidIndex;
+        this->urlIndex.Add(e.urlHash, entryIndex);
+    }
+    this->curStats.NumEntries++;
+    this->curStats.NumBytes += size;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::invalidate(const URL& url) {
+    o_assert_dbg(this->valid);
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    // the keys of an URL are the URL itself, or start with 'URL|',
+    // only the entries in the chain of the URL hash are candidates
+    const char* urlStr = url.AsCStr();
+    const int urlLen = url.Get().Length();
+    const int chainIndex = this->urlIndex.FindIndex(urlHash(urlStr));
+    int entryIndex = (InvalidIndex != chainIndex) ? this->urlIndex.ValueAtIndex(chainIndex) : InvalidIndex;
+    while (InvalidIndex != entryIndex) {
+        const entry& e = this->entries[entryIndex];
+        const int nextIndex = e.urlNext;
+        const char* keyStr = e.key.AsCStr();
+        if ((0 == std::strncmp(keyStr, urlStr, urlLen)) && ((0 == keyStr[urlLen]) || ('|' == keyStr[urlLen]))) {
+            this->removeEntry(entryIndex);
+        }
+        entryIndex = nextIndex;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::clear() {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    while (InvalidIndex != this->lruTail) {
+        this->removeEntry(this->lruTail);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::countDiskHit() {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curStats.NumDiskHits++;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::countDiskWrite() {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curStats.NumDiskWrites++;
+}
+
+//------------------------------------------------------------------------------
+IOCacheStats
+ioCache::stats() const {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    return this->curStats;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::unlink(int entryIndex) {
+    entry& e = this->entries[entryIndex];
+    if (InvalidIndex != e.prev) {
+        this->entries[e.prev].next = e.next;
+    }
+    else {
+        this->lruHead = e.next;
+    }
+    if (InvalidIndex != e.next) {
+        this->entries[e.next].prev = e.prev;
+    }
+    else {
+        this->lruTail = e.prev;
+    }
+    e.prev = e.next = InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::linkFront(int entryIndex) {
+    entry& e = this->entries[entryIndex];
+    e.prev = InvalidIndex;
+    e.next = this->lruHead;
+    if (InvalidIndex != this->lruHead) {
+        this->entries[this->lruHead].prev = entryIndex;
+    }
+    this->lruHead = entryIndex;
+    if (InvalidIndex == this->lruTail) {
+        this->lruTail = entryIndex;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::evictLRU() {
+    o_assert_dbg(InvalidIndex != this->lruTail);
+    this->removeEntry(this->lruTail);
+    this->curStats.NumEvictions++;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCache::removeEntry(int entryIndex) {
+    entry& e = this->entries[entryIndex];
+    this->unlink(entryIndex);
+    this->index.Erase(e.key);
+
+    // unlink from the URL chain, and drop an empty chain
+    if (InvalidIndex != e.urlPrev) {
+        this->entries[e.urlPrev].urlNext = e.urlNext;
+    }
+    else if (InvalidIndex != e.urlNext) {
+        this->urlIndex[e.urlHash] = e.urlNext;
+    }
+    else {
+        this->urlIndex.Erase(e.urlHash);
+    }
+    if (InvalidIndex != e.urlNext) {
+        this->entries[e.urlNext].urlPrev = e.urlPrev;
+    }
+    e.urlPrev = e.urlNext = InvalidIndex;
+    this->curStats.NumEntries--;
+    this->curStats.NumBytes -= e.data.Size();
+    e.key.Clear();
+    e.data = Buffer();
+    this->freeEntries.Add(entryIndex);
+}
+
+} // namespace _priv
+} // namespace Oryol
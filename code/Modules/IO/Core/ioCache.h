@@ -0,0 +1,134 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::ioCache
+    @ingroup _priv
+    @brief LRU read cache for IORead requests
+
+    The ioCache keeps the data of recently read URLs in memory, up to
+    a byte budget. When the budget is exceeded, the least recently used
+    entries are evicted. Optionally, a cache directory URL can be
+    defined where cache entries are persisted, this is used as
+    a second cache level behind the in-memory cache. The actual
+    disk access happens in the ioWorker through the filesystem
+    registered for the cache directory's URL scheme, the ioCache
+    only provides the URLs of the cache entries.
+
+    All cached data of an URL (all byte ranges) is dropped with
+    invalidate(), the ioWorkers do this for every write to the URL.
+    The entries of an URL are chained and found through a hash of
+    the URL, so invalidation doesn't need to look at other entries.
+    Since files can't be deleted through the IO module, disk cache
+    entries are invalidated through a per-URL generation number which
+    is part of the disk cache filename. The generation is persisted in
+    a small file in the cache directory (see generationURL()), and
+    bumping it makes all existing disk cache entries of the URL
+    unreachable.
+
+    HTTP(S) URLs never go into the disk cache, persistent HTTP caching
+    with revalidation is done by the HTTPFileSystem's response cache.
+
+    The cache is shared by all ioWorkers and is thread-safe.
+*/
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "Core/Containers/Map.h"
+#include "Core/String/String.h"
+#include "IO/Core/URL.h"
+#include "IO/Core/IOCacheStats.h"
+#if ORYOL_HAS_THREADS
+#include <mutex>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+class ioCache {
+public:
+    /// constructor
+    ioCache();
+    /// destructor
+    ~ioCache();
+
+    /// setup the cache with a byte budget and optional cache directory
+    void setup(int budget, const URL& dir);
+    /// discard the cache
+    void discard();
+    /// return true if the cache has been setup
+    bool isValid() const;
+    /// return true if either the memory- or disk-cache is enabled
+    bool isEnabled() const;
+    /// return true if a disk cache directory has been defined
+    bool hasDiskCache() const;
+    /// return true if the disk cache should be used for an URL
+    bool useDiskCache(const URL& url) const;
+
+    /// build a cache key from an URL and a byte range
+    static String key(const URL& url, int64_t startOffset, int64_t endOffset);
+    /// get the disk cache URL for a cache key and the URL's disk cache generation
+    URL diskURL(const String& key, uint32_t generation) const;
+    /// get the disk URL of the file which holds the disk cache generation of an URL
+    URL generationURL(const URL& url) const;
+    /// get the disk cache generation of an URL, return false if not known yet
+    bool generation(const URL& url, uint32_t& outGeneration) const;
+    /// set the disk cache generation of an URL
+    void setGeneration(const URL& url, uint32_t generation);
+
+    /// lookup cached data, copy to outData and return true on hit
+    bool read(const String& key, Buffer& outData);
+    /// add or replace cached data, may evict old entries
+    void write(const String& key, const uint8_t* data, int size);
+    /// drop all in-memory entries of an URL (all byte ranges)
+    void invalidate(const URL& url);
+    /// clear the in-memory cache
+    void clear();
+
+    /// count a hit in the disk cache
+    void countDiskHit();
+    /// count a write to the disk cache
+    void countDiskWrite();
+    /// get a copy of the cache stats
+    IOCacheStats stats() const;
+
+private:
+    /// unlink an entry from the LRU list
+    void unlink(int entryIndex);
+    /// link an entry to the front of the LRU list
+    void linkFront(int entryIndex);
+    /// evict the least recently used entry
+    void evictLRU();
+    /// remove an entry by index
+    void removeEntry(int entryIndex);
+    /// build a disk filename from a hashed string
+    URL hashedURL(const char* str, const char* suffix) const;
+    /// hash the URL part of a cache key (everything before the first '|')
+    static uint64_t urlHash(const char* key);
+
+    struct entry {
+        String key;
+        Buffer data;
+        int prev = InvalidIndex;
+        int next = InvalidIndex;
+        uint64_t urlHash = 0;
+        int urlPrev = InvalidIndex;     // chain of entries with the same URL hash
+        int urlNext = InvalidIndex;
+    };
+    #if ORYOL_HAS_THREADS
+    mutable std::mutex mutex;
+    #endif
+    bool valid;
+    int budget;
+    URL dir;
+    String dirScheme;
+    Array<entry> entries;
+    Array<int> freeEntries;
+    Map<String, int> index;
+    Map<uint64_t, int> urlIndex;    // URL hash to first entry of the chain
+    Map<String, uint32_t> generations;
+    int lruHead;        // most recently used
+    int lruTail;        // least recently used
+    IOCacheStats curStats;
+};
+
+} // namespace _priv
+} // namespace Oryol
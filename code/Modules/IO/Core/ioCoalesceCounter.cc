@@ -0,0 +1,47 @@
+//------------------------------------------------------------------------------
+//  ioCoalesceCounter.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "ioCoalesceCounter.h"
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+void
+ioCoalesceCounter::setup(bool coalesce, bool merge) {
+    this->coalesceEnabled = coalesce;
+    this->mergeEnabled = coalesce && merge;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCoalesceCounter::countGroup(int numCoalesced, int numMerged) {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curStats.NumCoalesced += numCoalesced;
+    this->curStats.NumMerged += numMerged;
+    this->curStats.NumGroupReads++;
+}
+
+//------------------------------------------------------------------------------
+void
+ioCoalesceCounter::reset() {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curStats = IOCoalesceStats();
+}
+
+//------------------------------------------------------------------------------
+IOCoalesceStats
+ioCoalesceCounter::stats() const {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    return this->curStats;
+}
+
+} // namespace _priv
+} // namespace Oryol
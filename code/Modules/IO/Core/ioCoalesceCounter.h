@@ -0,0 +1,56 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::ioCoalesceCounter
+    @ingroup _priv
+    @brief IORead coalescing settings and statistics of all ioWorkers
+
+    This is shared by all ioWorkers and is thread-safe, the settings
+    must only be changed before IO requests are issued.
+*/
+#include "IO/Core/IOCoalesceStats.h"
+#if ORYOL_HAS_THREADS
+#include <mutex>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+class ioCoalesceCounter {
+public:
+    /// setup the coalescing settings
+    void setup(bool coalesceEnabled, bool mergeEnabled);
+    /// return true if identical IORead requests should be coalesced
+    bool isCoalesceEnabled() const;
+    /// return true if overlapping or adjacent ranges should be merged
+    bool isMergeEnabled() const;
+    /// count a filesystem read serving several requests
+    void countGroup(int numCoalesced, int numMerged);
+    /// reset the statistics
+    void reset();
+    /// get a copy of the statistics
+    IOCoalesceStats stats() const;
+
+private:
+    bool coalesceEnabled = false;
+    bool mergeEnabled = false;
+    #if ORYOL_HAS_THREADS
+    mutable std::mutex mutex;
+    #endif
+    IOCoalesceStats curStats;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+ioCoalesceCounter::isCoalesceEnabled() const {
+    return this->coalesceEnabled;
+}
+
+//------------------------------------------------------------------------------
+inline bool
+ioCoalesceCounter::isMergeEnabled() const {
+    return this->mergeEnabled;
+}
+
+} // namespace _priv
+} // namespace Oryol
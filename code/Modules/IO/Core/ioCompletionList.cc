@@ -0,0 +1,42 @@
+//------------------------------------------------------------------------------
+//  ioCompletionList.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "ioCompletionList.h"
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+void
+ioCompletionList::push(const Ptr<IORead>& msg) {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->msgs.Add(msg);
+}
+
+//------------------------------------------------------------------------------
+void
+ioCompletionList::takeAll(Array<Ptr<IORead>>& outMsgs) {
+    o_assert_dbg(outMsgs.Empty());
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    // swap the arrays so that the allocated capacity is recycled
+    Array<Ptr<IORead>> tmp(std::move(outMsgs));
+    outMsgs = std::move(this->msgs);
+    this->msgs = std::move(tmp);
+}
+
+//------------------------------------------------------------------------------
+bool
+ioCompletionList::empty() const {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    return this->msgs.Empty();
+}
+
+} // namespace _priv
+} // namespace Oryol
@@ -0,0 +1,42 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::ioCompletionList
+    @ingroup _priv
+    @brief list of finished IORead requests, filled by the ioWorkers
+
+    IORead requests with the CompletionListEnabled flag are pushed
+    to the completion list by the ioWorker which handled them, in
+    the order they have been handled. The main thread takes the
+    whole list once per frame, so that finished requests don't
+    need to be polled.
+
+    This is shared by all ioWorkers and is thread-safe.
+*/
+#include "Core/Containers/Array.h"
+#include "IO/FS/ioRequests.h"
+#if ORYOL_HAS_THREADS
+#include <mutex>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+class ioCompletionList {
+public:
+    /// push a handled request (called from ioWorkers)
+    void push(const Ptr<IORead>& msg);
+    /// move all completed requests into an (empty) array
+    void takeAll(Array<Ptr<IORead>>& outMsgs);
+    /// return true if the completion list is empty
+    bool empty() const;
+
+private:
+    #if ORYOL_HAS_THREADS
+    mutable std::mutex mutex;
+    #endif
+    Array<Ptr<IORead>> msgs;
+};
+
+} // namespace _priv
+} // namespace Oryol
@@ -0,0 +1,53 @@
+//------------------------------------------------------------------------------
+//  ioDecodeCounter.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "ioDecodeCounter.h"
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+void
+ioDecodeCounter::countDecoded(int64_t bytesIn, int64_t bytesOut, Duration decodeTime) {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curStats.NumDecoded++;
+    this->curStats.NumBytesIn += bytesIn;
+    this->curStats.NumBytesOut += bytesOut;
+    this->curStats.DecodeTime += decodeTime;
+}
+
+//------------------------------------------------------------------------------
+void
+ioDecodeCounter::countFailed(int64_t bytesIn, int64_t bytesOut, Duration decodeTime) {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curStats.NumFailed++;
+    this->curStats.NumBytesIn += bytesIn;
+    this->curStats.NumBytesOut += bytesOut;
+    this->curStats.DecodeTime += decodeTime;
+}
+
+//------------------------------------------------------------------------------
+void
+ioDecodeCounter::reset() {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curStats = IODecodeStats();
+}
+
+//------------------------------------------------------------------------------
+IODecodeStats
+ioDecodeCounter::stats() const {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    return this->curStats;
+}
+
+} // namespace _priv
+} // namespace Oryol
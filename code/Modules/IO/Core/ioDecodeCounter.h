@@ -0,0 +1,37 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::ioDecodeCounter
+    @ingroup _priv
+    @brief collect decompression statistics from all ioWorkers
+
+    This is shared by all ioWorkers and is thread-safe.
+*/
+#include "IO/Core/IODecodeStats.h"
+#if ORYOL_HAS_THREADS
+#include <mutex>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+class ioDecodeCounter {
+public:
+    /// count a successfully decompressed request
+    void countDecoded(int64_t bytesIn, int64_t bytesOut, Duration decodeTime);
+    /// count a request which failed to decompress
+    void countFailed(int64_t bytesIn, int64_t bytesOut, Duration decodeTime);
+    /// reset the statistics
+    void reset();
+    /// get a copy of the statistics
+    IODecodeStats stats() const;
+
+private:
+    #if ORYOL_HAS_THREADS
+    mutable std::mutex mutex;
+    #endif
+    IODecodeStats curStats;
+};
+
+} // namespace _priv
+} // namespace Oryol
@@ -0,0 +1,99 @@
+//------------------------------------------------------------------------------
+//  ioInflater.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "ioInflater.h"
+#include "Core/Memory/Memory.h"
+#include "Core/Time/Clock.h"
+#include "zlib.h"
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+ioInflater::ioInflater() :
+strm(nullptr),
+bytesIn(0),
+bytesOut(0) {
+    this->strm = Memory::New<z_stream>();
+    Memory::Clear(this->strm, sizeof(z_stream));
+    // window bits 15 + 32 enables automatic zlib/gzip header detection
+    int res = inflateInit2(this->strm, 15 + 32);
+    o_assert(Z_OK == res);
+    this->scratch.Add(64 * 1024);
+}
+
+//------------------------------------------------------------------------------
+ioInflater::~ioInflater() {
+    inflateEnd(this->strm);
+    Memory::Delete(this->strm);
+    this->strm = nullptr;
+}
+
+//------------------------------------------------------------------------------
+ioInflater::result
+ioInflater::feed(const uint8_t* data, int size, Buffer& outData) {
+    o_assert_dbg(data || (0 == size));
+    TimePoint start = Clock::Now();
+    this->bytesIn += size;
+    this->strm->next_in = (Bytef*) data;
+    this->strm->avail_in = uInt(size);
+    result res = NeedMore;
+    do {
+        this->strm->next_out = this->scratch.Data();
+        this->strm->avail_out = uInt(this->scratch.Size());
+        const int zres = inflate(this->strm, Z_NO_FLUSH);
+        const int numBytes = this->scratch.Size() - int(this->strm->avail_out);
+        if (numBytes > 0) {
+            // grow the output buffer geometrically, Buffer::Add() only
+            // grows by the number of added bytes
+            if (outData.Spare() < numBytes) {
+                const int maxGrow = Buffer::MaxSize - outData.Size();
+                if (maxGrow < numBytes) {
+                    res = Error;
+                    break;
+                }
+                int grow = outData.Size() > numBytes ? outData.Size() : numBytes;
+                outData.Reserve(grow < maxGrow ? grow : maxGrow);
+            }
+            outData.Add(this->scratch.Data(), numBytes);
+            this->bytesOut += numBytes;
+        }
+        if (Z_STREAM_END == zres) {
+            res = Done;
+            break;
+        }
+        else if ((Z_OK != zres) && (Z_BUF_ERROR != zres)) {
+            res = Error;
+            break;
+        }
+        else if ((Z_BUF_ERROR == zres) && (0 == numBytes)) {
+            // no progress possible, more input needed
+            break;
+        }
+    }
+    while ((this->strm->avail_in > 0) || (0 == this->strm->avail_out));
+    this->time += Clock::Since(start);
+    return res;
+}
+
+//------------------------------------------------------------------------------
+int64_t
+ioInflater::numBytesIn() const {
+    return this->bytesIn;
+}
+
+//------------------------------------------------------------------------------
+int64_t
+ioInflater::numBytesOut() const {
+    return this->bytesOut;
+}
+
+//------------------------------------------------------------------------------
+Duration
+ioInflater::decodeTime() const {
+    return this->time;
+}
+
+} // namespace _priv
+} // namespace Oryol
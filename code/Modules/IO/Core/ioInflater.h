@@ -0,0 +1,58 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::ioInflater
+    @ingroup _priv
+    @brief streaming zlib/gzip decompressor for IORead requests
+
+    The ioWorker reads compressed data in chunks from the filesystem
+    and feeds each chunk into an ioInflater, which appends the
+    decompressed data to the result buffer. The compressed data
+    can be in zlib or gzip format (detected automatically).
+
+    The time spent in feed() is accumulated so that the decode
+    throughput can be reported independently from IO time.
+*/
+#include "Core/RefCounted.h"
+#include "Core/Containers/Buffer.h"
+#include "Core/Time/Duration.h"
+
+struct z_stream_s;
+
+namespace Oryol {
+namespace _priv {
+
+class ioInflater : public RefCounted {
+    OryolClassDecl(ioInflater);
+public:
+    /// constructor
+    ioInflater();
+    /// destructor
+    ~ioInflater();
+
+    /// result of feeding a chunk of compressed data
+    enum result {
+        NeedMore,   // all input consumed, end of stream not reached yet
+        Done,       // end of compressed stream reached
+        Error,      // corrupted input data, or output too big for a Buffer
+    };
+    /// feed a chunk of compressed data, append decompressed data to outData
+    result feed(const uint8_t* data, int size, Buffer& outData);
+
+    /// number of compressed bytes fed so far
+    int64_t numBytesIn() const;
+    /// number of decompressed bytes produced so far
+    int64_t numBytesOut() const;
+    /// accumulated time spent in feed()
+    Duration decodeTime() const;
+
+private:
+    z_stream_s* strm;
+    Buffer scratch;
+    int64_t bytesIn;
+    int64_t bytesOut;
+    Duration time;
+};
+
+} // namespace _priv
+} // namespace Oryol
@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+//  ioMetricsCounter.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "ioMetricsCounter.h"
+#include "Core/Time/Clock.h"
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+void
+ioMetricsCounter::setup(bool enabled_) {
+    this->enabled = enabled_;
+    this->reset();
+}
+
+//------------------------------------------------------------------------------
+void
+ioMetricsCounter::count(IORequestCounters& counters, IOStatus::Code status, int64_t numBytes) {
+    counters.NumRequests++;
+    if (IOStatus::Cancelled == status) {
+        counters.NumCancelled++;
+    }
+    else if (IOStatus::OK != status) {
+        counters.NumFailed++;
+    }
+    else {
+        counters.NumBytes += numBytes;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioMetricsCounter::countRequest(int workerIndex, const URL& url, IOStatus::Code status, int64_t numBytes, Duration queueWait, Duration service) {
+    o_assert_dbg((workerIndex >= 0) && (workerIndex < IOConfig::NumWorkers));
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    count(this->curMetrics.Total, status, numBytes);
+    count(this->curMetrics.Workers[workerIndex], status, numBytes);
+    int schemeIndex = 0;
+    for (; schemeIndex < this->schemes.Size(); schemeIndex++) {
+        if (url.HasScheme(this->schemes[schemeIndex].AsCStr())) {
+            break;
+        }
+    }
+    if (schemeIndex == this->schemes.Size()) {
+        this->schemes.Add(url.Scheme());
+        this->schemeCounters.Add(IORequestCounters());
+    }
+    count(this->schemeCounters[schemeIndex], status, numBytes);
+    this->curMetrics.QueueWait.Add(queueWait);
+    this->curMetrics.Service.Add(service);
+}
+
+//------------------------------------------------------------------------------
+void
+ioMetricsCounter::countEndToEnd(Duration endToEnd) {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curMetrics.EndToEnd.Add(endToEnd);
+}
+
+//------------------------------------------------------------------------------
+void
+ioMetricsCounter::reset() {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->curMetrics = IOMetrics();
+    this->schemes.Clear();
+    this->schemeCounters.Clear();
+    this->startTime = Clock::Now();
+}
+
+//------------------------------------------------------------------------------
+IOMetrics
+ioMetricsCounter::metrics() const {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    IOMetrics result = this->curMetrics;
+    for (int i = 0; i < this->schemes.Size(); i++) {
+        result.Schemes.Add(this->schemes[i], this->schemeCounters[i]);
+    }
+    result.Elapsed = Clock::Since(this->startTime);
+    return result;
+}
+
+} // namespace _priv
+} // namespace Oryol
@@ -0,0 +1,61 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::ioMetricsCounter
+    @ingroup _priv
+    @brief request counters and latency histograms of all ioWorkers
+
+    This is shared by all ioWorkers and is thread-safe. Per-scheme
+    counters are kept in a small array which is searched linearly,
+    so that counting a request doesn't need to allocate a String
+    for the URL scheme.
+*/
+#include "IO/Core/IOMetrics.h"
+#include "IO/Core/IOStatus.h"
+#include "IO/Core/URL.h"
+#include "Core/Containers/Array.h"
+#include "Core/Time/TimePoint.h"
+#if ORYOL_HAS_THREADS
+#include <mutex>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+class ioMetricsCounter {
+public:
+    /// setup the counter
+    void setup(bool enabled);
+    /// return true if metrics should be recorded
+    bool isEnabled() const;
+    /// count a handled request
+    void countRequest(int workerIndex, const URL& url, IOStatus::Code status, int64_t numBytes, Duration queueWait, Duration service);
+    /// count the end-to-end latency of a request delivered on the main thread
+    void countEndToEnd(Duration endToEnd);
+    /// reset the metrics
+    void reset();
+    /// get a copy of the metrics (without queue depths)
+    IOMetrics metrics() const;
+
+private:
+    /// count a request into a counter set
+    static void count(IORequestCounters& counters, IOStatus::Code status, int64_t numBytes);
+
+    bool enabled = false;
+    #if ORYOL_HAS_THREADS
+    mutable std::mutex mutex;
+    #endif
+    TimePoint startTime;
+    IOMetrics curMetrics;
+    Array<String> schemes;
+    Array<IORequestCounters> schemeCounters;
+};
+
+//------------------------------------------------------------------------------
+inline bool
+ioMetricsCounter::isEnabled() const {
+    return this->enabled;
+}
+
+} // namespace _priv
+} // namespace Oryol
@@ -12,10 +12,20 @@ namespace _priv {
 
 class assignRegistry;
 class schemeRegistry;
+class ioCache;
+class ioDecodeCounter;
+class ioCoalesceCounter;
+class ioMetricsCounter;
+class ioCompletionList;
 
 struct ioPointers {
     class assignRegistry* assignRegistry;
     class schemeRegistry* schemeRegistry;
+    class ioCache* cache;
+    class ioDecodeCounter* decodeCounter;
+    class ioCoalesceCounter* coalesceCounter;
+    class ioMetricsCounter* metricsCounter;
+    class ioCompletionList* completionList;
 };
 
 } // namespace _priv
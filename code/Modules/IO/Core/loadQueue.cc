@@ -6,112 +6,255 @@
 #include "Core/Core.h"
 #include "Core/RunLoop.h"
 #include "IO/IO.h"
+#include "IO/Core/ioCompletionList.h"
+#include "IO/Core/ioMetricsCounter.h"
+#include "Core/Time/Clock.h"
 
 namespace Oryol {
 
+using namespace _priv;
+
 //------------------------------------------------------------------------------
 void
-loadQueue::add(const URL& url, successFunc onSuccess, failFunc onFail) {
-    o_assert_dbg(onSuccess);
-    Ptr<IORead> ioReq = IORead::Create();
+loadQueue::put(const Ptr<loadItem>& item, int index, const URL& url, int64_t startOffset, int64_t endOffset, bool cached, std::function<void(IORead*)> processFunc) {
+    Ptr<loadRequest> ioReq = loadRequest::Create();
     ioReq->Url = url;
+    ioReq->StartOffset = startOffset;
+    ioReq->EndOffset = endOffset;
+    ioReq->CacheReadEnabled = cached;
+    ioReq->CacheWriteEnabled = cached;
+    ioReq->CompletionListEnabled = true;
+    ioReq->ProcessFunc = std::move(processFunc);
+    ioReq->item = item;
+    ioReq->index = index;
     IO::Put(ioReq);
-    this->items.Add(item{ ioReq, onSuccess, onFail });
 }
 
 //------------------------------------------------------------------------------
 void
-loadQueue::addGroup(const Array<URL>& urls, groupSuccessFunc onSuccess, failFunc onFail) {
+loadQueue::add(const URL& url, successFunc onSuccess, failFunc onFail) {
     o_assert_dbg(onSuccess);
-    
-    groupItem item;
-    item.ioRequests.Reserve(urls.Size());
-    for (const URL& url : urls) {
-        Ptr<IORead> ioReq = IORead::Create();
-        ioReq->Url = url;
-        IO::Put(ioReq);
-        item.ioRequests.Add(ioReq);
-        item.onSuccess = onSuccess;
-        item.onFail = onFail;
+    Ptr<loadItem> item = loadItem::Create();
+    item->type = loadItem::Single;
+    item->onSuccess = onSuccess;
+    item->onFail = onFail;
+    put(item, 0, url, 0, EndOfFile, true);
+    this->numPendingItems++;
+}
+
+//------------------------------------------------------------------------------
+void
+loadQueue::addGroup(const Array<URL>& urls, groupSuccessFunc onSuccess, failFunc onFail, groupProcessFunc onProcess) {
+    o_assert_dbg(onSuccess);
+    if (urls.Empty()) {
+        onSuccess(Array<result>());
+        return;
+    }
+
+    Ptr<loadItem> item = loadItem::Create();
+    item->type = loadItem::Group;
+    item->onGroupSuccess = onSuccess;
+    item->onFail = onFail;
+    item->urls = urls;
+    item->data.Reserve(urls.Size());
+    item->numOutstanding = urls.Size();
+    for (int i = 0; i < urls.Size(); i++) {
+        item->data.Add(Buffer());
+        std::function<void(IORead*)> processFunc;
+        if (onProcess) {
+            processFunc = [onProcess, i](IORead* req) {
+                onProcess(i, req);
+            };
+        }
+        put(item, i, urls[i], 0, EndOfFile, true, std::move(processFunc));
+    }
+    this->numPendingItems++;
+}
+
+//------------------------------------------------------------------------------
+void
+loadQueue::addStream(const URL& url, int chunkSize, int maxChunksInFlight, chunkFunc onChunk, doneFunc onDone) {
+    o_assert_dbg(onChunk);
+    o_assert_dbg(chunkSize > 0);
+    o_assert_dbg(maxChunksInFlight > 0);
+
+    Ptr<loadItem> item = loadItem::Create();
+    item->type = loadItem::Stream;
+    item->url = url;
+    item->chunkSize = chunkSize;
+    item->maxChunksInFlight = maxChunksInFlight;
+    item->onChunk = onChunk;
+    item->onDone = onDone;
+    fillStream(item);
+    this->numPendingItems++;
+}
+
+//------------------------------------------------------------------------------
+void
+loadQueue::fillStream(const Ptr<loadItem>& item) {
+    while (item->numChunksInFlight < item->maxChunksInFlight) {
+        const int64_t startOffset = int64_t(item->nextChunk) * item->chunkSize;
+        put(item, item->nextChunk, item->url, startOffset, startOffset + item->chunkSize, false);
+        item->nextChunk++;
+        item->numChunksInFlight++;
     }
-    this->groupItems.Add(item);
 }
 
 //------------------------------------------------------------------------------
 int
 loadQueue::numPending() const {
-    return this->items.Size() + this->groupItems.Size();
+    return this->numPendingItems;
+}
+
+//------------------------------------------------------------------------------
+void
+loadQueue::fail(const failFunc& onFail, const URL& url, IOStatus::Code ioStatus) {
+    if (onFail) {
+        onFail(url, ioStatus);
+    }
+    else {
+        // no fail handler was set, just print a warning
+        o_warn("loadQueue:: failed to load file '%s' with '%s'\n",
+            url.AsCStr(), IOStatus::ToString(ioStatus));
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+loadQueue::update(ioCompletionList* completionList, ioMetricsCounter* metricsCounter) {
+    o_assert_dbg(completionList && metricsCounter);
+    if (completionList->empty()) {
+        return;
+    }
+
+    // NOTE: callbacks may issue new loads, these end up in the
+    // completion list and are handled in a later frame
+    o_assert_dbg(this->completed.Empty());
+    completionList->takeAll(this->completed);
+    const bool metricsEnabled = metricsCounter->isEnabled();
+    for (const auto& ioReq : this->completed) {
+        if (metricsEnabled) {
+            metricsCounter->countEndToEnd(Clock::Since(ioReq->PutTime));
+        }
+        if (ioReq->IsA<loadRequest>()) {
+            this->onCompleted(ioReq->DynamicCast<loadRequest>());
+        }
+    }
+    this->completed.Clear();
 }
 
 //------------------------------------------------------------------------------
 void
-loadQueue::update() {
-
-    // check single items
-    for (int i = this->items.Size() - 1; i >= 0; --i) {
-        const item& curItem = this->items[i];
-        const auto& ioReq = curItem.ioRequest;
-        if (ioReq->Handled) {
-            // io request has been handled
+loadQueue::onCompleted(const Ptr<loadRequest>& ioReq) {
+    o_assert_dbg(ioReq->Handled);
+    const Ptr<loadItem>& item = ioReq->item;
+    switch (item->type) {
+        case loadItem::Single:
             if (IOStatus::OK == ioReq->Status) {
-                // io request was successful
-                curItem.onSuccess(result(ioReq->Url, std::move(ioReq->Data)));
+                item->onSuccess(result(ioReq->Url, std::move(ioReq->Data)));
             }
             else {
-                // io request failed
-                if (curItem.onFail) {
-                    curItem.onFail(ioReq->Url, ioReq->Status);
+                fail(item->onFail, ioReq->Url, ioReq->Status);
+            }
+            this->numPendingItems--;
+            break;
+
+        case loadItem::Group:
+            // failures are reported immediately, the success-callback
+            // is only called when all requests were successful
+            if (IOStatus::OK == ioReq->Status) {
+                item->data[ioReq->index] = std::move(ioReq->Data);
+            }
+            else {
+                item->anyFailed = true;
+                fail(item->onFail, ioReq->Url, ioReq->Status);
+            }
+            if (0 == --item->numOutstanding) {
+                if (!item->anyFailed) {
+                    Array<result> results;
+                    results.Reserve(item->urls.Size());
+                    for (int i = 0; i < item->urls.Size(); i++) {
+                        results.Add(item->urls[i], std::move(item->data[i]));
+                    }
+                    item->onGroupSuccess(std::move(results));
+                }
+                this->numPendingItems--;
+            }
+            break;
+
+        case loadItem::Stream:
+            if (!item->done) {
+                if (this->onChunkCompleted(item, ioReq)) {
+                    item->done = true;
+                    item->readChunks.Clear();
+                    this->numPendingItems--;
                 }
                 else {
-                    // no fail handler was set, just print a warning
-                    o_warn("loadQueue:: failed to load file '%s' with '%s'\n",
-                        ioReq->Url.AsCStr(), IOStatus::ToString(ioReq->Status));
+                    fillStream(item);
                 }
             }
-            // remove the handled io request from the queue
-            this->items.Erase(i);
-        }
+            break;
     }
-    
-    // check group items
-    for (int i = this->groupItems.Size() - 1; i >= 0; --i) {
-        const groupItem& curItem = this->groupItems[i];
-        bool allHandled = true;
-        bool anyFailed = false;
-        for (const auto& ioReq : curItem.ioRequests) {
-            if (ioReq->Handled) {
-                if (IOStatus::OK != ioReq->Status) {
-                    anyFailed = true;
-                    if (curItem.onFail) {
-                        curItem.onFail(ioReq->Url, ioReq->Status);
-                    }
-                    else {
-                        o_warn("loadQueue:: failed to load file '%s' with '%s'\n",
-                            ioReq->Url.AsCStr(), IOStatus::ToString(ioReq->Status));
-                    }
+}
+
+//------------------------------------------------------------------------------
+bool
+loadQueue::onChunkCompleted(const Ptr<loadItem>& item, const Ptr<loadRequest>& ioReq) {
+    loadItem::chunkResult res;
+    res.index = ioReq->index;
+    res.status = ioReq->Status;
+    res.data = std::move(ioReq->Data);
+    item->readChunks.Add(std::move(res));
+
+    // deliver all chunks which are now in order
+    bool delivered = true;
+    while (delivered) {
+        delivered = false;
+        for (int i = 0; i < item->readChunks.Size(); i++) {
+            if (item->readChunks[i].index != item->nextDelivered) {
+                continue;
+            }
+            loadItem::chunkResult cur = std::move(item->readChunks[i]);
+            item->readChunks.Erase(i);
+            item->numChunksInFlight--;
+            item->nextDelivered++;
+            delivered = true;
+
+            bool endOfStream = false;
+            IOStatus::Code status = cur.status;
+            const int64_t offset = int64_t(cur.index) * item->chunkSize;
+            if (IOStatus::OK == status) {
+                // a short chunk marks the end of the stream
+                const int size = cur.data.Size();
+                endOfStream = size < item->chunkSize;
+                if (size > 0) {
+                    item->onChunk(chunk(item->url, offset, std::move(cur.data)));
                 }
             }
+            else if ((IOStatus::RequestedRangeNotSatisfiable == status) && (offset > 0)) {
+                // a chunk starting exactly at the end of the data, some
+                // filesystems (e.g. HTTP servers) report this as an error
+                status = IOStatus::OK;
+                endOfStream = true;
+            }
             else {
-                allHandled = false;
-                break;
+                endOfStream = true;
             }
-        }
-        
-        // if all request in this group have been handled, remove item, and
-        // if all were successful, call the success-callback
-        if (allHandled) {
-            if (!anyFailed) {
-                Array<result> result;
-                result.Reserve(curItem.ioRequests.Size());
-                for (const auto& ioReq : curItem.ioRequests) {
-                    result.Add(ioReq->Url, std::move(ioReq->Data));
+            if (endOfStream) {
+                // chunk requests past the end are ignored when they arrive
+                if (item->onDone) {
+                    item->onDone(item->url, status);
+                }
+                else if (IOStatus::OK != status) {
+                    o_warn("loadQueue:: failed to stream file '%s' with '%s'\n",
+                        item->url.AsCStr(), IOStatus::ToString(status));
                 }
-                curItem.onSuccess(std::move(result));
+                return true;
             }
-            this->groupItems.Erase(i);
+            break;
         }
     }
+    return false;
 }
 
 } // namespace Oryol
-
@@ -5,9 +5,33 @@
     @ingroup IO
     @brief asynchronously load multiple files, invoke callbacks with result
 
-    This is the class behind the IO::Load() and LoadGroup() functions.
+    This is the class behind the IO::Load(), LoadGroup() and
+    LoadStream() functions.
+
+    The loadQueue doesn't poll its pending requests, instead the
+    IORead requests are created with the CompletionListEnabled flag,
+    and the ioWorkers push them to the ioCompletionList when they
+    are handled. Once per frame the loadQueue takes the completed
+    requests and invokes the callbacks in completion order, so the
+    per-frame cost only depends on the number of completed requests,
+    not on the number of pending requests.
+
+    Groups can have a process function, which is called on the IO
+    threads for each file of the group as soon as it has been read
+    (see IORead::ProcessFunc), so that parsing overlaps with the
+    loading of the other files of the group.
+
+    Streams are read as a sequence of chunk-sized IORead range
+    requests, at most maxChunksInFlight chunk requests are pending
+    at any time (this includes chunks which have been read but
+    can't be delivered yet because an earlier chunk is still
+    pending), so that the memory used by a stream is bounded no
+    matter how fast the consumer processes the chunks. Chunks
+    are delivered in order, a chunk which is shorter than the
+    chunk size marks the end of the stream.
 */
 #include "Core/Types.h"
+#include "Core/RefCounted.h"
 #include "Core/String/StringAtom.h"
 #include "Core/Containers/Array.h"
 #include "Core/Containers/Buffer.h"
@@ -17,7 +41,12 @@
 #include <functional>
 
 namespace Oryol {
-    
+
+namespace _priv {
+class ioCompletionList;
+class ioMetricsCounter;
+}
+
 class loadQueue {
 public:
     /// loading result (iff successful)
@@ -39,31 +68,99 @@ public:
     typedef std::function<void(result result)> successFunc;
     /// callback function signature for success when loading URL groups
     typedef std::function<void(Array<result>)> groupSuccessFunc;
+    /// callback function signature for processing a group file on the IO thread
+    typedef std::function<void(int index, IORead* req)> groupProcessFunc;
     /// callback function signature for failure
     typedef std::function<void(const URL& url, IOStatus::Code ioStatus)> failFunc;
+    /// a chunk of data delivered by a stream
+    struct chunk {
+        chunk(const URL& url, int64_t offset, Buffer&& data) : Url(url), Offset(offset), Data(std::move(data)) { };
+        chunk(chunk&& rhs) {
+            this->Url = std::move(rhs.Url);
+            this->Offset = rhs.Offset;
+            this->Data = std::move(rhs.Data);
+        };
+        URL Url;
+        int64_t Offset = 0;
+        Buffer Data;
+    };
+    /// callback function signature for stream chunks
+    typedef std::function<void(chunk chunk)> chunkFunc;
+    /// callback function signature for finished (or failed) streams
+    typedef std::function<void(const URL& url, IOStatus::Code ioStatus)> doneFunc;
 
     /// add a file load request to the queue
     void add(const URL& url, successFunc onSuccess, failFunc onFail=failFunc());
     /// add a file group request to the queue
-    void addGroup(const Array<URL>& urls, groupSuccessFunc onSuccess, failFunc onFail=failFunc());
+    void addGroup(const Array<URL>& urls, groupSuccessFunc onSuccess, failFunc onFail=failFunc(), groupProcessFunc onProcess=groupProcessFunc());
+    /// add a stream request to the queue
+    void addStream(const URL& url, int chunkSize, int maxChunksInFlight, chunkFunc onChunk, doneFunc onDone);
     /// update the queue, called per frame from runloop
-    void update();
+    void update(_priv::ioCompletionList* completionList, _priv::ioMetricsCounter* metricsCounter);
     /// get number of pending load actions
     int numPending() const;
 
 private:
-    struct item {
-        Ptr<IORead> ioRequest;
+    /// shared state of a pending Load(), LoadGroup() or LoadStream() action
+    class loadItem : public RefCounted {
+        OryolClassDecl(loadItem);
+    public:
+        enum itemType {
+            Single,
+            Group,
+            Stream,
+        };
+        itemType type = Single;
         successFunc onSuccess;
+        groupSuccessFunc onGroupSuccess;
         failFunc onFail;
+        chunkFunc onChunk;
+        doneFunc onDone;
+
+        // groups: results in URL order
+        Array<URL> urls;
+        Array<Buffer> data;
+        int numOutstanding = 0;
+        bool anyFailed = false;
+
+        // streams: chunk requests which have been read but not yet
+        // delivered since an earlier chunk is still pending
+        struct chunkResult {
+            int index = 0;
+            IOStatus::Code status = IOStatus::InvalidIOStatus;
+            Buffer data;
+        };
+        URL url;
+        int chunkSize = 0;
+        int maxChunksInFlight = 0;
+        int numChunksInFlight = 0;
+        int nextChunk = 0;
+        int nextDelivered = 0;
+        bool done = false;
+        Array<chunkResult> readChunks;
     };
-    Array<item> items;
-    struct groupItem {
-        Array<Ptr<IORead>> ioRequests;
-        groupSuccessFunc onSuccess;
-        failFunc onFail;
+    /// an IORead issued by the loadQueue
+    class loadRequest : public IORead {
+        OryolClassDecl(loadRequest);
+        OryolTypeDecl(loadRequest, IORead);
+    public:
+        Ptr<loadItem> item;
+        int index = 0;
     };
-    Array<groupItem> groupItems;
+
+    /// create and send an IORead for a load item
+    static void put(const Ptr<loadItem>& item, int index, const URL& url, int64_t startOffset, int64_t endOffset, bool cached, std::function<void(IORead*)> processFunc=nullptr);
+    /// issue chunk requests until the in-flight limit is reached
+    static void fillStream(const Ptr<loadItem>& item);
+    /// handle a completed request
+    void onCompleted(const Ptr<loadRequest>& ioReq);
+    /// handle a completed chunk request, return true if the stream is done
+    bool onChunkCompleted(const Ptr<loadItem>& item, const Ptr<loadRequest>& ioReq);
+    /// call fail callback, or print a warning
+    static void fail(const failFunc& onFail, const URL& url, IOStatus::Code ioStatus);
+
+    int numPendingItems = 0;
+    Array<Ptr<IORead>> completed;
 };
 
 } // namespace Oryol
@@ -35,4 +35,35 @@ FileSystem::onMsg(const Ptr<IORequest>& ioReq) {
     o_warn("FileSystem::onMsg(): message not handled by FileSystem!\n");
 }
 
+//------------------------------------------------------------------------------
+bool
+FileSystem::update() {
+    // only asynchronous filesystems need to do work here
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool
+FileSystem::wait(Duration timeout) {
+    // the IO lane falls back to polling update()
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+FileSystem::wakeup() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+void
+FileSystem::setHandled(const Ptr<IORequest>& ioReq) {
+    // NOTE: the request must be counted before it is flagged as
+    // handled, since the main thread may take the result after that
+    if (ioReq->CountWhenHandled && this->countFunc) {
+        this->countFunc(ioReq);
+    }
+    ioReq->Handled = true;
+}
+
 } // namespace Oryol
\ No newline at end of file
@@ -7,10 +7,26 @@
 
     Subclasses of FileSystem provide a specific file-system implementation
     (e.g. HttpFileSystem, HostFileSystem, etc).
+
+    Asynchronous filesystems may return from onMsg() before the request
+    is handled, and finish the request later in update(), which is
+    called regularly on the IO lane thread as long as it returns true.
+    Between the calls to update(), the IO lane thread calls wait(),
+    which should block until the requests make progress (e.g. until
+    there's activity on the sockets of the requests), or until wakeup()
+    is called from the main thread because new messages have arrived.
+    If wait() isn't implemented, update() is called every millisecond.
+
+    Filesystems should flag requests as handled with setHandled(),
+    which counts the requests the IO worker has passed on as they are
+    (plain reads without callbacks) for the IO metrics, before the
+    main thread can take the result.
 */
 #include "Core/String/StringAtom.h"
 #include "Core/RefCounted.h"
+#include "Core/Time/Duration.h"
 #include "IO/FS/ioRequests.h"
+#include <functional>
 
 namespace Oryol {
     
@@ -28,8 +44,18 @@ public:
     virtual void initLane();
     /// called when IO message should be handled
     virtual void onMsg(const Ptr<IORequest>& ioReq);
+    /// called on the IO lane thread, return true if requests are still in flight
+    virtual bool update();
+    /// called on the IO lane thread while update() returns true, wait for progress, return false if not supported
+    virtual bool wait(Duration timeout);
+    /// called on the main thread to end a wait() because new messages have arrived
+    virtual void wakeup();
+    /// flag a request as handled, counts it first if the IO worker asked for it
+    void setHandled(const Ptr<IORequest>& ioReq);
 
     StringAtom scheme;
+    /// set by the IO worker, counts a request for the IO metrics
+    std::function<void(const Ptr<IORequest>&)> countFunc;
 };
     
 } // namespace Oryol
@@ -7,20 +7,40 @@
     These are all the core IO requests classes. If you want to 
     add custom requests to your own filesystem implementations, please
     add those custom requests in your own module, not here.
+
+    Each message carries a compact type tag (MsgType), which the IO
+    router, workers and filesystems use for dispatch instead of
+    IsA<>() chains, ioMsgCast() then downcasts a message with a
+    static_cast.
 */
 #include "Core/RefCounted.h"
 #include "Core/Containers/Buffer.h"
 #include "IO/Core/URL.h"
 #include "IO/Core/IOStatus.h"
+#include "Core/Time/TimePoint.h"
+#include <functional>
 
 namespace Oryol {
 namespace _priv {
+//------------------------------------------------------------------------------
+/// compact type tag of IO messages
+enum class ioMsgType : uint8_t {
+    Msg,
+    Request,        // an IORequest which isn't a read or write (e.g. a custom request)
+    Read,           // IORead and its subclasses
+    ReadGroup,      // a coalesced read of the IO workers
+    Write,
+    NotifyAdded,
+    NotifyRemoved,
+    NotifyReplaced,
+};
+
 //------------------------------------------------------------------------------
 class ioMsg : public RefCounted {
     OryolClassDecl(ioMsg);
     OryolBaseTypeDecl(ioMsg);
 public:
-    ioMsg() : Handled(false), Cancelled(false) { };
+    ioMsg() : Handled(false), Cancelled(false), MsgType(ioMsgType::Msg) { };
     #if ORYOL_HAS_ATOMIC
     std::atomic<bool> Handled;
     std::atomic<bool> Cancelled;
@@ -28,7 +48,29 @@ public:
     bool Handled;
     bool Cancelled;
     #endif
+    ioMsgType MsgType;
+
+    /// return true if the message is an IORequest
+    bool isRequest() const {
+        return (this->MsgType >= ioMsgType::Request) && (this->MsgType <= ioMsgType::Write);
+    };
+    /// return true if the message is an IORead (or a read group)
+    bool isRead() const {
+        return (ioMsgType::Read == this->MsgType) || (ioMsgType::ReadGroup == this->MsgType);
+    };
+    /// return true if the message is a notifyWorkers message
+    bool isNotify() const {
+        return this->MsgType >= ioMsgType::NotifyAdded;
+    };
 };
+
+//------------------------------------------------------------------------------
+/// downcast an IO message after checking its MsgType, returns a raw pointer
+template<class T, class U> T*
+ioMsgCast(const Ptr<U>& msg) {
+    o_assert_dbg(msg->template IsA<T>());
+    return static_cast<T*>(msg.get());
+}
 } // namespace _priv;
 
 //------------------------------------------------------------------------------
@@ -36,27 +78,91 @@ class IORequest : public _priv::ioMsg {
     OryolClassDecl(IORequest);
     OryolTypeDecl(IORequest, _priv::ioMsg);
 public:
+    IORequest() { this->MsgType = _priv::ioMsgType::Request; };
     URL Url;
-    int StartOffset = 0;
-    int EndOffset = EndOfFile;
+    int64_t StartOffset = 0;
+    int64_t EndOffset = EndOfFile;
     Buffer Data;
     IOStatus::Code Status = IOStatus::InvalidIOStatus;
     String ErrorDesc;
+    TimePoint PutTime;      // set by the IO system when metrics are enabled
+    TimePoint StartTime;    // set by the IO worker when metrics are enabled
+    bool CountWhenHandled = false;  // set by the IO worker, see FileSystem::setHandled()
 };
 
 //------------------------------------------------------------------------------
+/**
+    By default the result of an IORead is returned in the Data buffer.
+    To read directly into caller-owned memory, either set DestPtr and
+    DestCapacity, or set DestFunc, which is called on the IO thread
+    with the result size once it is known and must return a pointer
+    to at least that many bytes (or nullptr to reject the result).
+    If the size isn't known up front (e.g. a chunked HTTP response),
+    DestFunc is called again with a bigger size whenever the result
+    outgrows the memory, and must then return memory which contains
+    the bytes written so far (like realloc() does).
+    The memory must stay valid until the request is handled. DestSize
+    is the number of bytes actually written to the destination memory,
+    if the result doesn't fit, the request fails with
+    IOStatus::RequestEntityTooLarge.
+
+    Filesystems should write the result through the *Result() methods,
+    which work for both cases.
+
+    StartOffset and EndOffset are 64-bit, but the result of a single
+    read is limited to Buffer::MaxSize bytes (ResultSize() and the
+    Dest* members are ints like the Buffer sizes), larger files must
+    be read in ranges. The *Result() methods fail instead of growing
+    the result past that limit.
+
+    ProcessFunc is called on the IO thread after the data has been
+    read successfully, but before the request is flagged as handled.
+    This moves work like file format parsing off the main thread.
+    The function may fail the request by setting Status and ErrorDesc.
+
+    HandledFunc is called on the IO thread right after the request
+    has been flagged as handled, whether it succeeded or not. This
+    can be used to wake up a consumer instead of polling Handled.
+*/
 class IORead : public IORequest {
     OryolClassDecl(IORead);
     OryolTypeDecl(IORead, IORequest);
 public:
+    IORead() { this->MsgType = _priv::ioMsgType::Read; };
     bool CacheReadEnabled = false;
     bool CacheWriteEnabled = false;
+    bool DecompressEnabled = false;
+    bool CompletionListEnabled = false;     // push to IO completion list when handled (used by IO::Load())
+
+    uint8_t* DestPtr = nullptr;
+    int DestCapacity = 0;
+    std::function<uint8_t*(int size)> DestFunc;
+    int DestSize = 0;
+    std::function<void(IORead* req)> ProcessFunc;
+    std::function<void()> HandledFunc;
+
+    /// return true if the result goes to caller-owned memory
+    bool HasDest() const;
+    /// announce the total result size if known up front, return false if the destination is too small
+    bool ReserveResult(int64_t size);
+    /// append numBytes to the result, return write pointer, or nullptr if the destination is too small
+    uint8_t* AddResult(int numBytes);
+    /// copy data into the result, return false if the destination is too small
+    bool SetResult(const uint8_t* ptr, int numBytes);
+    /// shrink the result to numBytes (e.g. after a partial read)
+    void TruncateResult(int numBytes);
+    /// get the result size in bytes
+    int ResultSize() const;
+    /// get pointer to the result data (nullptr if empty)
+    const uint8_t* ResultData() const;
 };
 
 //------------------------------------------------------------------------------
 class IOWrite : public IORequest {
     OryolClassDecl(IOWrite);
     OryolTypeDecl(IOWrite, IORequest);
+public:
+    IOWrite() { this->MsgType = _priv::ioMsgType::Write; };
 };
 
 //------------------------------------------------------------------------------
@@ -71,18 +177,138 @@ public:
 class notifyFileSystemRemoved : public notifyWorkers {
     OryolClassDecl(notifyFileSystemRemoved);
     OryolTypeDecl(notifyFileSystemRemoved, notifyWorkers);
+public:
+    notifyFileSystemRemoved() { this->MsgType = _priv::ioMsgType::NotifyRemoved; };
 };
 
 //------------------------------------------------------------------------------
 class notifyFileSystemAdded : public notifyWorkers {
     OryolClassDecl(notifyFileSystemAdded);
     OryolTypeDecl(notifyFileSystemAdded, notifyWorkers);
+public:
+    notifyFileSystemAdded() { this->MsgType = _priv::ioMsgType::NotifyAdded; };
 };
 
 //------------------------------------------------------------------------------
 class notifyFileSystemReplaced : public notifyWorkers {
     OryolClassDecl(notifyFileSystemReplaced);
     OryolTypeDecl(notifyFileSystemReplaced, notifyWorkers);
+public:
+    notifyFileSystemReplaced() { this->MsgType = _priv::ioMsgType::NotifyReplaced; };
 };
 
+//------------------------------------------------------------------------------
+inline bool
+IORead::HasDest() const {
+    return (nullptr != this->DestPtr) || this->DestFunc;
+}
+
+//------------------------------------------------------------------------------
+inline bool
+IORead::ReserveResult(int64_t size) {
+    if ((size < 0) || (size > Buffer::MaxSize)) {
+        return false;
+    }
+    if (this->HasDest()) {
+        const int64_t total = this->DestSize + size;
+        if (total > Buffer::MaxSize) {
+            return false;
+        }
+        if (this->DestFunc && (total > this->DestCapacity)) {
+            // ask for more memory, grow geometrically if the result size
+            // isn't known up front, so that chunked results don't cause
+            // a reallocation for each chunk
+            int64_t capacity = total;
+            if ((this->DestSize > 0) && (capacity < 2 * int64_t(this->DestCapacity))) {
+                capacity = 2 * int64_t(this->DestCapacity);
+                if (capacity > Buffer::MaxSize) {
+                    capacity = Buffer::MaxSize;
+                }
+            }
+            this->DestPtr = this->DestFunc(int(capacity));
+            this->DestCapacity = this->DestPtr ? int(capacity) : 0;
+            if (nullptr == this->DestPtr) {
+                this->DestSize = 0;
+            }
+        }
+        return total <= this->DestCapacity;
+    }
+    else {
+        if ((this->Data.Size() + size) > Buffer::MaxSize) {
+            return false;
+        }
+        this->Data.Reserve(int(size));
+        return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+inline uint8_t*
+IORead::AddResult(int numBytes) {
+    o_assert_dbg(numBytes > 0);
+    if (this->HasDest()) {
+        if (!this->ReserveResult(numBytes)) {
+            return nullptr;
+        }
+        uint8_t* ptr = this->DestPtr + this->DestSize;
+        this->DestSize += numBytes;
+        return ptr;
+    }
+    else {
+        if (numBytes > (Buffer::MaxSize - this->Data.Size())) {
+            return nullptr;
+        }
+        return this->Data.Add(numBytes);
+    }
+}
+
+//------------------------------------------------------------------------------
+inline bool
+IORead::SetResult(const uint8_t* ptr, int numBytes) {
+    this->TruncateResult(0);
+    if (numBytes > 0) {
+        uint8_t* dst = this->AddResult(numBytes);
+        if (nullptr == dst) {
+            return false;
+        }
+        Memory::Copy(ptr, dst, numBytes);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+inline void
+IORead::TruncateResult(int numBytes) {
+    o_assert_dbg((numBytes >= 0) && (numBytes <= this->ResultSize()));
+    if (this->HasDest()) {
+        this->DestSize = numBytes;
+    }
+    else if (0 == numBytes) {
+        this->Data.Clear();
+    }
+    else {
+        // NOTE: Buffer can't shrink, move the remaining data into a new buffer
+        Buffer data;
+        data.Add(this->Data.Data(), numBytes);
+        this->Data = std::move(data);
+    }
+}
+
+//------------------------------------------------------------------------------
+inline int
+IORead::ResultSize() const {
+    return this->HasDest() ? this->DestSize : this->Data.Size();
+}
+
+//------------------------------------------------------------------------------
+inline const uint8_t*
+IORead::ResultData() const {
+    if (this->HasDest()) {
+        return this->DestSize > 0 ? this->DestPtr : nullptr;
+    }
+    else {
+        return this->Data.Empty() ? nullptr : this->Data.Data();
+    }
+}
+
 } // namespace Oryol
@@ -3,6 +3,10 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "ioRouter.h"
+#include "IO/Core/ioCoalesceCounter.h"
+#include "IO/Core/ioMetricsCounter.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/stringAtomTable.h"
 
 namespace Oryol {
 namespace _priv {
@@ -10,8 +14,9 @@ namespace _priv {
 //------------------------------------------------------------------------------
 void
 ioRouter::setup(const ioPointers& ptrs) {
-    for (auto& worker : this->workers) {
-        worker.start(ptrs);
+    this->pointers = ptrs;
+    for (int i = 0; i < IOConfig::NumWorkers; i++) {
+        this->workers[i].start(ptrs, i);
     }
 }
 
@@ -34,12 +39,19 @@ ioRouter::doWork() {
 //------------------------------------------------------------------------------
 void
 ioRouter::put(const Ptr<ioMsg>& msg) {
-    if (msg->IsA<notifyWorkers>()) {
+    if (this->pointers.metricsCounter->isEnabled() && msg->isRequest()) {
+        ioMsgCast<IORequest>(msg)->PutTime = Clock::Now();
+    }
+    if (msg->isNotify()) {
         // notifyWorker messages must be distributed to all workers
         for (auto& worker : this->workers) {
             worker.put(msg);
         }
     }
+    else if (msg->isRead() && this->pointers.coalesceCounter->isCoalesceEnabled()) {
+        // reads of the same URL go to the same worker so they can be coalesced
+        this->workers[this->workerForRead(ioMsgCast<IORead>(msg))].put(msg);
+    }
     else {
         // for all other messages, use a round-robin dispatch
         this->curWorker = (this->curWorker + 1) % IOConfig::NumWorkers;
@@ -47,6 +59,19 @@ ioRouter::put(const Ptr<ioMsg>& msg) {
     }
 }
 
+//------------------------------------------------------------------------------
+int
+ioRouter::queueDepth(int workerIndex) const {
+    return this->workers[workerIndex].queueDepth();
+}
+
+//------------------------------------------------------------------------------
+int
+ioRouter::workerForRead(const Ptr<IORead>& msg) {
+    const uint32_t hash = uint32_t(stringAtomTable::HashForString(msg->Url.AsCStr()));
+    return int(hash % IOConfig::NumWorkers);
+}
+
 } // namespace _priv
 } // namespace Oryol
 
@@ -4,6 +4,11 @@
     @class Oryol::_priv::ioRouter
     @ingroup IO
     @brief route IO requests to ioWorkers
+
+    If IORead coalescing is enabled (see IOSetup::CoalesceReads), all
+    IORead requests for the same URL are routed to the same ioWorker, so
+    that identical or adjacent reads can be coalesced by the worker,
+    otherwise messages are distributed round-robin.
 */
 #include "Core/Containers/StaticArray.h"
 #include "IO/Core/IOConfig.h"
@@ -23,8 +28,14 @@ public:
     void put(const Ptr<ioMsg>& msg);
     /// perform per-frame work
     void doWork();
+    /// get the number of messages waiting in a worker's queue
+    int queueDepth(int workerIndex) const;
 
 private:
+    /// select the worker for an IORead request
+    int workerForRead(const Ptr<IORead>& msg);
+
+    ioPointers pointers;
     int curWorker = 0;
     StaticArray<ioWorker, IOConfig::NumWorkers> workers;
 };
@@ -4,21 +4,34 @@
 #include "Pre.h"
 #include "ioWorker.h"
 #include "IO/Core/schemeRegistry.h"
+#include "IO/Core/ioCache.h"
+#include "IO/Core/ioDecodeCounter.h"
+#include "IO/Core/ioCompletionList.h"
+#include "IO/Core/ioCoalesceCounter.h"
+#include "IO/Core/ioMetricsCounter.h"
+#include "IO/Core/IOConfig.h"
+#include "Core/String/StringBuilder.h"
+#include "Core/Time/Clock.h"
+#include "Core/Trace.h"
+#include <algorithm>
+#include <cstring>
 
 namespace Oryol {
 namespace _priv {
 
 //------------------------------------------------------------------------------
 ioWorker::ioWorker() :
-threadStopRequested(false) {
+threadStopRequested(false),
+numQueued(0) {
     // empty
 }
 
 //------------------------------------------------------------------------------
 void
-ioWorker::start(const ioPointers& ptrs) {
+ioWorker::start(const ioPointers& ptrs, int index_) {
     o_assert(!this->threadStartRequested);
     this->pointers = ptrs;
+    this->index = index_;
     #if ORYOL_HAS_THREADS
         this->sendThreadId = std::this_thread::get_id();
         this->thread = std::thread(threadFunc, this);
@@ -32,8 +45,14 @@ ioWorker::stop() {
     o_assert(this->threadStartRequested);
     this->threadStopRequested = true;
     #if ORYOL_HAS_THREADS
+    {
+        std::lock_guard<std::mutex> lock(this->transferMutex);
         this->transferCondVar.notify_one();
-        this->thread.join();
+        if (this->waitingFileSystem) {
+            this->waitingFileSystem->wakeup();
+        }
+    }
+    this->thread.join();
     #endif
     this->threadStopped = true;
 }
@@ -45,6 +64,13 @@ ioWorker::put(const Ptr<ioMsg>& msg) {
     o_assert(this->threadStartRequested);
     o_assert(!this->threadStopped);
     this->writeQueue.Enqueue(msg);
+    this->numQueued++;
+}
+
+//------------------------------------------------------------------------------
+int
+ioWorker::queueDepth() const {
+    return this->numQueued;
 }
 
 //------------------------------------------------------------------------------
@@ -64,6 +90,9 @@ ioWorker::doWork() {
         std::lock_guard<std::mutex> lock(this->transferMutex);
         if (!this->transferQueue.Empty()) {
             this->transferCondVar.notify_one();
+            if (this->waitingFileSystem) {
+                this->waitingFileSystem->wakeup();
+            }
         }
     }
     #endif
@@ -72,9 +101,12 @@ ioWorker::doWork() {
         // if platform has no threads, pump the message queue right
         // FIXME: we could do without all those queue transfers here!
         this->moveTransferToReadQueue();
+        this->coalesceReads();
         while (!this->readQueue.Empty()) {
             this->onMsg(std::move(this->readQueue.Dequeue()));
         }
+        this->fileSystemsBusy = this->updateFileSystems();
+        this->checkPendingReads();
     #endif
 }
 
@@ -88,20 +120,60 @@ ioWorker::threadFunc(ioWorker* self) {
     // moves them from the transfer queue, processes them then goes back to sleep
     while (!self->threadStopRequested) {
 
-        // wait for messages to arrive, and if so, transfer to read queue
+        // wait for messages to arrive, and if so, transfer to read queue,
+        // if requests are pending in asynchronous filesystems, only
+        // wait for a short time so that they are checked regularly
+        // (filesystems which are busy in update() wait for their
+        // requests to make progress, or are pumped more frequently)
         {
             std::unique_lock<std::mutex> lock(self->transferMutex);
-            self->transferCondVar.wait(lock);
+            if (self->fileSystemsBusy) {
+                if (self->transferQueue.Empty() && !self->threadStopRequested) {
+                    self->waitFileSystem(lock);
+                }
+            }
+            else if (self->pendingReads.Empty()) {
+                self->transferCondVar.wait(lock);
+            }
+            else {
+                self->transferCondVar.wait_for(lock, std::chrono::milliseconds(10));
+            }
             self->moveTransferToReadQueue();
             lock.unlock();
         }
+        {
+            o_trace_scoped(IO_WorkerProcess);
+            self->coalesceReads();
 
-        // now process the messages, this happens without locking
-        while (!self->readQueue.Empty()) {
-            self->onMsg(std::move(self->readQueue.Dequeue()));
+            // now process the messages, this happens without locking
+            while (!self->readQueue.Empty()) {
+                self->onMsg(std::move(self->readQueue.Dequeue()));
+            }
+            self->fileSystemsBusy = self->updateFileSystems();
+            self->checkPendingReads();
         }
     }
 }
+
+//------------------------------------------------------------------------------
+void
+ioWorker::waitFileSystem(std::unique_lock<std::mutex>& lock) {
+    // a single busy filesystem can block in wait() (e.g. on its sockets),
+    // doWork() wakes it up when new messages arrive, otherwise the
+    // busy filesystems are pumped every millisecond
+    bool waited = false;
+    if (this->busyFileSystem) {
+        FileSystem* fs = this->busyFileSystem;
+        this->waitingFileSystem = fs;
+        lock.unlock();
+        waited = fs->wait(Duration::FromMilliSeconds(double(IOConfig::MaxFileSystemWaitMs)));
+        lock.lock();
+        this->waitingFileSystem = nullptr;
+    }
+    if (!waited && this->transferQueue.Empty()) {
+        this->transferCondVar.wait_for(lock, std::chrono::milliseconds(1));
+    }
+}
 #endif
 
 //------------------------------------------------------------------------------
@@ -156,14 +228,15 @@ ioWorker::moveTransferToReadQueue() {
 //------------------------------------------------------------------------------
 Ptr<FileSystem>
 ioWorker::fileSystemForURL(const URL& url) {
-    StringAtom scheme = url.Scheme();
-    if (this->fileSystems.Contains(scheme)) {
-        return this->fileSystems[scheme];
-    }
-    else {
-        o_warn("ioLane::fileSystemForURL: no filesystem registered for URL scheme '%s'!\n", scheme.AsCStr());
-        return Ptr<FileSystem>();
+    // NOTE: there are only a few filesystems, so a linear search
+    // which doesn't need to create a String for the scheme is fastest
+    for (const auto& kvp : this->fileSystems) {
+        if (url.HasScheme(kvp.Key().AsCStr())) {
+            return kvp.Value();
+        }
     }
+    o_warn("ioLane::fileSystemForURL: no filesystem registered for URL scheme '%s'!\n", url.Scheme().AsCStr());
+    return Ptr<FileSystem>();
 }
 
 //------------------------------------------------------------------------------
@@ -171,7 +244,7 @@ bool
 ioWorker::checkCancelled(const Ptr<IORequest>& msg) {
     if (msg->Cancelled) {
         msg->Status = IOStatus::Cancelled;
-        msg->Handled = true;
+        this->setHandled(msg);
         return true;
     }
     else {
@@ -179,41 +252,682 @@ ioWorker::checkCancelled(const Ptr<IORequest>& msg) {
     }
 }
 
+//------------------------------------------------------------------------------
+void
+ioWorker::setHandled(const Ptr<IORequest>& msg) {
+    // post-process successful reads on this thread, before
+    // the main thread can see the request as handled
+    if (msg->isRead() && (IOStatus::OK == msg->Status) && !msg->Cancelled) {
+        IORead* readMsg = ioMsgCast<IORead>(msg);
+        if (readMsg->ProcessFunc) {
+            readMsg->ProcessFunc(readMsg);
+        }
+    }
+    // NOTE: the request must be counted before it is flagged as
+    // handled, since the main thread may take the result after that
+    if (this->pointers.metricsCounter->isEnabled() && (ioMsgType::ReadGroup != msg->MsgType)) {
+        this->countRequest(msg);
+    }
+    msg->Handled = true;
+    if (msg->isRead()) {
+        IORead* readMsg = ioMsgCast<IORead>(msg);
+        if (readMsg->HandledFunc) {
+            readMsg->HandledFunc();
+        }
+        if (readMsg->CompletionListEnabled) {
+            this->pointers.completionList->push(readMsg);
+        }
+        else if (ioMsgType::ReadGroup == readMsg->MsgType) {
+            this->finishGroup(ioMsgCast<readGroup>(msg));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::countRequest(const Ptr<IORequest>& msg) {
+    int64_t numBytes = msg->Data.Size();
+    if (msg->isRead()) {
+        numBytes = ioMsgCast<IORead>(msg)->ResultSize();
+    }
+    this->pointers.metricsCounter->countRequest(this->index,
+        msg->Url,
+        msg->Status,
+        numBytes,
+        msg->StartTime - msg->PutTime,
+        Clock::Since(msg->StartTime));
+}
+
+//------------------------------------------------------------------------------
+bool
+ioWorker::canCoalesce(const Ptr<IORead>& msg) const {
+    return !msg->Cancelled && !msg->DecompressEnabled && (msg->StartOffset >= 0);
+}
+
+//------------------------------------------------------------------------------
+bool
+ioWorker::canMerge(const Ptr<IORead>& msg) const {
+    // NOTE: cached requests are not merged, since the cache
+    // is keyed by the requested range
+    const ioCache* cache = this->pointers.cache;
+    const bool cacheEnabled = (nullptr != cache) && cache->isEnabled();
+    return (EndOfFile != msg->EndOffset) &&
+           ((msg->EndOffset - msg->StartOffset) <= IOConfig::MaxMergedReadSize) &&
+           !(cacheEnabled && (msg->CacheReadEnabled || msg->CacheWriteEnabled));
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::coalesceReads() {
+    ioCoalesceCounter* counter = this->pointers.coalesceCounter;
+    if (!counter->isCoalesceEnabled() || (this->readQueue.Size() < 2)) {
+        return;
+    }
+
+    // gather the queued messages, and sort the reads which can be
+    // coalesced by URL and range (reads to the end of file after
+    // explicit ranges, so that those don't interrupt mergeable
+    // ranges), and then put order
+    Array<Ptr<ioMsg>> msgs;
+    Array<Ptr<IORead>> reads;
+    Array<int> order;
+    msgs.Reserve(this->readQueue.Size());
+    while (!this->readQueue.Empty()) {
+        msgs.Add(this->readQueue.Dequeue());
+        Ptr<IORead> read;
+        if (msgs.Back()->isRead()) {
+            read = ioMsgCast<IORead>(msgs.Back());
+            if (this->canCoalesce(read)) {
+                order.Add(msgs.Size() - 1);
+            }
+        }
+        reads.Add(read);
+    }
+    std::sort(order.begin(), order.end(), [&reads](int a, int b) {
+        const Ptr<IORead>& readA = reads[a];
+        const Ptr<IORead>& readB = reads[b];
+        int cmp = std::strcmp(readA->Url.AsCStr(), readB->Url.AsCStr());
+        if (0 != cmp) {
+            return cmp < 0;
+        }
+        if ((EndOfFile == readA->EndOffset) != (EndOfFile == readB->EndOffset)) {
+            return EndOfFile == readB->EndOffset;
+        }
+        if (readA->StartOffset != readB->StartOffset) {
+            return readA->StartOffset < readB->StartOffset;
+        }
+        if (readA->EndOffset != readB->EndOffset) {
+            return readA->EndOffset < readB->EndOffset;
+        }
+        return a < b;
+    });
+
+    // find runs of identical (or mergeable) reads, and replace
+    // each run with a read group at the position of its first request
+    const bool mergeEnabled = counter->isMergeEnabled();
+    int i = 0;
+    while (i < order.Size()) {
+        const Ptr<IORead>& first = reads[order[i]];
+        const int64_t start = first->StartOffset;
+        int64_t end = first->EndOffset;
+        bool merged = false;
+        bool mergeable = mergeEnabled && this->canMerge(first);
+        int j = i + 1;
+        for (; j < order.Size(); j++) {
+            const Ptr<IORead>& cur = reads[order[j]];
+            if (0 != std::strcmp(cur->Url.AsCStr(), first->Url.AsCStr())) {
+                break;
+            }
+            if (!merged && (cur->StartOffset == start) && (cur->EndOffset == end)) {
+                mergeable &= this->canMerge(cur);
+            }
+            else if (mergeable && this->canMerge(cur) && (cur->StartOffset <= end) &&
+                     ((std::max(end, cur->EndOffset) - start) <= IOConfig::MaxMergedReadSize)) {
+                end = std::max(end, cur->EndOffset);
+                merged = true;
+            }
+            else {
+                break;
+            }
+        }
+        const int num = j - i;
+        if (num > 1) {
+            std::sort(order.begin() + i, order.begin() + j);
+            Ptr<readGroup> group = readGroup::Create();
+            group->Url = first->Url;
+            group->StartOffset = start;
+            group->EndOffset = end;
+            group->merged = merged;
+            group->CacheReadEnabled = !merged;
+            group->reads.Reserve(num);
+            for (int k = i; k < j; k++) {
+                const Ptr<IORead>& read = reads[order[k]];
+                group->reads.Add(read);
+                if (!merged) {
+                    // only serve the group from the cache if all requests allow it
+                    group->CacheReadEnabled &= read->CacheReadEnabled;
+                    group->CacheWriteEnabled |= read->CacheWriteEnabled;
+                }
+                msgs[order[k]] = nullptr;
+            }
+            msgs[order[i]] = group;
+            counter->countGroup(merged ? 0 : num - 1, merged ? num : 0);
+        }
+        i = j;
+    }
+
+    // and put the remaining messages back into the read queue
+    for (auto& msg : msgs) {
+        if (msg) {
+            this->readQueue.Enqueue(std::move(msg));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::finishGroup(const Ptr<readGroup>& group) {
+    const uint8_t* data = group->ResultData();
+    const int size = group->ResultSize();
+    for (int i = 0; i < group->reads.Size(); i++) {
+        const Ptr<IORead>& msg = group->reads[i];
+        if (msg->Cancelled) {
+            msg->Status = IOStatus::Cancelled;
+        }
+        else if (IOStatus::OK != group->Status) {
+            msg->Status = group->Status;
+            msg->ErrorDesc = group->ErrorDesc;
+        }
+        else {
+            // the part of the group result requested by this request
+            const int64_t offset = msg->StartOffset - group->StartOffset;
+            int64_t end = size;
+            if ((EndOfFile != msg->EndOffset) && ((msg->EndOffset - group->StartOffset) < end)) {
+                end = msg->EndOffset - group->StartOffset;
+            }
+            if (offset > size) {
+                msg->Status = IOStatus::RequestedRangeNotSatisfiable;
+                msg->ErrorDesc = "Range outside of file";
+            }
+            else if (!group->merged && !msg->HasDest() && (i == group->reads.Size() - 1)) {
+                // the last request can take over the result
+                msg->Data = std::move(group->Data);
+                msg->Status = IOStatus::OK;
+            }
+            else if (msg->SetResult(data ? data + offset : nullptr, int(std::max(end - offset, int64_t(0))))) {
+                msg->Status = IOStatus::OK;
+            }
+            else {
+                msg->Status = IOStatus::RequestEntityTooLarge;
+                msg->ErrorDesc = "Destination buffer too small";
+            }
+        }
+        this->setHandled(msg);
+    }
+    group->reads.Clear();
+}
+
 //------------------------------------------------------------------------------
 void
 ioWorker::onMsg(const Ptr<ioMsg>& msg) {
-    if (msg->IsA<IORequest>()) {
-        // find filesystem and forward request, NOTE:
-        // the filesystem is responsible to set the
-        // request to 'handled'!
-        Ptr<IORequest> ioReq = msg->DynamicCast<IORequest>();
-        if (!this->checkCancelled(ioReq)) {
-            Ptr<FileSystem> fs = this->fileSystemForURL(ioReq->Url);
-            if (fs) {
-                fs->onMsg(ioReq);
+    // a read group stands for all the queued requests it serves
+    if (ioMsgType::ReadGroup == msg->MsgType) {
+        readGroup* group = ioMsgCast<readGroup>(msg);
+        this->numQueued -= group->reads.Size();
+        if (this->pointers.metricsCounter->isEnabled()) {
+            const TimePoint now = Clock::Now();
+            for (const auto& read : group->reads) {
+                read->StartTime = now;
             }
         }
     }
-    else if (msg->IsA<notifyWorkers>()) {
-        // add, remove or replace a filesystem association
-        const StringAtom& urlScheme = msg->DynamicCast<notifyWorkers>()->Scheme;
-        if (msg->IsA<notifyFileSystemAdded>()) {
-            o_assert(!this->fileSystems.Contains(urlScheme));
-            Ptr<FileSystem> newFileSystem = this->pointers.schemeRegistry->CreateFileSystem(urlScheme);
-            this->fileSystems.Add(urlScheme, newFileSystem);
+    else {
+        this->numQueued--;
+        if (this->pointers.metricsCounter->isEnabled() && msg->isRequest()) {
+            ioMsgCast<IORequest>(msg)->StartTime = Clock::Now();
         }
-        else if (msg->IsA<notifyFileSystemRemoved>()) {
-            o_assert(this->fileSystems.Contains(urlScheme));
-            this->fileSystems.Erase(urlScheme);
+    }
+
+    // dispatch on the message type tag
+    switch (msg->MsgType) {
+        case ioMsgType::Read:
+        case ioMsgType::ReadGroup:
+            this->onRead(ioMsgCast<IORead>(msg));
+            break;
+
+        case ioMsgType::Request:
+        case ioMsgType::Write:
+            this->onRequest(ioMsgCast<IORequest>(msg));
+            break;
+
+        case ioMsgType::NotifyAdded:
+        case ioMsgType::NotifyRemoved:
+        case ioMsgType::NotifyReplaced:
+            this->onNotify(ioMsgCast<notifyWorkers>(msg));
+            break;
+
+        default:
+            // other messages are ignored
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::onRequest(const Ptr<IORequest>& ioReq) {
+    // find filesystem and forward request, NOTE:
+    // the filesystem is responsible to set the
+    // request to 'handled'!
+    if (!this->checkCancelled(ioReq)) {
+        Ptr<FileSystem> fs = this->fileSystemForURL(ioReq->Url);
+        // writes make all cached data of the URL stale, no matter
+        // which cache flags the reads of the URL have been using
+        ioCache* cache = this->pointers.cache;
+        const bool invalidate = (ioMsgType::Write == ioReq->MsgType) && cache && cache->isValid();
+        if (invalidate) {
+            this->invalidateCache(ioReq->Url);
         }
-        else if (msg->IsA<notifyFileSystemReplaced>()) {
-            o_assert(this->fileSystems.Contains(urlScheme));
-            Ptr<FileSystem> newFileSystem = this->pointers.schemeRegistry->CreateFileSystem(urlScheme);
-            this->fileSystems[urlScheme] = newFileSystem;
+        if (fs) {
+            // NOTE: the request can only be counted if the filesystem
+            // handles it synchronously, the byte size must be taken
+            // before, since the main thread may take the request once
+            // it is handled
+            const int64_t numBytes = ioReq->Data.Size();
+            fs->onMsg(ioReq);
+            if (invalidate && ioReq->Handled) {
+                // drop data which has been cached by other workers while the write was in flight
+                cache->invalidate(ioReq->Url);
+            }
+            if (this->pointers.metricsCounter->isEnabled() && ioReq->Handled) {
+                this->pointers.metricsCounter->countRequest(this->index,
+                    ioReq->Url,
+                    ioReq->Status,
+                    numBytes,
+                    ioReq->StartTime - ioReq->PutTime,
+                    Clock::Since(ioReq->StartTime));
+            }
         }
-        msg->Handled = true;
     }
 }
 
+//------------------------------------------------------------------------------
+void
+ioWorker::onNotify(const Ptr<notifyWorkers>& msg) {
+    // add, remove or replace a filesystem association, NOTE: the
+    // scheme registry is keyed by main-thread string atoms, while
+    // the worker's filesystem map must use this thread's string atoms
+    const StringAtom& urlScheme = msg->Scheme;
+    const StringAtom localScheme(urlScheme.AsCStr());
+    if (ioMsgType::NotifyAdded == msg->MsgType) {
+        o_assert(!this->fileSystems.Contains(localScheme));
+        Ptr<FileSystem> newFileSystem = this->pointers.schemeRegistry->CreateFileSystem(urlScheme);
+        newFileSystem->countFunc = [this](const Ptr<IORequest>& req) {
+            this->countRequest(req);
+        };
+        this->fileSystems.Add(localScheme, newFileSystem);
+    }
+    else if (ioMsgType::NotifyRemoved == msg->MsgType) {
+        o_assert(this->fileSystems.Contains(localScheme));
+        this->fileSystems.Erase(localScheme);
+    }
+    else if (ioMsgType::NotifyReplaced == msg->MsgType) {
+        o_assert(this->fileSystems.Contains(localScheme));
+        Ptr<FileSystem> newFileSystem = this->pointers.schemeRegistry->CreateFileSystem(urlScheme);
+        newFileSystem->countFunc = [this](const Ptr<IORequest>& req) {
+            this->countRequest(req);
+        };
+        this->fileSystems[localScheme] = newFileSystem;
+    }
+    msg->Handled = true;
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::onRead(const Ptr<IORead>& msg) {
+    if (this->checkCancelled(msg)) {
+        return;
+    }
+    ioCache* cache = this->pointers.cache;
+    const bool cacheEnabled = (nullptr != cache) && cache->isEnabled();
+
+    // cache hits are served without touching the filesystem
+    Buffer cached;
+    if (cacheEnabled && msg->CacheReadEnabled && this->readFromCache(msg, cached)) {
+        this->moveResult(msg, cached);
+        this->setHandled(msg);
+        return;
+    }
+
+    // compressed data is read in chunks and decompressed on the fly
+    if (msg->DecompressEnabled) {
+        if ((0 != msg->StartOffset) || (EndOfFile != msg->EndOffset)) {
+            msg->Status = IOStatus::BadRequest;
+            msg->ErrorDesc = "Ranges are not supported for decompressed reads";
+            this->setHandled(msg);
+        }
+        else {
+            this->readChunks(msg, ioInflater::Create());
+        }
+        return;
+    }
+
+    // find filesystem and forward request, NOTE:
+    // the filesystem is responsible to set the
+    // request to 'handled'!
+    Ptr<FileSystem> fs = this->fileSystemForURL(msg->Url);
+    if (fs) {
+        // NOTE: metrics alone don't need a copy, plain reads are
+        // counted by the filesystem in FileSystem::setHandled()
+        if ((cacheEnabled && msg->CacheWriteEnabled) || msg->CompletionListEnabled || msg->ProcessFunc || msg->HandledFunc ||
+            (ioMsgType::ReadGroup == msg->MsgType)) {
+            // forward a copy of the request, so that the result can be
+            // written to the cache (or post-processed) before the original
+            // request is handled, and the worker knows when the request
+            // has been handled
+            Ptr<IORead> fsMsg = IORead::Create();
+            fsMsg->Url = msg->Url;
+            fsMsg->StartOffset = msg->StartOffset;
+            fsMsg->EndOffset = msg->EndOffset;
+            fsMsg->DestPtr = msg->DestPtr;
+            fsMsg->DestCapacity = msg->DestCapacity;
+            fsMsg->DestFunc = msg->DestFunc;
+            fs->onMsg(fsMsg);
+            if (fsMsg->Handled) {
+                this->finishRead(msg, fsMsg);
+            }
+            else {
+                // asynchronous filesystem, check again later
+                this->pendingReads.Add(pendingRead{ msg, fsMsg, nullptr });
+            }
+        }
+        else {
+            msg->CountWhenHandled = this->pointers.metricsCounter->isEnabled();
+            fs->onMsg(msg);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+String
+ioWorker::cacheKey(const Ptr<IORead>& msg) {
+    if (msg->DecompressEnabled) {
+        // decompressed data must not be mixed up with the raw data
+        StringBuilder builder(ioCache::key(msg->Url, msg->StartOffset, msg->EndOffset));
+        builder.Append("|inflate");
+        return builder.GetString();
+    }
+    else {
+        return ioCache::key(msg->Url, msg->StartOffset, msg->EndOffset);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+ioWorker::readFromCache(const Ptr<IORead>& msg, Buffer& outData) {
+    ioCache* cache = this->pointers.cache;
+    const String key = this->cacheKey(msg);
+    if (cache->read(key, outData)) {
+        return true;
+    }
+    if (cache->useDiskCache(msg->Url)) {
+        // NOTE: the disk cache only works with synchronous filesystems
+        const URL diskUrl = cache->diskURL(key, this->diskGeneration(msg->Url));
+        Ptr<FileSystem> diskFs = this->fileSystemForURL(diskUrl);
+        if (diskFs) {
+            Ptr<IORead> diskMsg = IORead::Create();
+            diskMsg->Url = diskUrl;
+            diskFs->onMsg(diskMsg);
+            if (diskMsg->Handled && (IOStatus::OK == diskMsg->Status)) {
+                cache->countDiskHit();
+                if (!diskMsg->Data.Empty()) {
+                    cache->write(key, diskMsg->Data.Data(), diskMsg->Data.Size());
+                }
+                outData = std::move(diskMsg->Data);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::moveResult(const Ptr<IORead>& msg, Buffer& data) {
+    if (msg->HasDest()) {
+        if (msg->SetResult(data.Empty() ? nullptr : data.Data(), data.Size())) {
+            msg->Status = IOStatus::OK;
+        }
+        else {
+            msg->Status = IOStatus::RequestEntityTooLarge;
+            msg->ErrorDesc = "Destination buffer too small";
+        }
+    }
+    else {
+        msg->Data = std::move(data);
+        msg->Status = IOStatus::OK;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::writeToCache(const Ptr<IORead>& msg) {
+    o_assert_dbg(IOStatus::OK == msg->Status);
+    ioCache* cache = this->pointers.cache;
+    const String key = this->cacheKey(msg);
+    const uint8_t* data = msg->ResultData();
+    const int size = msg->ResultSize();
+    if (0 == size) {
+        return;
+    }
+    cache->write(key, data, size);
+    if (cache->useDiskCache(msg->Url)) {
+        const URL diskUrl = cache->diskURL(key, this->diskGeneration(msg->Url));
+        Ptr<FileSystem> diskFs = this->fileSystemForURL(diskUrl);
+        if (diskFs) {
+            Ptr<IOWrite> diskMsg = IOWrite::Create();
+            diskMsg->Url = diskUrl;
+            diskMsg->Data.Add(data, size);
+            diskFs->onMsg(diskMsg);
+            if (diskMsg->Handled && (IOStatus::OK == diskMsg->Status)) {
+                cache->countDiskWrite();
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+ioWorker::diskGeneration(const URL& url) {
+    ioCache* cache = this->pointers.cache;
+    uint32_t generation = 0;
+    if (!cache->generation(url, generation)) {
+        // not known yet, a missing generation file means generation 0
+        const URL genUrl = cache->generationURL(url);
+        Ptr<FileSystem> diskFs = this->fileSystemForURL(genUrl);
+        if (diskFs) {
+            Ptr<IORead> genMsg = IORead::Create();
+            genMsg->Url = genUrl;
+            diskFs->onMsg(genMsg);
+            if (genMsg->Handled && (IOStatus::OK == genMsg->Status) && (int(sizeof(generation)) == genMsg->Data.Size())) {
+                std::memcpy(&generation, genMsg->Data.Data(), sizeof(generation));
+            }
+        }
+        cache->setGeneration(url, generation);
+    }
+    return generation;
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::invalidateCache(const URL& url) {
+    ioCache* cache = this->pointers.cache;
+    cache->invalidate(url);
+    if (cache->useDiskCache(url)) {
+        // bump and persist the disk cache generation, this makes
+        // the existing disk cache entries of the URL unreachable
+        const uint32_t generation = this->diskGeneration(url) + 1;
+        cache->setGeneration(url, generation);
+        const URL genUrl = cache->generationURL(url);
+        Ptr<FileSystem> diskFs = this->fileSystemForURL(genUrl);
+        if (diskFs) {
+            Ptr<IOWrite> genMsg = IOWrite::Create();
+            genMsg->Url = genUrl;
+            genMsg->Data.Add((const uint8_t*)&generation, sizeof(generation));
+            diskFs->onMsg(genMsg);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::finishRead(const Ptr<IORead>& msg, const Ptr<IORead>& fsMsg) {
+    o_assert_dbg(fsMsg->Handled);
+    msg->Status = fsMsg->Status;
+    msg->ErrorDesc = fsMsg->ErrorDesc;
+    msg->Data = std::move(fsMsg->Data);
+    msg->DestPtr = fsMsg->DestPtr;
+    msg->DestCapacity = fsMsg->DestCapacity;
+    msg->DestSize = fsMsg->DestSize;
+    ioCache* cache = this->pointers.cache;
+    if ((IOStatus::OK == msg->Status) && cache && cache->isEnabled() && msg->CacheWriteEnabled) {
+        this->writeToCache(msg);
+    }
+    this->setHandled(msg);
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::readChunks(const Ptr<IORead>& msg, const Ptr<ioInflater>& inflater) {
+    Ptr<FileSystem> fs = this->fileSystemForURL(msg->Url);
+    if (!fs) {
+        return;
+    }
+    // synchronous filesystems are read chunk by chunk until
+    // the compressed stream is complete, asynchronous filesystems
+    // continue in checkPendingReads()
+    bool moreChunks = true;
+    while (moreChunks) {
+        if (this->checkCancelled(msg)) {
+            return;
+        }
+        Ptr<IORead> fsMsg = IORead::Create();
+        fsMsg->Url = msg->Url;
+        fsMsg->StartOffset = inflater->numBytesIn();
+        fsMsg->EndOffset = fsMsg->StartOffset + IOConfig::DecompressChunkSize;
+        fs->onMsg(fsMsg);
+        if (!fsMsg->Handled) {
+            this->pendingReads.Add(pendingRead{ msg, fsMsg, inflater });
+            return;
+        }
+        moreChunks = this->decodeChunk(msg, fsMsg, inflater);
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+ioWorker::decodeChunk(const Ptr<IORead>& msg, const Ptr<IORead>& fsMsg, const Ptr<ioInflater>& inflater) {
+    o_assert_dbg(fsMsg->Handled);
+    if (IOStatus::OK != fsMsg->Status) {
+        this->finishDecode(msg, inflater, fsMsg->Status, fsMsg->ErrorDesc);
+        return false;
+    }
+    const int64_t requestedSize = fsMsg->EndOffset - fsMsg->StartOffset;
+    const int size = fsMsg->Data.Size();
+    const uint8_t* ptr = size > 0 ? fsMsg->Data.Data() : nullptr;
+    switch (inflater->feed(ptr, size, msg->Data)) {
+        case ioInflater::Done:
+            this->finishDecode(msg, inflater, IOStatus::OK, String());
+            return false;
+        case ioInflater::Error:
+            this->finishDecode(msg, inflater, IOStatus::UnsupportedMediaType, "Failed to decompress data");
+            return false;
+        default:
+            // a short chunk means that the end of the file has been reached,
+            // a longer chunk means the filesystem has ignored the range and
+            // returned the complete file
+            if (size != requestedSize) {
+                this->finishDecode(msg, inflater, IOStatus::DownloadError, "Compressed data is truncated");
+                return false;
+            }
+            return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::finishDecode(const Ptr<IORead>& msg, const Ptr<ioInflater>& inflater, IOStatus::Code status, const String& errorDesc) {
+    ioDecodeCounter* counter = this->pointers.decodeCounter;
+    msg->Status = status;
+    msg->ErrorDesc = errorDesc;
+    if (IOStatus::OK == status) {
+        counter->countDecoded(inflater->numBytesIn(), inflater->numBytesOut(), inflater->decodeTime());
+        if (msg->HasDest()) {
+            // NOTE: decompressed data is copied once into caller memory
+            Buffer decoded(std::move(msg->Data));
+            this->moveResult(msg, decoded);
+        }
+    }
+    else {
+        counter->countFailed(inflater->numBytesIn(), inflater->numBytesOut(), inflater->decodeTime());
+        msg->Data.Clear();
+    }
+    ioCache* cache = this->pointers.cache;
+    if ((IOStatus::OK == msg->Status) && cache && cache->isEnabled() && msg->CacheWriteEnabled) {
+        this->writeToCache(msg);
+    }
+    this->setHandled(msg);
+}
+
+//------------------------------------------------------------------------------
+void
+ioWorker::checkPendingReads() {
+    for (int i = this->pendingReads.Size() - 1; i >= 0; i--) {
+        const Ptr<IORead>& msg = this->pendingReads[i].msg;
+        if (!msg->Cancelled && (ioMsgType::ReadGroup == msg->MsgType)) {
+            // a read group is cancelled once all its requests are cancelled
+            bool allCancelled = true;
+            for (const auto& read : ioMsgCast<readGroup>(msg)->reads) {
+                allCancelled &= bool(read->Cancelled);
+            }
+            msg->Cancelled = allCancelled;
+        }
+        if (msg->Cancelled) {
+            this->pendingReads[i].fsMsg->Cancelled = true;
+        }
+        if (this->pendingReads[i].fsMsg->Handled) {
+            // NOTE: reading the next chunk of a compressed stream
+            // may add a new pending read to the end of the array
+            pendingRead pending = this->pendingReads[i];
+            this->pendingReads.Erase(i);
+            if (pending.inflater) {
+                if (this->decodeChunk(pending.msg, pending.fsMsg, pending.inflater)) {
+                    this->readChunks(pending.msg, pending.inflater);
+                }
+            }
+            else {
+                this->finishRead(pending.msg, pending.fsMsg);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+ioWorker::updateFileSystems() {
+    int numBusy = 0;
+    this->busyFileSystem = nullptr;
+    for (const auto& kvp : this->fileSystems) {
+        if (kvp.Value()->update()) {
+            this->busyFileSystem = kvp.Value().get();
+            numBusy++;
+        }
+    }
+    if (numBusy > 1) {
+        // several busy filesystems can't wait at the same time
+        this->busyFileSystem = nullptr;
+    }
+    return numBusy > 0;
+}
+
 } // namespace _priv
 } // namespace Oryol
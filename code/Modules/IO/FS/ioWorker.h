@@ -11,11 +11,50 @@
     'transfer queue', and the worker thread will be signaled. The 
     worker thread wakes up, moves the messages from the transfer queue
     to a read-queue, processes them and goes back to sleep.
+
+    IORead requests with the CacheReadEnabled flag are first looked
+    up in the ioCache and are only forwarded to the filesystem on a
+    cache miss. IORead requests with CacheWriteEnabled are forwarded
+    to the filesystem as an internal copy, the result is written to the
+    cache before it is moved into the original request, so that the 
+    original request is only touched by the worker thread until it is
+    flagged as handled.
+
+    IORead requests with the DecompressEnabled flag are read from
+    the filesystem in chunks of IOConfig::DecompressChunkSize bytes,
+    each chunk is decompressed into the result buffer as soon as it
+    has been read, so that the complete compressed data is never
+    held in memory.
+
+    IORead requests with caller-owned destination memory (see IORead)
+    are forwarded with the destination, so that the filesystem reads
+    directly into it. Only results served from the cache, or
+    decompressed results, are copied into the destination memory.
+
+    If IO metrics are enabled (see IOSetup::MetricsEnabled), IORead
+    requests are also forwarded as an internal copy, so that the worker
+    can count the request once it has been handled. Other requests are
+    only counted if the filesystem handles them synchronously.
+
+    IORead requests with the CompletionListEnabled flag are always
+    forwarded to the filesystem as an internal copy, so that the worker
+    knows when they are finished, and are pushed to the ioCompletionList
+    once they are flagged as handled.
+
+    If IORead coalescing is enabled, identical IORead requests (same URL
+    and range) which are waiting in the read queue at the same time are
+    served by a single internal read group, the result is copied into
+    each request when the group read has finished. Optionally, requests
+    for overlapping or adjacent ranges of the same URL are merged into
+    one read group covering all ranges. The ioRouter makes sure that
+    all reads of the same URL end up in the same worker.
 */
+#include "Core/Containers/Array.h"
 #include "Core/Containers/Queue.h"
 #include "Core/Containers/Map.h"
 #include "Core/String/StringAtom.h"
 #include "IO/Core/ioPointers.h"
+#include "IO/Core/ioInflater.h"
 #include "IO/FS/ioRequests.h"
 #include "IO/FS/FileSystem.h"
 #if ORYOL_HAS_THREADS
@@ -33,24 +72,80 @@ public:
     /// constructor
     ioWorker();
     /// setup and start the worker thread
-    void start(const ioPointers& ptrs);
+    void start(const ioPointers& ptrs, int index);
     /// stop the worker thread, wait for join
     void stop();
     /// put an io message into the internal message queue
     void put(const Ptr<ioMsg>& msg);
     /// do work on the main thread, this moves queued messages to transfer queue
     void doWork();
+    /// get number of messages which have been put but not yet started
+    int queueDepth() const;
 
 private:
+    /// an internal IORead which serves several coalesced IORead requests
+    class readGroup : public IORead {
+        OryolClassDecl(readGroup);
+        OryolTypeDecl(readGroup, IORead);
+    public:
+        readGroup() { this->MsgType = ioMsgType::ReadGroup; };
+        Array<Ptr<IORead>> reads;   // the original requests in put order
+        bool merged = false;        // true if the requests have different ranges
+    };
+
     /// lookup filesystem for URL
     Ptr<FileSystem> fileSystemForURL(const URL& url);
     /// check for and handle cancelled message
     bool checkCancelled(const Ptr<IORequest>& msg);
-    /// called from thread to handle a generic message
+    /// flag a request as handled, and push it to the completion list if requested
+    void setHandled(const Ptr<IORequest>& msg);
+    /// count a handled request in the IO metrics
+    void countRequest(const Ptr<IORequest>& msg);
+    /// coalesce identical (and merge adjacent) IORead requests in the read queue
+    void coalesceReads();
+    /// test if an IORead can be coalesced with identical requests
+    bool canCoalesce(const Ptr<IORead>& msg) const;
+    /// test if an IORead can be merged with requests of other ranges
+    bool canMerge(const Ptr<IORead>& msg) const;
+    /// copy the result of a read group into its requests
+    void finishGroup(const Ptr<readGroup>& group);
+    /// called from thread to handle a generic message, dispatches on the message type
     void onMsg(const Ptr<ioMsg>& msg);
+    /// called from thread to forward a non-read IORequest to its filesystem
+    void onRequest(const Ptr<IORequest>& msg);
+    /// called from thread to add, remove or replace a filesystem
+    void onNotify(const Ptr<notifyWorkers>& msg);
+    /// called from thread to handle an IORead message
+    void onRead(const Ptr<IORead>& msg);
+    /// try to serve an IORead from the memory or disk cache
+    bool readFromCache(const Ptr<IORead>& msg, Buffer& outData);
+    /// set result data of a request, copy into caller memory if requested
+    void moveResult(const Ptr<IORead>& msg, Buffer& data);
+    /// write the result of a finished IORead to the memory and disk cache
+    void writeToCache(const Ptr<IORead>& msg);
+    /// get the disk cache generation of an URL, read from the cache directory if not known
+    uint32_t diskGeneration(const URL& url);
+    /// drop all memory and disk cache entries of an URL (called for writes)
+    void invalidateCache(const URL& url);
+    /// finish an IORead which was forwarded as internal copy
+    void finishRead(const Ptr<IORead>& msg, const Ptr<IORead>& fsMsg);
+    /// read and decompress chunks of a compressed IORead
+    void readChunks(const Ptr<IORead>& msg, const Ptr<ioInflater>& inflater);
+    /// decompress a chunk, return true if more chunks must be read
+    bool decodeChunk(const Ptr<IORead>& msg, const Ptr<IORead>& fsMsg, const Ptr<ioInflater>& inflater);
+    /// finish a compressed IORead
+    void finishDecode(const Ptr<IORead>& msg, const Ptr<ioInflater>& inflater, IOStatus::Code status, const String& errorDesc);
+    /// get the read cache key for an IORead
+    static String cacheKey(const Ptr<IORead>& msg);
+    /// check forwarded IORead copies for completion (only async filesystems)
+    void checkPendingReads();
+    /// give asynchronous filesystems time to work, return true if any is busy
+    bool updateFileSystems();
     /// the thread worker func
     #if ORYOL_HAS_THREADS
     static void threadFunc(ioWorker* self);
+    /// wait in a busy filesystem until its requests make progress (called with locked transferMutex)
+    void waitFileSystem(std::unique_lock<std::mutex>& lock);
     #endif
     /// test if we are on the send-thread
     bool isSendThread();
@@ -62,11 +157,21 @@ private:
     void moveTransferToReadQueue();
 
     ioPointers pointers;
+    int index = 0;
     Map<StringAtom, Ptr<FileSystem>> fileSystems;
 
     Queue<Ptr<ioMsg>> writeQueue;     // written by sender thread
     Queue<Ptr<ioMsg>> transferQueue;  // written by sender, read by worker thread (locked)
     Queue<Ptr<ioMsg>> readQueue;      // read by worker thread
+    struct pendingRead {
+        Ptr<IORead> msg;                // the original request
+        Ptr<IORead> fsMsg;              // the copy forwarded to the filesystem
+        Ptr<ioInflater> inflater;       // only for compressed reads
+    };
+    Array<pendingRead> pendingReads;  // only used by worker thread
+    bool fileSystemsBusy = false;     // only used by worker thread
+    FileSystem* busyFileSystem = nullptr;       // the only busy filesystem (worker thread)
+    FileSystem* waitingFileSystem = nullptr;    // filesystem in wait() (locked by transferMutex)
 
     #if ORYOL_HAS_THREADS
     std::thread::id sendThreadId;
@@ -77,8 +182,10 @@ private:
     #endif
     #if ORYOL_HAS_ATOMIC
     std::atomic<bool> threadStopRequested;
+    std::atomic<int> numQueued;
     #else
     bool threadStopRequested;
+    int numQueued;
     #endif
     bool threadStartRequested = false;
     bool threadStopped = false;
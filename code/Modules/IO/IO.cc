@@ -6,6 +6,8 @@
 #include "IO/Core/assignRegistry.h"
 #include "IO/Core/ioPointers.h"
 #include "Core/Core.h"
+#include "Core/Log.h"
+#include "Core/Trace.h"
 
 namespace Oryol {
 
@@ -22,6 +24,13 @@ IO::Setup(const IOSetup& setup) {
     ioPointers ptrs;
     ptrs.schemeRegistry = &state->schemeReg;
     ptrs.assignRegistry = &state->assignReg;
+    ptrs.cache = &state->cache;
+    ptrs.decodeCounter = &state->decodeCounter;
+    ptrs.coalesceCounter = &state->coalesceCounter;
+    ptrs.metricsCounter = &state->metricsCounter;
+    ptrs.completionList = &state->completionList;
+    state->coalesceCounter.setup(setup.CoalesceReads, setup.MergeReads);
+    state->metricsCounter.setup(setup.MetricsEnabled);
     state->router.setup(ptrs);
 
     // setup initial assigns
@@ -34,6 +43,15 @@ IO::Setup(const IOSetup& setup) {
         RegisterFileSystem(fs.Key(), fs.Value());
     }
 
+    // setup the read cache, this must happen after filesystems and
+    // assigns are registered, since the cache dir may contain assigns,
+    // the resolved URL's scheme selects the cache dir's filesystem
+    URL cacheDir;
+    if (setup.CacheDir.IsValid()) {
+        cacheDir = ResolveAssigns(setup.CacheDir);
+    }
+    state->cache.setup(setup.CacheBudget, cacheDir);
+
     state->runLoopId = Core::PreRunLoop()->Add([] { doWork(); });
 }
 
@@ -43,6 +61,7 @@ IO::Discard() {
     o_assert(IsValid());
     Core::PreRunLoop()->Remove(state->runLoopId);
     state->router.discard();
+    state->cache.discard();
     Memory::Delete(state);
     state = nullptr;
 }
@@ -52,8 +71,9 @@ void
 IO::doWork() {
     o_assert_dbg(IsValid());
     o_assert_dbg(Core::IsMainThread());
+    o_trace_scoped(IO_DoWork);
     state->router.doWork();
-    state->loadQueue.update();
+    state->loadQueue.update(&state->completionList, &state->metricsCounter);
 }
 
 //------------------------------------------------------------------------------
@@ -138,6 +158,20 @@ IO::LoadGroup(const Array<URL>& urls, LoadGroupSuccessFunc onSuccess, LoadFailed
     state->loadQueue.addGroup(urls, onSuccess, onFailed);
 }
 
+//------------------------------------------------------------------------------
+void
+IO::LoadGroup(const Array<URL>& urls, LoadGroupProcessFunc onProcess, LoadGroupSuccessFunc onSuccess, LoadFailedFunc onFailed) {
+    o_assert_dbg(IsValid());
+    state->loadQueue.addGroup(urls, onSuccess, onFailed, onProcess);
+}
+
+//------------------------------------------------------------------------------
+void
+IO::LoadStream(const URL& url, int chunkSize, LoadStreamChunkFunc onChunk, LoadStreamDoneFunc onDone, int maxChunksInFlight) {
+    o_assert_dbg(IsValid());
+    state->loadQueue.addStream(url, chunkSize, maxChunksInFlight, onChunk, onDone);
+}
+
 //------------------------------------------------------------------------------
 int
 IO::NumPendingLoads() {
@@ -151,6 +185,22 @@ IO::LoadFile(const URL& url) {
     o_assert_dbg(IsValid());
     Ptr<IORead> ioReq = IORead::Create();
     ioReq->Url = url;
+    ioReq->CacheReadEnabled = true;
+    ioReq->CacheWriteEnabled = true;
+    state->router.put(ioReq);
+    return ioReq;
+}
+
+//------------------------------------------------------------------------------
+Ptr<IORead>
+IO::LoadFile(const URL& url, std::function<void(IORead* req)> processFunc, std::function<void()> handledFunc) {
+    o_assert_dbg(IsValid());
+    Ptr<IORead> ioReq = IORead::Create();
+    ioReq->Url = url;
+    ioReq->CacheReadEnabled = true;
+    ioReq->CacheWriteEnabled = true;
+    ioReq->ProcessFunc = std::move(processFunc);
+    ioReq->HandledFunc = std::move(handledFunc);
     state->router.put(ioReq);
     return ioReq;
 }
@@ -173,4 +223,97 @@ IO::Put(const Ptr<IORequest>& ioReq) {
     state->router.put(ioReq);
 }
 
+//------------------------------------------------------------------------------
+IOCacheStats
+IO::QueryCacheStats() {
+    o_assert_dbg(IsValid());
+    return state->cache.stats();
+}
+
+//------------------------------------------------------------------------------
+void
+IO::ClearCache() {
+    o_assert_dbg(IsValid());
+    state->cache.clear();
+}
+
+//------------------------------------------------------------------------------
+IODecodeStats
+IO::QueryDecodeStats() {
+    o_assert_dbg(IsValid());
+    return state->decodeCounter.stats();
+}
+
+//------------------------------------------------------------------------------
+IOCoalesceStats
+IO::QueryCoalesceStats() {
+    o_assert_dbg(IsValid());
+    return state->coalesceCounter.stats();
+}
+
+//------------------------------------------------------------------------------
+IOMetrics
+IO::QueryMetrics() {
+    o_assert_dbg(IsValid());
+    IOMetrics metrics = state->metricsCounter.metrics();
+    for (int i = 0; i < IOConfig::NumWorkers; i++) {
+        metrics.QueueDepths[i] = state->router.queueDepth(i);
+    }
+    metrics.NumPendingLoads = state->loadQueue.numPending();
+    return metrics;
+}
+
+//------------------------------------------------------------------------------
+void
+IO::ResetMetrics() {
+    o_assert_dbg(IsValid());
+    state->metricsCounter.reset();
+}
+
+//------------------------------------------------------------------------------
+void
+IO::LogMetrics() {
+    o_assert_dbg(IsValid());
+    const IOMetrics metrics = QueryMetrics();
+    const double secs = metrics.Elapsed.AsSeconds();
+    const double kbytes = double(metrics.Total.NumBytes) / 1024.0;
+    Log::Info("IO metrics over %.2f sec: %d requests (%d failed, %d cancelled), %.1f KB (%.1f KB/sec)\n",
+        secs,
+        metrics.Total.NumRequests,
+        metrics.Total.NumFailed,
+        metrics.Total.NumCancelled,
+        kbytes,
+        secs > 0.0 ? kbytes / secs : 0.0);
+    for (const auto& kvp : metrics.Schemes) {
+        Log::Info("  scheme '%s': %d requests (%d failed, %d cancelled), %.1f KB\n",
+            kvp.Key().AsCStr(),
+            kvp.Value().NumRequests,
+            kvp.Value().NumFailed,
+            kvp.Value().NumCancelled,
+            double(kvp.Value().NumBytes) / 1024.0);
+    }
+    for (int i = 0; i < IOConfig::NumWorkers; i++) {
+        Log::Info("  worker %d: %d requests, %d queued\n",
+            i, metrics.Workers[i].NumRequests, metrics.QueueDepths[i]);
+    }
+    const struct {
+        const char* name;
+        const IOLatencyHistogram& hist;
+    } latencies[] = {
+        { "queue wait", metrics.QueueWait },
+        { "service", metrics.Service },
+        { "end-to-end", metrics.EndToEnd },
+    };
+    for (const auto& lat : latencies) {
+        Log::Info("  %s: avg %.3f ms, p50 < %.3f ms, p90 < %.3f ms, p99 < %.3f ms, max %.3f ms\n",
+            lat.name,
+            lat.hist.Average().AsMilliSeconds(),
+            lat.hist.Percentile(50.0f).AsMilliSeconds(),
+            lat.hist.Percentile(90.0f).AsMilliSeconds(),
+            lat.hist.Percentile(99.0f).AsMilliSeconds(),
+            lat.hist.Max.AsMilliSeconds());
+    }
+    Log::Info("  %d pending loads\n", metrics.NumPendingLoads);
+}
+
 } // namespace Oryol
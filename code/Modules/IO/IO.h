@@ -11,6 +11,16 @@
 #include "Core/String/String.h"
 #include "Core/String/StringAtom.h"
 #include "IO/Core/IOSetup.h"
+#include "IO/Core/IOConfig.h"
+#include "IO/Core/IOCacheStats.h"
+#include "IO/Core/IODecodeStats.h"
+#include "IO/Core/IOCoalesceStats.h"
+#include "IO/Core/IOMetrics.h"
+#include "IO/Core/ioCache.h"
+#include "IO/Core/ioDecodeCounter.h"
+#include "IO/Core/ioCoalesceCounter.h"
+#include "IO/Core/ioMetricsCounter.h"
+#include "IO/Core/ioCompletionList.h"
 #include "IO/FS/ioRouter.h"
 #include "IO/Core/assignRegistry.h"
 #include "IO/Core/schemeRegistry.h"
@@ -48,24 +58,53 @@ public:
     typedef loadQueue::successFunc LoadSuccessFunc;
     /// success-callback for LoadGroup()
     typedef loadQueue::groupSuccessFunc LoadGroupSuccessFunc;
+    /// process-callback for LoadGroup(), called on the IO threads
+    typedef loadQueue::groupProcessFunc LoadGroupProcessFunc;
     /// failed-callback for Load functions
     typedef loadQueue::failFunc LoadFailedFunc;
     /// result of an asynchronous loading operation
     typedef loadQueue::result LoadResult;
+    /// chunk-callback for LoadStream()
+    typedef loadQueue::chunkFunc LoadStreamChunkFunc;
+    /// done-callback for LoadStream()
+    typedef loadQueue::doneFunc LoadStreamDoneFunc;
+    /// a data chunk delivered by LoadStream()
+    typedef loadQueue::chunk LoadStreamChunk;
     
     /// async load a file, with success and fail callbacks
     static void Load(const URL& url, LoadSuccessFunc onSuccess, LoadFailedFunc onFailed=LoadFailedFunc());
     /// async load a group of files, with success and fail callbacks
     static void LoadGroup(const Array<URL>& urls, LoadGroupSuccessFunc onSuccess, LoadFailedFunc onFailed=LoadFailedFunc());
-    /// get number of pending Load() and LoadGroup() actions
+    /// async load a group of files, each file is processed (e.g. parsed) on the IO thread as soon as it has been read
+    static void LoadGroup(const Array<URL>& urls, LoadGroupProcessFunc onProcess, LoadGroupSuccessFunc onSuccess, LoadFailedFunc onFailed=LoadFailedFunc());
+    /// asynchronously stream a file in chunks, chunks are delivered in order
+    static void LoadStream(const URL& url, int chunkSize, LoadStreamChunkFunc onChunk, LoadStreamDoneFunc onDone=LoadStreamDoneFunc(), int maxChunksInFlight=IOConfig::MaxStreamChunksInFlight);
+    /// get number of pending Load(), LoadGroup() and LoadStream() actions
     static int NumPendingLoads();
 
     /// low-level: start async loading of file from URL, return message for polling result
     static Ptr<IORead> LoadFile(const URL& url);
+    /// low-level: same as LoadFile(), but post-process the data on the IO thread, and call handledFunc on the IO thread when handled
+    static Ptr<IORead> LoadFile(const URL& url, std::function<void(IORead* req)> processFunc, std::function<void()> handledFunc=std::function<void()>());
     /// low-level: start async writing of file via URL, return message for polling result
     static Ptr<IOWrite> WriteFile(const URL& url, const Buffer& data);
     /// low-level: push a generic asynchronous IO request
     static void Put(const Ptr<IORequest>& ioReq);
+
+    /// query read cache statistics
+    static IOCacheStats QueryCacheStats();
+    /// clear the in-memory read cache
+    static void ClearCache();
+    /// query decompression statistics
+    static IODecodeStats QueryDecodeStats();
+    /// query IORead coalescing statistics
+    static IOCoalesceStats QueryCoalesceStats();
+    /// query request counters, latencies and queue depths
+    static IOMetrics QueryMetrics();
+    /// reset request counters and latencies
+    static void ResetMetrics();
+    /// write a summary of the IO metrics to the log
+    static void LogMetrics();
     
 private:
     /// pump the ioRequestRouter
@@ -74,11 +113,17 @@ private:
     struct _state {
         _priv::assignRegistry assignReg;
         _priv::schemeRegistry schemeReg;
+        _priv::ioCache cache;
+        _priv::ioDecodeCounter decodeCounter;
+        _priv::ioCoalesceCounter coalesceCounter;
+        _priv::ioMetricsCounter metricsCounter;
+        _priv::ioCompletionList completionList;
         _priv::ioRouter router;
         RunLoop::Id runLoopId = RunLoop::InvalidId;
         class loadQueue loadQueue;
     };
     static _state* state;
+    friend class URL;
 };
 
 } // namespace Oryol
@@ -5,6 +5,10 @@
 #include "Pre.h"
 #include "UnitTest++/src/UnitTest++.h"
 #include "IO/Core/URL.h"
+#include "IO/IO.h"
+#include "Core/Core.h"
+#include "Core/String/StringBuilder.h"
+#include "Core/Time/Clock.h"
 #include <cstring>
 
 using namespace Oryol;
@@ -98,3 +102,53 @@ TEST(URLTest) {
     CHECK(url3.Fragment() == "frag");
     CHECK(url3.PathToEnd() == "bla.txt?key0=val0&key1=val1#frag");
 }
+
+TEST(URLResolveTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.Assigns.Add("tex:", "data:textures/");
+    ioSetup.Assigns.Add("data:", "http://www.flohofwoe.net/data/");
+    IO::Setup(ioSetup);
+
+    URL url("tex:wood.dds");
+    CHECK(url.IsValid());
+    CHECK(std::strcmp(url.AsCStr(), "http://www.flohofwoe.net/data/textures/wood.dds") == 0);
+    CHECK(url.HasScheme("http"));
+    CHECK(!url.HasScheme("htt"));
+    CHECK(!url.HasScheme("https"));
+    CHECK(url.Path() == "data/textures/wood.dds");
+    CHECK(IO::ResolveAssigns("tex:") == "http://www.flohofwoe.net/data/textures/");
+
+    // changing an assign invalidates resolved assigns which depend on it
+    IO::SetAssign("data:", "file:///data/");
+    url = "tex:wood.dds";
+    CHECK(std::strcmp(url.AsCStr(), "file:///data/textures/wood.dds") == 0);
+    CHECK(url.HasScheme("file"));
+    CHECK(!url.HasHost());
+
+    // unknown assigns, URL schemes and DOS drive letters are not resolved
+    CHECK(IO::ResolveAssigns("bla:blub") == "bla:blub");
+    CHECK(IO::ResolveAssigns("c:/bla") == "c:/bla");
+    CHECK(IO::ResolveAssigns("http://www.flohofwoe.net") == "http://www.flohofwoe.net");
+
+    // per-URL overhead of assign resolution and parsing
+    const int num = 100000;
+    StringBuilder strBuilder;
+    Array<String> paths;
+    for (int i = 0; i < 64; i++) {
+        strBuilder.Format(64, "tex:texture%d.dds", i);
+        paths.Add(strBuilder.GetString());
+    }
+    TimePoint start = Clock::Now();
+    int numValid = 0;
+    for (int i = 0; i < num; i++) {
+        URL url(paths[i & 63].AsCStr());
+        numValid += url.IsValid() ? 1 : 0;
+    }
+    Duration dur = Clock::Since(start);
+    CHECK(numValid == num);
+    Log::Info("URLResolveTest: %.3fus per URL\n", dur.AsMicroSeconds() / num);
+
+    IO::Discard();
+    Core::Discard();
+}
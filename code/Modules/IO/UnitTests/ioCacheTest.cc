@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+//  ioCacheTest.cc
+//  Test the IO read cache.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "IO/Core/ioCache.h"
+#include "Core/String/StringBuilder.h"
+
+using namespace Oryol;
+using namespace Oryol::_priv;
+
+TEST(ioCacheTest) {
+
+    const uint8_t data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    ioCache cache;
+    CHECK(!cache.isValid());
+    cache.setup(16, URL());
+    CHECK(cache.isValid());
+    CHECK(cache.isEnabled());
+    CHECK(!cache.hasDiskCache());
+
+    // cache keys
+    URL url("http://www.flohofwoe.net/bla.txt");
+    CHECK(ioCache::key(url, 0, EndOfFile) == "http://www.flohofwoe.net/bla.txt");
+    CHECK(ioCache::key(url, 4, 8) == "http://www.flohofwoe.net/bla.txt|4-8");
+
+    // miss, write, hit
+    Buffer buf;
+    CHECK(!cache.read("a", buf));
+    cache.write("a", data, 8);
+    CHECK(cache.read("a", buf));
+    CHECK(buf.Size() == 8);
+    CHECK(buf.Data()[0] == 1);
+    CHECK(buf.Data()[7] == 8);
+    IOCacheStats stats = cache.stats();
+    CHECK(stats.NumHits == 1);
+    CHECK(stats.NumMisses == 1);
+    CHECK(stats.NumEntries == 1);
+    CHECK(stats.NumBytes == 8);
+    CHECK(stats.Budget == 16);
+
+    // fill the cache, touch 'a' so that 'b' becomes least recently used
+    cache.write("b", data, 4);
+    cache.write("c", data, 4);
+    CHECK(cache.read("a", buf));
+    cache.write("d", data, 4);
+    stats = cache.stats();
+    CHECK(stats.NumEvictions == 1);
+    CHECK(stats.NumEntries == 3);
+    CHECK(stats.NumBytes == 16);
+    CHECK(!cache.read("b", buf));
+    CHECK(cache.read("a", buf));
+    CHECK(cache.read("c", buf));
+    CHECK(cache.read("d", buf));
+
+    // replacing an entry doesn't evict
+    cache.write("d", data, 2);
+    stats = cache.stats();
+    CHECK(stats.NumEvictions == 1);
+    CHECK(stats.NumBytes == 14);
+
+    // entries larger than the budget are not cached
+    uint8_t bigData[32] = { };
+    cache.write("e", bigData, sizeof(bigData));
+    CHECK(!cache.read("e", buf));
+    CHECK(cache.stats().NumEntries == 3);
+
+    // clear
+    cache.clear();
+    stats = cache.stats();
+    CHECK(stats.NumEntries == 0);
+    CHECK(stats.NumBytes == 0);
+    CHECK(!cache.read("a", buf));
+    cache.write("a", data, 8);
+    CHECK(cache.read("a", buf));
+    cache.discard();
+    CHECK(!cache.isValid());
+
+    // disk cache URLs, HTTP URLs are not cached on disk
+    cache.setup(0, URL("file:///tmp/cache/"));
+    CHECK(cache.isEnabled());
+    CHECK(cache.hasDiskCache());
+    URL pakUrl("pak://data/bla.txt");
+    CHECK(cache.useDiskCache(pakUrl));
+    CHECK(!cache.useDiskCache(url));
+    CHECK(!cache.useDiskCache(URL("https://www.flohofwoe.net/bla.txt")));
+    CHECK(!cache.useDiskCache(URL("file:///tmp/bla.txt")));
+    URL diskUrl = cache.diskURL(ioCache::key(pakUrl, 0, EndOfFile), 0);
+    CHECK(diskUrl.IsValid());
+    CHECK(diskUrl.Scheme() == "file");
+    CHECK(diskUrl.Get() == cache.diskURL("pak://data/bla.txt", 0).Get());
+    CHECK(diskUrl.Get() != cache.diskURL(ioCache::key(pakUrl, 4, 8), 0).Get());
+    CHECK(diskUrl.Get() != cache.diskURL(ioCache::key(pakUrl, 0, EndOfFile), 1).Get());
+    CHECK(cache.generationURL(pakUrl).Get() != diskUrl.Get());
+
+    // disk cache generations
+    uint32_t generation = 0;
+    CHECK(!cache.generation(pakUrl, generation));
+    cache.setGeneration(pakUrl, 3);
+    CHECK(cache.generation(pakUrl, generation));
+    CHECK(generation == 3);
+    cache.setGeneration(pakUrl, 4);
+    CHECK(cache.generation(pakUrl, generation));
+    CHECK(generation == 4);
+    cache.discard();
+}
+
+TEST(ioCacheInvalidateTest) {
+
+    const uint8_t data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    // invalidating an URL drops all its byte ranges, but not other URLs
+    // which start with the same string
+    ioCache cache;
+    cache.setup(1024, URL());
+    URL url("file:///tmp/bla.txt");
+    URL otherUrl("file:///tmp/bla.txt.bak");
+    cache.write(ioCache::key(url, 0, EndOfFile), data, 8);
+    cache.write(ioCache::key(url, 4, 8), data, 4);
+    StringBuilder inflateKey(ioCache::key(url, 0, EndOfFile));
+    inflateKey.Append("|inflate");
+    cache.write(inflateKey.GetString(), data, 8);
+    cache.write(ioCache::key(otherUrl, 0, EndOfFile), data, 8);
+    CHECK(cache.stats().NumEntries == 4);
+    cache.invalidate(url);
+    IOCacheStats stats = cache.stats();
+    CHECK(stats.NumEntries == 1);
+    CHECK(stats.NumBytes == 8);
+    CHECK(stats.NumEvictions == 0);
+    Buffer buf;
+    CHECK(!cache.read(ioCache::key(url, 0, EndOfFile), buf));
+    CHECK(!cache.read(ioCache::key(url, 4, 8), buf));
+    CHECK(cache.read(ioCache::key(otherUrl, 0, EndOfFile), buf));
+
+    // invalidating an URL without entries is harmless
+    cache.invalidate(URL("file:///tmp/nothing.txt"));
+    CHECK(cache.stats().NumEntries == 1);
+
+    // an URL which contains a '|' shares the hash chain of its prefix,
+    // entries can be replaced and invalidated in any order
+    URL pipeUrl("file:///tmp/bla.txt|1");
+    cache.write(ioCache::key(url, 0, EndOfFile), data, 8);
+    cache.write(ioCache::key(pipeUrl, 0, EndOfFile), data, 8);
+    cache.write(ioCache::key(url, 0, 4), data, 4);
+    cache.write(ioCache::key(url, 0, EndOfFile), data, 2);
+    CHECK(cache.stats().NumEntries == 4);
+    cache.invalidate(pipeUrl);
+    CHECK(cache.stats().NumEntries == 3);
+    CHECK(cache.read(ioCache::key(url, 0, 4), buf));
+    cache.invalidate(url);
+    CHECK(cache.stats().NumEntries == 1);
+    CHECK(!cache.read(ioCache::key(url, 0, 4), buf));
+    CHECK(cache.read(ioCache::key(otherUrl, 0, EndOfFile), buf));
+    cache.invalidate(otherUrl);
+    CHECK(cache.stats().NumEntries == 0);
+    CHECK(cache.stats().NumBytes == 0);
+    cache.discard();
+}
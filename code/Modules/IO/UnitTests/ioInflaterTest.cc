@@ -0,0 +1,66 @@
+//------------------------------------------------------------------------------
+//  ioInflaterTest.cc
+//  Test the streaming decompressor of the IO module.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "IO/Core/ioInflater.h"
+#include "zlib.h"
+#include <cstring>
+
+using namespace Oryol;
+using namespace Oryol::_priv;
+
+TEST(ioInflaterTest) {
+
+    // some compressible test data
+    Buffer data;
+    uint8_t* ptr = data.Add(200 * 1024);
+    uint32_t x = 12345;
+    for (int i = 0; i < data.Size(); i++) {
+        x = x * 1103515245 + 12345;
+        ptr[i] = uint8_t((x >> 16) & 0x0F);
+    }
+    Buffer compressed;
+    uLongf compressedSize = compressBound(uLong(data.Size()));
+    uint8_t* dst = compressed.Add(int(compressedSize));
+    CHECK(Z_OK == compress2(dst, &compressedSize, data.Data(), uLong(data.Size()), Z_DEFAULT_COMPRESSION));
+    const int size = int(compressedSize);
+    CHECK(size < data.Size());
+
+    // decompress in one go
+    Ptr<ioInflater> inflater = ioInflater::Create();
+    Buffer result;
+    CHECK(ioInflater::Done == inflater->feed(compressed.Data(), size, result));
+    CHECK(result.Size() == data.Size());
+    CHECK(0 == std::memcmp(result.Data(), data.Data(), data.Size()));
+    CHECK(inflater->numBytesIn() == size);
+    CHECK(inflater->numBytesOut() == data.Size());
+
+    // decompress in small chunks
+    inflater = ioInflater::Create();
+    result.Clear();
+    const int chunkSize = 1000;
+    int offset = 0;
+    ioInflater::result res = ioInflater::NeedMore;
+    while ((ioInflater::NeedMore == res) && (offset < size)) {
+        const int num = (size - offset) < chunkSize ? (size - offset) : chunkSize;
+        res = inflater->feed(compressed.Data() + offset, num, result);
+        offset += num;
+    }
+    CHECK(ioInflater::Done == res);
+    CHECK(offset == size);
+    CHECK(result.Size() == data.Size());
+    CHECK(0 == std::memcmp(result.Data(), data.Data(), data.Size()));
+
+    // truncated data needs more input
+    inflater = ioInflater::Create();
+    result.Clear();
+    CHECK(ioInflater::NeedMore == inflater->feed(compressed.Data(), size / 2, result));
+
+    // corrupted data
+    inflater = ioInflater::Create();
+    result.Clear();
+    const uint8_t garbage[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    CHECK(ioInflater::Error == inflater->feed(garbage, sizeof(garbage), result));
+}
@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+//  ioMetricsTest.cc
+//  Test IO request counters and latency histograms.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "IO/IO.h"
+#include "Core/Core.h"
+#include "Core/RunLoop.h"
+
+using namespace Oryol;
+
+// a filesystem which serves 16 bytes for each host except 'missing'
+class MetricsFileSystem : public FileSystem {
+    OryolClassDecl(MetricsFileSystem);
+    OryolClassCreator(MetricsFileSystem);
+public:
+    virtual void onMsg(const Ptr<IORequest>& msg) override {
+        Ptr<IORead> read = msg->DynamicCast<IORead>();
+        if (read) {
+            if (read->Url.Host() == "missing") {
+                read->Status = IOStatus::NotFound;
+            }
+            else {
+                uint8_t* ptr = read->AddResult(16);
+                for (int i = 0; i < 16; i++) {
+                    ptr[i] = uint8_t(i);
+                }
+                read->Status = IOStatus::OK;
+            }
+        }
+        else {
+            msg->Status = IOStatus::OK;
+        }
+        this->setHandled(msg);
+    };
+};
+
+static Ptr<IORead>
+put(const URL& url, bool cancel=false) {
+    auto msg = IORead::Create();
+    msg->Url = url;
+    msg->Cancelled = cancel;
+    IO::Put(msg);
+    return msg;
+}
+
+static void
+wait(const Array<Ptr<IORequest>>& msgs) {
+    for (const auto& msg : msgs) {
+        while (!msg->Handled) {
+            Core::PreRunLoop()->Run();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+TEST(IOLatencyHistogramTest) {
+    IOLatencyHistogram hist;
+    CHECK(hist.Count == 0);
+    CHECK(hist.Average() == Duration());
+    CHECK(hist.Percentile(50.0f) == Duration());
+    hist.Add(Duration());
+    hist.Add(Duration::FromMicroSeconds(3.0));
+    hist.Add(Duration::FromMicroSeconds(3.0));
+    hist.Add(Duration::FromMicroSeconds(1000.0));
+    CHECK(hist.Count == 4);
+    CHECK(hist.Buckets[0] == 1);
+    CHECK(hist.Buckets[2] == 2);
+    CHECK(hist.Buckets[10] == 1);
+    CHECK_CLOSE(1000.0, hist.Max.AsMicroSeconds(), 0.01);
+    CHECK_CLOSE(251.5, hist.Average().AsMicroSeconds(), 1.0);
+    CHECK_CLOSE(4.0, hist.Percentile(50.0f).AsMicroSeconds(), 0.01);
+    CHECK_CLOSE(1000.0, hist.Percentile(100.0f).AsMicroSeconds(), 0.01);
+    CHECK_CLOSE(1024.0, IOLatencyHistogram::BucketLimit(10).AsMicroSeconds(), 0.01);
+
+    // very long latencies end up in the last bucket
+    hist.Add(Duration::FromSeconds(10000.0));
+    CHECK(hist.Buckets[IOLatencyHistogram::NumBuckets - 1] == 1);
+}
+
+TEST(ioMetricsTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("metrics", MetricsFileSystem::Creator());
+    ioSetup.FileSystems.Add("other", MetricsFileSystem::Creator());
+    IO::Setup(ioSetup);
+
+    Array<Ptr<IORequest>> msgs;
+    msgs.Add(put("metrics://a"));
+    msgs.Add(put("metrics://b"));
+    msgs.Add(put("metrics://missing"));
+    msgs.Add(put("metrics://c", true));
+    msgs.Add(put("other://a"));
+    Buffer data;
+    data.Add((const uint8_t*)"Hello", 5);
+    msgs.Add(IO::WriteFile("other://b", data));
+    wait(msgs);
+
+    IOMetrics metrics = IO::QueryMetrics();
+    CHECK(metrics.Total.NumRequests == 6);
+    CHECK(metrics.Total.NumFailed == 1);
+    CHECK(metrics.Total.NumCancelled == 1);
+    CHECK(metrics.Total.NumBytes == 3 * 16 + 5);
+    CHECK(metrics.Schemes.Size() == 2);
+    CHECK(metrics.Schemes["metrics"].NumRequests == 4);
+    CHECK(metrics.Schemes["metrics"].NumBytes == 32);
+    CHECK(metrics.Schemes["other"].NumRequests == 2);
+    CHECK(metrics.Schemes["other"].NumBytes == 21);
+    int numWorkerRequests = 0;
+    for (int i = 0; i < IOConfig::NumWorkers; i++) {
+        numWorkerRequests += metrics.Workers[i].NumRequests;
+        CHECK(metrics.QueueDepths[i] == 0);
+    }
+    CHECK(numWorkerRequests == 6);
+    CHECK(metrics.QueueWait.Count == 6);
+    CHECK(metrics.Service.Count == 6);
+    CHECK(metrics.EndToEnd.Count == 0);
+    CHECK(metrics.Elapsed > Duration());
+
+    // IO::Load() also records the end-to-end latency
+    bool loaded = false;
+    IO::Load("metrics://d", [&loaded](IO::LoadResult res) {
+        loaded = true;
+    });
+    while (!loaded) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    metrics = IO::QueryMetrics();
+    CHECK(metrics.Total.NumRequests == 7);
+    CHECK(metrics.EndToEnd.Count == 1);
+    CHECK(metrics.NumPendingLoads == 0);
+    IO::LogMetrics();
+
+    IO::ResetMetrics();
+    metrics = IO::QueryMetrics();
+    CHECK(metrics.Total.NumRequests == 0);
+    CHECK(metrics.Schemes.Empty());
+    CHECK(metrics.QueueWait.Count == 0);
+
+    IO::Discard();
+    Core::Discard();
+}
+
+TEST(ioMetricsDisabledTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("metrics", MetricsFileSystem::Creator());
+    ioSetup.MetricsEnabled = false;
+    IO::Setup(ioSetup);
+
+    Array<Ptr<IORequest>> msgs;
+    msgs.Add(put("metrics://a"));
+    wait(msgs);
+    CHECK(IO::QueryMetrics().Total.NumRequests == 0);
+
+    IO::Discard();
+    Core::Discard();
+}
@@ -0,0 +1,248 @@
+//------------------------------------------------------------------------------
+//  ioProcessTest.cc
+//  Test post-processing of IORead results on the IO threads.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "IO/IO.h"
+#include "Core/Core.h"
+#include "Core/Log.h"
+#include "Core/RunLoop.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/StringBuilder.h"
+#include <thread>
+#include <atomic>
+
+using namespace Oryol;
+
+// a filesystem which serves a 16 KByte file for each path,
+// where each byte is the lower 8 bits of its file offset
+static const int fileSize = 16 * 1024;
+
+class DataFileSystem : public FileSystem {
+    OryolClassDecl(DataFileSystem);
+    OryolClassCreator(DataFileSystem);
+public:
+    virtual void onMsg(const Ptr<IORequest>& msg) override {
+        Ptr<IORead> read = msg->DynamicCast<IORead>();
+        if (read) {
+            uint8_t* ptr = read->AddResult(fileSize);
+            for (int i = 0; i < fileSize; i++) {
+                ptr[i] = uint8_t(i);
+            }
+            read->Status = IOStatus::OK;
+        }
+        msg->Handled = true;
+    };
+};
+
+// a stand-in for file format parsing, touches each byte a few times
+static uint32_t
+parse(const uint8_t* data, int size) {
+    uint32_t hash = 2166136261u;
+    for (int pass = 0; pass < 8; pass++) {
+        for (int i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+static void
+setupIO() {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("data", DataFileSystem::Creator());
+    IO::Setup(ioSetup);
+}
+
+static void
+discardIO() {
+    IO::Discard();
+    Core::Discard();
+}
+
+static void
+wait(const Ptr<IORead>& msg) {
+    while (!msg->Handled) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(ioProcessTest) {
+    setupIO();
+    const std::thread::id mainThread = std::this_thread::get_id();
+
+    // the process function runs on the IO thread, before the
+    // request is flagged as handled
+    std::thread::id processThread = mainThread;
+    bool sawHandled = true;
+    int processSize = 0;
+    Ptr<IORead> msg = IO::LoadFile("data://bla.txt", [&](IORead* req) {
+        processThread = std::this_thread::get_id();
+        sawHandled = req->Handled;
+        processSize = req->Data.Size();
+        req->Data.Data()[1] = 0xFF;
+    });
+    wait(msg);
+    CHECK(processThread != mainThread);
+    CHECK(!sawHandled);
+    CHECK(processSize == fileSize);
+    CHECK(msg->Status == IOStatus::OK);
+    CHECK(msg->Data.Data()[1] == 0xFF);
+    CHECK(msg->Data.Data()[2] == 2);
+
+    // the process function can fail the request
+    msg = IO::LoadFile("data://blub.txt", [](IORead* req) {
+        req->Status = IOStatus::UnsupportedMediaType;
+        req->ErrorDesc = "Invalid data";
+    });
+    wait(msg);
+    CHECK(msg->Status == IOStatus::UnsupportedMediaType);
+    CHECK(msg->ErrorDesc == "Invalid data");
+
+    // cancelled reads are not processed
+    bool processed = false;
+    msg = IORead::Create();
+    msg->Url = "data://blob.txt";
+    msg->ProcessFunc = [&processed](IORead* req) {
+        processed = true;
+    };
+    // ...but HandledFunc is called for all requests
+    std::atomic<int> numHandled(0);
+    msg->HandledFunc = [&numHandled]() {
+        numHandled++;
+    };
+    msg->Cancelled = true;
+    IO::Put(msg);
+    wait(msg);
+    CHECK(msg->Status == IOStatus::Cancelled);
+    CHECK(!processed);
+    while (0 == numHandled) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(numHandled == 1);
+
+    discardIO();
+}
+
+TEST(ioProcessGroupTest) {
+    setupIO();
+    const std::thread::id mainThread = std::this_thread::get_id();
+
+    // each file of a group is processed on an IO thread with its
+    // group index, before the group success callback is called
+    const int numFiles = 8;
+    Array<URL> urls;
+    StringBuilder strBuilder;
+    Array<uint32_t> hashes;
+    for (int i = 0; i < numFiles; i++) {
+        strBuilder.Format(64, "data://%d.omsh", i);
+        urls.Add(strBuilder.GetString());
+        hashes.Add(0);
+    }
+    std::atomic<int> numProcessed(0);
+    std::atomic<int> numOnMainThread(0);
+    uint32_t* hashPtr = hashes.begin();
+    bool loaded = false;
+    IO::LoadGroup(urls,
+        [&, hashPtr](int index, IORead* req) {
+            if (std::this_thread::get_id() == mainThread) {
+                numOnMainThread++;
+            }
+            hashPtr[index] = parse(req->Data.Data(), req->Data.Size()) + index;
+            numProcessed++;
+        },
+        [&](Array<IO::LoadResult> results) {
+            CHECK(results.Size() == numFiles);
+            CHECK(numProcessed == numFiles);
+            loaded = true;
+        });
+    while (!loaded) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(numOnMainThread == 0);
+    for (int i = 1; i < numFiles; i++) {
+        CHECK(hashes[i] == hashes[0] + i);
+    }
+
+    // a failed process callback fails the group
+    bool groupLoaded = false;
+    int numFailed = 0;
+    IO::LoadGroup(urls,
+        [](int index, IORead* req) {
+            if (3 == index) {
+                req->Status = IOStatus::UnsupportedMediaType;
+            }
+        },
+        [&groupLoaded](Array<IO::LoadResult> results) {
+            groupLoaded = true;
+        },
+        [&numFailed](const URL& url, IOStatus::Code ioStatus) {
+            CHECK(ioStatus == IOStatus::UnsupportedMediaType);
+            numFailed++;
+        });
+    while (IO::NumPendingLoads() > 0) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(!groupLoaded);
+    CHECK(numFailed == 1);
+
+    discardIO();
+}
+
+// load 1000 files, parse them either on the main thread after the
+// data has arrived, or on the IO threads, and compare the time the
+// main thread spends with the results
+TEST(ioProcessBenchmark) {
+    setupIO();
+    const int numFiles = 1000;
+    StringBuilder strBuilder;
+
+    // parse on the main thread
+    Array<Ptr<IORead>> msgs;
+    Array<uint32_t> hashes;
+    for (int i = 0; i < numFiles; i++) {
+        strBuilder.Format(64, "data://%d.dds", i);
+        msgs.Add(IO::LoadFile(strBuilder.GetString()));
+    }
+    Duration mainThreadParse;
+    for (const auto& msg : msgs) {
+        wait(msg);
+        TimePoint start = Clock::Now();
+        hashes.Add(parse(msg->Data.Data(), msg->Data.Size()));
+        mainThreadParse += Clock::Since(start);
+    }
+
+    // parse on the IO threads
+    msgs.Clear();
+    Array<uint32_t> ioHashes;
+    for (int i = 0; i < numFiles; i++) {
+        ioHashes.Add(0);
+    }
+    for (int i = 0; i < numFiles; i++) {
+        uint32_t* hashPtr = &ioHashes[i];
+        strBuilder.Format(64, "data://%d.dds", i);
+        msgs.Add(IO::LoadFile(strBuilder.GetString(), [hashPtr](IORead* req) {
+            *hashPtr = parse(req->Data.Data(), req->Data.Size());
+        }));
+    }
+    Duration ioThreadParse;
+    int numMatches = 0;
+    for (int i = 0; i < numFiles; i++) {
+        wait(msgs[i]);
+        TimePoint start = Clock::Now();
+        if (ioHashes[i] == hashes[i]) {
+            numMatches++;
+        }
+        ioThreadParse += Clock::Since(start);
+    }
+    CHECK(numMatches == numFiles);
+    Log::Info("ioProcessBenchmark: main-thread time for %d files, parsed on main thread: %.3fms, parsed on IO threads: %.3fms\n",
+        numFiles, mainThreadParse.AsMilliSeconds(), ioThreadParse.AsMilliSeconds());
+
+    discardIO();
+}
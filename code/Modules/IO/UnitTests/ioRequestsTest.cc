@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+//  ioRequestsTest.cc
+//  Test IO message type tags, message creation and destination memory,
+//  and measure the request throughput with tiny payloads.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "IO/IO.h"
+#include "Core/Core.h"
+#include "Core/RunLoop.h"
+#include "Core/Time/Clock.h"
+#include <cstring>
+
+using namespace Oryol;
+using namespace Oryol::_priv;
+
+// a filesystem which serves 16 bytes for each read
+class TinyFileSystem : public FileSystem {
+    OryolClassDecl(TinyFileSystem);
+    OryolClassCreator(TinyFileSystem);
+public:
+    virtual void onMsg(const Ptr<IORequest>& msg) override {
+        if (msg->isRead()) {
+            IORead* read = ioMsgCast<IORead>(msg);
+            uint8_t* ptr = read->AddResult(16);
+            for (int i = 0; i < 16; i++) {
+                ptr[i] = uint8_t(i);
+            }
+        }
+        msg->Status = IOStatus::OK;
+        msg->Handled = true;
+    };
+};
+
+TEST(IOMsgTypeTest) {
+    CHECK(IORead::Create()->MsgType == ioMsgType::Read);
+    CHECK(IOWrite::Create()->MsgType == ioMsgType::Write);
+    CHECK(notifyFileSystemAdded::Create()->MsgType == ioMsgType::NotifyAdded);
+    CHECK(notifyFileSystemRemoved::Create()->MsgType == ioMsgType::NotifyRemoved);
+    CHECK(notifyFileSystemReplaced::Create()->MsgType == ioMsgType::NotifyReplaced);
+
+    Ptr<ioMsg> msg = IORead::Create();
+    CHECK(msg->isRequest());
+    CHECK(msg->isRead());
+    CHECK(!msg->isNotify());
+    CHECK(ioMsgCast<IORead>(msg) == msg.get());
+    msg = IOWrite::Create();
+    CHECK(msg->isRequest());
+    CHECK(!msg->isRead());
+    msg = notifyFileSystemAdded::Create();
+    CHECK(!msg->isRequest());
+    CHECK(msg->isNotify());
+}
+
+TEST(IOMsgCreateTest) {
+    // a new message starts out in its default state
+    {
+        Ptr<IORead> read = IORead::Create();
+        read->Url = "test://bla/blub.txt";
+        read->Status = IOStatus::OK;
+    }
+    Ptr<IORead> read = IORead::Create();
+    CHECK(read->Url.Empty());
+    CHECK(read->Status == IOStatus::InvalidIOStatus);
+
+    const int num = 1000000;
+    TimePoint start = Clock::Now();
+    for (int i = 0; i < num; i++) {
+        Ptr<IORead> tmp = IORead::Create();
+    }
+    Duration dur = Clock::Since(start);
+    Log::Info("IOMsgCreateTest: %d IORead create/release: %.3fms (%.1f ns each)\n",
+        num, dur.AsMilliSeconds(), dur.AsMicroSeconds() * 1000.0 / num);
+}
+
+TEST(IOReadDestTest) {
+    // a result of unknown size is appended in chunks, the destination
+    // callback is asked for more memory whenever the result outgrows it
+    uint8_t dest[64] = { };
+    Array<int> requestedSizes;
+    Ptr<IORead> read = IORead::Create();
+    read->DestFunc = [&dest, &requestedSizes](int size) -> uint8_t* {
+        requestedSizes.Add(size);
+        return size <= int(sizeof(dest)) ? dest : nullptr;
+    };
+    for (int i = 0; i < 3; i++) {
+        uint8_t* ptr = read->AddResult(10);
+        CHECK(nullptr != ptr);
+        if (ptr) {
+            std::memset(ptr, 'a' + i, 10);
+        }
+    }
+    CHECK(read->ResultSize() == 30);
+    CHECK(read->ResultData() == dest);
+    CHECK(dest[0] == 'a' && dest[10] == 'b' && dest[29] == 'c');
+    CHECK(requestedSizes.Size() == 3);
+    CHECK(requestedSizes[0] == 10);
+    CHECK(requestedSizes[1] == 20);
+    CHECK(requestedSizes[2] == 40);
+    CHECK(read->DestCapacity == 40);
+
+    // a rejected result drops the bytes written so far
+    CHECK(nullptr != read->AddResult(10));
+    CHECK(nullptr == read->AddResult(30));
+    CHECK(requestedSizes.Back() == 80);
+    CHECK(read->ResultSize() == 0);
+    CHECK(read->ResultData() == nullptr);
+
+    // a result size announced up front is requested once
+    requestedSizes.Clear();
+    read = IORead::Create();
+    read->DestFunc = [&dest, &requestedSizes](int size) -> uint8_t* {
+        requestedSizes.Add(size);
+        return dest;
+    };
+    CHECK(read->ReserveResult(48));
+    CHECK(nullptr != read->AddResult(16));
+    CHECK(nullptr != read->AddResult(32));
+    CHECK(requestedSizes.Size() == 1);
+    CHECK(requestedSizes[0] == 48);
+}
+
+TEST(IORequestThroughputTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("tiny", TinyFileSystem::Creator());
+    IO::Setup(ioSetup);
+
+    // keep a batch of requests in flight, and measure the request rate
+    const int numBatches = 16;
+    const int batchSize = 2048;
+    Array<Ptr<IORead>> reads;
+    reads.Reserve(batchSize);
+    int numOk = 0;
+    TimePoint start = Clock::Now();
+    for (int batch = 0; batch < numBatches; batch++) {
+        for (int i = 0; i < batchSize; i++) {
+            Ptr<IORead> read = IORead::Create();
+            read->Url = "tiny://host/file.bin";
+            IO::Put(read);
+            reads.Add(read);
+        }
+        for (const auto& read : reads) {
+            while (!read->Handled) {
+                Core::PreRunLoop()->Run();
+            }
+            if ((IOStatus::OK == read->Status) && (read->Data.Size() == 16)) {
+                numOk++;
+            }
+        }
+        reads.Clear();
+    }
+    Duration dur = Clock::Since(start);
+    const int num = numBatches * batchSize;
+    CHECK(numOk == num);
+    Log::Info("IORequestThroughputTest: %d reads of 16 bytes: %.3fms (%.0f reads/sec)\n",
+        num, dur.AsMilliSeconds(), num / dur.AsSeconds());
+
+    IO::Discard();
+    Core::Discard();
+}
@@ -0,0 +1,187 @@
+//------------------------------------------------------------------------------
+//  ioRouterTest.cc
+//  Test coalescing of in-flight IORead requests.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "IO/IO.h"
+#include "Core/Core.h"
+#include "Core/RunLoop.h"
+#include <atomic>
+
+using namespace Oryol;
+
+// a filesystem which counts reads, and serves a 4 KByte file
+// where each byte is the lower 8 bits of its file offset
+static std::atomic<int> numReads(0);
+static const int fileSize = 4096;
+
+class CountFileSystem : public FileSystem {
+    OryolClassDecl(CountFileSystem);
+    OryolClassCreator(CountFileSystem);
+public:
+    virtual void onMsg(const Ptr<IORequest>& msg) override {
+        Ptr<IORead> read = msg->DynamicCast<IORead>();
+        if (read) {
+            numReads++;
+            const int64_t end = ((EndOfFile == read->EndOffset) || (read->EndOffset > fileSize)) ? fileSize : read->EndOffset;
+            if (read->StartOffset > end) {
+                read->Status = IOStatus::RequestedRangeNotSatisfiable;
+            }
+            else {
+                const int size = int(end - read->StartOffset);
+                uint8_t* ptr = size > 0 ? read->AddResult(size) : nullptr;
+                for (int i = 0; i < size; i++) {
+                    ptr[i] = uint8_t(read->StartOffset + i);
+                }
+                read->Status = IOStatus::OK;
+            }
+        }
+        msg->Handled = true;
+    };
+};
+
+static Ptr<IORead>
+put(const URL& url, int64_t startOffset=0, int64_t endOffset=EndOfFile) {
+    auto msg = IORead::Create();
+    msg->Url = url;
+    msg->StartOffset = startOffset;
+    msg->EndOffset = endOffset;
+    IO::Put(msg);
+    return msg;
+}
+
+static void
+wait(const Array<Ptr<IORead>>& msgs) {
+    for (const auto& msg : msgs) {
+        while (!msg->Handled) {
+            Core::PreRunLoop()->Run();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+static bool
+checkData(const Ptr<IORead>& msg, int64_t startOffset, int size) {
+    if ((IOStatus::OK != msg->Status) || (msg->ResultSize() != size)) {
+        return false;
+    }
+    const uint8_t* ptr = msg->ResultData();
+    for (int i = 0; i < size; i++) {
+        if (ptr[i] != uint8_t(startOffset + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(ioRouterCoalesceTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("count", CountFileSystem::Creator());
+    IO::Setup(ioSetup);
+
+    // identical reads put in the same frame are served by one read
+    numReads = 0;
+    uint8_t dest[fileSize];
+    Array<Ptr<IORead>> msgs;
+    msgs.Add(put("count://a"));
+    msgs.Add(put("count://b"));
+    msgs.Add(put("count://a"));
+    msgs.Add(put("count://a", 16, 32));
+    msgs.Add(put("count://a", 16, 32));
+    auto destMsg = IORead::Create();
+    destMsg->Url = "count://a";
+    destMsg->DestPtr = dest;
+    destMsg->DestCapacity = sizeof(dest);
+    IO::Put(destMsg);
+    msgs.Add(destMsg);
+    msgs.Add(put("count://a"));
+    wait(msgs);
+    CHECK(numReads == 3);
+    CHECK(checkData(msgs[0], 0, fileSize));
+    CHECK(checkData(msgs[1], 0, fileSize));
+    CHECK(checkData(msgs[2], 0, fileSize));
+    CHECK(checkData(msgs[3], 16, 16));
+    CHECK(checkData(msgs[4], 16, 16));
+    CHECK(checkData(msgs[5], 0, fileSize));
+    CHECK(msgs[5]->Data.Empty());
+    CHECK(checkData(msgs[6], 0, fileSize));
+    IOCoalesceStats stats = IO::QueryCoalesceStats();
+    CHECK(stats.NumCoalesced == 4);
+    CHECK(stats.NumMerged == 0);
+    CHECK(stats.NumGroupReads == 2);
+
+    // ranges are not merged by default
+    numReads = 0;
+    msgs.Clear();
+    msgs.Add(put("count://a", 0, 16));
+    msgs.Add(put("count://a", 16, 32));
+    wait(msgs);
+    CHECK(numReads == 2);
+    CHECK(checkData(msgs[0], 0, 16));
+    CHECK(checkData(msgs[1], 16, 16));
+
+    IO::Discard();
+    Core::Discard();
+}
+
+TEST(ioRouterMergeTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("count", CountFileSystem::Creator());
+    ioSetup.MergeReads = true;
+    IO::Setup(ioSetup);
+
+    // overlapping and adjacent ranges are merged into one read
+    numReads = 0;
+    Array<Ptr<IORead>> msgs;
+    msgs.Add(put("count://a", 16, 32));
+    msgs.Add(put("count://a", 0, 16));
+    msgs.Add(put("count://a", 8, 24));
+    msgs.Add(put("count://a", 8, 24));
+    msgs.Add(put("count://a", 100, 116));
+    msgs.Add(put("count://a", 4090, 4100));
+    msgs.Add(put("count://a", 4100, 4110));
+    msgs.Add(put("count://a"));
+    wait(msgs);
+    CHECK(numReads == 4);
+    CHECK(checkData(msgs[0], 16, 16));
+    CHECK(checkData(msgs[1], 0, 16));
+    CHECK(checkData(msgs[2], 8, 16));
+    CHECK(checkData(msgs[3], 8, 16));
+    CHECK(checkData(msgs[4], 100, 16));
+    CHECK(checkData(msgs[5], 4090, 6));
+    CHECK(msgs[6]->Status == IOStatus::RequestedRangeNotSatisfiable);
+    CHECK(checkData(msgs[7], 0, fileSize));
+    IOCoalesceStats stats = IO::QueryCoalesceStats();
+    CHECK(stats.NumCoalesced == 0);
+    CHECK(stats.NumMerged == 6);
+    CHECK(stats.NumGroupReads == 2);
+
+    IO::Discard();
+    Core::Discard();
+}
+
+TEST(ioRouterNoCoalesceTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("count", CountFileSystem::Creator());
+    ioSetup.CoalesceReads = false;
+    IO::Setup(ioSetup);
+
+    numReads = 0;
+    Array<Ptr<IORead>> msgs;
+    for (int i = 0; i < 4; i++) {
+        msgs.Add(put("count://a"));
+    }
+    wait(msgs);
+    CHECK(numReads == 4);
+    for (const auto& msg : msgs) {
+        CHECK(checkData(msg, 0, fileSize));
+    }
+    CHECK(IO::QueryCoalesceStats().NumGroupReads == 0);
+
+    IO::Discard();
+    Core::Discard();
+}
@@ -0,0 +1,143 @@
+//------------------------------------------------------------------------------
+//  loadQueueTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "IO/IO.h"
+#include "Core/Core.h"
+#include "Core/RunLoop.h"
+#include "Core/String/StringBuilder.h"
+#include "Core/Time/Clock.h"
+#include <cstring>
+#include <mutex>
+
+using namespace Oryol;
+
+// a filesystem which holds on to all requests until they are released
+static std::mutex stalledMutex;
+static Array<Ptr<IORequest>> stalledRequests;
+
+class StallFileSystem : public FileSystem {
+    OryolClassDecl(StallFileSystem);
+    OryolClassCreator(StallFileSystem);
+public:
+    virtual void onMsg(const Ptr<IORequest>& msg) override {
+        std::lock_guard<std::mutex> lock(stalledMutex);
+        stalledRequests.Add(msg);
+    };
+};
+
+static int
+numStalled() {
+    std::lock_guard<std::mutex> lock(stalledMutex);
+    return stalledRequests.Size();
+}
+
+static void
+release(const URL& url) {
+    std::lock_guard<std::mutex> lock(stalledMutex);
+    for (int i = 0; i < stalledRequests.Size(); i++) {
+        const auto& msg = stalledRequests[i];
+        // NOTE: URLs can't be compared directly, since the request
+        // URL has been created on the IO thread
+        if (0 == std::strcmp(msg->Url.AsCStr(), url.AsCStr())) {
+            msg->Data.Add((const uint8_t*)url.AsCStr(), int(std::strlen(url.AsCStr())));
+            msg->Status = IOStatus::OK;
+            msg->Handled = true;
+            stalledRequests.Erase(i);
+            return;
+        }
+    }
+}
+
+static void
+releaseAll() {
+    std::lock_guard<std::mutex> lock(stalledMutex);
+    for (const auto& msg : stalledRequests) {
+        msg->Status = IOStatus::NotFound;
+        msg->Handled = true;
+    }
+    stalledRequests.Clear();
+}
+
+static void
+waitFrames(std::function<bool()> cond) {
+    while (!cond()) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+#if !ORYOL_EMSCRIPTEN && !ORYOL_UNITTESTS_HEADLESS
+TEST(loadQueueTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("stall", StallFileSystem::Creator());
+    IO::Setup(ioSetup);
+
+    // callbacks are called in completion order
+    Array<String> loaded;
+    IO::Load("stall://a", [&loaded](IO::LoadResult res) {
+        loaded.Add(String(res.Url.AsCStr()));
+    });
+    IO::Load("stall://b", [&loaded](IO::LoadResult res) {
+        loaded.Add(String(res.Url.AsCStr()));
+    });
+    CHECK(IO::NumPendingLoads() == 2);
+    waitFrames([] { return numStalled() == 2; });
+    release("stall://b");
+    waitFrames([&loaded] { return loaded.Size() == 1; });
+    release("stall://a");
+    waitFrames([&loaded] { return loaded.Size() == 2; });
+    CHECK(loaded[0] == "stall://b");
+    CHECK(loaded[1] == "stall://a");
+    CHECK(IO::NumPendingLoads() == 0);
+
+    // group results are in URL order, independent from completion order
+    Array<String> groupLoaded;
+    IO::LoadGroup(Array<URL>({ "stall://x", "stall://y", "stall://z" }), [&groupLoaded](Array<IO::LoadResult> results) {
+        for (const auto& res : results) {
+            groupLoaded.Add(String((const char*)res.Data.Data(), 0, res.Data.Size()));
+        }
+    });
+    waitFrames([] { return numStalled() == 3; });
+    release("stall://z");
+    release("stall://x");
+    release("stall://y");
+    waitFrames([] { return IO::NumPendingLoads() == 0; });
+    CHECK(groupLoaded.Size() == 3);
+    CHECK(groupLoaded[0] == "stall://x");
+    CHECK(groupLoaded[1] == "stall://y");
+    CHECK(groupLoaded[2] == "stall://z");
+
+    // measure the per-frame overhead with many pending loads
+    const int numLoads = 10000;
+    const int numFrames = 100;
+    int numFailed = 0;
+    StringBuilder strBuilder;
+    for (int i = 0; i < numLoads; i++) {
+        strBuilder.Format(64, "stall://file%d", i);
+        IO::Load(strBuilder.GetString(),
+            [](IO::LoadResult res) { },
+            [&numFailed](const URL& url, IOStatus::Code ioStatus) {
+                numFailed++;
+            });
+    }
+    waitFrames([numLoads] { return numStalled() == numLoads; });
+    CHECK(IO::NumPendingLoads() == numLoads);
+    TimePoint start = Clock::Now();
+    for (int i = 0; i < numFrames; i++) {
+        Core::PreRunLoop()->Run();
+    }
+    Duration frameTime = Clock::Since(start);
+    Log::Info("loadQueueTest: %d pending loads, %.3fus per frame\n",
+        numLoads, frameTime.AsMicroSeconds() / numFrames);
+    CHECK(IO::NumPendingLoads() == numLoads);
+    releaseAll();
+    waitFrames([] { return IO::NumPendingLoads() == 0; });
+    CHECK(numFailed == numLoads);
+
+    IO::Discard();
+    Core::Discard();
+}
+#endif
@@ -29,13 +29,13 @@ LocalFileSystem::init(const StringAtom& scheme_) {
 //------------------------------------------------------------------------------
 void
 LocalFileSystem::onMsg(const Ptr<IORequest>& req) {
-    if (req->IsA<IORead>()) {
-        this->onRead(req->DynamicCast<IORead>());
+    if (req->isRead()) {
+        this->onRead(ioMsgCast<IORead>(req));
     }
-    else if (req->IsA<IOWrite>()) {
-        this->onWrite(req->DynamicCast<IOWrite>());
+    else if (ioMsgType::Write == req->MsgType) {
+        this->onWrite(ioMsgCast<IOWrite>(req));
     }
-    req->Handled = true;
+    this->setHandled(req);
 }
 
 //------------------------------------------------------------------------------
@@ -44,29 +44,47 @@ LocalFileSystem::onRead(const Ptr<IORead>& msg) {
     if (msg->Url.HasPath()) {
         fsWrapper::handle h = fsWrapper::openRead(msg->Url.Path().AsCStr());
         if (fsWrapper::invalidHandle != h) {
-            const int startOffset = msg->StartOffset;
-            const int endOffset = msg->EndOffset;
-            if (startOffset > 0) {
-                fsWrapper::seek(h, startOffset);
+            // like HTTP range requests, ranges reaching past
+            // the end of the file are clamped to the file size
+            const int64_t fileSize = fsWrapper::size(h);
+            const int64_t startOffset = msg->StartOffset;
+            int64_t endOffset = msg->EndOffset;
+            if ((endOffset == EndOfFile) || (endOffset > fileSize)) {
+                endOffset = fileSize;
             }
-            int size;
-            if (endOffset == EndOfFile) {
-                size = fsWrapper::size(h) - startOffset;
+            const int64_t size = endOffset - startOffset;
+            if ((startOffset < 0) || (size < 0)) {
+                msg->Status = IOStatus::RequestedRangeNotSatisfiable;
+                msg->ErrorDesc = "Range outside of file";
             }
-            else {
-                size = endOffset - startOffset;
+            else if (size > Buffer::MaxSize) {
+                // large files must be read in ranges
+                msg->Status = IOStatus::RequestEntityTooLarge;
+                msg->ErrorDesc = "Range too large for a single read";
             }
-            if (size > 0) {
-                uint8_t* ptr = msg->Data.Add(size);
-                int bytesRead = fsWrapper::read(h, ptr, size);
-                if (bytesRead != size) {
-                    msg->Status = IOStatus::DownloadError;
-                    msg->ErrorDesc = "Fewer bytes read then expected";
+            else if (size > 0) {
+                // NOTE: the result may go directly into caller-owned memory
+                uint8_t* ptr = msg->AddResult(int(size));
+                if (nullptr == ptr) {
+                    msg->Status = IOStatus::RequestEntityTooLarge;
+                    msg->ErrorDesc = "Destination buffer too small";
                 }
                 else {
-                    msg->Status = IOStatus::OK;
+                    int bytesRead = fsWrapper::readAt(h, startOffset, ptr, int(size));
+                    if (bytesRead != size) {
+                        // report the partial read in the result size
+                        msg->TruncateResult(bytesRead > 0 ? bytesRead : 0);
+                        msg->Status = IOStatus::DownloadError;
+                        msg->ErrorDesc = "Fewer bytes read then expected";
+                    }
+                    else {
+                        msg->Status = IOStatus::OK;
+                    }
                 }
             }
+            else {
+                msg->Status = IOStatus::OK;
+            }
             fsWrapper::close(h);
         }
         else {
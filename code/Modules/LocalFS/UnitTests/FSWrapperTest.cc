@@ -53,7 +53,7 @@ TEST(FSWrapperTest) {
     fsWrapper::close(hr);
 
     const fsWrapper::handle hs = fsWrapper::openRead(strBuilder.AsCStr());
-    int size = fsWrapper::size(hs);
+    int64_t size = fsWrapper::size(hs);
     CHECK(size == 12);
     CHECK(fsWrapper::seek(hs, 6));
     size = fsWrapper::size(hs);
@@ -62,4 +62,18 @@ TEST(FSWrapperTest) {
     readStr.Assign(buf, 0, 6);
     CHECK(readStr == "World\n");
     fsWrapper::close(hs);
+
+    #if !ORYOL_WINDOWS
+    int64_t mapSize = 0;
+    const void* mapPtr = fsWrapper::map(strBuilder.AsCStr(), mapSize);
+    CHECK(mapPtr);
+    CHECK(mapSize == 12);
+    readStr.Assign((const char*)mapPtr, 0, int(mapSize));
+    CHECK(readStr == "Hello World\n");
+    fsWrapper::unmap(mapPtr, mapSize);
+    #endif
+
+    CHECK(fsWrapper::remove(strBuilder.AsCStr()));
+    CHECK(fsWrapper::openRead(strBuilder.AsCStr()) == fsWrapper::invalidHandle);
+    CHECK(!fsWrapper::remove(strBuilder.AsCStr()));
 }
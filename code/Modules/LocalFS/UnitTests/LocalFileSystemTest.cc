@@ -8,6 +8,8 @@
 #include "IO/IO.h"
 #include "LocalFS/LocalFileSystem.h"
 #include "LocalFS/Core/fsWrapper.h"
+#include "zlib.h"
+#include <cstring>
 
 using namespace Oryol;
 
@@ -83,6 +85,24 @@ TEST(LocalFileSystemTest) {
     readStr.Assign((const char*)read->Data.Data(), 0, read->Data.Size());
     CHECK(readStr == "World");
 
+    // ranges past the end of file are clamped
+    read = IORead::Create();
+    read->Url = "root:test.txt";
+    read->StartOffset = 6;
+    read->EndOffset = 100;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(read->Data.Size() == 6);
+
+    // ranges starting past the end of file fail
+    read = IORead::Create();
+    read->Url = "root:test.txt";
+    read->StartOffset = 100;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::RequestedRangeNotSatisfiable);
+
     IO::Discard();
     Core::Discard();
 }
@@ -190,5 +210,364 @@ TEST(SameExtensionTest) {
     Core::Discard();
 }
 
+TEST(ReadCacheTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("file", LocalFileSystem::Creator());
+    ioSetup.CacheBudget = 1024;
+    IO::Setup(ioSetup);
+
+    const String hello("Hello Cache!");
+    auto write = IOWrite::Create();
+    write->Url = "root:cache.txt";
+    write->Data.Add((const uint8_t*)hello.AsCStr(), hello.Length());
+    IO::Put(write);
+    wait(write);
+    CHECK(write->Status == IOStatus::OK);
+
+    // first read is a cache miss, second read is a hit
+    auto read = IO::LoadFile("root:cache.txt");
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(read->Data.Size() == 12);
+    IOCacheStats stats = IO::QueryCacheStats();
+    CHECK(stats.NumMisses == 1);
+    CHECK(stats.NumHits == 0);
+    CHECK(stats.NumEntries == 1);
+    CHECK(stats.NumBytes == 12);
+
+    read = IO::LoadFile("root:cache.txt");
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(read->Data.Size() == 12);
+    String readStr((const char*)read->Data.Data(), 0, read->Data.Size());
+    CHECK(readStr == "Hello Cache!");
+    stats = IO::QueryCacheStats();
+    CHECK(stats.NumMisses == 1);
+    CHECK(stats.NumHits == 1);
+
+    // requests without the cache flags bypass the cache
+    read = IORead::Create();
+    read->Url = "root:cache.txt";
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(IO::QueryCacheStats().NumHits == 1);
+
+    // a write drops the cached data of the URL
+    const String bye("Bye Cache!");
+    write = IOWrite::Create();
+    write->Url = "root:cache.txt";
+    write->Data.Add((const uint8_t*)bye.AsCStr(), bye.Length());
+    IO::Put(write);
+    wait(write);
+    CHECK(write->Status == IOStatus::OK);
+    CHECK(IO::QueryCacheStats().NumEntries == 0);
+    read = IO::LoadFile("root:cache.txt");
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(String((const char*)read->Data.Data(), 0, read->Data.Size()) == "Bye Cache!");
+    CHECK(IO::QueryCacheStats().NumHits == 1);
+
+    IO::ClearCache();
+    CHECK(IO::QueryCacheStats().NumEntries == 0);
+
+    IO::Discard();
+    Core::Discard();
+}
+
+TEST(DecompressTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("file", LocalFileSystem::Creator());
+    IO::Setup(ioSetup);
+
+    // write a compressed file which needs several chunks
+    Buffer data;
+    uint8_t* ptr = data.Add(300 * 1024);
+    uint32_t x = 12345;
+    for (int i = 0; i < data.Size(); i++) {
+        x = x * 1103515245 + 12345;
+        ptr[i] = uint8_t((x >> 16) & 0x0F);
+    }
+    Buffer compressed;
+    uLongf compressedSize = compressBound(uLong(data.Size()));
+    uint8_t* dst = compressed.Add(int(compressedSize));
+    CHECK(Z_OK == compress2(dst, &compressedSize, data.Data(), uLong(data.Size()), Z_DEFAULT_COMPRESSION));
+    CHECK(int(compressedSize) > IOConfig::DecompressChunkSize);
+    auto write = IOWrite::Create();
+    write->Url = "root:compressed.z";
+    write->Data.Add(compressed.Data(), int(compressedSize));
+    IO::Put(write);
+    wait(write);
+    CHECK(write->Status == IOStatus::OK);
+
+    // read and decompress
+    auto read = IORead::Create();
+    read->Url = "root:compressed.z";
+    read->DecompressEnabled = true;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(read->Data.Size() == data.Size());
+    CHECK(0 == std::memcmp(read->Data.Data(), data.Data(), data.Size()));
+    IODecodeStats stats = IO::QueryDecodeStats();
+    CHECK(stats.NumDecoded == 1);
+    CHECK(stats.NumFailed == 0);
+    CHECK(stats.NumBytesIn == int64_t(compressedSize));
+    CHECK(stats.NumBytesOut == data.Size());
+    CHECK(stats.Ratio() > 1.0);
+    Log::Info("DecompressTest: ratio=%.2f, throughput=%.2f MB/s\n", stats.Ratio(), stats.Throughput());
+
+    // uncompressed data fails to decompress
+    read = IORead::Create();
+    read->Url = "root:test.txt";
+    read->DecompressEnabled = true;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::UnsupportedMediaType);
+    CHECK(read->Data.Empty());
+    CHECK(IO::QueryDecodeStats().NumFailed == 1);
+
+    IO::Discard();
+    Core::Discard();
+}
+
+TEST(LoadStreamTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("file", LocalFileSystem::Creator());
+    IO::Setup(ioSetup);
+
+    // write a file which is streamed in several chunks, with a short last chunk
+    const int chunkSize = 16 * 1024;
+    Buffer data;
+    uint8_t* ptr = data.Add(10 * chunkSize + 123);
+    for (int i = 0; i < data.Size(); i++) {
+        ptr[i] = uint8_t(i * 7);
+    }
+    auto write = IOWrite::Create();
+    write->Url = "root:stream.bin";
+    write->Data.Add(data.Data(), data.Size());
+    IO::Put(write);
+    wait(write);
+    CHECK(write->Status == IOStatus::OK);
+
+    Buffer streamed;
+    int numChunks = 0;
+    int numDone = 0;
+    bool inOrder = true;
+    IOStatus::Code doneStatus = IOStatus::InvalidIOStatus;
+    IO::LoadStream("root:stream.bin", chunkSize,
+        [&](IO::LoadStreamChunk chunk) {
+            inOrder &= (chunk.Offset == streamed.Size());
+            inOrder &= (chunk.Data.Size() <= chunkSize);
+            streamed.Add(chunk.Data.Data(), chunk.Data.Size());
+            numChunks++;
+        },
+        [&](const URL& url, IOStatus::Code status) {
+            doneStatus = status;
+            numDone++;
+        }, 3);
+    CHECK(IO::NumPendingLoads() == 1);
+    while (IO::NumPendingLoads() > 0) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        Core::PostRunLoop()->Run();
+    }
+    CHECK(numDone == 1);
+    CHECK(doneStatus == IOStatus::OK);
+    CHECK(inOrder);
+    CHECK(numChunks == 11);
+    CHECK(streamed.Size() == data.Size());
+    CHECK(0 == std::memcmp(streamed.Data(), data.Data(), data.Size()));
+
+    // streaming a non-existing file only calls the done callback
+    numChunks = 0;
+    numDone = 0;
+    IO::LoadStream("root:bla.bin", chunkSize,
+        [&](IO::LoadStreamChunk chunk) {
+            numChunks++;
+        },
+        [&](const URL& url, IOStatus::Code status) {
+            doneStatus = status;
+            numDone++;
+        });
+    while (IO::NumPendingLoads() > 0) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        Core::PostRunLoop()->Run();
+    }
+    CHECK(numChunks == 0);
+    CHECK(numDone == 1);
+    CHECK(doneStatus == IOStatus::NotFound);
+
+    IO::Discard();
+    Core::Discard();
+}
+
+TEST(DestBufferTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("file", LocalFileSystem::Creator());
+    ioSetup.CacheBudget = 1024;
+    IO::Setup(ioSetup);
+
+    const String hello("Hello Destination!");
+    auto write = IOWrite::Create();
+    write->Url = "root:dest.txt";
+    write->Data.Add((const uint8_t*)hello.AsCStr(), hello.Length());
+    IO::Put(write);
+    wait(write);
+    CHECK(write->Status == IOStatus::OK);
 
+    // read into caller memory, the Data buffer stays empty
+    uint8_t dest[64] = { };
+    auto read = IORead::Create();
+    read->Url = "root:dest.txt";
+    read->DestPtr = dest;
+    read->DestCapacity = sizeof(dest);
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(read->DestSize == hello.Length());
+    CHECK(read->Data.Empty());
+    CHECK(String((const char*)dest, 0, read->DestSize) == hello);
 
+    // range read into caller memory
+    read = IORead::Create();
+    read->Url = "root:dest.txt";
+    read->StartOffset = 6;
+    read->EndOffset = 10;
+    read->DestPtr = dest;
+    read->DestCapacity = 4;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(read->DestSize == 4);
+    CHECK(String((const char*)dest, 0, 4) == "Dest");
+
+    // destination memory too small
+    read = IORead::Create();
+    read->Url = "root:dest.txt";
+    read->DestPtr = dest;
+    read->DestCapacity = 8;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::RequestEntityTooLarge);
+    CHECK(read->DestSize == 0);
+    CHECK(read->Data.Empty());
+
+    // destination memory provided by a callback once the size is known
+    Buffer allocated;
+    int requestedSize = 0;
+    read = IORead::Create();
+    read->Url = "root:dest.txt";
+    read->DestFunc = [&allocated, &requestedSize](int size) -> uint8_t* {
+        requestedSize = size;
+        return allocated.Add(size);
+    };
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(requestedSize == hello.Length());
+    CHECK(read->DestPtr == allocated.Data());
+    CHECK(String((const char*)allocated.Data(), 0, read->DestSize) == hello);
+
+    // a cached result is copied into the destination memory
+    auto cached = IO::LoadFile("root:dest.txt");
+    wait(cached);
+    CHECK(cached->Status == IOStatus::OK);
+    std::memset(dest, 0, sizeof(dest));
+    read = IORead::Create();
+    read->Url = "root:dest.txt";
+    read->CacheReadEnabled = true;
+    read->DestPtr = dest;
+    read->DestCapacity = sizeof(dest);
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(IO::QueryCacheStats().NumHits == 1);
+    CHECK(read->Data.Empty());
+    CHECK(String((const char*)dest, 0, read->DestSize) == hello);
+
+    IO::Discard();
+    Core::Discard();
+}
+
+// sparse files are not supported everywhere
+#if !ORYOL_WINDOWS
+TEST(LargeFileTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("file", LocalFileSystem::Creator());
+    IO::Setup(ioSetup);
+
+    // create a sparse file of more than 4 GByte with a marker at the end,
+    // the file is created in the directory of the 'cwd:' assign, which is
+    // also used to read it back through the IO module
+    const int64_t markerOffset = 5LL * 1024 * 1024 * 1024;
+    const char* marker = "End of large file";
+    const int markerLength = int(std::strlen(marker));
+    const URL url(IO::ResolveAssigns("cwd:large.bin"));
+    const String path = url.Path();
+    _priv::fsWrapper::handle h = _priv::fsWrapper::openWrite(path.AsCStr());
+    CHECK(_priv::fsWrapper::invalidHandle != h);
+    if (_priv::fsWrapper::invalidHandle == h) {
+        IO::Discard();
+        Core::Discard();
+        return;
+    }
+    CHECK(_priv::fsWrapper::seek(h, markerOffset));
+    CHECK(_priv::fsWrapper::write(h, marker, markerLength) == markerLength);
+    _priv::fsWrapper::close(h);
+    h = _priv::fsWrapper::openRead(path.AsCStr());
+    CHECK(_priv::fsWrapper::size(h) == markerOffset + markerLength);
+    char buf[64] = { };
+    CHECK(_priv::fsWrapper::readAt(h, markerOffset + 4, buf, sizeof(buf)) == markerLength - 4);
+    CHECK(String(buf, 0, markerLength - 4) == "of large file");
+    _priv::fsWrapper::close(h);
+
+    // range reads beyond 4 GByte
+    auto read = IORead::Create();
+    read->Url = url;
+    read->StartOffset = markerOffset - 4;
+    read->EndOffset = markerOffset + markerLength + 100;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(read->Data.Size() == markerLength + 4);
+    if (read->Data.Size() == markerLength + 4) {
+        CHECK(0 == std::memcmp(read->Data.Data(), "\0\0\0\0", 4));
+        CHECK(0 == std::memcmp(read->Data.Data() + 4, marker, markerLength));
+    }
+    read = IORead::Create();
+    read->Url = url;
+    read->StartOffset = 4LL * 1024 * 1024 * 1024 + 1;
+    read->EndOffset = read->StartOffset + 16;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::OK);
+    CHECK(read->Data.Size() == 16);
+    read = IORead::Create();
+    read->Url = url;
+    read->StartOffset = markerOffset + markerLength + 1;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::RequestedRangeNotSatisfiable);
+
+    // the whole file doesn't fit into a buffer
+    read = IORead::Create();
+    read->Url = url;
+    IO::Put(read);
+    wait(read);
+    CHECK(read->Status == IOStatus::RequestEntityTooLarge);
+    CHECK(read->Data.Empty());
+
+    // and delete the file again
+    CHECK(_priv::fsWrapper::remove(path.AsCStr()));
+
+    IO::Discard();
+    Core::Discard();
+}
+#endif
@@ -31,14 +31,20 @@ dummyFSWrapper::read(handle f, void* ptr, int numBytes) {
     return 0;
 }
 
+//------------------------------------------------------------------------------
+int
+dummyFSWrapper::readAt(handle f, int64_t offset, void* ptr, int numBytes) {
+    return 0;
+}
+
 //------------------------------------------------------------------------------
 bool
-dummyFSWrapper::seek(handle f, int offset) {
+dummyFSWrapper::seek(handle f, int64_t offset) {
     return true;
 }
 
 //------------------------------------------------------------------------------
-int
+int64_t
 dummyFSWrapper::size(handle f) {
     return 0;
 }
@@ -49,6 +55,25 @@ dummyFSWrapper::close(handle f) {
     // empty
 }
 
+//------------------------------------------------------------------------------
+const void*
+dummyFSWrapper::map(const char* path, int64_t& outSize) {
+    outSize = 0;
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+void
+dummyFSWrapper::unmap(const void* ptr, int64_t size) {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+bool
+dummyFSWrapper::remove(const char* path) {
+    return false;
+}
+
 //------------------------------------------------------------------------------
 String
 dummyFSWrapper::getExecutableDir() {
@@ -26,12 +26,20 @@ public:
     static int write(handle f, const void* ptr, int numBytes);
     /// read from file, return number of bytes actually read
     static int read(handle f, void* ptr, int numBytes);
+    /// read from a file position without moving the file pointer, return number of bytes actually read
+    static int readAt(handle f, int64_t offset, void* ptr, int numBytes);
     /// seek from start of file
-    static bool seek(handle f, int offset);
+    static bool seek(handle f, int64_t offset);
     /// get file size
-    static int size(handle f);
+    static int64_t size(handle f);
     /// close file
     static void close(handle f);
+    /// map a whole file read-only into memory, return nullptr if not supported
+    static const void* map(const char* path, int64_t& outSize);
+    /// unmap a file mapped with map()
+    static void unmap(const void* ptr, int64_t size);
+    /// delete a file, return false if failed
+    static bool remove(const char* path);
     
     /// get path to own executable
     static String getExecutableDir();
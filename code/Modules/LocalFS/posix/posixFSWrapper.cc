@@ -12,6 +12,9 @@
 #include <direct.h>
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 namespace Oryol {
@@ -49,23 +52,60 @@ posixFSWrapper::read(handle h, void* ptr, int numBytes) {
     return (int) fread(ptr, 1, numBytes, (FILE*)h);
 }
 
+//------------------------------------------------------------------------------
+int
+posixFSWrapper::readAt(handle h, int64_t offset, void* ptr, int numBytes) {
+    o_assert_dbg(invalidHandle != h);
+    o_assert_dbg(ptr && (offset >= 0));
+    #if ORYOL_WINDOWS
+        if (!seek(h, offset)) {
+            return 0;
+        }
+        return read(h, ptr, numBytes);
+    #else
+        // pread() doesn't touch the FILE's buffer and position, so
+        // it doesn't mix with buffered reads on the same handle
+        const int fd = fileno((FILE*)h);
+        int bytesRead = 0;
+        while (bytesRead < numBytes) {
+            ssize_t res = pread(fd, (uint8_t*)ptr + bytesRead, size_t(numBytes - bytesRead), off_t(offset + bytesRead));
+            if (res <= 0) {
+                break;
+            }
+            bytesRead += int(res);
+        }
+        return bytesRead;
+    #endif
+}
+
 //------------------------------------------------------------------------------
 bool
-posixFSWrapper::seek(handle h, int offset) {
+posixFSWrapper::seek(handle h, int64_t offset) {
     o_assert_dbg(invalidHandle != h);
-    return 0 == fseek((FILE*)h, offset, SEEK_SET);
+    #if ORYOL_WINDOWS
+    return 0 == _fseeki64((FILE*)h, offset, SEEK_SET);
+    #else
+    return 0 == fseeko((FILE*)h, off_t(offset), SEEK_SET);
+    #endif
 }
 
 //------------------------------------------------------------------------------
-int
+int64_t
 posixFSWrapper::size(handle h) {
     o_assert_dbg(invalidHandle != h);
     FILE* fp = (FILE*) h;
-    long off = ftell(fp);
-    fseek(fp, 0, SEEK_END);
-    long size = ftell(fp);
-    fseek(fp, off, SEEK_SET);
-    return (int) size;
+    #if ORYOL_WINDOWS
+    int64_t off = _ftelli64(fp);
+    _fseeki64(fp, 0, SEEK_END);
+    int64_t size = _ftelli64(fp);
+    _fseeki64(fp, off, SEEK_SET);
+    #else
+    off_t off = ftello(fp);
+    fseeko(fp, 0, SEEK_END);
+    int64_t size = int64_t(ftello(fp));
+    fseeko(fp, off, SEEK_SET);
+    #endif
+    return size;
 }
 
 //------------------------------------------------------------------------------
@@ -75,6 +115,51 @@ posixFSWrapper::close(handle h) {
     fclose((FILE*)h);
 }
 
+//------------------------------------------------------------------------------
+const void*
+posixFSWrapper::map(const char* path, int64_t& outSize) {
+    o_assert_dbg(path);
+    outSize = 0;
+    #if ORYOL_WINDOWS
+        // FIXME: use CreateFileMapping/MapViewOfFile
+        return nullptr;
+    #else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st;
+        if ((0 != fstat(fd, &st)) || (st.st_size <= 0) || (uint64_t(st.st_size) > uint64_t(SIZE_MAX))) {
+            ::close(fd);
+            return nullptr;
+        }
+        void* ptr = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping stays valid after the file descriptor is closed
+        ::close(fd);
+        if (MAP_FAILED == ptr) {
+            return nullptr;
+        }
+        outSize = int64_t(st.st_size);
+        return ptr;
+    #endif
+}
+
+//------------------------------------------------------------------------------
+void
+posixFSWrapper::unmap(const void* ptr, int64_t size) {
+    o_assert_dbg(ptr && (size > 0));
+    #if !ORYOL_WINDOWS
+    munmap(const_cast<void*>(ptr), size_t(size));
+    #endif
+}
+
+//------------------------------------------------------------------------------
+bool
+posixFSWrapper::remove(const char* path) {
+    o_assert_dbg(path);
+    return 0 == ::remove(path);
+}
+
 //------------------------------------------------------------------------------
 String
 posixFSWrapper::getExecutableDir() {
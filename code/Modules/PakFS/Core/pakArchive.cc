@@ -0,0 +1,278 @@
+//------------------------------------------------------------------------------
+//  pakArchive.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "pakArchive.h"
+#include "Core/Memory/Memory.h"
+#include "zlib.h"
+#include <cstring>
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+pakArchive::pakArchive() :
+mapping(nullptr),
+mappingSize(0),
+file(fsWrapper::invalidHandle),
+toc(nullptr),
+names(nullptr) {
+    Memory::Clear(&this->header, sizeof(this->header));
+}
+
+//------------------------------------------------------------------------------
+pakArchive::~pakArchive() {
+    if (this->isOpen()) {
+        this->close();
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+pakArchive::open(const char* path) {
+    o_assert_dbg(path);
+    o_assert_dbg(!this->isOpen());
+
+    // try to map the whole archive, the table of contents
+    // and name table can then be used in-place
+    const uint8_t* ptr = (const uint8_t*) fsWrapper::map(path, this->mappingSize);
+    if (ptr) {
+        this->mapping = ptr;
+        if (this->mappingSize < int64_t(sizeof(pakFormat::header))) {
+            this->close();
+            return false;
+        }
+        Memory::Copy(ptr, &this->header, sizeof(this->header));
+        this->toc = (const pakFormat::entry*) (ptr + sizeof(pakFormat::header));
+        this->names = (const char*) (this->toc + this->header.numEntries);
+        if (!this->validate(this->mappingSize)) {
+            this->close();
+            return false;
+        }
+        return true;
+    }
+
+    // fallback: load table of contents and name table into memory,
+    // and keep the file open for reading entry data
+    this->file = fsWrapper::openRead(path);
+    if (fsWrapper::invalidHandle == this->file) {
+        return false;
+    }
+    const int64_t archiveSize = fsWrapper::size(this->file);
+    if ((archiveSize < int64_t(sizeof(pakFormat::header))) ||
+        (fsWrapper::read(this->file, &this->header, sizeof(this->header)) != int(sizeof(this->header))) ||
+        (this->header.magic != pakFormat::Magic) ||
+        (uint64_t(this->header.numEntries) * sizeof(pakFormat::entry) + this->header.namesSize > uint64_t(archiveSize))) {
+        this->close();
+        return false;
+    }
+    const int tocSize = this->header.numEntries * sizeof(pakFormat::entry) + this->header.namesSize;
+    if (tocSize > 0) {
+        uint8_t* dst = this->tocData.Add(tocSize);
+        if (fsWrapper::read(this->file, dst, tocSize) != tocSize) {
+            this->close();
+            return false;
+        }
+        this->toc = (const pakFormat::entry*) dst;
+        this->names = (const char*) (this->toc + this->header.numEntries);
+    }
+    if (!this->validate(archiveSize)) {
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+pakArchive::close() {
+    if (this->mapping) {
+        fsWrapper::unmap(this->mapping, this->mappingSize);
+        this->mapping = nullptr;
+        this->mappingSize = 0;
+    }
+    if (fsWrapper::invalidHandle != this->file) {
+        fsWrapper::close(this->file);
+        this->file = fsWrapper::invalidHandle;
+    }
+    this->tocData = Buffer();
+    this->toc = nullptr;
+    this->names = nullptr;
+    Memory::Clear(&this->header, sizeof(this->header));
+}
+
+//------------------------------------------------------------------------------
+bool
+pakArchive::isOpen() const {
+    return (nullptr != this->mapping) || (fsWrapper::invalidHandle != this->file);
+}
+
+//------------------------------------------------------------------------------
+bool
+pakArchive::isMapped() const {
+    return nullptr != this->mapping;
+}
+
+//------------------------------------------------------------------------------
+bool
+pakArchive::validate(int64_t archiveSize) const {
+    if ((this->header.magic != pakFormat::Magic) || (this->header.version != pakFormat::Version)) {
+        return false;
+    }
+    const uint64_t dataStart = sizeof(pakFormat::header) +
+        uint64_t(this->header.numEntries) * sizeof(pakFormat::entry) +
+        this->header.namesSize;
+    if (dataStart > uint64_t(archiveSize)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < this->header.numEntries; i++) {
+        const pakFormat::entry& e = this->toc[i];
+        if ((uint64_t(e.nameOffset) + e.nameLength > this->header.namesSize) ||
+            (e.offset < dataStart) ||
+            (e.offset + e.size > uint64_t(archiveSize)) ||
+            (e.uncompressedSize > 0x7FFFFFFF) ||
+            (e.compression > pakFormat::Deflate) ||
+            ((e.compression == pakFormat::None) && (e.size != e.uncompressedSize))) {
+            return false;
+        }
+        // entries must be sorted for the binary search in find()
+        if ((i > 0) && (this->toc[i-1].nameHash > e.nameHash)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int
+pakArchive::numEntries() const {
+    return int(this->header.numEntries);
+}
+
+//------------------------------------------------------------------------------
+int
+pakArchive::find(const char* name, int len) const {
+    o_assert_dbg(name);
+    const uint32_t nameHash = pakFormat::hashString(name, len);
+
+    // binary search for the first entry with a matching hash
+    int lo = 0;
+    int hi = int(this->header.numEntries);
+    while (lo < hi) {
+        const int mid = lo + ((hi - lo) >> 1);
+        if (this->toc[mid].nameHash < nameHash) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    // compare names of all entries with the same hash
+    for (int i = lo; (i < int(this->header.numEntries)) && (this->toc[i].nameHash == nameHash); i++) {
+        const pakFormat::entry& e = this->toc[i];
+        if ((int(e.nameLength) == len) && (0 == std::memcmp(this->names + e.nameOffset, name, len))) {
+            return i;
+        }
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+const pakFormat::entry&
+pakArchive::entryAt(int index) const {
+    o_assert_range_dbg(index, int(this->header.numEntries));
+    return this->toc[index];
+}
+
+//------------------------------------------------------------------------------
+String
+pakArchive::entryName(int index) const {
+    const pakFormat::entry& e = this->entryAt(index);
+    return String(this->names + e.nameOffset, 0, e.nameLength);
+}
+
+//------------------------------------------------------------------------------
+bool
+pakArchive::readStored(int index, int64_t offset, int size, uint8_t* dst) {
+    const pakFormat::entry& e = this->entryAt(index);
+    o_assert_dbg((offset >= 0) && (size >= 0) && (uint64_t(offset) + size <= e.size));
+    if (0 == size) {
+        return true;
+    }
+    o_assert_dbg(dst);
+    if (this->mapping) {
+        Memory::Copy(this->mapping + e.offset + offset, dst, size);
+        return true;
+    }
+    else {
+        #if ORYOL_HAS_THREADS
+        std::lock_guard<std::mutex> lock(this->fileMutex);
+        #endif
+        return fsWrapper::readAt(this->file, int64_t(e.offset) + offset, dst, size) == size;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool
+pakArchive::readEntry(int index, int64_t startOffset, int64_t endOffset, Buffer& outData, String& outError) {
+    if (EndOfFile == endOffset) {
+        endOffset = int64_t(this->entryAt(index).uncompressedSize);
+    }
+    o_assert_dbg((endOffset - startOffset) <= Buffer::MaxSize);
+    const int size = int(endOffset - startOffset);
+    if (0 == size) {
+        return true;
+    }
+    return this->readEntry(index, startOffset, endOffset, outData.Add(size), outError);
+}
+
+//------------------------------------------------------------------------------
+bool
+pakArchive::readEntry(int index, int64_t startOffset, int64_t endOffset, uint8_t* dst, String& outError) {
+    const pakFormat::entry& e = this->entryAt(index);
+    const int64_t entrySize = int64_t(e.uncompressedSize);
+    o_assert_dbg((startOffset >= 0) && (startOffset <= endOffset) && (endOffset <= entrySize));
+    o_assert_dbg((endOffset - startOffset) <= Buffer::MaxSize);
+    const int size = int(endOffset - startOffset);
+    if (0 == size) {
+        return true;
+    }
+    o_assert_dbg(dst);
+    if (pakFormat::None == e.compression) {
+        // uncompressed entries can be read directly
+        if (!this->readStored(index, startOffset, size, dst)) {
+            outError = "Failed to read from archive";
+            return false;
+        }
+    }
+    else {
+        // compressed entries must be inflated completely, if the whole
+        // entry is requested, directly into the destination memory
+        if ((e.size > uint64_t(Buffer::MaxSize)) || (e.uncompressedSize > uint64_t(Buffer::MaxSize))) {
+            outError = "Compressed archive entry too large";
+            return false;
+        }
+        Buffer stored;
+        uint8_t* src = stored.Add(int(e.size));
+        if (!this->readStored(index, 0, int(e.size), src)) {
+            outError = "Failed to read from archive";
+            return false;
+        }
+        Buffer inflated;
+        uint8_t* inflateDst = (size == entrySize) ? dst : inflated.Add(int(entrySize));
+        uLongf inflatedSize = uLongf(entrySize);
+        if ((Z_OK != uncompress(inflateDst, &inflatedSize, src, uLong(e.size))) ||
+            (inflatedSize != uLongf(entrySize)) ||
+            (pakFormat::hash(inflateDst, int(entrySize)) != e.contentHash)) {
+            outError = "Failed to decompress archive entry";
+            return false;
+        }
+        if (inflateDst != dst) {
+            Memory::Copy(inflateDst + startOffset, dst, size);
+        }
+    }
+    return true;
+}
+
+} // namespace _priv
+} // namespace Oryol
@@ -0,0 +1,81 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::pakArchive
+    @ingroup _priv
+    @brief a mounted pak archive
+
+    Opens a pak archive on the local filesystem and provides
+    lookup of entries by name and read access to entry data.
+    Where supported, the whole archive is mapped into memory and
+    the table of contents is used in-place, otherwise the
+    table of contents is loaded and the entry data is read
+    through a single file handle.
+
+    After open() the archive is immutable (apart from the shared
+    file handle which is guarded by a mutex), so a pakArchive
+    object can be used from several IO threads at once.
+*/
+#include "Core/RefCounted.h"
+#include "Core/Containers/Buffer.h"
+#include "Core/String/String.h"
+#include "LocalFS/Core/fsWrapper.h"
+#include "PakFS/Core/pakFormat.h"
+#if ORYOL_HAS_THREADS
+#include <mutex>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+class pakArchive : public RefCounted {
+    OryolClassDecl(pakArchive);
+public:
+    /// constructor
+    pakArchive();
+    /// destructor
+    ~pakArchive();
+
+    /// open archive from a local filesystem path
+    bool open(const char* path);
+    /// close the archive
+    void close();
+    /// return true if the archive is open
+    bool isOpen() const;
+    /// return true if the archive is mapped into memory
+    bool isMapped() const;
+
+    /// get number of entries
+    int numEntries() const;
+    /// find entry index by name, return InvalidIndex if not found
+    int find(const char* name, int len) const;
+    /// get entry by index
+    const pakFormat::entry& entryAt(int index) const;
+    /// get name of entry by index
+    String entryName(int index) const;
+
+    /// read a range of the stored data of an entry, return false on error
+    bool readStored(int index, int64_t offset, int size, uint8_t* dst);
+    /// read and decompress a valid range of an entry, append to a buffer
+    bool readEntry(int index, int64_t startOffset, int64_t endOffset, Buffer& outData, String& outError);
+    /// read and decompress a valid range of an entry into memory of (endOffset-startOffset) bytes
+    bool readEntry(int index, int64_t startOffset, int64_t endOffset, uint8_t* dst, String& outError);
+
+private:
+    /// validate the table of contents against the archive size
+    bool validate(int64_t archiveSize) const;
+
+    const uint8_t* mapping;
+    int64_t mappingSize;
+    fsWrapper::handle file;
+    #if ORYOL_HAS_THREADS
+    std::mutex fileMutex;
+    #endif
+    Buffer tocData;
+    pakFormat::header header;
+    const pakFormat::entry* toc;
+    const char* names;
+};
+
+} // namespace _priv
+} // namespace Oryol
@@ -0,0 +1,78 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::pakFormat
+    @ingroup _priv
+    @brief binary layout of pak archives
+
+    A pak archive starts with a header, followed by the table of
+    contents (one entry per file, sorted by name hash and name),
+    followed by the entry name string table, followed by the
+    entry data (each entry starts at an aligned file offset).
+    All values are stored little-endian.
+*/
+#include "Core/Types.h"
+
+namespace Oryol {
+namespace _priv {
+
+class pakFormat {
+public:
+    /// file magic ('OPAK')
+    static const uint32_t Magic = 0x4B41504F;
+    /// current format version
+    static const uint32_t Version = 1;
+    /// alignment of entry data in the archive
+    static const int Alignment = 16;
+
+    /// entry compression types
+    enum Compression : uint32_t {
+        None = 0,
+        Deflate = 1,
+    };
+
+    /// archive header
+    struct header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t numEntries;
+        uint32_t namesSize;
+    };
+    /// table of contents entry
+    struct entry {
+        uint32_t nameHash;          // hashString() of the entry name
+        uint32_t nameOffset;        // offset into the name string table
+        uint32_t nameLength;        // length of name without terminating 0
+        uint32_t compression;       // pakFormat::Compression
+        uint64_t offset;            // start of stored data from start of archive
+        uint64_t size;              // size of stored data
+        uint64_t uncompressedSize;  // size of data after decompression
+        uint32_t contentHash;       // hash() of the uncompressed data, checked after decompression
+        uint32_t reserved;
+    };
+
+    /// compute FNV-1a hash of a memory range
+    static uint32_t hash(const uint8_t* ptr, int size);
+    /// compute FNV-1a hash of a string
+    static uint32_t hashString(const char* str, int len);
+};
+
+//------------------------------------------------------------------------------
+inline uint32_t
+pakFormat::hash(const uint8_t* ptr, int size) {
+    uint32_t h = 2166136261U;
+    for (int i = 0; i < size; i++) {
+        h ^= ptr[i];
+        h *= 16777619U;
+    }
+    return h;
+}
+
+//------------------------------------------------------------------------------
+inline uint32_t
+pakFormat::hashString(const char* str, int len) {
+    return hash((const uint8_t*)str, len);
+}
+
+} // namespace _priv
+} // namespace Oryol
@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------------
+//  PakBuilder.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "PakBuilder.h"
+#include "Core/Memory/Memory.h"
+#include "PakFS/Core/pakFormat.h"
+#include "zlib.h"
+#include <algorithm>
+
+namespace Oryol {
+
+using namespace _priv;
+
+//------------------------------------------------------------------------------
+void
+PakBuilder::Add(const String& name, const uint8_t* data, int size, bool compress) {
+    o_assert(name.IsValid() && (name.Front() != '/'));
+    o_assert(!this->Contains(name));
+    o_assert_dbg(size >= 0);
+
+    item newItem;
+    newItem.name = name;
+    newItem.nameHash = pakFormat::hashString(name.AsCStr(), name.Length());
+    newItem.compression = pakFormat::None;
+    newItem.uncompressedSize = size;
+    newItem.contentHash = pakFormat::hash(data, size);
+    if (compress && (size > 0)) {
+        uLongf compressedSize = compressBound(uLong(size));
+        Buffer compressed;
+        uint8_t* dst = compressed.Add(int(compressedSize));
+        if ((Z_OK == compress2(dst, &compressedSize, data, uLong(size), Z_BEST_COMPRESSION)) &&
+            (int(compressedSize) < size)) {
+            newItem.data.Add(dst, int(compressedSize));
+            newItem.compression = pakFormat::Deflate;
+        }
+    }
+    if ((pakFormat::None == newItem.compression) && (size > 0)) {
+        newItem.data.Add(data, size);
+    }
+    this->items.Add(std::move(newItem));
+}
+
+//------------------------------------------------------------------------------
+bool
+PakBuilder::Contains(const String& name) const {
+    for (const item& cur : this->items) {
+        if (cur.name == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+int
+PakBuilder::NumEntries() const {
+    return this->items.Size();
+}
+
+//------------------------------------------------------------------------------
+void
+PakBuilder::Clear() {
+    this->items.Clear();
+}
+
+//------------------------------------------------------------------------------
+Buffer
+PakBuilder::Build() const {
+
+    // the table of contents is sorted by name hash (and name on collision)
+    Array<int> order;
+    order.Reserve(this->items.Size());
+    for (int i = 0; i < this->items.Size(); i++) {
+        order.Add(i);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        const item& itemA = this->items[a];
+        const item& itemB = this->items[b];
+        if (itemA.nameHash != itemB.nameHash) {
+            return itemA.nameHash < itemB.nameHash;
+        }
+        return itemA.name < itemB.name;
+    });
+
+    // build the name table
+    Buffer names;
+    Array<uint32_t> nameOffsets;
+    for (int i : order) {
+        const String& name = this->items[i].name;
+        nameOffsets.Add(uint32_t(names.Size()));
+        names.Add((const uint8_t*)name.AsCStr(), name.Length() + 1);
+    }
+
+    pakFormat::header header;
+    header.magic = pakFormat::Magic;
+    header.version = pakFormat::Version;
+    header.numEntries = uint32_t(order.Size());
+    header.namesSize = uint32_t(names.Size());
+    const int tocSize = order.Size() * int(sizeof(pakFormat::entry));
+
+    // compute entry data offsets
+    Array<pakFormat::entry> toc;
+    toc.Reserve(order.Size());
+    uint64_t offset = sizeof(header) + tocSize + names.Size();
+    for (int i = 0; i < order.Size(); i++) {
+        const item& cur = this->items[order[i]];
+        offset = (offset + pakFormat::Alignment - 1) & ~uint64_t(pakFormat::Alignment - 1);
+        pakFormat::entry e;
+        Memory::Clear(&e, sizeof(e));
+        e.nameHash = cur.nameHash;
+        e.nameOffset = nameOffsets[i];
+        e.nameLength = uint32_t(cur.name.Length());
+        e.compression = cur.compression;
+        e.offset = offset;
+        e.size = uint64_t(cur.data.Size());
+        e.uncompressedSize = uint64_t(cur.uncompressedSize);
+        e.contentHash = cur.contentHash;
+        toc.Add(e);
+        offset += e.size;
+    }
+
+    // write the archive
+    Buffer archive;
+    archive.Reserve(int(offset));
+    archive.Add((const uint8_t*)&header, sizeof(header));
+    if (tocSize > 0) {
+        archive.Add((const uint8_t*)&toc[0], tocSize);
+    }
+    if (names.Size() > 0) {
+        archive.Add(names.Data(), names.Size());
+    }
+    for (int i = 0; i < order.Size(); i++) {
+        const int padding = int(toc[i].offset) - archive.Size();
+        o_assert_dbg(padding >= 0);
+        if (padding > 0) {
+            Memory::Clear(archive.Add(padding), padding);
+        }
+        const Buffer& data = this->items[order[i]].data;
+        if (!data.Empty()) {
+            archive.Add(data.Data(), data.Size());
+        }
+    }
+    return archive;
+}
+
+} // namespace Oryol
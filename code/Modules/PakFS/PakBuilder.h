@@ -0,0 +1,46 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::PakBuilder
+    @ingroup PakFS
+    @brief build pak archives in memory
+
+    Add entries with a name and their data, optionally
+    compressed, and call Build() to get the complete archive.
+    Entry names should use '/' as path separator and have no
+    leading '/', they are looked up with the path of a pak: URL.
+
+    @see PakFileSystem
+*/
+#include "Core/Containers/Array.h"
+#include "Core/Containers/Buffer.h"
+#include "Core/String/String.h"
+
+namespace Oryol {
+
+class PakBuilder {
+public:
+    /// add an entry, compress if requested and it makes the entry smaller
+    void Add(const String& name, const uint8_t* data, int size, bool compress=false);
+    /// return true if an entry with name has been added
+    bool Contains(const String& name) const;
+    /// get number of added entries
+    int NumEntries() const;
+    /// build the archive
+    Buffer Build() const;
+    /// remove all entries
+    void Clear();
+
+private:
+    struct item {
+        String name;
+        Buffer data;
+        uint32_t nameHash = 0;
+        uint32_t compression = 0;
+        int uncompressedSize = 0;
+        uint32_t contentHash = 0;
+    };
+    Array<item> items;
+};
+
+} // namespace Oryol
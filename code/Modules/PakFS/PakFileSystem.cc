@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+//  PakFileSystem.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "PakFileSystem.h"
+#include "Core/Containers/Map.h"
+#include "Core/Threading/RWLock.h"
+#include "PakFS/Core/pakArchive.h"
+#include "IO/IO.h"
+
+namespace Oryol {
+
+using namespace _priv;
+
+namespace {
+    // mounted archives are shared between all IO lanes, the
+    // names are stored as strings since StringAtoms are thread-local
+    RWLock mountLock;
+    Map<String, Ptr<pakArchive>> mounts;
+}
+
+//------------------------------------------------------------------------------
+bool
+PakFileSystem::Mount(const StringAtom& name, const URL& location) {
+    o_assert(name.IsValid());
+    o_assert(!IsMounted(name));
+
+    URL url(IO::ResolveAssigns(location.Get().AsString()));
+    if (!url.HasPath()) {
+        Log::Warn("PakFileSystem::Mount(): no path in URL '%s'\n", url.AsCStr());
+        return false;
+    }
+    Ptr<pakArchive> archive = pakArchive::Create();
+    if (!archive->open(url.Path().AsCStr())) {
+        Log::Warn("PakFileSystem::Mount(): failed to open archive '%s'\n", url.AsCStr());
+        return false;
+    }
+    mountLock.LockWrite();
+    mounts.Add(name.AsString(), archive);
+    mountLock.UnlockWrite();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void
+PakFileSystem::Unmount(const StringAtom& name) {
+    // IO lanes which are currently reading from the archive
+    // hold a reference, so the archive is closed after the
+    // last read has finished
+    mountLock.LockWrite();
+    o_assert(mounts.Contains(name.AsString()));
+    mounts.Erase(name.AsString());
+    mountLock.UnlockWrite();
+}
+
+//------------------------------------------------------------------------------
+bool
+PakFileSystem::IsMounted(const StringAtom& name) {
+    mountLock.LockRead();
+    bool result = mounts.Contains(name.AsString());
+    mountLock.UnlockRead();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+Ptr<pakArchive>
+PakFileSystem::lookup(const String& name) {
+    Ptr<pakArchive> archive;
+    mountLock.LockRead();
+    const int index = mounts.FindIndex(name);
+    if (InvalidIndex != index) {
+        archive = mounts.ValueAtIndex(index);
+    }
+    mountLock.UnlockRead();
+    return archive;
+}
+
+//------------------------------------------------------------------------------
+void
+PakFileSystem::onMsg(const Ptr<IORequest>& req) {
+    if (req->isRead()) {
+        this->onRead(ioMsgCast<IORead>(req));
+    }
+    else if (ioMsgType::Write == req->MsgType) {
+        req->Status = IOStatus::MethodNotAllowed;
+        req->ErrorDesc = "Pak archives are read-only";
+    }
+    this->setHandled(req);
+}
+
+//------------------------------------------------------------------------------
+void
+PakFileSystem::onRead(const Ptr<IORead>& msg) {
+    if (!msg->Url.HasHost() || !msg->Url.HasPath()) {
+        msg->Status = IOStatus::BadRequest;
+        msg->ErrorDesc = "No archive name or path in URL";
+        return;
+    }
+    Ptr<pakArchive> archive = lookup(msg->Url.Host());
+    if (!archive) {
+        msg->Status = IOStatus::NotFound;
+        msg->ErrorDesc = "Archive not mounted";
+        return;
+    }
+    const String path = msg->Url.Path();
+    const int index = archive->find(path.AsCStr(), path.Length());
+    if (InvalidIndex == index) {
+        msg->Status = IOStatus::NotFound;
+        msg->ErrorDesc = "Entry not found in archive";
+        return;
+    }
+    // like HTTP range requests, ranges reaching past
+    // the end of the entry are clamped to the entry size
+    const int64_t entrySize = int64_t(archive->entryAt(index).uncompressedSize);
+    int64_t endOffset = msg->EndOffset;
+    if ((EndOfFile == endOffset) || (endOffset > entrySize)) {
+        endOffset = entrySize;
+    }
+    if ((msg->StartOffset < 0) || (msg->StartOffset > endOffset)) {
+        msg->Status = IOStatus::RequestedRangeNotSatisfiable;
+        msg->ErrorDesc = "Range outside of archive entry";
+        return;
+    }
+    if ((endOffset - msg->StartOffset) > Buffer::MaxSize) {
+        // large entries must be read in ranges
+        msg->Status = IOStatus::RequestEntityTooLarge;
+        msg->ErrorDesc = "Range too large for a single read";
+        return;
+    }
+    const int size = int(endOffset - msg->StartOffset);
+    if (0 == size) {
+        msg->Status = IOStatus::OK;
+        return;
+    }
+    uint8_t* dst = msg->AddResult(size);
+    if (nullptr == dst) {
+        msg->Status = IOStatus::RequestEntityTooLarge;
+        msg->ErrorDesc = "Destination buffer too small";
+    }
+    else if (archive->readEntry(index, msg->StartOffset, endOffset, dst, msg->ErrorDesc)) {
+        msg->Status = IOStatus::OK;
+    }
+    else {
+        msg->TruncateResult(0);
+        msg->Status = IOStatus::InternalServerError;
+    }
+}
+
+} // namespace Oryol
@@ -0,0 +1,54 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @defgroup PakFS PakFS
+    @brief read access to packed archive files
+
+    @class Oryol::PakFileSystem
+    @ingroup PakFS
+    @brief FileSystem subclass to read entries from pak archives
+
+    Archives must first be mounted under a name with PakFileSystem::Mount(),
+    the name is then used as the host part of pak URLs, and the
+    path part selects the archive entry, for instance an entry
+    'tex/wood.dds' in an archive mounted as 'data' is read
+    from the URL 'pak://data/tex/wood.dds'.
+
+    Archives are read from the local host filesystem, where possible
+    they are mapped into memory and entry data is copied directly
+    from the mapped archive. All IO lanes share the mounted archives.
+
+    Archives are built with the PakBuilder class, or the oryol-pak
+    command line tool.
+*/
+#include "IO/FS/FileSystem.h"
+#include "Core/Creator.h"
+
+namespace Oryol {
+
+namespace _priv {
+class pakArchive;
+}
+
+class PakFileSystem : public FileSystem {
+    OryolClassDecl(PakFileSystem);
+    OryolClassCreator(PakFileSystem);
+public:
+    /// mount an archive on the local filesystem under a name (main thread only)
+    static bool Mount(const StringAtom& name, const URL& location);
+    /// unmount an archive (main thread only)
+    static void Unmount(const StringAtom& name);
+    /// return true if an archive is mounted under a name
+    static bool IsMounted(const StringAtom& name);
+
+    /// called when IO message should be handled
+    virtual void onMsg(const Ptr<IORequest>& ioReq) override;
+
+private:
+    /// lookup a mounted archive, return invalid ptr if not mounted
+    static Ptr<_priv::pakArchive> lookup(const String& name);
+    /// handle IORead msg
+    void onRead(const Ptr<IORead>& ioRead);
+};
+
+} // namespace Oryol
@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+//  PakTool.cc
+//  Command line tool to build a pak archive from the content of a directory.
+//
+//  oryol-pak [-z] archive.pak directory
+//
+//  -z: compress entries
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "Core/Core.h"
+#include "Core/Containers/Array.h"
+#include "Core/String/StringBuilder.h"
+#include "LocalFS/Core/fsWrapper.h"
+#include "PakFS/PakBuilder.h"
+#include <string.h>
+#if ORYOL_WINDOWS
+#include <io.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+using namespace Oryol;
+using namespace Oryol::_priv;
+
+//------------------------------------------------------------------------------
+static bool
+addFile(PakBuilder& builder, const String& path, const String& name, bool compress) {
+    fsWrapper::handle h = fsWrapper::openRead(path.AsCStr());
+    if (fsWrapper::invalidHandle == h) {
+        Log::Warn("failed to open '%s'\n", path.AsCStr());
+        return false;
+    }
+    Buffer data;
+    const int64_t size = fsWrapper::size(h);
+    if (size > Buffer::MaxSize) {
+        fsWrapper::close(h);
+        Log::Warn("'%s' is too big\n", path.AsCStr());
+        return false;
+    }
+    bool success = true;
+    if (size > 0) {
+        success = fsWrapper::read(h, data.Add(int(size)), int(size)) == size;
+    }
+    fsWrapper::close(h);
+    if (!success) {
+        Log::Warn("failed to read '%s'\n", path.AsCStr());
+        return false;
+    }
+    builder.Add(name, data.Empty() ? nullptr : data.Data(), data.Size(), compress);
+    Log::Info("  %s (%d bytes)\n", name.AsCStr(), data.Size());
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static bool
+listDirectory(const String& dir, Array<String>& outFiles, Array<String>& outDirs) {
+    StringBuilder strBuilder;
+    #if ORYOL_WINDOWS
+    strBuilder.Format(4096, "%s/*", dir.AsCStr());
+    _finddata_t findData;
+    intptr_t findHandle = _findfirst(strBuilder.AsCStr(), &findData);
+    if (-1 == findHandle) {
+        return false;
+    }
+    do {
+        if ((0 != strcmp(findData.name, ".")) && (0 != strcmp(findData.name, ".."))) {
+            if (findData.attrib & _A_SUBDIR) {
+                outDirs.Add(findData.name);
+            }
+            else {
+                outFiles.Add(findData.name);
+            }
+        }
+    }
+    while (0 == _findnext(findHandle, &findData));
+    _findclose(findHandle);
+    #else
+    DIR* dirHandle = opendir(dir.AsCStr());
+    if (nullptr == dirHandle) {
+        return false;
+    }
+    struct dirent* dirEntry;
+    while (nullptr != (dirEntry = readdir(dirHandle))) {
+        if ((0 != strcmp(dirEntry->d_name, ".")) && (0 != strcmp(dirEntry->d_name, ".."))) {
+            strBuilder.Format(4096, "%s/%s", dir.AsCStr(), dirEntry->d_name);
+            struct stat st;
+            if (0 == stat(strBuilder.AsCStr(), &st)) {
+                if (S_ISDIR(st.st_mode)) {
+                    outDirs.Add(dirEntry->d_name);
+                }
+                else {
+                    outFiles.Add(dirEntry->d_name);
+                }
+            }
+        }
+    }
+    closedir(dirHandle);
+    #endif
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static bool
+addDirectory(PakBuilder& builder, const String& dir, const String& prefix, bool compress) {
+    Array<String> files;
+    Array<String> dirs;
+    if (!listDirectory(dir, files, dirs)) {
+        Log::Warn("failed to open directory '%s'\n", dir.AsCStr());
+        return false;
+    }
+    StringBuilder strBuilder;
+    for (int i = 0; i < files.Size() + dirs.Size(); i++) {
+        const bool isDir = i >= files.Size();
+        const String& fileName = isDir ? dirs[i - files.Size()] : files[i];
+        strBuilder.Format(4096, "%s/%s", dir.AsCStr(), fileName.AsCStr());
+        String path = strBuilder.GetString();
+        if (prefix.Empty()) {
+            strBuilder.Set(fileName);
+        }
+        else {
+            strBuilder.Format(4096, "%s/%s", prefix.AsCStr(), fileName.AsCStr());
+        }
+        String name = strBuilder.GetString();
+        bool success = isDir ?
+            addDirectory(builder, path, name, compress) :
+            addFile(builder, path, name, compress);
+        if (!success) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+int
+main(int argc, const char** argv) {
+    Core::Setup();
+
+    bool compress = false;
+    int argIndex = 1;
+    if ((argIndex < argc) && (0 == strcmp(argv[argIndex], "-z"))) {
+        compress = true;
+        argIndex++;
+    }
+    if ((argc - argIndex) != 2) {
+        Log::Info("usage: oryol-pak [-z] archive.pak directory\n");
+        Core::Discard();
+        return 10;
+    }
+    const String archivePath(argv[argIndex]);
+    const String dirPath(argv[argIndex + 1]);
+
+    PakBuilder builder;
+    Log::Info("adding files from '%s':\n", dirPath.AsCStr());
+    bool success = addDirectory(builder, dirPath, String(), compress);
+    if (success) {
+        Buffer archive = builder.Build();
+        fsWrapper::handle h = fsWrapper::openWrite(archivePath.AsCStr());
+        if (fsWrapper::invalidHandle != h) {
+            success = fsWrapper::write(h, archive.Data(), archive.Size()) == archive.Size();
+            fsWrapper::close(h);
+        }
+        else {
+            success = false;
+        }
+        if (success) {
+            Log::Info("wrote '%s' (%d entries, %d bytes)\n",
+                archivePath.AsCStr(), builder.NumEntries(), archive.Size());
+        }
+        else {
+            Log::Warn("failed to write '%s'\n", archivePath.AsCStr());
+        }
+    }
+    Core::Discard();
+    return success ? 0 : 10;
+}
@@ -0,0 +1,261 @@
+//------------------------------------------------------------------------------
+//  PakFileSystemTest.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Core/Core.h"
+#include "Core/String/StringBuilder.h"
+#include "Core/Time/Clock.h"
+#include "IO/IO.h"
+#include "LocalFS/LocalFileSystem.h"
+#include "PakFS/PakFileSystem.h"
+#include "PakFS/PakBuilder.h"
+#include "PakFS/Core/pakArchive.h"
+#include "zlib.h"
+
+using namespace Oryol;
+using namespace _priv;
+
+static void
+wait(const Ptr<IORequest>& msg) {
+    while (!msg->Handled) {
+        Core::PreRunLoop()->Run();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        Core::PostRunLoop()->Run();
+    }
+}
+
+static Ptr<IORead>
+read(const URL& url, int startOffset=0, int endOffset=EndOfFile) {
+    auto msg = IORead::Create();
+    msg->Url = url;
+    msg->StartOffset = startOffset;
+    msg->EndOffset = endOffset;
+    IO::Put(msg);
+    wait(msg);
+    return msg;
+}
+
+static void
+writeFile(const URL& url, const Buffer& data) {
+    auto msg = IOWrite::Create();
+    msg->Url = url;
+    msg->Data.Add(data.Data(), data.Size());
+    IO::Put(msg);
+    wait(msg);
+    o_assert(msg->Status == IOStatus::OK);
+}
+
+TEST(PakArchiveTest) {
+    Core::Setup();
+
+    const String hello("Hello World!");
+    String repeated;
+    {
+        StringBuilder strBuilder;
+        for (int i = 0; i < 64; i++) {
+            strBuilder.Append("Bla Blub ");
+        }
+        repeated = strBuilder.GetString();
+    }
+    PakBuilder builder;
+    builder.Add("hello.txt", (const uint8_t*)hello.AsCStr(), hello.Length());
+    builder.Add("dir/repeated.txt", (const uint8_t*)repeated.AsCStr(), repeated.Length(), true);
+    builder.Add("empty.txt", nullptr, 0);
+    CHECK(builder.NumEntries() == 3);
+    CHECK(builder.Contains("hello.txt"));
+    CHECK(!builder.Contains("bla.txt"));
+    Buffer data = builder.Build();
+
+    // write the archive and open it
+    StringBuilder strBuilder;
+    strBuilder.Format(4096, "%stest.pak", fsWrapper::getCwd().AsCStr());
+    const String path = strBuilder.GetString();
+    fsWrapper::handle h = fsWrapper::openWrite(path.AsCStr());
+    CHECK(fsWrapper::write(h, data.Data(), data.Size()) == data.Size());
+    fsWrapper::close(h);
+
+    Ptr<pakArchive> archive = pakArchive::Create();
+    CHECK(archive->open(path.AsCStr()));
+    CHECK(archive->isOpen());
+    CHECK(archive->numEntries() == 3);
+    CHECK(InvalidIndex == archive->find("bla.txt", 7));
+    CHECK(InvalidIndex == archive->find("hello.tx", 8));
+
+    // uncompressed entry
+    int index = archive->find("hello.txt", 9);
+    CHECK(InvalidIndex != index);
+    CHECK(archive->entryName(index) == "hello.txt");
+    CHECK(archive->entryAt(index).compression == pakFormat::None);
+    CHECK(archive->entryAt(index).uncompressedSize == 12);
+    Buffer buf;
+    String error;
+    CHECK(archive->readEntry(index, 0, EndOfFile, buf, error));
+    CHECK(String((const char*)buf.Data(), 0, buf.Size()) == hello);
+    buf.Clear();
+    CHECK(archive->readEntry(index, 6, 11, buf, error));
+    CHECK(String((const char*)buf.Data(), 0, buf.Size()) == "World");
+
+    // compressed entry
+    index = archive->find("dir/repeated.txt", 16);
+    CHECK(InvalidIndex != index);
+    CHECK(archive->entryAt(index).compression == pakFormat::Deflate);
+    CHECK(archive->entryAt(index).size < archive->entryAt(index).uncompressedSize);
+    buf.Clear();
+    CHECK(archive->readEntry(index, 0, EndOfFile, buf, error));
+    CHECK(String((const char*)buf.Data(), 0, buf.Size()) == repeated);
+    buf.Clear();
+    CHECK(archive->readEntry(index, 4, 8, buf, error));
+    CHECK(String((const char*)buf.Data(), 0, buf.Size()) == "Blub");
+    uint8_t dest[1024];
+    CHECK(archive->readEntry(index, 0, repeated.Length(), dest, error));
+    CHECK(String((const char*)dest, 0, repeated.Length()) == repeated);
+    CHECK(archive->readEntry(index, 4, 8, dest, error));
+    CHECK(String((const char*)dest, 0, 4) == "Blub");
+
+    // empty entry
+    index = archive->find("empty.txt", 9);
+    CHECK(InvalidIndex != index);
+    buf.Clear();
+    CHECK(archive->readEntry(index, 0, EndOfFile, buf, error));
+    CHECK(buf.Empty());
+    archive->close();
+    CHECK(!archive->isOpen());
+
+    // a corrupted archive must be rejected
+    data.Data()[0] = 'X';
+    h = fsWrapper::openWrite(path.AsCStr());
+    fsWrapper::write(h, data.Data(), data.Size());
+    fsWrapper::close(h);
+    CHECK(!archive->open(path.AsCStr()));
+
+    Core::Discard();
+}
+
+TEST(PakFileSystemTest) {
+    Core::Setup();
+    IOSetup ioSetup;
+    ioSetup.FileSystems.Add("file", LocalFileSystem::Creator());
+    ioSetup.FileSystems.Add("pak", PakFileSystem::Creator());
+    ioSetup.Assigns.Add("data:", "pak://data/");
+    IO::Setup(ioSetup);
+
+    // build an archive, and the same content as loose files
+    const int numFiles = 256;
+    const int fileSize = 16 * 1024;
+    PakBuilder builder;
+    StringBuilder strBuilder;
+    Buffer content;
+    for (int i = 0; i < numFiles; i++) {
+        content.Clear();
+        uint8_t* ptr = content.Add(fileSize);
+        for (int j = 0; j < fileSize; j++) {
+            ptr[j] = uint8_t(i + j);
+        }
+        strBuilder.Format(64, "file%d.bin", i);
+        builder.Add(strBuilder.GetString(), content.Data(), content.Size());
+        strBuilder.Format(64, "root:pakfs_loose%d.bin", i);
+        writeFile(strBuilder.GetString(), content);
+    }
+    // an entry with zlib-compressed content, read through the IO decompression stage
+    const String hello("Hello Compressed World!");
+    uLongf compressedSize = compressBound(uLong(hello.Length()));
+    uint8_t* compressed = content.Add(int(compressedSize));
+    compress2(compressed, &compressedSize, (const uint8_t*)hello.AsCStr(), uLong(hello.Length()), Z_DEFAULT_COMPRESSION);
+    builder.Add("hello.z", compressed, int(compressedSize));
+    writeFile("root:test.pak", builder.Build());
+    CHECK(!PakFileSystem::IsMounted("data"));
+    CHECK(!PakFileSystem::Mount("bla", "root:nonexisting.pak"));
+    CHECK(PakFileSystem::Mount("data", "root:test.pak"));
+    CHECK(PakFileSystem::IsMounted("data"));
+
+    // read single entries
+    Ptr<IORead> msg = read("data:file1.bin");
+    CHECK(msg->Status == IOStatus::OK);
+    CHECK(msg->Data.Size() == fileSize);
+    CHECK(msg->Data.Data()[0] == 1);
+    CHECK(msg->Data.Data()[fileSize - 1] == uint8_t(1 + fileSize - 1));
+    msg = read("data:file2.bin", 16, 32);
+    CHECK(msg->Status == IOStatus::OK);
+    CHECK(msg->Data.Size() == 16);
+    CHECK(msg->Data.Data()[0] == 18);
+    msg = read("data:file2.bin", 16, fileSize + 1);
+    CHECK(msg->Status == IOStatus::OK);
+    CHECK(msg->Data.Size() == fileSize - 16);
+    msg = read("data:file2.bin", fileSize + 1, fileSize + 16);
+    CHECK(msg->Status == IOStatus::RequestedRangeNotSatisfiable);
+    msg = IORead::Create();
+    msg->Url = "data:hello.z";
+    msg->DecompressEnabled = true;
+    IO::Put(msg);
+    wait(msg);
+    CHECK(msg->Status == IOStatus::OK);
+    CHECK(String((const char*)msg->Data.Data(), 0, msg->Data.Size()) == hello);
+    Buffer dest;
+    msg = IORead::Create();
+    msg->Url = "data:file3.bin";
+    msg->DestPtr = dest.Add(fileSize);
+    msg->DestCapacity = fileSize;
+    IO::Put(msg);
+    wait(msg);
+    CHECK(msg->Status == IOStatus::OK);
+    CHECK(msg->DestSize == fileSize);
+    CHECK(msg->Data.Empty());
+    CHECK(dest.Data()[0] == 3);
+    msg = IORead::Create();
+    msg->Url = "data:file3.bin";
+    msg->DestPtr = dest.Data();
+    msg->DestCapacity = fileSize - 1;
+    IO::Put(msg);
+    wait(msg);
+    CHECK(msg->Status == IOStatus::RequestEntityTooLarge);
+    msg = read("data:bla.bin");
+    CHECK(msg->Status == IOStatus::NotFound);
+    msg = read("pak://bla/file1.bin");
+    CHECK(msg->Status == IOStatus::NotFound);
+
+    // compare load time of loose files and archive entries
+    Array<Ptr<IORead>> msgs;
+    TimePoint start = Clock::Now();
+    for (int i = 0; i < numFiles; i++) {
+        strBuilder.Format(64, "root:pakfs_loose%d.bin", i);
+        auto loose = IORead::Create();
+        loose->Url = strBuilder.GetString();
+        IO::Put(loose);
+        msgs.Add(loose);
+    }
+    for (const auto& cur : msgs) {
+        wait(cur);
+    }
+    Duration looseTime = Clock::Since(start);
+    for (const auto& cur : msgs) {
+        CHECK(cur->Status == IOStatus::OK);
+    }
+    msgs.Clear();
+    start = Clock::Now();
+    for (int i = 0; i < numFiles; i++) {
+        strBuilder.Format(64, "data:file%d.bin", i);
+        auto entry = IORead::Create();
+        entry->Url = strBuilder.GetString();
+        IO::Put(entry);
+        msgs.Add(entry);
+    }
+    for (const auto& cur : msgs) {
+        wait(cur);
+    }
+    Duration pakTime = Clock::Since(start);
+    for (const auto& cur : msgs) {
+        CHECK(cur->Status == IOStatus::OK);
+        CHECK(cur->Data.Size() == fileSize);
+    }
+    Log::Info("PakFileSystemTest: %d files of %d bytes: loose=%.3fms, pak=%.3fms\n",
+        numFiles, fileSize, looseTime.AsMilliSeconds(), pakTime.AsMilliSeconds());
+
+    PakFileSystem::Unmount("data");
+    CHECK(!PakFileSystem::IsMounted("data"));
+    msg = read("data:file1.bin");
+    CHECK(msg->Status == IOStatus::NotFound);
+
+    IO::Discard();
+    Core::Discard();
+}
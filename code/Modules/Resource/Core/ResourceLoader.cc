@@ -3,6 +3,7 @@
 //------------------------------------------------------------------------------
 #include "Pre.h"
 #include "ResourceLoader.h"
+#include "Core/Log.h"
 
 namespace Oryol {
 
@@ -31,4 +32,28 @@ ResourceLoader::Cancel() {
     // empty
 }
 
+//------------------------------------------------------------------------------
+bool
+ResourceLoader::CanReload() const {
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+ResourceLoader::Reload(const Id& /*id*/) {
+    o_error("ResourceLoader::Reload(): loader can't reload resources!\n");
+}
+
+//------------------------------------------------------------------------------
+bool
+ResourceLoader::CanWakeup() const {
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void
+ResourceLoader::SetWakeupFunc(std::function<void()> func) {
+    this->wakeupFunc = std::move(func);
+}
+
 } // namespace Oryol
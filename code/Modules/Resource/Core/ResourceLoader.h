@@ -4,8 +4,14 @@
     @class Oryol::ResourceLoader
     @ingroup Resource
     @brief base class for resource loaders
+
+    By default, the resource container calls Continue() on each pending
+    loader once per frame. Loaders which return true from CanWakeup()
+    instead call their wakeupFunc (from any thread) once Continue() can
+    finish the loading process, and are only continued after that.
 */
 #include "Core/RefCounted.h"
+#include <functional>
 #include "Resource/Id.h"
 #include "Resource/Locator.h"
 #include "Resource/ResourceState.h"
@@ -23,6 +29,18 @@ public:
     virtual ResourceState::Code Continue();
     /// cancel the resource loading process
     virtual void Cancel();
+    /// return true if the loader can reload an evicted resource
+    virtual bool CanReload() const;
+    /// reload an evicted resource into its existing resource id, followed by Continue() calls
+    virtual void Reload(const Id& id);
+    /// return true if the loader calls its wakeup function instead of being continued every frame
+    virtual bool CanWakeup() const;
+    /// set the wakeup function (called by the resource container before Start() or Reload())
+    void SetWakeupFunc(std::function<void()> func);
+
+protected:
+    /// wakes up the loader, thread-safe, may be copied into IO callbacks
+    std::function<void()> wakeupFunc;
 };
 
 } // namespace Oryol
@@ -4,11 +4,59 @@
     @class Oryol::ResourcePool
     @ingroup Resource
     @brief generic resource pool
-    @todo ResourcePool description
+
+    The resource slots of a pool live in pages of NumPageSlots slots,
+    the pool starts with enough pages for the pool size given to
+    Setup() and grows by one page whenever the free list runs empty,
+    up to 65535 slots (the 16-bit slot index of an Id). Existing
+    slots never move, so resource pointers stay valid while the
+    pool grows.
+
+    AllocId() and the free-slot list are lock-free (a tagged
+    free list like in the poolAllocator), so loaders running on
+    worker threads can reserve resource ids directly, all other
+    methods must be called from the main thread. The number of
+    pages, the memory used by the pool and the number of retried
+    free-list operations (a measure of contention) are returned
+    by QueryPoolInfo(). AllocIds() reserves a batch of ids, it grows
+    the pool once for the whole batch and pops the slots off the free
+    list with a single compare-and-swap.
+
+    A pool can have a memory budget: the owner of the pool tracks
+    the memory size of its resources with SetByteSize(), and when the
+    pool is over budget, SelectEvictions() returns the least recently
+    used evictable resources (resources with a reloadable Loader,
+    which have not been looked up in the current frame). The owner
+    destroys the resources and marks them as evicted with Evict(),
+    evicted resources are in the Pending state until they are
+    reloaded. Lookup() records the frame of the last use of a resource,
+    Peek() returns the same pointer without touching the last use frame
+    and is meant for the pool owner's own bookkeeping (destroying
+    resources, resolving dependencies between resources).
+
+    AddRef() and Release() manage the optional reference count of a
+    resource, the pool only does the counting, the owner of the pool
+    decides what happens with resources which have been released.
+
+    An optional state function is called on each state change of a
+    resource with the old and new state. Resources which have just
+    been assigned have the old state Initial, and unassigned resources
+    have the new state InvalidState.
+
+    The pool keeps live counters of its resources by state, and of the
+    created, destroyed and loaded resources (overall and in the last
+    frame, a frame ends with Update()), so QueryPoolInfo() is cheap
+    enough to be called each frame. A load starts when a resource
+    enters the Pending state and completes when it leaves it, the
+    average time from load start to Valid is tracked as load latency.
 */
-#include "Core/Ptr.h"
-#include "Core/Containers/Queue.h"
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include "Core/Memory/Memory.h"
 #include "Core/Containers/Array.h"
+#include "Core/Containers/StaticArray.h"
+#include "Core/Time/Clock.h"
 #include "Resource/Id.h"
 #include "Resource/ResourceInfo.h"
 #include "Resource/ResourcePoolInfo.h"
@@ -19,13 +67,19 @@ template<class RESOURCE, class SETUP> class ResourcePool {
 public:
     /// max number of resources in a pool
     static const int MaxNumPoolResources = (1<<16);
+    /// number of resource slots in a page
+    static const int NumPageSlots = 64;
+    /// max number of pages in a pool
+    static const int MaxNumPages = MaxNumPoolResources / NumPageSlots;
+    /// called on resource state changes
+    typedef std::function<void(const Id& id, ResourceState::Code oldState, ResourceState::Code newState)> StateFunc;
 
     /// constructor
     ResourcePool();
     /// destructor
     ~ResourcePool();
     
-    /// setup the resource pool
+    /// setup the resource pool with an initial pool size
     void Setup(Id::TypeT resourceType, int poolSize);
     /// discard the resource pool
     void Discard();
@@ -34,15 +88,21 @@ public:
     /// update the pool, call once per frame
     void Update();
     
-    /// allocate a resource id
+    /// allocate a resource id (thread-safe, grows the pool if necessary)
     Id AllocId();
+    /// allocate a batch of resource ids and append them to outIds (thread-safe)
+    void AllocIds(int num, Array<Id>& outIds);
+    /// free allocated ids which have not been assigned (thread-safe)
+    void FreeIds(const Array<Id>& ids, int startIndex=0);
     
     /// assign a resource to a free slot
     RESOURCE& Assign(const Id& id, const SETUP& setup, ResourceState::Code state);
     /// unassign/free a resource slot
     void Unassign(const Id& id);
-    /// return pointer to resource object, may return placeholder or nullptr
-    RESOURCE* Lookup(const Id& id) const;
+    /// return pointer to valid resource object or nullptr, records the frame of use
+    RESOURCE* Lookup(const Id& id);
+    /// return pointer to valid resource object or nullptr, without recording the use
+    RESOURCE* Peek(const Id& id) const;
     /// get pointer to resource by resource id, only return nullptr if resource is not contained
     RESOURCE* Get(const Id& id) const;
     /// update the resource state of a contained resource
@@ -53,8 +113,29 @@ public:
     ResourceState::Code QueryState(const Id& id) const;
     /// query additional info about a contained resource
     ResourceInfo QueryResourceInfo(const Id& id) const;
-    /// query additional info about the pool (slow)
+    /// query additional info about the pool
     ResourcePoolInfo QueryPoolInfo() const;
+    /// acquire a reference to a contained resource, return new ref count or InvalidIndex
+    int AddRef(const Id& id);
+    /// release a reference to a contained resource, return remaining ref count or InvalidIndex
+    int Release(const Id& id);
+    /// get the ref count of a resource, InvalidIndex if the resource is not contained
+    int GetRefCount(const Id& id) const;
+    /// set a function which is called on each resource state change
+    void SetStateFunc(StateFunc func);
+    
+    /// set the memory budget of the pool in bytes (0 means unlimited)
+    void SetByteBudget(int64_t numBytes);
+    /// get the memory budget of the pool
+    int64_t GetByteBudget() const;
+    /// get the tracked memory size of all resources in the pool
+    int64_t GetNumBytes() const;
+    /// set the tracked memory size of a resource, completes the reload of an evicted resource
+    void SetByteSize(const Id& id, int numBytes);
+    /// get least recently used evictable resources to free until the pool is in budget (slow)
+    Array<Id> SelectEvictions() const;
+    /// mark a resource as evicted (the resource object must have been destroyed)
+    void Evict(const Id& id);
     
     /// get number of slots in pool
     int GetNumSlots() const;
@@ -64,16 +145,72 @@ public:
     int GetNumFreeSlots() const;
     
 protected:
-    /// free a resource id
+    /// free a resource id (thread-safe)
     void freeId(const Id& id);
     
+    typedef uint32_t slotTag;   // [16bit counter] | [16bit slot index]
+    static const uint32_t invalidTag = 0xFFFFFFFF;
+    
+    struct page {
+        RESOURCE slots[NumPageSlots];
+        slotTag next[NumPageSlots];     // free-list links
+    };
+    
+    /// get a resource slot by slot index
+    RESOURCE& slot(uint32_t slotIndex) const;
+    /// get the free-list link of a slot
+    slotTag& next(uint32_t slotIndex) const;
+    /// pop a slot index from the free list, return InvalidSlotIndex if empty
+    Id::SlotIndexT pop();
+    /// pop up to num linked slots from the free list, return number of popped slots
+    int popChain(int num, slotTag& outFirst);
+    /// push a slot index onto the free list
+    void push(Id::SlotIndexT slotIndex);
+    /// allocate new pages and add their slots to the free list
+    void allocPages(int num);
+    /// update the live counters and call the state function if the state has changed
+    void stateChanged(RESOURCE& slot, const Id& id, ResourceState::Code oldState, ResourceState::Code newState);
+    
+    /// resource counters of a frame
+    struct frameCounters {
+        int numCreated = 0;
+        int numDestroyed = 0;
+        int numLoaded = 0;
+    };
+    
     bool isValid;
     int frameCounter;
-    int uniqueCounter;
     Id::TypeT resourceType;
-    
-    Array<RESOURCE> slots;
-    Queue<uint16_t> freeSlots;
+    int64_t byteBudget;
+    int64_t numBytes;
+    int numEvictions;
+    int numReloads;
+    int numEvicted;
+    StaticArray<int, ResourceState::NumStates> numByState;
+    frameCounters overall;
+    frameCounters curFrame;
+    frameCounters lastFrame;
+    int numTimedLoads;
+    Duration loadTime;
+    page* pages[MaxNumPages];
+    StateFunc stateFunc;
+    #if ORYOL_HAS_ATOMIC
+        std::atomic<uint32_t> uniqueCounter;
+        std::atomic<uint32_t> tagCounter;
+        std::atomic<slotTag> head;      // free-list head
+        std::atomic<int> numPages;
+        std::atomic<int> numSlots;
+        std::atomic<int> numFreeSlots;
+        std::atomic<int> numRetries;
+    #else
+        uint32_t uniqueCounter;
+        uint32_t tagCounter;
+        slotTag head;
+        int numPages;
+        int numSlots;
+        int numFreeSlots;
+        int numRetries;
+    #endif
 };
     
 //------------------------------------------------------------------------------
@@ -81,9 +218,22 @@ template<class RESOURCE, class SETUP>
 ResourcePool<RESOURCE,SETUP>::ResourcePool() :
 isValid(false),
 frameCounter(0),
-uniqueCounter(0),
-resourceType(0xFF) {
-    // empty
+resourceType(0xFF),
+byteBudget(0),
+numBytes(0),
+numEvictions(0),
+numReloads(0),
+numEvicted(0),
+numTimedLoads(0) {
+    this->numByState.Fill(0);
+    Memory::Clear(this->pages, sizeof(this->pages));
+    this->uniqueCounter = 0;
+    this->tagCounter = 0;
+    this->head = invalidTag;
+    this->numPages = 0;
+    this->numSlots = 0;
+    this->numFreeSlots = 0;
+    this->numRetries = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -97,24 +247,13 @@ template<class RESOURCE, class SETUP> void
 ResourcePool<RESOURCE,SETUP>::Setup(Id::TypeT resType, int poolSize) {
     o_assert_dbg(!this->isValid);
     o_assert_dbg(Id::InvalidType != resType);
-    o_assert_dbg(poolSize > 0);
+    o_assert_dbg((poolSize > 0) && (poolSize <= MaxNumPoolResources));
     
     this->resourceType = resType;
-    this->slots.Reserve(poolSize);
-    this->slots.SetAllocStrategy(0, 0);    // disable growing
-    this->freeSlots.Reserve(poolSize);
-    
-    // setup empty slots
-    for (int i = 0; i < poolSize; i++) {
-        this->slots.Add();
-    }
-    
-    // setup free slots queue
-    for (uint16_t i = 0; i < poolSize; i++) {
-        this->freeSlots.Enqueue(i);
-    }
-    
     this->isValid = true;
+    
+    // allocate the initial pages, pop order of the slots is 0, 1, 2...
+    this->allocPages((poolSize + NumPageSlots - 1) / NumPageSlots);
 }
 
 //------------------------------------------------------------------------------
@@ -122,11 +261,19 @@ template<class RESOURCE, class SETUP> void
 ResourcePool<RESOURCE,SETUP>::Discard() {
     o_assert_dbg(this->isValid);
     // make sure that all resources had been freed (or should we do this here?)
-    o_assert_dbg(this->freeSlots.Size() == this->slots.Size());
+    o_assert_dbg(this->numFreeSlots == this->numSlots);
     this->isValid = false;
     
-    this->slots.Clear();
-    this->freeSlots.Clear();
+    const int num = this->numPages;
+    for (int i = 0; i < num; i++) {
+        Memory::Delete(this->pages[i]);
+        this->pages[i] = nullptr;
+    }
+    this->head = invalidTag;
+    this->numPages = 0;
+    this->numSlots = 0;
+    this->numFreeSlots = 0;
+    this->stateFunc = nullptr;
 }
 
 //------------------------------------------------------------------------------
@@ -140,6 +287,153 @@ template<class RESOURCE, class SETUP> void
 ResourcePool<RESOURCE, SETUP>::Update() {
     o_assert_dbg(this->isValid);
     this->frameCounter++;
+    this->lastFrame = this->curFrame;
+    this->curFrame = frameCounters();
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> RESOURCE&
+ResourcePool<RESOURCE,SETUP>::slot(uint32_t slotIndex) const {
+    o_assert_dbg(nullptr != this->pages[slotIndex / NumPageSlots]);
+    return this->pages[slotIndex / NumPageSlots]->slots[slotIndex % NumPageSlots];
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> typename ResourcePool<RESOURCE,SETUP>::slotTag&
+ResourcePool<RESOURCE,SETUP>::next(uint32_t slotIndex) const {
+    return this->pages[slotIndex / NumPageSlots]->next[slotIndex % NumPageSlots];
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::allocPages(int num) {
+
+    // reserve the page indices first, this can be called from different threads
+    #if ORYOL_HAS_ATOMIC
+        const int firstPage = this->numPages.fetch_add(num, std::memory_order_relaxed);
+    #else
+        const int firstPage = this->numPages;
+        this->numPages += num;
+    #endif
+    if (firstPage + num > MaxNumPages) {
+        o_error("ResourcePool: pool of resource type '%d' is full (%d slots)\n", this->resourceType, MaxNumPoolResources - 1);
+    }
+    for (int i = 0; i < num; i++) {
+        this->pages[firstPage + i] = Memory::New<page>();
+    }
+
+    // link the new slots in ascending order (the last slot index
+    // of the last page is the invalid slot index)
+    const int firstSlot = firstPage * NumPageSlots;
+    int endSlot = (firstPage + num) * NumPageSlots;
+    if (endSlot > Id::InvalidSlotIndex) {
+        endSlot = Id::InvalidSlotIndex;
+    }
+    for (int slotIndex = firstSlot; slotIndex < (endSlot - 1); slotIndex++) {
+        this->next(slotIndex) = slotIndex + 1;
+    }
+    this->numSlots += endSlot - firstSlot;
+
+    // ...and put them on top of the free list
+    const slotTag newHead = firstSlot | ((++this->tagCounter & 0xFFFF) << 16);
+    #if ORYOL_HAS_ATOMIC
+        slotTag oldHead = this->head.load(std::memory_order_relaxed);
+        for (;;) {
+            this->next(endSlot - 1) = oldHead;
+            if (this->head.compare_exchange_weak(oldHead, newHead)) {
+                break;
+            }
+            this->numRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+    #else
+        this->next(endSlot - 1) = this->head;
+        this->head = newHead;
+    #endif
+    this->numFreeSlots += endSlot - firstSlot;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::push(Id::SlotIndexT slotIndex) {
+    // see poolAllocator::push(), the slot tag carries a counter against ABA
+    const slotTag newHead = slotIndex | ((++this->tagCounter & 0xFFFF) << 16);
+    #if ORYOL_HAS_ATOMIC
+        slotTag oldHead = this->head.load(std::memory_order_relaxed);
+        for (;;) {
+            this->next(slotIndex) = oldHead;
+            if (this->head.compare_exchange_weak(oldHead, newHead)) {
+                break;
+            }
+            this->numRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+    #else
+        this->next(slotIndex) = this->head;
+        this->head = newHead;
+    #endif
+    this->numFreeSlots++;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> Id::SlotIndexT
+ResourcePool<RESOURCE,SETUP>::pop() {
+    // see poolAllocator::pop()
+    #if ORYOL_HAS_ATOMIC
+        slotTag oldHead = this->head.load(std::memory_order_acquire);
+        for (;;) {
+            if (invalidTag == oldHead) {
+                return Id::InvalidSlotIndex;
+            }
+            const slotTag newHead = this->next(oldHead & 0xFFFF);
+            if (this->head.compare_exchange_weak(oldHead, newHead)) {
+                break;
+            }
+            this->numRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+    #else
+        const slotTag oldHead = this->head;
+        if (invalidTag == oldHead) {
+            return Id::InvalidSlotIndex;
+        }
+        this->head = this->next(oldHead & 0xFFFF);
+    #endif
+    this->numFreeSlots--;
+    return Id::SlotIndexT(oldHead & 0xFFFF);
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> int
+ResourcePool<RESOURCE,SETUP>::popChain(int num, slotTag& outFirst) {
+    // like pop(), but unlinks up to num slots at once, the slots
+    // behind the head can't change as long as the head is unchanged
+    slotTag tag;
+    int numPopped;
+    #if ORYOL_HAS_ATOMIC
+        slotTag oldHead = this->head.load(std::memory_order_acquire);
+        for (;;) {
+            tag = oldHead;
+            numPopped = 0;
+            while ((numPopped < num) && (invalidTag != tag)) {
+                tag = this->next(tag & 0xFFFF);
+                numPopped++;
+            }
+            if (this->head.compare_exchange_weak(oldHead, tag)) {
+                break;
+            }
+            this->numRetries.fetch_add(1, std::memory_order_relaxed);
+        }
+    #else
+        const slotTag oldHead = this->head;
+        tag = oldHead;
+        numPopped = 0;
+        while ((numPopped < num) && (invalidTag != tag)) {
+            tag = this->next(tag & 0xFFFF);
+            numPopped++;
+        }
+        this->head = tag;
+    #endif
+    this->numFreeSlots -= numPopped;
+    outFirst = oldHead;
+    return numPopped;
 }
 
 //------------------------------------------------------------------------------
@@ -147,20 +441,61 @@ template<class RESOURCE, class SETUP> Id
 ResourcePool<RESOURCE,SETUP>::AllocId() {
     o_assert_dbg(this->isValid);
     o_assert_dbg(Id::InvalidType != this->resourceType);
-    Id newId(this->uniqueCounter++, this->freeSlots.Dequeue(), this->resourceType);
-    #if ORYOL_DEBUG
-        const auto& slot = this->slots[newId.SlotIndex];
-        o_assert_dbg(ResourceState::Initial == slot.State);
-    #endif
+    Id::SlotIndexT slotIndex;
+    while (Id::InvalidSlotIndex == (slotIndex = this->pop())) {
+        this->allocPages(1);
+    }
+    Id newId(this->uniqueCounter++, slotIndex, this->resourceType);
+    o_assert_dbg(ResourceState::Initial == this->slot(newId.SlotIndex).State);
     return newId;
 }
 
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::AllocIds(int num, Array<Id>& outIds) {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(Id::InvalidType != this->resourceType);
+    o_assert_dbg(num >= 0);
+    outIds.Reserve(num);
+
+    // grow the pool once for the whole batch
+    const int numMissing = num - this->numFreeSlots;
+    if (numMissing > 0) {
+        this->allocPages((numMissing + NumPageSlots - 1) / NumPageSlots);
+    }
+    uint32_t uniqueStamp = (this->uniqueCounter += num) - num;
+    while (num > 0) {
+        slotTag tag;
+        int numPopped = this->popChain(num, tag);
+        if (0 == numPopped) {
+            // other threads took the new slots
+            this->allocPages(1);
+            continue;
+        }
+        num -= numPopped;
+        while (numPopped-- > 0) {
+            Id newId(uniqueStamp++, Id::SlotIndexT(tag & 0xFFFF), this->resourceType);
+            o_assert_dbg(ResourceState::Initial == this->slot(newId.SlotIndex).State);
+            outIds.Add(newId);
+            tag = this->next(tag & 0xFFFF);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::FreeIds(const Array<Id>& ids, int startIndex) {
+    for (int i = startIndex; i < ids.Size(); i++) {
+        this->freeId(ids[i]);
+    }
+}
+
 //------------------------------------------------------------------------------
 template<class RESOURCE, class SETUP> void
 ResourcePool<RESOURCE,SETUP>::freeId(const Id& id) {
     o_assert_dbg(this->isValid);
-    o_assert_dbg(ResourceState::Initial == this->slots[id.SlotIndex].State);
-    this->freeSlots.Enqueue(id.SlotIndex);
+    o_assert_dbg(ResourceState::Initial == this->slot(id.SlotIndex).State);
+    this->push(id.SlotIndex);
 }
 
 //------------------------------------------------------------------------------
@@ -168,12 +503,19 @@ template<class RESOURCE, class SETUP> RESOURCE&
 ResourcePool<RESOURCE,SETUP>::Assign(const Id& id, const SETUP& setup, ResourceState::Code state) {
     o_assert_dbg(this->isValid);
     
-    auto& slot = this->slots[id.SlotIndex];
+    auto& slot = this->slot(id.SlotIndex);
     o_assert_dbg(ResourceState::Valid != slot.State);
+    const ResourceState::Code oldState = slot.State;
     slot.State = state;
     slot.StateStartFrame = this->frameCounter;
+    slot.LastUseFrame = this->frameCounter;
     slot.Id = id;
     slot.Setup = setup;
+    if (ResourceState::Initial == oldState) {
+        this->overall.numCreated++;
+        this->curFrame.numCreated++;
+    }
+    this->stateChanged(slot, id, oldState, state);
     return slot;
 }
 
@@ -182,13 +524,26 @@ template<class RESOURCE, class SETUP> void
 ResourcePool<RESOURCE,SETUP>::Unassign(const Id& id) {
     o_assert_dbg(this->isValid);
     
-    auto& slot = this->slots[id.SlotIndex];
+    auto& slot = this->slot(id.SlotIndex);
     if (id == slot.Id) {
         o_assert_dbg(ResourceState::Initial != slot.State);
+        const ResourceState::Code oldState = slot.State;
         slot.Id.Invalidate();
         slot.State = ResourceState::Initial;
         slot.StateStartFrame = 0;
+        slot.LastUseFrame = 0;
+        this->numBytes -= slot.ByteSize;
+        slot.ByteSize = 0;
+        if (slot.Evicted) {
+            slot.Evicted = false;
+            this->numEvicted--;
+        }
+        slot.RefCount = 0;
+        slot.Loader = nullptr;
+        this->overall.numDestroyed++;
+        this->curFrame.numDestroyed++;
         this->freeId(id);
+        this->stateChanged(slot, id, oldState, ResourceState::InvalidState);
     }
     else {
         o_warn("ResourcePool::Unassign(): id not in pool (type: '%d', slot: '%d')\n", id.Type, id.SlotIndex);
@@ -197,17 +552,29 @@ ResourcePool<RESOURCE,SETUP>::Unassign(const Id& id) {
 
 //------------------------------------------------------------------------------
 template<class RESOURCE, class SETUP> RESOURCE*
-ResourcePool<RESOURCE,SETUP>::Lookup(const Id& id) const {
+ResourcePool<RESOURCE,SETUP>::Lookup(const Id& id) {
     o_assert_dbg(this->isValid);
     o_assert_dbg(id.Type == this->resourceType);
     
-    const auto& slot = this->slots[id.SlotIndex];
+    auto& slot = this->slot(id.SlotIndex);
     if (id == slot.Id) {
+        slot.LastUseFrame = this->frameCounter;
         if (ResourceState::Valid == slot.State) {
-            // resource exists and is valid or pending, all ok
-            return const_cast<RESOURCE*>(&slot);
+            return &slot;
         }
-        // FIXME: return placeholder if one is defined
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> RESOURCE*
+ResourcePool<RESOURCE,SETUP>::Peek(const Id& id) const {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(id.Type == this->resourceType);
+    
+    const auto& slot = this->slot(id.SlotIndex);
+    if ((id == slot.Id) && (ResourceState::Valid == slot.State)) {
+        return const_cast<RESOURCE*>(&slot);
     }
     return nullptr;
 }
@@ -217,7 +584,7 @@ template<class RESOURCE, class SETUP> RESOURCE*
 ResourcePool<RESOURCE,SETUP>::Get(const Id& id) const {
     o_assert_dbg(this->isValid);
     o_assert_dbg(id.Type == this->resourceType);
-    const auto& slot = this->slots[id.SlotIndex];
+    const auto& slot = this->slot(id.SlotIndex);
     if (id == slot.Id) {
         return const_cast<RESOURCE*>(&slot);
     }
@@ -231,11 +598,13 @@ ResourcePool<RESOURCE,SETUP>::Get(const Id& id) const {
 template<class RESOURCE, class SETUP> void
 ResourcePool<RESOURCE, SETUP>::UpdateState(const Id& id, ResourceState::Code newState) {
     o_assert_dbg(this->isValid);
-    auto& slot = this->slots[id.SlotIndex];
+    auto& slot = this->slot(id.SlotIndex);
     if (id == slot.Id) {
         o_assert_dbg(ResourceState::Initial != slot.State);
+        const ResourceState::Code oldState = slot.State;
         slot.State = newState;
         slot.StateStartFrame = this->frameCounter;
+        this->stateChanged(slot, id, oldState, newState);
     }
     else {
         o_warn("ResourcePool::UpdateState(): id not in pool (type: '%d', slot: '%d')\n", id.Type, id.SlotIndex);
@@ -247,7 +616,53 @@ template<class RESOURCE, class SETUP> bool
 ResourcePool<RESOURCE, SETUP>::Contains(const Id& id) const {
     o_assert_dbg(this->isValid);
     o_assert_dbg(id.Type == this->resourceType);
-    return id == this->slots[id.SlotIndex].Id;
+    return id == this->slot(id.SlotIndex).Id;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> int
+ResourcePool<RESOURCE,SETUP>::AddRef(const Id& id) {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(id.Type == this->resourceType);
+    
+    auto& slot = this->slot(id.SlotIndex);
+    if (id == slot.Id) {
+        return ++slot.RefCount;
+    }
+    else {
+        return InvalidIndex;
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> int
+ResourcePool<RESOURCE,SETUP>::Release(const Id& id) {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(id.Type == this->resourceType);
+    
+    auto& slot = this->slot(id.SlotIndex);
+    if (id == slot.Id) {
+        o_assert_dbg(slot.RefCount > 0);
+        return --slot.RefCount;
+    }
+    else {
+        return InvalidIndex;
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> int
+ResourcePool<RESOURCE,SETUP>::GetRefCount(const Id& id) const {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(id.Type == this->resourceType);
+    
+    const auto& slot = this->slot(id.SlotIndex);
+    if (id == slot.Id) {
+        return slot.RefCount;
+    }
+    else {
+        return InvalidIndex;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -256,7 +671,7 @@ ResourcePool<RESOURCE,SETUP>::QueryState(const Id& id) const {
     o_assert_dbg(this->isValid);
     o_assert_dbg(id.Type == this->resourceType);
     
-    const auto& slot = this->slots[id.SlotIndex];
+    const auto& slot = this->slot(id.SlotIndex);
     if (id == slot.Id) {
         return slot.State;
     }
@@ -272,7 +687,7 @@ ResourcePool<RESOURCE, SETUP>::QueryResourceInfo(const Id& id) const {
     o_assert_dbg(id.Type == this->resourceType);
     
     ResourceInfo info;
-    const auto& slot = this->slots[id.SlotIndex];
+    const auto& slot = this->slot(id.SlotIndex);
     if (id == slot.Id) {
         info.State = slot.State;
         info.StateAge = this->frameCounter - slot.StateStartFrame;
@@ -290,30 +705,174 @@ ResourcePool<RESOURCE, SETUP>::QueryPoolInfo() const {
     poolInfo.NumSlots = this->GetNumSlots();
     poolInfo.NumUsedSlots = this->GetNumUsedSlots();
     poolInfo.NumFreeSlots = this->GetNumFreeSlots();
-    for (const auto& slot : this->slots) {
-        if (ResourceState::InvalidState != slot.State) {
-            poolInfo.NumSlotsByState[slot.State]++;
-        }
+    poolInfo.NumPages = this->numPages;
+    poolInfo.NumBytes = poolInfo.NumPages * int(sizeof(page));
+    poolInfo.NumFreeListRetries = this->numRetries;
+    poolInfo.NumResourceBytes = this->numBytes;
+    poolInfo.ByteBudget = this->byteBudget;
+    poolInfo.NumEvictions = this->numEvictions;
+    poolInfo.NumReloads = this->numReloads;
+    poolInfo.NumEvicted = this->numEvicted;
+    // slots which are not assigned (free or allocated ids) are in the Initial state
+    int numAssigned = 0;
+    for (int state = 0; state < ResourceState::NumStates; state++) {
+        poolInfo.NumSlotsByState[state] = this->numByState[state];
+        numAssigned += this->numByState[state];
     }
+    poolInfo.NumSlotsByState[ResourceState::Initial] = poolInfo.NumSlots - numAssigned;
+    poolInfo.NumCreated = this->overall.numCreated;
+    poolInfo.NumDestroyed = this->overall.numDestroyed;
+    poolInfo.NumLoaded = this->overall.numLoaded;
+    poolInfo.NumCreatedLastFrame = this->lastFrame.numCreated;
+    poolInfo.NumDestroyedLastFrame = this->lastFrame.numDestroyed;
+    poolInfo.NumLoadedLastFrame = this->lastFrame.numLoaded;
+    poolInfo.NumTimedLoads = this->numTimedLoads;
+    poolInfo.LoadTime = this->loadTime;
     return poolInfo;
 }
 
 //------------------------------------------------------------------------------
 template<class RESOURCE, class SETUP> int
 ResourcePool<RESOURCE,SETUP>::GetNumSlots() const {
-    return this->slots.Size();
+    return this->numSlots;
 }
 
 //------------------------------------------------------------------------------
 template<class RESOURCE, class SETUP> int
 ResourcePool<RESOURCE,SETUP>::GetNumUsedSlots() const {
-    return this->slots.Size() - this->freeSlots.Size();
+    return this->numSlots - this->numFreeSlots;
 }
 
 //------------------------------------------------------------------------------
 template<class RESOURCE, class SETUP> int
 ResourcePool<RESOURCE,SETUP>::GetNumFreeSlots() const {
-    return this->freeSlots.Size();
+    return this->numFreeSlots;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::SetByteBudget(int64_t budget) {
+    o_assert_dbg(budget >= 0);
+    this->byteBudget = budget;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> int64_t
+ResourcePool<RESOURCE,SETUP>::GetByteBudget() const {
+    return this->byteBudget;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> int64_t
+ResourcePool<RESOURCE,SETUP>::GetNumBytes() const {
+    return this->numBytes;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::SetByteSize(const Id& id, int byteSize) {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(byteSize >= 0);
+    
+    auto& slot = this->slot(id.SlotIndex);
+    if (id == slot.Id) {
+        this->numBytes += byteSize - slot.ByteSize;
+        slot.ByteSize = byteSize;
+        if (slot.Evicted) {
+            slot.Evicted = false;
+            this->numEvicted--;
+            this->numReloads++;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> Array<Id>
+ResourcePool<RESOURCE,SETUP>::SelectEvictions() const {
+    o_assert_dbg(this->isValid);
+    
+    Array<Id> ids;
+    if ((0 == this->byteBudget) || (this->numBytes <= this->byteBudget)) {
+        return ids;
+    }
+    
+    // gather the evictable resources, and sort them by last use
+    Array<const RESOURCE*> candidates;
+    const int num = this->numPages;
+    for (int pageIndex = 0; pageIndex < num; pageIndex++) {
+        const page* p = this->pages[pageIndex];
+        for (int i = 0; p && (i < NumPageSlots); i++) {
+            const RESOURCE& slot = p->slots[i];
+            if ((ResourceState::Valid == slot.State) && slot.Loader.isValid() &&
+                (slot.ByteSize > 0) && (slot.LastUseFrame < this->frameCounter)) {
+                candidates.Add(&slot);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](const RESOURCE* a, const RESOURCE* b) {
+        return a->LastUseFrame < b->LastUseFrame;
+    });
+    int64_t excess = this->numBytes - this->byteBudget;
+    for (int i = 0; (i < candidates.Size()) && (excess > 0); i++) {
+        ids.Add(candidates[i]->Id);
+        excess -= candidates[i]->ByteSize;
+    }
+    return ids;
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::Evict(const Id& id) {
+    o_assert_dbg(this->isValid);
+    
+    auto& slot = this->slot(id.SlotIndex);
+    o_assert_dbg((id == slot.Id) && slot.Loader.isValid() && !slot.Evicted);
+    this->numBytes -= slot.ByteSize;
+    slot.ByteSize = 0;
+    slot.Evicted = true;
+    const ResourceState::Code oldState = slot.State;
+    slot.State = ResourceState::Pending;
+    slot.StateStartFrame = this->frameCounter;
+    this->numEvictions++;
+    this->numEvicted++;
+    this->stateChanged(slot, id, oldState, ResourceState::Pending);
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::SetStateFunc(StateFunc func) {
+    this->stateFunc = std::move(func);
+}
+
+//------------------------------------------------------------------------------
+template<class RESOURCE, class SETUP> void
+ResourcePool<RESOURCE,SETUP>::stateChanged(RESOURCE& slot, const Id& id, ResourceState::Code oldState, ResourceState::Code newState) {
+    if (oldState == newState) {
+        return;
+    }
+    // Initial and InvalidState are the states of unassigned slots
+    if ((ResourceState::Initial != oldState) && (ResourceState::InvalidState != oldState)) {
+        this->numByState[oldState]--;
+    }
+    if (ResourceState::InvalidState != newState) {
+        this->numByState[newState]++;
+    }
+    if (ResourceState::Pending == newState) {
+        slot.LoadStartTime = Clock::Now();
+    }
+    else if (ResourceState::Pending == oldState) {
+        if (ResourceState::InvalidState != newState) {
+            this->overall.numLoaded++;
+            this->curFrame.numLoaded++;
+        }
+        if (ResourceState::Valid == newState) {
+            this->loadTime += Clock::Since(slot.LoadStartTime);
+            this->numTimedLoads++;
+        }
+    }
+    if (this->stateFunc) {
+        this->stateFunc(id, oldState, newState);
+    }
 }
 
 } // namespace Oryol
@@ -0,0 +1,42 @@
+//------------------------------------------------------------------------------
+//  loaderWakeupList.cc
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "loaderWakeupList.h"
+
+namespace Oryol {
+namespace _priv {
+
+//------------------------------------------------------------------------------
+void
+loaderWakeupList::push(uint32_t ticket) {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    this->tickets.Add(ticket);
+}
+
+//------------------------------------------------------------------------------
+void
+loaderWakeupList::takeAll(Array<uint32_t>& outTickets) {
+    o_assert_dbg(outTickets.Empty());
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    // swap the arrays so that the allocated capacity is recycled
+    Array<uint32_t> tmp(std::move(outTickets));
+    outTickets = std::move(this->tickets);
+    this->tickets = std::move(tmp);
+}
+
+//------------------------------------------------------------------------------
+bool
+loaderWakeupList::empty() const {
+    #if ORYOL_HAS_THREADS
+    std::lock_guard<std::mutex> lock(this->mutex);
+    #endif
+    return this->tickets.Empty();
+}
+
+} // namespace _priv
+} // namespace Oryol
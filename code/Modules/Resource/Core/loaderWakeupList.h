@@ -0,0 +1,45 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::_priv::loaderWakeupList
+    @ingroup _priv
+    @brief list of resource loaders which are ready to continue
+
+    Resource loaders which can wake up (ResourceLoader::CanWakeup())
+    get a wakeup function from their resource container, which pushes
+    the loader's ticket to the wakeup list, usually from an IO thread.
+    Once per frame the resource container takes the whole list and
+    only continues the loaders which have woken up.
+
+    The wakeup functions keep a reference to the list, so that late
+    wakeups after the container has been discarded are harmless.
+    This is thread-safe.
+*/
+#include "Core/RefCounted.h"
+#include "Core/Containers/Array.h"
+#if ORYOL_HAS_THREADS
+#include <mutex>
+#endif
+
+namespace Oryol {
+namespace _priv {
+
+class loaderWakeupList : public RefCounted {
+    OryolClassDecl(loaderWakeupList);
+public:
+    /// push the ticket of a loader which can continue (called from any thread)
+    void push(uint32_t ticket);
+    /// move all tickets into an (empty) array
+    void takeAll(Array<uint32_t>& outTickets);
+    /// return true if the list is empty
+    bool empty() const;
+
+private:
+    #if ORYOL_HAS_THREADS
+    mutable std::mutex mutex;
+    #endif
+    Array<uint32_t> tickets;
+};
+
+} // namespace _priv
+} // namespace Oryol
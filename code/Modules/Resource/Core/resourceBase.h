@@ -14,10 +14,21 @@
     all information required to create a resource object. A copy of the
     setup object is stored in the resource object, so that the resource
     can be destroyed and re-created if needed.
+
+    Resources which were created by a reloadable ResourceLoader keep
+    a reference to the loader, the resource pool may then evict the
+    least recently used of those resources to stay in its memory
+    budget, an evicted resource is reloaded when it is looked up again.
+
+    Resources can optionally be reference counted (see ResourceHandle),
+    the reference count lives in the resource slot.
 */
 #include "Core/Assertion.h"
+#include "Core/Ptr.h"
+#include "Core/Time/TimePoint.h"
 #include "Resource/Id.h"
 #include "Resource/ResourceState.h"
+#include "Resource/Core/ResourceLoader.h"
 
 namespace Oryol {
     
@@ -29,6 +40,18 @@ public:
     ResourceState::Code State = ResourceState::Initial;
     /// frame count of last state change
     int StateStartFrame = 0;
+    /// frame count of last lookup (for LRU eviction)
+    int LastUseFrame = 0;
+    /// tracked memory size in bytes (for memory budgets)
+    int ByteSize = 0;
+    /// true if the resource has been evicted and must be reloaded
+    bool Evicted = false;
+    /// number of acquired references (0 if not reference counted)
+    int RefCount = 0;
+    /// time when the resource entered the Pending state (for load latency stats)
+    TimePoint LoadStartTime;
+    /// the loader of an evictable resource (reloads the resource after eviction)
+    Ptr<ResourceLoader> Loader;
     /// the setup object
     SETUP Setup;
     
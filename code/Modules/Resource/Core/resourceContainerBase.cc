@@ -11,7 +11,9 @@ namespace Oryol {
 //------------------------------------------------------------------------------
 resourceContainerBase::resourceContainerBase() :
 curLabelCount(0),
-valid(false) {
+valid(false),
+curWakeupTicket(0),
+curHandlerId(0) {
     // empty
 }
 
@@ -26,6 +28,7 @@ resourceContainerBase::setup(int labelStackCapacity, int registryCapacity) {
     o_assert_dbg(!this->valid);
     this->labelStack.Reserve(labelStackCapacity);
     this->registry.Setup(registryCapacity);
+    this->wakeups = _priv::loaderWakeupList::Create();
     this->valid = true;
     this->PushLabel(ResourceLabel::Default);
 }
@@ -36,6 +39,11 @@ resourceContainerBase::discard() {
     o_assert_dbg(this->valid);
     o_assert_dbg(this->labelStack.Size() == 1);
     this->PopLabel();
+    this->cancelLoaders();
+    this->wakeups = nullptr;
+    this->resourceHandlers.Clear();
+    this->labelHandlers.Clear();
+    this->groups.Clear();
     this->registry.Discard();
     this->valid = false;
 }
@@ -85,4 +93,178 @@ resourceContainerBase::Lookup(const Locator& loc) const {
     return this->registry.Lookup(loc);
 }
 
+//------------------------------------------------------------------------------
+void
+resourceContainerBase::addLoader(const Ptr<ResourceLoader>& loader) {
+    o_assert_dbg(this->valid);
+    if (loader->CanWakeup()) {
+        // the loader sleeps until its wakeup function pushes its ticket
+        const uint32_t ticket = this->curWakeupTicket++;
+        Ptr<_priv::loaderWakeupList> list = this->wakeups;
+        loader->SetWakeupFunc([list, ticket]() {
+            list->push(ticket);
+        });
+        this->sleepingLoaders.Add(ticket, loader);
+    }
+    else {
+        this->pendingLoaders.Add(loader);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+resourceContainerBase::updateLoaders() {
+    o_assert_dbg(this->valid);
+
+    // continue the loaders which have woken up since the last update
+    if (!this->wakeups->empty()) {
+        this->wakeups->takeAll(this->wokenTickets);
+        for (uint32_t ticket : this->wokenTickets) {
+            // NOTE: cancelled loaders may still wake up
+            const int index = this->sleepingLoaders.FindIndex(ticket);
+            if (InvalidIndex != index) {
+                // NOTE: Continue() may add new loaders
+                Ptr<ResourceLoader> loader = this->sleepingLoaders.ValueAtIndex(index);
+                this->sleepingLoaders.EraseIndex(index);
+                if (ResourceState::Pending == loader->Continue()) {
+                    // not finished yet, wait for the next wakeup
+                    this->sleepingLoaders.Add(ticket, loader);
+                }
+            }
+        }
+        this->wokenTickets.Clear();
+    }
+
+    // trigger polled loaders, and remove from pending array if finished
+    for (int i = this->pendingLoaders.Size() - 1; i >= 0; i--) {
+        const auto& loader = this->pendingLoaders[i];
+        ResourceState::Code state = loader->Continue();
+        if (ResourceState::Pending != state) {
+            this->pendingLoaders.Erase(i);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+resourceContainerBase::cancelLoaders() {
+    for (const auto& loader : this->pendingLoaders) {
+        loader->Cancel();
+    }
+    this->pendingLoaders.Clear();
+    for (const auto& kvp : this->sleepingLoaders) {
+        kvp.Value()->Cancel();
+    }
+    this->sleepingLoaders.Clear();
+}
+
+//------------------------------------------------------------------------------
+resourceContainerBase::stateHandlerId
+resourceContainerBase::Subscribe(const Id& id, stateHandler handler) {
+    o_assert_dbg(this->valid);
+    subscription sub;
+    sub.handlerId = this->curHandlerId++;
+    sub.handler = handler;
+    this->resourceHandlers.Add(id, sub);
+    return sub.handlerId;
+}
+
+//------------------------------------------------------------------------------
+resourceContainerBase::stateHandlerId
+resourceContainerBase::Subscribe(ResourceLabel label, stateHandler handler) {
+    o_assert_dbg(this->valid);
+    subscription sub;
+    sub.handlerId = this->curHandlerId++;
+    sub.handler = handler;
+    this->labelHandlers.Add(label.Value, sub);
+    return sub.handlerId;
+}
+
+//------------------------------------------------------------------------------
+void
+resourceContainerBase::Unsubscribe(stateHandlerId handlerId) {
+    o_assert_dbg(this->valid);
+    for (int i = 0; i < this->resourceHandlers.Size(); i++) {
+        if (this->resourceHandlers.ValueAtIndex(i).handlerId == handlerId) {
+            this->resourceHandlers.EraseIndex(i);
+            return;
+        }
+    }
+    for (int i = 0; i < this->labelHandlers.Size(); i++) {
+        if (this->labelHandlers.ValueAtIndex(i).handlerId == handlerId) {
+            this->labelHandlers.EraseIndex(i);
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+resourceContainerBase::notifyStateChange(const Id& id, ResourceState::Code oldState, ResourceState::Code newState) {
+    o_assert_dbg(this->valid);
+    if (this->resourceHandlers.Empty() && this->labelHandlers.Empty() && this->groups.Empty()) {
+        return;
+    }
+
+    // collect the handlers first, since they may (un)subscribe
+    Array<stateHandler> handlers;
+    for (int i = this->resourceHandlers.FindIndex(id);
+         (InvalidIndex != i) && (i < this->resourceHandlers.Size()) && (this->resourceHandlers.KeyAtIndex(i) == id);
+         i++) {
+        handlers.Add(this->resourceHandlers.ValueAtIndex(i).handler);
+    }
+    if (ResourceState::InvalidState == newState) {
+        // the resource has been destroyed
+        this->resourceHandlers.Erase(id);
+    }
+    const ResourceLabel label = this->registry.FindLabel(id);
+    Array<Ptr<ResourceGroup>> doneGroups;
+    if (label.IsValid()) {
+        for (const uint32_t key : { label.Value, ResourceLabel::All }) {
+            for (int i = this->labelHandlers.FindIndex(key);
+                 (InvalidIndex != i) && (i < this->labelHandlers.Size()) && (this->labelHandlers.KeyAtIndex(i) == key);
+                 i++) {
+                handlers.Add(this->labelHandlers.ValueAtIndex(i).handler);
+            }
+        }
+        for (int i = this->groups.Size() - 1; i >= 0; i--) {
+            const Ptr<ResourceGroup>& group = this->groups[i];
+            if ((group->Label == label) || (group->Label == ResourceLabel::All)) {
+                group->Count(oldState, -1);
+                group->Count(newState, 1);
+                if (0 == group->NumPending) {
+                    group->Done = true;
+                    doneGroups.Add(group);
+                    this->groups.Erase(i);
+                }
+            }
+        }
+    }
+
+    for (const auto& handler : handlers) {
+        handler(id, oldState, newState);
+    }
+    for (const auto& group : doneGroups) {
+        if (group->OnDone) {
+            group->OnDone(*group);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+resourceContainerBase::addGroup(const Ptr<ResourceGroup>& group) {
+    o_assert_dbg(this->valid);
+    o_assert_dbg(!group->Done);
+    if (0 == group->NumPending) {
+        group->Done = true;
+        if (group->OnDone) {
+            group->OnDone(*group);
+        }
+    }
+    else {
+        this->groups.Add(group);
+    }
+}
+
 } // namespace Oryol
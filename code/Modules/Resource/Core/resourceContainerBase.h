@@ -8,16 +8,42 @@
     discard for different types of related resources. Modules like
     the Gfx module typically derive a single ResourceContainer subclass
     to wrap their different resource types.
+
+    Pending resource loaders are owned by the container, loaders which
+    can wake up are only continued after they have woken up, all other
+    loaders are continued once per frame.
+
+    Subscribers are notified about the state changes of a resource,
+    or of all resources with a label (the subclass forwards the state
+    changes of its resource pools to notifyStateChange()). Resource
+    groups track whether all resources with a label have finished
+    loading. Per-resource subscriptions end when the resource is
+    destroyed.
+
+    createBatch() implements the bookkeeping for batched resource
+    creation: the resource ids of a batch are allocated at once, and
+    added to the registry in one bulk operation before the resources
+    are created.
 */
 #include "Core/Types.h"
 #include "Core/Containers/Array.h"
+#include "Core/Containers/Map.h"
 #include "Resource/Core/resourceRegistry.h"
+#include "Resource/Core/ResourceLoader.h"
+#include "Resource/Core/loaderWakeupList.h"
 #include "Resource/ResourceLabel.h"
+#include "Resource/ResourceGroup.h"
+#include <functional>
 
 namespace Oryol {
 
 class resourceContainerBase {
 public:
+    /// resource state change callback
+    typedef std::function<void(const Id& id, ResourceState::Code oldState, ResourceState::Code newState)> stateHandler;
+    /// resource state change subscription id
+    typedef unsigned int stateHandlerId;
+
     /// default constructor
     resourceContainerBase();
     /// destructor
@@ -31,6 +57,12 @@ public:
     ResourceLabel PopLabel();
     /// lookup a resource Id by Locator
     Id Lookup(const Locator& locator) const;
+    /// subscribe to the state changes of a resource
+    stateHandlerId Subscribe(const Id& id, stateHandler handler);
+    /// subscribe to the state changes of all resources with a label
+    stateHandlerId Subscribe(ResourceLabel label, stateHandler handler);
+    /// unsubscribe from state changes
+    void Unsubscribe(stateHandlerId handlerId);
     
 protected:
     /// setup the resource container
@@ -43,11 +75,80 @@ protected:
     ResourceLabel peekLabel() const;
     /// return true if currently on main thread
     bool isMainThread() const;
+    /// add a loader, must be called before the loader is started or reloaded
+    void addLoader(const Ptr<ResourceLoader>& loader);
+    /// continue the pending loaders, called once per frame
+    void updateLoaders();
+    /// cancel all pending loaders
+    void cancelLoaders();
+    /// notify subscribers and groups about a resource state change
+    void notifyStateChange(const Id& id, ResourceState::Code oldState, ResourceState::Code newState);
+    /// track a resource group with initialized counters, done at once if nothing is pending
+    void addGroup(const Ptr<ResourceGroup>& group);
+    /// create a batch of resources in a pool, calls createFunc(index, id) for each new resource
+    template<class POOL, class LOCFUNC, class CREATEFUNC> Array<Id> createBatch(POOL& pool, int num, LOCFUNC locFunc, CREATEFUNC createFunc);
     
+    struct subscription {
+        stateHandlerId handlerId = 0;
+        stateHandler handler;
+    };
     Array<ResourceLabel> labelStack;
     _priv::resourceRegistry registry;
     uint32_t curLabelCount;
     bool valid;
+    Array<Ptr<ResourceLoader>> pendingLoaders;
+    Map<uint32_t, Ptr<ResourceLoader>> sleepingLoaders;
+    Ptr<_priv::loaderWakeupList> wakeups;
+    Array<uint32_t> wokenTickets;
+    uint32_t curWakeupTicket;
+    Map<Id, subscription> resourceHandlers;
+    Map<uint32_t, subscription> labelHandlers;
+    stateHandlerId curHandlerId;
+    Array<Ptr<ResourceGroup>> groups;
 };
 
+//------------------------------------------------------------------------------
+template<class POOL, class LOCFUNC, class CREATEFUNC> Array<Id>
+resourceContainerBase::createBatch(POOL& pool, int num, LOCFUNC locFunc, CREATEFUNC createFunc) {
+    o_assert_dbg(this->valid);
+    o_assert_dbg(num >= 0);
+    
+    // shared resources which already exist are not created again
+    int numNew = 0;
+    for (int i = 0; i < num; i++) {
+        if (!this->registry.Lookup(locFunc(i)).IsValid()) {
+            numNew++;
+        }
+    }
+    Array<Id> newIds;
+    pool.AllocIds(numNew, newIds);
+    
+    // register the whole batch first, the same shared locator
+    // may appear several times in a batch
+    Array<Id> ids;
+    ids.Reserve(num);
+    int numUsed = 0;
+    this->registry.BeginBulk(numNew, this->peekLabel());
+    for (int i = 0; i < num; i++) {
+        const Locator& loc = locFunc(i);
+        Id resId = this->registry.Lookup(loc);
+        if (!resId.IsValid()) {
+            resId = newIds[numUsed++];
+            this->registry.AddBulk(loc, resId);
+        }
+        ids.Add(resId);
+    }
+    this->registry.EndBulk();
+    pool.FreeIds(newIds, numUsed);
+    
+    // ...and create the new resources
+    for (int i = 0, newIndex = 0; (i < num) && (newIndex < numUsed); i++) {
+        if (ids[i] == newIds[newIndex]) {
+            createFunc(i, ids[i]);
+            newIndex++;
+        }
+    }
+    return ids;
+}
+
 } // namespace Oryol
@@ -9,7 +9,11 @@ namespace _priv {
 
 //------------------------------------------------------------------------------
 resourceRegistry::resourceRegistry() :
-isValid(false) {
+isValid(false),
+inBulkMode(false),
+bulkLabelIndex(InvalidIndex),
+numIds(0),
+numLocators(0) {
     // empty
 }
 
@@ -26,18 +30,29 @@ resourceRegistry::Setup(int reserveSize) {
     
     this->isValid = true;
     this->entries.Reserve(reserveSize);
-    this->locatorIndexMap.Reserve(reserveSize);
-    this->idIndexMap.Reserve(reserveSize);
+    // keep the hash indices at most half full
+    int capacity = 16;
+    while (capacity < 2 * reserveSize) {
+        capacity *= 2;
+    }
+    rehash(this->idIndex, capacity);
+    rehash(this->locatorIndex, capacity);
+    this->numIds = 0;
+    this->numLocators = 0;
 }
 
 //------------------------------------------------------------------------------
 void
 resourceRegistry::Discard() {
     o_assert_dbg(this->isValid);
+    o_assert_dbg(!this->inBulkMode);
     
     this->entries.Clear();
-    this->locatorIndexMap.Clear();
-    this->idIndexMap.Clear();
+    this->idIndex.Clear();
+    this->locatorIndex.Clear();
+    this->labels.Clear();
+    this->numIds = 0;
+    this->numLocators = 0;
     this->isValid = false;
 }
 
@@ -47,43 +62,255 @@ resourceRegistry::IsValid() const {
     return this->isValid;
 }
 
+//------------------------------------------------------------------------------
+uint32_t
+resourceRegistry::hashId(Id id) {
+    // 64-bit finalizer of MurmurHash3
+    uint64_t h = id.Value;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return uint32_t(h);
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+resourceRegistry::hashLocator(const Locator& loc) {
+    // FNV-1a over the location string and the signature
+    uint32_t h = 2166136261U;
+    const char* str = loc.Location().AsCStr();
+    while (*str) {
+        h = (h ^ uint8_t(*str++)) * 16777619U;
+    }
+    const uint32_t sig = loc.Signature();
+    for (int i = 0; i < 4; i++) {
+        h = (h ^ ((sig >> (i * 8)) & 0xFF)) * 16777619U;
+    }
+    return h;
+}
+
+//------------------------------------------------------------------------------
+void
+resourceRegistry::rehash(Array<hashSlot>& index, int capacity) {
+    o_assert_dbg((capacity & (capacity - 1)) == 0);
+    Array<hashSlot> old(std::move(index));
+    index.Reserve(capacity);
+    for (int i = 0; i < capacity; i++) {
+        index.Add(hashSlot());
+    }
+    const int mask = capacity - 1;
+    for (const hashSlot& slot : old) {
+        if (InvalidIndex != slot.entryIndex) {
+            int i = slot.hash & mask;
+            while (InvalidIndex != index[i].entryIndex) {
+                i = (i + 1) & mask;
+            }
+            index[i] = slot;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+resourceRegistry::reserveSlots(Array<hashSlot>& index, int num) {
+    // keep the hash index at most half full
+    int capacity = index.Empty() ? 16 : index.Size();
+    while (capacity < 2 * num) {
+        capacity *= 2;
+    }
+    if (capacity > index.Size()) {
+        rehash(index, capacity);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+resourceRegistry::insertSlot(Array<hashSlot>& index, int& num, uint32_t hash, int entryIndex) {
+    if (2 * (num + 1) > index.Size()) {
+        rehash(index, index.Empty() ? 16 : index.Size() * 2);
+    }
+    const int mask = index.Size() - 1;
+    int i = hash & mask;
+    while (InvalidIndex != index[i].entryIndex) {
+        i = (i + 1) & mask;
+    }
+    index[i].hash = hash;
+    index[i].entryIndex = entryIndex;
+    num++;
+}
+
+//------------------------------------------------------------------------------
+void
+resourceRegistry::eraseSlot(Array<hashSlot>& index, int& num, int slot) {
+    // backward-shift deletion: move following slots of the same probe
+    // sequence into the gap, so that lookups don't need tombstones
+    const int mask = index.Size() - 1;
+    int gap = slot;
+    int i = slot;
+    while (true) {
+        i = (i + 1) & mask;
+        if (InvalidIndex == index[i].entryIndex) {
+            break;
+        }
+        const int home = index[i].hash & mask;
+        const bool stays = (gap <= i) ? ((gap < home) && (home <= i)) : ((gap < home) || (home <= i));
+        if (!stays) {
+            index[gap] = index[i];
+            gap = i;
+        }
+    }
+    index[gap] = hashSlot();
+    num--;
+}
+
+//------------------------------------------------------------------------------
+int
+resourceRegistry::findIdSlot(Id id) const {
+    if (this->idIndex.Empty()) {
+        return InvalidIndex;
+    }
+    const uint32_t hash = hashId(id);
+    const int mask = this->idIndex.Size() - 1;
+    int i = hash & mask;
+    while (InvalidIndex != this->idIndex[i].entryIndex) {
+        const hashSlot& slot = this->idIndex[i];
+        if ((slot.hash == hash) && (this->entries[slot.entryIndex].id == id)) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+int
+resourceRegistry::findLocatorSlot(const Locator& loc) const {
+    if (this->locatorIndex.Empty() || !loc.IsShared()) {
+        return InvalidIndex;
+    }
+    const uint32_t hash = hashLocator(loc);
+    const int mask = this->locatorIndex.Size() - 1;
+    int i = hash & mask;
+    while (InvalidIndex != this->locatorIndex[i].entryIndex) {
+        const hashSlot& slot = this->locatorIndex[i];
+        if ((slot.hash == hash) && (this->entries[slot.entryIndex].locator == loc)) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+    return InvalidIndex;
+}
+
+//------------------------------------------------------------------------------
+void
+resourceRegistry::Reserve(int num) {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(num >= 0);
+    this->entries.Reserve(num);
+    reserveSlots(this->idIndex, this->numIds + num);
+}
+
 //------------------------------------------------------------------------------
 void
 resourceRegistry::Add(const Locator& loc, Id id, ResourceLabel label) {
     o_assert_dbg(this->isValid);
-    o_assert_dbg(id.IsValid());
-    o_assert(!this->idIndexMap.Contains(id));
+    o_assert_dbg(!this->inBulkMode);
     
-    this->entries.Add(loc, id, label);
-    if (loc.IsShared()) {
-        o_assert_dbg(!this->locatorIndexMap.Contains(loc));
-        this->locatorIndexMap.Add(loc, this->entries.Size() - 1);
+    int labelIndex = this->labels.FindIndex(label.Value);
+    if (InvalidIndex == labelIndex) {
+        this->labels.Add(label.Value, labelList());
+        labelIndex = this->labels.FindIndex(label.Value);
+    }
+    this->addEntry(loc, id, label, labelIndex);
+}
+
+//------------------------------------------------------------------------------
+void
+resourceRegistry::BeginBulk(int num, ResourceLabel label) {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(!this->inBulkMode);
+    o_assert_dbg(num >= 0);
+    
+    this->inBulkMode = true;
+    this->Reserve(num);
+    
+    // the label list is resolved once for the whole batch, the
+    // labels map isn't touched again until EndBulk()
+    this->bulkLabelIndex = this->labels.FindIndex(label.Value);
+    if (InvalidIndex == this->bulkLabelIndex) {
+        this->labels.Add(label.Value, labelList());
+        this->bulkLabelIndex = this->labels.FindIndex(label.Value);
+    }
+}
+
+//------------------------------------------------------------------------------
+void
+resourceRegistry::AddBulk(const Locator& loc, Id id) {
+    o_assert_dbg(this->inBulkMode);
+    const ResourceLabel label(this->labels.KeyAtIndex(this->bulkLabelIndex));
+    this->addEntry(loc, id, label, this->bulkLabelIndex);
+}
+
+//------------------------------------------------------------------------------
+void
+resourceRegistry::EndBulk() {
+    o_assert_dbg(this->inBulkMode);
+    
+    // drop the label list if nothing has been added
+    if (0 == this->labels.ValueAtIndex(this->bulkLabelIndex).num) {
+        this->labels.EraseIndex(this->bulkLabelIndex);
     }
-    this->idIndexMap.Add(id, this->entries.Size() - 1);
+    this->inBulkMode = false;
+    this->bulkLabelIndex = InvalidIndex;
+    
+    // make sure nothing broke
+    #if ORYOL_DEBUG
+    o_assert(this->checkIntegrity());
+    #endif
 }
 
 //------------------------------------------------------------------------------
-const resourceRegistry::Entry*
-resourceRegistry::findEntryByLocator(const Locator& loc) const {
+void
+resourceRegistry::addEntry(const Locator& loc, Id id, ResourceLabel label, int labelIndex) {
+    o_assert_dbg(id.IsValid());
+    o_assert(InvalidIndex == this->findIdSlot(id));
+    
+    const int entryIndex = this->entries.Size();
+    this->entries.Add(loc, id, label);
     if (loc.IsShared()) {
-        const int mapIndex = this->locatorIndexMap.FindIndex(loc);
-        if (InvalidIndex != mapIndex) {
-            const int entryIndex = this->locatorIndexMap.ValueAtIndex(mapIndex);
-            return &(this->entries[entryIndex]);
-        }
+        o_assert_dbg(InvalidIndex == this->findLocatorSlot(loc));
+        insertSlot(this->locatorIndex, this->numLocators, hashLocator(loc), entryIndex);
+    }
+    insertSlot(this->idIndex, this->numIds, hashId(id), entryIndex);
+    
+    // append to the label's entry list
+    labelList& list = this->labels.ValueAtIndex(labelIndex);
+    Entry& entry = this->entries[entryIndex];
+    entry.prevInLabel = list.tail;
+    if (InvalidIndex != list.tail) {
+        this->entries[list.tail].nextInLabel = entryIndex;
     }
-    return nullptr;
+    else {
+        list.head = entryIndex;
+    }
+    list.tail = entryIndex;
+    list.num++;
 }
 
 //------------------------------------------------------------------------------
-const resourceRegistry::Entry*
-resourceRegistry::findEntryById(Id id) const {
-    const int mapIndex = this->idIndexMap.FindIndex(id);
-    if (InvalidIndex != mapIndex) {
-        const int entryIndex = this->idIndexMap.ValueAtIndex(mapIndex);
-        return &(this->entries[entryIndex]);
+bool
+resourceRegistry::RemoveId(Id id) {
+    o_assert_dbg(this->isValid);
+    o_assert_dbg(!this->inBulkMode);
+    
+    const int slot = this->findIdSlot(id);
+    if (InvalidIndex != slot) {
+        this->removeEntry(this->idIndex[slot].entryIndex);
+        return true;
     }
-    return nullptr;
+    return false;
 }
 
 //------------------------------------------------------------------------------
@@ -91,81 +318,172 @@ bool
 resourceRegistry::Contains(Id id) const {
     o_assert_dbg(this->isValid);
     o_assert_dbg(id.IsValid());
-    return this->idIndexMap.Contains(id);
+    return InvalidIndex != this->findIdSlot(id);
 }
 
 //------------------------------------------------------------------------------
 Id
 resourceRegistry::Lookup(const Locator& loc) const {
     o_assert_dbg(this->isValid);
-    if (loc.IsShared()) {
-        const Entry* entry = this->findEntryByLocator(loc);
-        if (nullptr != entry) {
-            return entry->id;
-        }
+    const int slot = this->findLocatorSlot(loc);
+    if (InvalidIndex != slot) {
+        return this->entries[this->locatorIndex[slot].entryIndex].id;
     }
     return Id::InvalidId();
 }
 
+//------------------------------------------------------------------------------
+void
+resourceRegistry::removeEntry(int entryIndex) {
+    
+    // remove from the hash indices
+    Entry& entry = this->entries[entryIndex];
+    eraseSlot(this->idIndex, this->numIds, this->findIdSlot(entry.id));
+    if (entry.locator.IsShared()) {
+        eraseSlot(this->locatorIndex, this->numLocators, this->findLocatorSlot(entry.locator));
+    }
+    
+    // unlink from the label list, and drop empty label lists
+    const int labelIndex = this->labels.FindIndex(entry.label.Value);
+    o_assert_dbg(InvalidIndex != labelIndex);
+    labelList& list = this->labels.ValueAtIndex(labelIndex);
+    if (InvalidIndex != entry.prevInLabel) {
+        this->entries[entry.prevInLabel].nextInLabel = entry.nextInLabel;
+    }
+    else {
+        list.head = entry.nextInLabel;
+    }
+    if (InvalidIndex != entry.nextInLabel) {
+        this->entries[entry.nextInLabel].prevInLabel = entry.prevInLabel;
+    }
+    else {
+        list.tail = entry.prevInLabel;
+    }
+    if (0 == --list.num) {
+        this->labels.EraseIndex(labelIndex);
+    }
+    
+    // move the last entry into the gap, and patch everything
+    // that points to the moved entry
+    const int lastIndex = this->entries.Size() - 1;
+    if (entryIndex != lastIndex) {
+        const Entry& moved = this->entries[lastIndex];
+        this->idIndex[this->findIdSlot(moved.id)].entryIndex = entryIndex;
+        if (moved.locator.IsShared()) {
+            this->locatorIndex[this->findLocatorSlot(moved.locator)].entryIndex = entryIndex;
+        }
+        labelList& movedList = this->labels.ValueAtIndex(this->labels.FindIndex(moved.label.Value));
+        if (InvalidIndex != moved.prevInLabel) {
+            this->entries[moved.prevInLabel].nextInLabel = entryIndex;
+        }
+        else {
+            movedList.head = entryIndex;
+        }
+        if (InvalidIndex != moved.nextInLabel) {
+            this->entries[moved.nextInLabel].prevInLabel = entryIndex;
+        }
+        else {
+            movedList.tail = entryIndex;
+        }
+    }
+    this->entries.EraseSwapBack(entryIndex);
+}
+
 //------------------------------------------------------------------------------
 Array<Id>
 resourceRegistry::Remove(ResourceLabel label) {
     o_assert_dbg(this->isValid);
+    o_assert_dbg(!this->inBulkMode);
     Array<Id> removed;
-    removed.Reserve(this->entries.Size() < 256 ? this->entries.Size() : 256);
-    
-    // for each entry where id.label matches label (from behind
-    // because matching entries will be removed)
-    // FIXME: this can be slow if many resource are live!
-    int entryIndex = this->entries.Size() - 1;
-    for (; entryIndex >= 0; entryIndex--) {
-        if ((ResourceLabel::All == label) || (this->entries[entryIndex].label == label)) {
-            Id id = this->entries[entryIndex].id;
-            Locator loc = this->entries[entryIndex].locator;
-            removed.Add(id);
-            
-            // remove entries
-            this->entries.EraseSwapBack(entryIndex);
-            this->idIndexMap.Erase(id);
-            if (loc.IsShared()) {
-                this->locatorIndexMap.Erase(loc);
-            }
-            
-            // fixup the index maps (see elementBuffer)
-            const int swappedIndex = this->entries.Size();
-            if (entryIndex != swappedIndex) {
-                for (auto& elm : this->idIndexMap) {
-                    if (swappedIndex == elm.value) {
-                        elm.value = entryIndex;
-                        break;
-                    }
-                }
-                for (auto& elm : this->locatorIndexMap) {
-                    if (swappedIndex == elm.value) {
-                        elm.value = entryIndex;
-                        break;
-                    }
-                }
+    
+    if (ResourceLabel::All == label) {
+        // remove everything (from behind, like the label lists)
+        removed.Reserve(this->entries.Size());
+        for (int entryIndex = this->entries.Size() - 1; entryIndex >= 0; entryIndex--) {
+            removed.Add(this->entries[entryIndex].id);
+        }
+        this->entries.Clear();
+        for (hashSlot& slot : this->idIndex) {
+            slot = hashSlot();
+        }
+        for (hashSlot& slot : this->locatorIndex) {
+            slot = hashSlot();
+        }
+        this->labels.Clear();
+        this->numIds = 0;
+        this->numLocators = 0;
+    }
+    else {
+        // walk the label list from behind, so that the most recently
+        // created resources are removed first
+        const int labelIndex = this->labels.FindIndex(label.Value);
+        if (InvalidIndex != labelIndex) {
+            const labelList& list = this->labels.ValueAtIndex(labelIndex);
+            int num = list.num;
+            int entryIndex = list.tail;
+            removed.Reserve(num);
+            while (num-- > 0) {
+                // NOTE: removeEntry() may drop the label list, and may
+                // move the previous entry into the removed entry's slot
+                const int prevIndex = this->entries[entryIndex].prevInLabel;
+                removed.Add(this->entries[entryIndex].id);
+                this->removeEntry(entryIndex);
+                entryIndex = (prevIndex == this->entries.Size()) ? entryIndex : prevIndex;
             }
-            
-            // make sure nothing broke
-            #if ORYOL_DEBUG
-            o_assert(this->checkIntegrity());
-            #endif
         }
     }
+    
+    // make sure nothing broke
+    #if ORYOL_DEBUG
+    o_assert(this->checkIntegrity());
+    #endif
     return removed;
 }
 
+//------------------------------------------------------------------------------
+Array<Id>
+resourceRegistry::GetIds(ResourceLabel label) const {
+    o_assert_dbg(this->isValid);
+    Array<Id> ids;
+    if (ResourceLabel::All == label) {
+        ids.Reserve(this->entries.Size());
+        for (int entryIndex = this->entries.Size() - 1; entryIndex >= 0; entryIndex--) {
+            ids.Add(this->entries[entryIndex].id);
+        }
+    }
+    else {
+        const int labelIndex = this->labels.FindIndex(label.Value);
+        if (InvalidIndex != labelIndex) {
+            const labelList& list = this->labels.ValueAtIndex(labelIndex);
+            ids.Reserve(list.num);
+            for (int entryIndex = list.tail; InvalidIndex != entryIndex; entryIndex = this->entries[entryIndex].prevInLabel) {
+                ids.Add(this->entries[entryIndex].id);
+            }
+        }
+    }
+    return ids;
+}
+
+//------------------------------------------------------------------------------
+ResourceLabel
+resourceRegistry::FindLabel(Id id) const {
+    o_assert_dbg(this->isValid);
+    const int slot = this->findIdSlot(id);
+    if (InvalidIndex != slot) {
+        return this->entries[this->idIndex[slot].entryIndex].label;
+    }
+    return ResourceLabel();
+}
+
 //------------------------------------------------------------------------------
 const Locator&
 resourceRegistry::GetLocator(Id id) const {
     o_assert_dbg(this->isValid);
     o_assert_dbg(id.IsValid());
     
-    const Entry* entry = this->findEntryById(id);
-    o_assert_dbg(nullptr != entry);
-    return entry->locator;
+    const int slot = this->findIdSlot(id);
+    o_assert_dbg(InvalidIndex != slot);
+    return this->entries[this->idIndex[slot].entryIndex].locator;
 }
 
 //------------------------------------------------------------------------------
@@ -174,9 +492,9 @@ resourceRegistry::GetLabel(Id id) const {
     o_assert_dbg(this->isValid);
     o_assert_dbg(id.IsValid());
     
-    const Entry* entry = this->findEntryById(id);
-    o_assert_dbg(nullptr != entry);
-    return entry->label;
+    const int slot = this->findIdSlot(id);
+    o_assert_dbg(InvalidIndex != slot);
+    return this->entries[this->idIndex[slot].entryIndex].label;
 }
 
 //------------------------------------------------------------------------------
@@ -186,6 +504,17 @@ resourceRegistry::GetNumResources() const {
     return this->entries.Size();
 }
 
+//------------------------------------------------------------------------------
+int
+resourceRegistry::GetNumResources(ResourceLabel label) const {
+    o_assert_dbg(this->isValid);
+    const int labelIndex = this->labels.FindIndex(label.Value);
+    if (InvalidIndex != labelIndex) {
+        return this->labels.ValueAtIndex(labelIndex).num;
+    }
+    return 0;
+}
+
 //------------------------------------------------------------------------------
 Id
 resourceRegistry::GetIdByIndex(int index) const {
@@ -197,26 +526,50 @@ resourceRegistry::GetIdByIndex(int index) const {
 #if ORYOL_DEBUG
 bool
 resourceRegistry::checkIntegrity() const {
-    for (const auto& kvp : this->locatorIndexMap) {
-        const Locator& loc = kvp.key;
-        const int entryIndex = kvp.value;
-        const Locator& entryLoc = this->entries[entryIndex].locator;
-        if (entryLoc != loc) {
-            o_error("ResourceRegistry: locator mismatch at index '%d' (%s != %s)\n",
-                    entryIndex, entryLoc.Location().AsCStr(), loc.Location().AsCStr());
+    int numShared = 0;
+    for (int entryIndex = 0; entryIndex < this->entries.Size(); entryIndex++) {
+        const Entry& entry = this->entries[entryIndex];
+        const int idSlot = this->findIdSlot(entry.id);
+        if ((InvalidIndex == idSlot) || (this->idIndex[idSlot].entryIndex != entryIndex)) {
+            o_error("ResourceRegistry:: id mismatch at index '%d' (%d,%d,%d)\n",
+                    entryIndex, entry.id.UniqueStamp, entry.id.SlotIndex, entry.id.Type);
             return false;
         }
+        if (entry.locator.IsShared()) {
+            numShared++;
+            const int locSlot = this->findLocatorSlot(entry.locator);
+            if ((InvalidIndex == locSlot) || (this->locatorIndex[locSlot].entryIndex != entryIndex)) {
+                o_error("ResourceRegistry: locator mismatch at index '%d' (%s)\n",
+                        entryIndex, entry.locator.Location().AsCStr());
+                return false;
+            }
+        }
     }
-    for (const auto& kvp : this->idIndexMap) {
-        const Id& id = kvp.key;
-        const int entryIndex = kvp.value;
-        const Id& entryId = this->entries[entryIndex].id;
-        if (entryId != id) {
-            o_error("ResourceRegistry:: id mismatch at index '%d' (%d,%d,%d != %d,%d,%d)\n",
-                    entryIndex, entryId.UniqueStamp, entryId.SlotIndex, entryId.Type,
-                    id.UniqueStamp, id.SlotIndex, id.Type);
+    if ((this->numIds != this->entries.Size()) || (this->numLocators != numShared)) {
+        o_error("ResourceRegistry: hash index size mismatch\n");
+        return false;
+    }
+    int numLinked = 0;
+    for (const auto& kvp : this->labels) {
+        int prevIndex = InvalidIndex;
+        int num = 0;
+        for (int i = kvp.value.head; InvalidIndex != i; i = this->entries[i].nextInLabel) {
+            if ((this->entries[i].label != kvp.key) || (this->entries[i].prevInLabel != prevIndex)) {
+                o_error("ResourceRegistry: broken label list at index '%d'\n", i);
+                return false;
+            }
+            prevIndex = i;
+            num++;
+        }
+        if ((prevIndex != kvp.value.tail) || (num != kvp.value.num)) {
+            o_error("ResourceRegistry: broken label list (label %d)\n", kvp.key);
             return false;
         }
+        numLinked += num;
+    }
+    if (numLinked != this->entries.Size()) {
+        o_error("ResourceRegistry: %d entries not in label lists\n", this->entries.Size() - numLinked);
+        return false;
     }
     return true;
 }
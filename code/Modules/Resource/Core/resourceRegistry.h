@@ -4,6 +4,19 @@
     @class Oryol::resourceRegistry
     @ingroup _priv
     @brief map resource locators to resource ids for resource sharing
+
+    The entries live in a dense array (in creation order until entries
+    are removed), ids and shared locators are found through
+    open-addressing hash indices, and all entries with the same
+    resource label are linked into a per-label list. Removing the
+    resources of a label only touches the removed entries, each
+    removal swaps the last entry into the gap and patches its
+    hash slots and label links in O(1).
+
+    Batches of resources with the same label can be added between
+    BeginBulk() and EndBulk(), this reserves the entries and hash
+    slots for the whole batch at once and resolves the label list
+    only once per batch.
 */
 #include "Resource/Id.h"
 #include "Resource/Locator.h"
@@ -28,15 +41,29 @@ public:
     /// return true if the registry has been setup
     bool IsValid() const;
     
+    /// reserve room for num additional entries
+    void Reserve(int num);
     /// add a new resource id to the registry
     void Add(const Locator& loc, Id id, ResourceLabel label);
+    /// begin adding a batch of up to num resources with the same label
+    void BeginBulk(int num, ResourceLabel label);
+    /// add a resource id in a batch (the locator can be looked up right away)
+    void AddBulk(const Locator& loc, Id id);
+    /// end adding a batch of resources
+    void EndBulk();
     /// lookup resource Id by locator
     Id Lookup(const Locator& loc) const;
     /// remove all resource matching label from registry, returns removed Ids
     Array<Id> Remove(ResourceLabel label);
+    /// remove a single resource from the registry, return false if not found
+    bool RemoveId(Id id);
     
+    /// get the ids of all resources matching label, in the order Remove() would remove them
+    Array<Id> GetIds(ResourceLabel label) const;
     /// check if resource is in registry
     bool Contains(Id id) const;
+    /// get the resource label of a resource, or an invalid label if not in registry
+    ResourceLabel FindLabel(Id id) const;
     /// (debug) get the locator of a resource (fail hard if resource doesn't exist)
     const Locator& GetLocator(Id id) const;
     /// (debug) get the resource label of a resource (fail hard if resource doesn't exist)
@@ -44,6 +71,8 @@ public:
     
     /// (debug) get number of resources in the registry
     int GetNumResources() const;
+    /// (debug) get number of resources with a resource label
+    int GetNumResources(ResourceLabel label) const;
     /// (debug) get resource id by index
     Id GetIdByIndex(int index) const;
     
@@ -57,22 +86,58 @@ private:
         Entry(const Locator& loc_, Id id_, ResourceLabel label_) :
             locator(loc_),
             id(id_),
-            label(label_) { };
+            label(label_),
+            prevInLabel(InvalidIndex),
+            nextInLabel(InvalidIndex) { };
         
         Locator locator;
         Id id;
         ResourceLabel label;
+        int prevInLabel;
+        int nextInLabel;
+    };
+    /// the entries of one resource label, linked through the entries
+    struct labelList {
+        int head = InvalidIndex;
+        int tail = InvalidIndex;
+        int num = 0;
+    };
+    /// a slot in a hash index, maps a key hash to an entry index
+    struct hashSlot {
+        uint32_t hash = 0;
+        int entryIndex = InvalidIndex;
     };
     
-    /// find an entry by locator
-    const Entry* findEntryByLocator(const Locator& loc) const;
-    /// find an entry by id
-    const Entry* findEntryById(Id id) const;
+    /// compute the hash of an id
+    static uint32_t hashId(Id id);
+    /// compute the hash of a locator
+    static uint32_t hashLocator(const Locator& loc);
+    /// find the hash slot of an id, InvalidIndex if not found
+    int findIdSlot(Id id) const;
+    /// find the hash slot of a shared locator, InvalidIndex if not found
+    int findLocatorSlot(const Locator& loc) const;
+    /// add an entry index to a hash index, grows the index if necessary
+    static void insertSlot(Array<hashSlot>& index, int& num, uint32_t hash, int entryIndex);
+    /// grow a hash index so that num slots fit without rehashing
+    static void reserveSlots(Array<hashSlot>& index, int num);
+    /// add an entry, and append it to a label list
+    void addEntry(const Locator& loc, Id id, ResourceLabel label, int labelIndex);
+    /// remove a slot from a hash index
+    static void eraseSlot(Array<hashSlot>& index, int& num, int slot);
+    /// rebuild a hash index with a new capacity (power of 2)
+    static void rehash(Array<hashSlot>& index, int capacity);
+    /// remove an entry, moves the last entry into the gap
+    void removeEntry(int entryIndex);
     
     bool isValid;
+    bool inBulkMode;
+    int bulkLabelIndex;
     Array<Entry> entries;
-    Map<Locator, int> locatorIndexMap;
-    Map<Id, int> idIndexMap;
+    Array<hashSlot> idIndex;
+    int numIds;
+    Array<hashSlot> locatorIndex;
+    int numLocators;
+    Map<uint32_t, labelList> labels;
 };
 } // namespace _priv
 } // namespace Oryol
@@ -0,0 +1,61 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::ResourceGroup
+    @ingroup Resource
+    @brief tracks the loading state of all resources with a resource label
+
+    A resource group is returned by the resource container (for instance
+    by Gfx::AwaitResources()), and counts the resources of a label which
+    are still loading, have become valid, or have failed. Resources which
+    are created with the label while the group is not done are added to
+    the group. Once no resource is loading anymore, the group is done:
+    the Done flag is set and the OnDone callback is called (once).
+*/
+#include "Core/RefCounted.h"
+#include "Resource/ResourceLabel.h"
+#include "Resource/ResourceState.h"
+#include <functional>
+
+namespace Oryol {
+
+class ResourceGroup : public RefCounted {
+    OryolClassDecl(ResourceGroup);
+public:
+    /// callback when all resources of the group are valid or failed
+    typedef std::function<void(const ResourceGroup& group)> DoneFunc;
+
+    /// the resource label of the group
+    ResourceLabel Label;
+    /// number of resources which are still loading
+    int NumPending = 0;
+    /// number of valid resources
+    int NumValid = 0;
+    /// number of failed resources
+    int NumFailed = 0;
+    /// true once no resource is loading anymore
+    bool Done = false;
+    /// called once when the group is done
+    DoneFunc OnDone;
+
+    /// add (delta=1) or remove (delta=-1) a resource state to the counters
+    void Count(ResourceState::Code state, int delta) {
+        switch (state) {
+            case ResourceState::Valid:
+                this->NumValid += delta;
+                break;
+            case ResourceState::Failed:
+                this->NumFailed += delta;
+                break;
+            case ResourceState::Setup:
+            case ResourceState::Pending:
+                this->NumPending += delta;
+                break;
+            default:
+                // Initial and InvalidState resources don't exist
+                break;
+        }
+    };
+};
+
+} // namespace Oryol
@@ -0,0 +1,160 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @class Oryol::ResourceHandle
+    @ingroup Resource
+    @brief a reference counted resource id
+
+    A ResourceHandle holds a reference to a resource for as long as
+    it exists, copies of a handle acquire additional references. When
+    the last reference to a resource is released, the resource is
+    destroyed by its owner (for instance the Gfx module destroys
+    released resources in a time-budgeted batch once per frame).
+
+    FACADE is the module facade which owns the resource (e.g. Gfx),
+    it must provide static IsValid(), AcquireResource() and
+    ReleaseResource() methods. Handles which are destroyed after the
+    module has been discarded don't release their reference.
+
+    @code
+    ResourceHandle<Gfx> tex(Gfx::CreateResource(texSetup));
+    drawState.FSTexture[0] = tex;
+    @endcode
+*/
+#include "Resource/Id.h"
+
+namespace Oryol {
+
+template<class FACADE> class ResourceHandle {
+public:
+    /// default constructor, constructs invalid handle
+    ResourceHandle();
+    /// construct from resource id, acquires a reference
+    explicit ResourceHandle(const class Id& id);
+    /// copy constructor, acquires a reference
+    ResourceHandle(const ResourceHandle& rhs);
+    /// move constructor
+    ResourceHandle(ResourceHandle&& rhs);
+    /// destructor, releases the reference
+    ~ResourceHandle();
+
+    /// copy-assignment
+    void operator=(const ResourceHandle& rhs);
+    /// move-assignment
+    void operator=(ResourceHandle&& rhs);
+
+    /// get the resource id
+    const class Id& Get() const;
+    /// convert to resource id
+    operator const class Id&() const;
+    /// return true if the handle holds a reference
+    bool IsValid() const;
+    /// release the reference, and invalidate the handle
+    void Invalidate();
+
+private:
+    /// acquire a reference for the current id
+    void acquire();
+    /// release the reference of the current id
+    void release();
+
+    class Id id;
+};
+
+//------------------------------------------------------------------------------
+template<class FACADE>
+ResourceHandle<FACADE>::ResourceHandle() {
+    // empty
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE>
+ResourceHandle<FACADE>::ResourceHandle(const class Id& id_) :
+id(id_) {
+    this->acquire();
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE>
+ResourceHandle<FACADE>::ResourceHandle(const ResourceHandle& rhs) :
+id(rhs.id) {
+    this->acquire();
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE>
+ResourceHandle<FACADE>::ResourceHandle(ResourceHandle&& rhs) :
+id(rhs.id) {
+    rhs.id.Invalidate();
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE>
+ResourceHandle<FACADE>::~ResourceHandle() {
+    this->release();
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE> void
+ResourceHandle<FACADE>::operator=(const ResourceHandle& rhs) {
+    if (this->id != rhs.id) {
+        this->release();
+        this->id = rhs.id;
+        this->acquire();
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE> void
+ResourceHandle<FACADE>::operator=(ResourceHandle&& rhs) {
+    if (this != &rhs) {
+        this->release();
+        this->id = rhs.id;
+        rhs.id.Invalidate();
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE> const Id&
+ResourceHandle<FACADE>::Get() const {
+    return this->id;
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE>
+ResourceHandle<FACADE>::operator const class Id&() const {
+    return this->id;
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE> bool
+ResourceHandle<FACADE>::IsValid() const {
+    return this->id.IsValid();
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE> void
+ResourceHandle<FACADE>::Invalidate() {
+    this->release();
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE> void
+ResourceHandle<FACADE>::acquire() {
+    if (this->id.IsValid()) {
+        FACADE::AcquireResource(this->id);
+    }
+}
+
+//------------------------------------------------------------------------------
+template<class FACADE> void
+ResourceHandle<FACADE>::release() {
+    if (this->id.IsValid()) {
+        if (FACADE::IsValid()) {
+            FACADE::ReleaseResource(this->id);
+        }
+        this->id.Invalidate();
+    }
+}
+
+} // namespace Oryol
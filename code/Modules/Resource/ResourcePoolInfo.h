@@ -5,10 +5,12 @@
     @ingroup Resource
     @brief detailed resource pool information
 
-    Note the querying resource pool information is relatively slow
-    since the function must iterate over all slots.
+    All values come from live counters of the pool, so querying the
+    pool information is cheap. The 'last frame' counters cover the
+    frame which was completed by the last ResourcePool::Update().
 */
 #include "Core/Containers/StaticArray.h"
+#include "Core/Time/Duration.h"
 #include "Resource/ResourceState.h"
 
 namespace Oryol {
@@ -30,6 +32,46 @@ public:
     int NumUsedSlots = 0;
     /// number of free slots
     int NumFreeSlots = 0;
+    /// number of allocated slot pages
+    int NumPages = 0;
+    /// memory used by the slot pages in bytes
+    int NumBytes = 0;
+    /// number of retried free-list operations (contention between threads)
+    int NumFreeListRetries = 0;
+    /// tracked memory size of the resources in bytes
+    int64_t NumResourceBytes = 0;
+    /// memory budget of the pool in bytes (0 means unlimited)
+    int64_t ByteBudget = 0;
+    /// number of currently evicted resources
+    int NumEvicted = 0;
+    /// overall number of evictions
+    int NumEvictions = 0;
+    /// overall number of completed reloads of evicted resources
+    int NumReloads = 0;
+    /// overall number of created (assigned) resources
+    int NumCreated = 0;
+    /// overall number of destroyed (unassigned) resources
+    int NumDestroyed = 0;
+    /// overall number of completed loads (Pending to Valid or Failed)
+    int NumLoaded = 0;
+    /// number of resources created in the last frame
+    int NumCreatedLastFrame = 0;
+    /// number of resources destroyed in the last frame
+    int NumDestroyedLastFrame = 0;
+    /// number of loads completed in the last frame
+    int NumLoadedLastFrame = 0;
+    /// number of loads which completed as Valid (the loads in LoadTime)
+    int NumTimedLoads = 0;
+    /// accumulated time from load start to Valid of all timed loads
+    Duration LoadTime;
+    
+    /// get the average load latency (from load start to Valid)
+    Duration AverageLoadTime() const {
+        if (this->NumTimedLoads > 0) {
+            return Duration(this->LoadTime.getRaw() / this->NumTimedLoads);
+        }
+        return Duration();
+    }
 };
 
 } // namespace Oryol
@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------
+//  ResourceHandleTest.cc
+//  Test reference counted resource handles.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Resource/ResourceHandle.h"
+#include "Core/Containers/Array.h"
+
+using namespace Oryol;
+
+// a facade which counts the references of a single resource
+class testFacade {
+public:
+    static bool IsValid() {
+        return valid;
+    };
+    static void AcquireResource(const Id& id) {
+        refCount++;
+    };
+    static void ReleaseResource(const Id& id) {
+        refCount--;
+    };
+    static bool valid;
+    static int refCount;
+};
+bool testFacade::valid = true;
+int testFacade::refCount = 0;
+
+TEST(ResourceHandleTest) {
+    const Id id(1, 2, 3);
+    {
+        ResourceHandle<testFacade> h0;
+        CHECK(!h0.IsValid());
+        CHECK(testFacade::refCount == 0);
+
+        ResourceHandle<testFacade> h1(id);
+        CHECK(h1.IsValid());
+        CHECK(h1.Get() == id);
+        CHECK(testFacade::refCount == 1);
+        const Id& asId = h1;
+        CHECK(asId == id);
+
+        // copies acquire references, moves don't
+        ResourceHandle<testFacade> h2(h1);
+        CHECK(testFacade::refCount == 2);
+        h0 = h2;
+        CHECK(testFacade::refCount == 3);
+        h0 = h2;
+        CHECK(testFacade::refCount == 3);
+        ResourceHandle<testFacade> h3(std::move(h0));
+        CHECK(!h0.IsValid());
+        CHECK(testFacade::refCount == 3);
+        h2 = std::move(h3);
+        CHECK(testFacade::refCount == 2);
+
+        Array<ResourceHandle<testFacade>> handles;
+        for (int i = 0; i < 8; i++) {
+            handles.Add(h1);
+        }
+        CHECK(testFacade::refCount == 10);
+        handles.Clear();
+        CHECK(testFacade::refCount == 2);
+
+        h1.Invalidate();
+        CHECK(!h1.IsValid());
+        CHECK(testFacade::refCount == 1);
+    }
+    CHECK(testFacade::refCount == 0);
+
+    // handles which outlive the facade don't release
+    {
+        ResourceHandle<testFacade> h(id);
+        testFacade::valid = false;
+    }
+    CHECK(testFacade::refCount == 1);
+    testFacade::valid = true;
+    testFacade::refCount = 0;
+}
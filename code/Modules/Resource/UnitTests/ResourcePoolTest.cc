@@ -5,6 +5,9 @@
 #include "UnitTest++/src/UnitTest++.h"
 #include "Resource/Core/ResourcePool.h"
 #include "Resource/Core/resourceBase.h"
+#include "Core/Containers/Set.h"
+#include "Core/Log.h"
+#include <thread>
 
 using namespace Oryol;
 
@@ -86,4 +89,274 @@ TEST(ResourcePoolTest) {
     
     resourcePool.Discard();
     CHECK(!resourcePool.IsValid());
-}
\ No newline at end of file
+}
+
+TEST(ResourcePoolGrowTest) {
+    // pools start with whole pages, and grow by pages without moving slots
+    myResourcePool resourcePool;
+    resourcePool.Setup(12, 1);
+    CHECK(resourcePool.GetNumSlots() == myResourcePool::NumPageSlots);
+    
+    Id firstId = resourcePool.AllocId();
+    myResource* firstRes = &resourcePool.Assign(firstId, mySetup(1), ResourceState::Valid);
+    Array<Id> ids;
+    for (int i = 1; i < 1000; i++) {
+        Id id = resourcePool.AllocId();
+        CHECK(id.SlotIndex == i);
+        resourcePool.Assign(id, mySetup(i), ResourceState::Valid);
+        ids.Add(id);
+    }
+    CHECK(resourcePool.Lookup(firstId) == firstRes);
+    CHECK(firstRes->Setup.bla == 1);
+    CHECK(resourcePool.GetNumSlots() == 1024);
+    CHECK(resourcePool.GetNumUsedSlots() == 1000);
+    const ResourcePoolInfo poolInfo = resourcePool.QueryPoolInfo();
+    CHECK(poolInfo.NumPages == 1024 / myResourcePool::NumPageSlots);
+    CHECK(poolInfo.NumBytes >= 1024 * int(sizeof(myResource)));
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Valid] == 1000);
+    
+    resourcePool.Unassign(firstId);
+    for (const Id& id : ids) {
+        resourcePool.Unassign(id);
+    }
+    CHECK(resourcePool.GetNumFreeSlots() == 1024);
+    resourcePool.Discard();
+}
+
+TEST(ResourcePoolThreadTest) {
+    // worker threads allocate ids concurrently, and grow the pool
+    const int numThreads = 4;
+    const int numIdsPerThread = 4096;
+    myResourcePool resourcePool;
+    resourcePool.Setup(12, 256);
+    Array<Id> ids[numThreads];
+    std::thread threads[numThreads];
+    for (int i = 0; i < numThreads; i++) {
+        threads[i] = std::thread([&resourcePool, &ids, i] {
+            ids[i].Reserve(numIdsPerThread);
+            for (int j = 0; j < numIdsPerThread; j++) {
+                ids[i].Add(resourcePool.AllocId());
+            }
+        });
+    }
+    for (int i = 0; i < numThreads; i++) {
+        threads[i].join();
+    }
+    CHECK(resourcePool.GetNumUsedSlots() == numThreads * numIdsPerThread);
+    CHECK(resourcePool.GetNumSlots() >= numThreads * numIdsPerThread);
+    
+    // all ids must be unique, free them on the main thread
+    Set<Id::SlotIndexT> slotIndices;
+    for (int i = 0; i < numThreads; i++) {
+        for (const Id& id : ids[i]) {
+            slotIndices.Add(id.SlotIndex);
+            resourcePool.Assign(id, mySetup(i), ResourceState::Valid);
+            resourcePool.Unassign(id);
+        }
+    }
+    CHECK(slotIndices.Size() == numThreads * numIdsPerThread);
+    CHECK(resourcePool.GetNumFreeSlots() == resourcePool.GetNumSlots());
+    const ResourcePoolInfo poolInfo = resourcePool.QueryPoolInfo();
+    Log::Info("ResourcePool: %d pages, %d bytes, %d free-list retries\n",
+        poolInfo.NumPages, poolInfo.NumBytes, poolInfo.NumFreeListRetries);
+    resourcePool.Discard();
+}
+
+TEST(ResourcePoolBatchTest) {
+    // a batch of ids grows the pool once
+    myResourcePool resourcePool;
+    resourcePool.Setup(12, 1);
+    Id firstId = resourcePool.AllocId();
+    Array<Id> ids;
+    resourcePool.AllocIds(1000, ids);
+    CHECK(ids.Size() == 1000);
+    CHECK(resourcePool.GetNumSlots() == 1024);
+    CHECK(resourcePool.QueryPoolInfo().NumPages == 1024 / myResourcePool::NumPageSlots);
+    Set<Id::SlotIndexT> batchSlots;
+    for (int i = 0; i < ids.Size(); i++) {
+        batchSlots.Add(ids[i].SlotIndex);
+        CHECK(ids[i].SlotIndex != firstId.SlotIndex);
+        CHECK(ids[i].Type == 12);
+        CHECK(ids[i].UniqueStamp == firstId.UniqueStamp + i + 1);
+    }
+    CHECK(batchSlots.Size() == 1000);
+    CHECK(resourcePool.GetNumUsedSlots() == 1001);
+    
+    // unused ids of a batch can be freed without assigning them
+    for (int i = 0; i < 500; i++) {
+        resourcePool.Assign(ids[i], mySetup(i), ResourceState::Valid);
+    }
+    resourcePool.FreeIds(ids, 500);
+    CHECK(resourcePool.GetNumUsedSlots() == 501);
+    for (int i = 0; i < 500; i++) {
+        resourcePool.Unassign(ids[i]);
+    }
+    resourcePool.Assign(firstId, mySetup(0), ResourceState::Valid);
+    resourcePool.Unassign(firstId);
+    CHECK(resourcePool.GetNumFreeSlots() == resourcePool.GetNumSlots());
+    
+    // batches from several threads
+    const int numThreads = 4;
+    Array<Id> threadIds[numThreads];
+    std::thread threads[numThreads];
+    for (int i = 0; i < numThreads; i++) {
+        threads[i] = std::thread([&resourcePool, &threadIds, i] {
+            for (int j = 0; j < 64; j++) {
+                resourcePool.AllocIds(j + 1, threadIds[i]);
+            }
+        });
+    }
+    for (int i = 0; i < numThreads; i++) {
+        threads[i].join();
+    }
+    Set<Id::SlotIndexT> slotIndices;
+    for (int i = 0; i < numThreads; i++) {
+        for (const Id& id : threadIds[i]) {
+            slotIndices.Add(id.SlotIndex);
+        }
+        resourcePool.FreeIds(threadIds[i]);
+    }
+    CHECK(slotIndices.Size() == numThreads * 64 * 65 / 2);
+    CHECK(resourcePool.GetNumFreeSlots() == resourcePool.GetNumSlots());
+    resourcePool.Discard();
+}
+
+TEST(ResourcePoolRefCountTest) {
+    myResourcePool resourcePool;
+    resourcePool.Setup(12, 16);
+    Id id = resourcePool.AllocId();
+    resourcePool.Assign(id, mySetup(1), ResourceState::Valid);
+    CHECK(resourcePool.GetRefCount(id) == 0);
+    CHECK(resourcePool.AddRef(id) == 1);
+    CHECK(resourcePool.AddRef(id) == 2);
+    CHECK(resourcePool.Release(id) == 1);
+    CHECK(resourcePool.GetRefCount(id) == 1);
+    CHECK(resourcePool.QueryResourceInfo(id).State == ResourceState::Valid);
+    CHECK(resourcePool.Release(id) == 0);
+    
+    // stale ids are not counted, and unassigning resets the count
+    resourcePool.AddRef(id);
+    resourcePool.Unassign(id);
+    CHECK(resourcePool.GetRefCount(id) == InvalidIndex);
+    CHECK(resourcePool.AddRef(id) == InvalidIndex);
+    CHECK(resourcePool.Release(id) == InvalidIndex);
+    Id newId = resourcePool.AllocId();
+    resourcePool.Assign(newId, mySetup(2), ResourceState::Valid);
+    CHECK(newId.SlotIndex == id.SlotIndex);
+    CHECK(resourcePool.GetRefCount(newId) == 0);
+    resourcePool.Unassign(newId);
+    resourcePool.Discard();
+}
+
+TEST(ResourcePoolBudgetTest) {
+    myResourcePool resourcePool;
+    resourcePool.Setup(12, 16);
+    resourcePool.SetByteBudget(1000);
+    
+    // 4 loaded resources with 300 bytes each, one without loader
+    Ptr<ResourceLoader> loader = ResourceLoader::Create();
+    Id ids[5];
+    for (int i = 0; i < 5; i++) {
+        ids[i] = resourcePool.AllocId();
+        myResource& res = resourcePool.Assign(ids[i], mySetup(i), ResourceState::Valid);
+        if (i < 4) {
+            res.Loader = loader;
+        }
+        resourcePool.SetByteSize(ids[i], 300);
+    }
+    CHECK(resourcePool.GetNumBytes() == 1500);
+    
+    // use the resources in the order 2, 0, 4, 3, 1 (resource 1 used in current frame)
+    const int order[5] = { 2, 0, 4, 3, 1 };
+    for (int i = 0; i < 5; i++) {
+        resourcePool.Update();
+        CHECK(resourcePool.Lookup(ids[order[i]]));
+    }
+    
+    // Peek() doesn't count as a use
+    CHECK(resourcePool.Peek(ids[2]) == resourcePool.Get(ids[2]));
+    
+    // the 2 least recently used resources with a loader must be evicted
+    Array<Id> evict = resourcePool.SelectEvictions();
+    CHECK(evict.Size() == 2);
+    CHECK(evict[0] == ids[2]);
+    CHECK(evict[1] == ids[0]);
+    for (const Id& id : evict) {
+        resourcePool.Evict(id);
+    }
+    CHECK(resourcePool.GetNumBytes() == 900);
+    CHECK(resourcePool.SelectEvictions().Empty());
+    CHECK(resourcePool.QueryState(ids[2]) == ResourceState::Pending);
+    CHECK(resourcePool.Get(ids[2])->Evicted);
+    CHECK(nullptr == resourcePool.Lookup(ids[2]));
+    
+    // the reloaded resource counts again
+    resourcePool.Assign(ids[2], mySetup(2), ResourceState::Valid);
+    resourcePool.SetByteSize(ids[2], 300);
+    CHECK(!resourcePool.Get(ids[2])->Evicted);
+    CHECK(resourcePool.GetNumBytes() == 1200);
+    ResourcePoolInfo poolInfo = resourcePool.QueryPoolInfo();
+    CHECK(poolInfo.NumResourceBytes == 1200);
+    CHECK(poolInfo.ByteBudget == 1000);
+    CHECK(poolInfo.NumEvicted == 1);
+    CHECK(poolInfo.NumEvictions == 2);
+    CHECK(poolInfo.NumReloads == 1);
+    
+    for (int i = 0; i < 5; i++) {
+        resourcePool.Unassign(ids[i]);
+    }
+    CHECK(resourcePool.GetNumBytes() == 0);
+    CHECK(resourcePool.QueryPoolInfo().NumEvicted == 0);
+    resourcePool.Discard();
+}
+
+TEST(ResourcePoolStatsTest) {
+    myResourcePool resourcePool;
+    resourcePool.Setup(12, 64);
+    
+    // two loading resources, and one created resource
+    Id loaded = resourcePool.AllocId();
+    resourcePool.Assign(loaded, mySetup(0), ResourceState::Pending);
+    Id failed = resourcePool.AllocId();
+    resourcePool.Assign(failed, mySetup(1), ResourceState::Pending);
+    Id created = resourcePool.AllocId();
+    resourcePool.Assign(created, mySetup(2), ResourceState::Setup);
+    resourcePool.UpdateState(created, ResourceState::Valid);
+    ResourcePoolInfo poolInfo = resourcePool.QueryPoolInfo();
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Initial] == 61);
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Pending] == 2);
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Valid] == 1);
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Setup] == 0);
+    CHECK(poolInfo.NumCreated == 3);
+    // the frame counters are updated by Update()
+    CHECK(poolInfo.NumCreatedLastFrame == 0);
+    resourcePool.Update();
+    poolInfo = resourcePool.QueryPoolInfo();
+    CHECK(poolInfo.NumCreatedLastFrame == 3);
+    
+    // loads complete when they leave the Pending state, only loads
+    // which end as Valid are timed
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    resourcePool.UpdateState(loaded, ResourceState::Valid);
+    resourcePool.UpdateState(failed, ResourceState::Failed);
+    resourcePool.Unassign(created);
+    resourcePool.Update();
+    poolInfo = resourcePool.QueryPoolInfo();
+    CHECK(poolInfo.NumCreatedLastFrame == 0);
+    CHECK(poolInfo.NumLoadedLastFrame == 2);
+    CHECK(poolInfo.NumDestroyedLastFrame == 1);
+    CHECK(poolInfo.NumLoaded == 2);
+    CHECK(poolInfo.NumTimedLoads == 1);
+    CHECK(poolInfo.AverageLoadTime().AsMilliSeconds() >= 2.0);
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Valid] == 1);
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Failed] == 1);
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Pending] == 0);
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Initial] == 62);
+    
+    resourcePool.Unassign(loaded);
+    resourcePool.Unassign(failed);
+    poolInfo = resourcePool.QueryPoolInfo();
+    CHECK(poolInfo.NumDestroyed == 3);
+    CHECK(poolInfo.NumSlotsByState[ResourceState::Initial] == 64);
+    resourcePool.Discard();
+}
@@ -0,0 +1,338 @@
+//------------------------------------------------------------------------------
+//  resourceContainerTest.cc
+//  Test resource state notifications, loader wakeups and batched creation.
+//------------------------------------------------------------------------------
+#include "Pre.h"
+#include "UnitTest++/src/UnitTest++.h"
+#include "Resource/Core/resourceContainerBase.h"
+#include "Resource/Core/ResourcePool.h"
+#include "Resource/Core/resourceBase.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/StringBuilder.h"
+#include "Core/Log.h"
+#include <thread>
+
+using namespace Oryol;
+
+class testSetup {
+public:
+    testSetup() { };
+    testSetup(const class Locator& loc) : Locator(loc) { };
+    class Locator Locator = Locator::NonShared();
+};
+
+class testResource : public resourceBase<testSetup> { };
+
+class testPool : public ResourcePool<testResource, testSetup> { };
+
+// a minimal resource container with a single resource pool
+class testContainer : public resourceContainerBase {
+public:
+    void setup(int poolSize=16) {
+        this->pool.Setup(1, poolSize);
+        this->pool.SetStateFunc([this](const Id& id, ResourceState::Code oldState, ResourceState::Code newState) {
+            this->notifyStateChange(id, oldState, newState);
+        });
+        resourceContainerBase::setup(4, 16);
+    };
+    void discard() {
+        this->destroy(ResourceLabel::All);
+        resourceContainerBase::discard();
+        this->pool.Discard();
+    };
+    Id prepare() {
+        Id id = this->pool.AllocId();
+        this->registry.Add(Locator::NonShared(), id, this->peekLabel());
+        this->pool.Assign(id, testSetup(), ResourceState::Pending);
+        return id;
+    };
+    void destroy(ResourceLabel label) {
+        for (const Id& id : this->registry.GetIds(label)) {
+            this->pool.Unassign(id);
+        }
+        this->registry.Remove(label);
+    };
+    // like gfxResourceContainerBase::Create()
+    Id create(const testSetup& setup) {
+        Id id = this->registry.Lookup(setup.Locator);
+        if (!id.IsValid()) {
+            id = this->pool.AllocId();
+            this->registry.Add(setup.Locator, id, this->peekLabel());
+            this->pool.Assign(id, setup, ResourceState::Setup);
+            this->pool.UpdateState(id, ResourceState::Valid);
+        }
+        return id;
+    };
+    // like gfxResourceContainerBase::CreateBatch()
+    Array<Id> createBatch(const Array<testSetup>& setups) {
+        return this->createBatch(this->pool, setups.Size(),
+            [&setups](int i) -> const Locator& {
+                return setups[i].Locator;
+            },
+            [this, &setups](int i, const Id& id) {
+                this->pool.Assign(id, setups[i], ResourceState::Setup);
+                this->pool.UpdateState(id, ResourceState::Valid);
+            });
+    };
+    using resourceContainerBase::createBatch;
+    Ptr<ResourceGroup> await(ResourceLabel label) {
+        Ptr<ResourceGroup> group = ResourceGroup::Create();
+        group->Label = label;
+        for (const Id& id : this->registry.GetIds(label)) {
+            group->Count(this->pool.QueryState(id), 1);
+        }
+        this->addGroup(group);
+        return group;
+    };
+    testPool pool;
+    using resourceContainerBase::addLoader;
+    using resourceContainerBase::updateLoaders;
+};
+
+// a loader which finishes when it has been woken up, or after
+// numPolls Continue() calls if it can't wake up
+class testLoader : public ResourceLoader {
+    OryolClassDecl(testLoader);
+public:
+    testLoader(testContainer* container_, bool canWakeup_) : container(container_), canWakeup(canWakeup_) { };
+    virtual Id Start() override {
+        this->id = this->container->prepare();
+        return this->id;
+    };
+    virtual ResourceState::Code Continue() override {
+        this->numContinues++;
+        if (this->woken || (!this->canWakeup && (this->numContinues == 3))) {
+            this->container->pool.UpdateState(this->id, ResourceState::Valid);
+            return ResourceState::Valid;
+        }
+        return ResourceState::Pending;
+    };
+    virtual bool CanWakeup() const override {
+        return this->canWakeup;
+    };
+    // simulate a handled IO request on another thread
+    void wakeup() {
+        this->woken = true;
+        std::function<void()> func = this->wakeupFunc;
+        std::thread thread([func] { func(); });
+        thread.join();
+    };
+    testContainer* container;
+    bool canWakeup;
+    bool woken = false;
+    int numContinues = 0;
+    Id id;
+};
+
+TEST(ResourceStateEventTest) {
+    testContainer container;
+    container.setup();
+
+    // per-resource and per-label subscriptions
+    ResourceLabel label = container.PushLabel();
+    Id id0 = container.prepare();
+    Id id1 = container.prepare();
+    container.PopLabel();
+    Id id2 = container.prepare();
+    int numId0Events = 0;
+    ResourceState::Code lastOldState = ResourceState::InvalidState;
+    ResourceState::Code lastNewState = ResourceState::InvalidState;
+    container.Subscribe(id0, [&](const Id& id, ResourceState::Code oldState, ResourceState::Code newState) {
+        CHECK(id == id0);
+        numId0Events++;
+        lastOldState = oldState;
+        lastNewState = newState;
+    });
+    int numLabelEvents = 0;
+    auto labelHandler = container.Subscribe(label, [&](const Id& id, ResourceState::Code, ResourceState::Code) {
+        CHECK((id == id0) || (id == id1));
+        numLabelEvents++;
+    });
+    int numAllEvents = 0;
+    container.Subscribe(ResourceLabel(ResourceLabel::All), [&](const Id&, ResourceState::Code, ResourceState::Code) {
+        numAllEvents++;
+    });
+
+    container.pool.UpdateState(id0, ResourceState::Valid);
+    CHECK(numId0Events == 1);
+    CHECK(lastOldState == ResourceState::Pending);
+    CHECK(lastNewState == ResourceState::Valid);
+    CHECK(numLabelEvents == 1);
+    CHECK(numAllEvents == 1);
+    container.pool.UpdateState(id2, ResourceState::Failed);
+    CHECK(numId0Events == 1);
+    CHECK(numLabelEvents == 1);
+    CHECK(numAllEvents == 2);
+    // no event if the state doesn't change
+    container.pool.UpdateState(id0, ResourceState::Valid);
+    CHECK(numId0Events == 1);
+    container.Unsubscribe(labelHandler);
+    container.pool.UpdateState(id1, ResourceState::Valid);
+    CHECK(numLabelEvents == 1);
+    CHECK(numAllEvents == 3);
+
+    // destroyed resources notify InvalidState and end the subscription
+    container.destroy(label);
+    CHECK(numId0Events == 2);
+    CHECK(lastNewState == ResourceState::InvalidState);
+    CHECK(numAllEvents == 5);
+
+    container.discard();
+}
+
+TEST(ResourceGroupTest) {
+    testContainer container;
+    container.setup();
+
+    // a group is done once all resources of its label are valid or failed
+    ResourceLabel label = container.PushLabel();
+    Id id0 = container.prepare();
+    Id id1 = container.prepare();
+    container.PopLabel();
+    Ptr<ResourceGroup> group = container.await(label);
+    int numDone = 0;
+    group->OnDone = [&numDone](const ResourceGroup& g) {
+        numDone++;
+    };
+    CHECK(group->NumPending == 2);
+    CHECK(!group->Done);
+    container.pool.UpdateState(id0, ResourceState::Valid);
+    CHECK(!group->Done);
+    CHECK(group->NumValid == 1);
+    // resources created with the label are added to the group
+    container.PushLabel(label);
+    Id id2 = container.prepare();
+    container.PopLabel();
+    CHECK(group->NumPending == 2);
+    container.pool.UpdateState(id1, ResourceState::Failed);
+    CHECK(!group->Done);
+    container.pool.UpdateState(id2, ResourceState::Valid);
+    CHECK(group->Done);
+    CHECK(numDone == 1);
+    CHECK(group->NumValid == 2);
+    CHECK(group->NumFailed == 1);
+    CHECK(group->NumPending == 0);
+    // the done callback is only called once
+    container.pool.UpdateState(id1, ResourceState::Valid);
+    CHECK(numDone == 1);
+
+    // a group without pending resources is done at once
+    Ptr<ResourceGroup> doneGroup = container.await(label);
+    CHECK(doneGroup->Done);
+    CHECK(doneGroup->NumValid == 3);
+
+    container.discard();
+}
+
+TEST(ResourceLoaderWakeupTest) {
+    testContainer container;
+    container.setup();
+
+    // loaders which can wake up are only continued after the wakeup
+    Array<Ptr<testLoader>> loaders;
+    for (int i = 0; i < 4; i++) {
+        Ptr<testLoader> loader = testLoader::Create(&container, true);
+        container.addLoader(loader);
+        loader->Start();
+        loaders.Add(loader);
+    }
+    Ptr<testLoader> polled = testLoader::Create(&container, false);
+    container.addLoader(polled);
+    polled->Start();
+    for (int frame = 0; frame < 5; frame++) {
+        container.updateLoaders();
+    }
+    for (const auto& loader : loaders) {
+        CHECK(loader->numContinues == 0);
+    }
+    CHECK(polled->numContinues == 3);
+    CHECK(container.pool.QueryState(polled->id) == ResourceState::Valid);
+
+    loaders[1]->wakeup();
+    loaders[3]->wakeup();
+    container.updateLoaders();
+    CHECK(loaders[0]->numContinues == 0);
+    CHECK(loaders[1]->numContinues == 1);
+    CHECK(loaders[2]->numContinues == 0);
+    CHECK(loaders[3]->numContinues == 1);
+    CHECK(container.pool.QueryState(loaders[1]->id) == ResourceState::Valid);
+    CHECK(container.pool.QueryState(loaders[0]->id) == ResourceState::Pending);
+    // finished loaders are not continued again
+    loaders[1]->wakeup();
+    container.updateLoaders();
+    CHECK(loaders[1]->numContinues == 1);
+
+    container.discard();
+}
+
+TEST(ResourceBatchTest) {
+    testContainer container;
+    container.setup();
+    
+    // shared resources are only created once, also within the batch
+    Id existing = container.create(testSetup(Locator("tex0")));
+    Array<testSetup> setups;
+    setups.Add(testSetup(Locator("tex0")));
+    setups.Add(testSetup(Locator("tex1")));
+    setups.Add(testSetup(Locator::NonShared()));
+    setups.Add(testSetup(Locator("tex1")));
+    setups.Add(testSetup(Locator::NonShared()));
+    int numEvents = 0;
+    container.Subscribe(ResourceLabel(ResourceLabel::All), [&numEvents](const Id&, ResourceState::Code, ResourceState::Code) {
+        numEvents++;
+    });
+    ResourceLabel label = container.PushLabel();
+    Array<Id> ids = container.createBatch(setups);
+    container.PopLabel();
+    CHECK(ids.Size() == 5);
+    CHECK(ids[0] == existing);
+    CHECK(ids[1] == ids[3]);
+    CHECK(ids[1] != ids[2]);
+    CHECK(ids[2] != ids[4]);
+    CHECK(container.pool.GetNumUsedSlots() == 4);
+    CHECK(container.pool.QueryState(ids[4]) == ResourceState::Valid);
+    CHECK(container.Lookup(Locator("tex1")) == ids[1]);
+    // Setup and Valid for each new resource
+    CHECK(numEvents == 6);
+    
+    container.destroy(label);
+    CHECK(container.pool.GetNumUsedSlots() == 1);
+    container.discard();
+}
+
+// create 10k resources one by one, and in a batch, and compare
+// the time spent in the resource bookkeeping
+TEST(ResourceBatchBenchmark) {
+    const int numResources = 10000;
+    Array<testSetup> setups;
+    StringBuilder strBuilder;
+    for (int i = 0; i < numResources; i++) {
+        strBuilder.Format(64, "mesh%d", i);
+        setups.Add(testSetup((i & 1) ? Locator(strBuilder.GetString()) : Locator::NonShared()));
+    }
+    
+    testContainer container;
+    container.setup(64);
+    container.PushLabel();
+    TimePoint start = Clock::Now();
+    for (const auto& setup : setups) {
+        container.create(setup);
+    }
+    Duration singleTime = Clock::Since(start);
+    container.PopLabel();
+    CHECK(container.pool.GetNumUsedSlots() == numResources);
+    container.discard();
+    
+    container.setup(64);
+    container.PushLabel();
+    start = Clock::Now();
+    Array<Id> ids = container.createBatch(setups);
+    Duration batchTime = Clock::Since(start);
+    container.PopLabel();
+    CHECK(ids.Size() == numResources);
+    CHECK(container.pool.GetNumUsedSlots() == numResources);
+    container.discard();
+    
+    Log::Info("ResourceBatchBenchmark: %d resources, one by one: %.3fms, batched: %.3fms\n",
+        numResources, singleTime.AsMilliSeconds(), batchTime.AsMilliSeconds());
+}
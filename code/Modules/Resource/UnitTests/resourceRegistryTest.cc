@@ -4,6 +4,9 @@
 #include "Pre.h"
 #include "UnitTest++/src/UnitTest++.h"
 #include "Resource/Core/resourceRegistry.h"
+#include "Core/Time/Clock.h"
+#include "Core/String/StringBuilder.h"
+#include "Core/Log.h"
 
 using namespace Oryol;
 using namespace Oryol::_priv;
@@ -76,3 +79,124 @@ TEST(ResourceRegistryTest) {
 
     reg.Discard();
 }
+
+TEST(ResourceRegistryBulkTest) {
+    resourceRegistry reg;
+    reg.Setup(16);
+    reg.Add(Locator("bla"), Id(0, 0, 1), 1);
+
+    // a batch shares one label, shared locators can be found during the batch
+    reg.BeginBulk(100, 2);
+    StringBuilder strBuilder;
+    for (int i = 1; i <= 100; i++) {
+        strBuilder.Format(64, "bulk%d", i);
+        CHECK(!reg.Lookup(Locator(strBuilder.GetString())).IsValid());
+        reg.AddBulk(Locator(strBuilder.GetString()), Id(i, i, 1));
+        CHECK(reg.Lookup(Locator(strBuilder.GetString())) == Id(i, i, 1));
+    }
+    reg.EndBulk();
+    CHECK(reg.GetNumResources() == 101);
+    CHECK(reg.GetNumResources(2) == 100);
+    CHECK(reg.GetLabel(Id(50, 50, 1)) == 2);
+    CHECK(reg.Lookup(Locator("bulk17")) == Id(17, 17, 1));
+    Array<Id> ids = reg.GetIds(2);
+    CHECK(ids.Size() == 100);
+    CHECK(ids[0] == Id(100, 100, 1));
+
+    // single resources can be removed from a label
+    CHECK(reg.RemoveId(Id(17, 17, 1)));
+    CHECK(!reg.RemoveId(Id(17, 17, 1)));
+    CHECK(!reg.Lookup(Locator("bulk17")).IsValid());
+    CHECK(reg.GetNumResources(2) == 99);
+
+    // an empty batch doesn't leave a label behind
+    reg.BeginBulk(10, 3);
+    reg.EndBulk();
+    CHECK(reg.GetNumResources(3) == 0);
+    CHECK(reg.GetIds(3).Empty());
+
+    // a batch with an existing label appends to it
+    reg.BeginBulk(1, 1);
+    reg.AddBulk(Locator::NonShared(), Id(101, 101, 1));
+    reg.EndBulk();
+    CHECK(reg.GetNumResources(1) == 2);
+    CHECK(reg.Remove(1).Size() == 2);
+    CHECK(reg.Remove(2).Size() == 99);
+    CHECK(reg.GetNumResources() == 0);
+    reg.Discard();
+}
+
+TEST(ResourceRegistryStressTest) {
+
+    // 50k live resources in 8 labels, every 4th is non-shared
+    const int numResources = 50000;
+    const int numLabels = 8;
+    resourceRegistry reg;
+    reg.Setup(1024);
+    Array<Locator> locs;
+    locs.Reserve(numResources);
+    StringBuilder strBuilder;
+    for (int i = 0; i < numResources; i++) {
+        strBuilder.Format(64, "res%d", i);
+        if (0 == (i & 3)) {
+            locs.Add(Locator::NonShared(strBuilder.GetString()));
+        }
+        else {
+            locs.Add(Locator(strBuilder.GetString(), i & 1 ? 'SIG_' : Locator::DefaultSignature));
+        }
+    }
+    TimePoint t0 = Clock::Now();
+    for (int i = 0; i < numResources; i++) {
+        reg.Add(locs[i], Id(i, i, 1), i % numLabels);
+    }
+    Duration addTime = Clock::Since(t0);
+    CHECK(reg.GetNumResources() == numResources);
+    CHECK(reg.GetNumResources(3) == numResources / numLabels);
+
+    // lookup by locator and id
+    t0 = Clock::Now();
+    int numFound = 0;
+    for (int i = 0; i < numResources; i++) {
+        const Id id = reg.Lookup(locs[i]);
+        if (id.IsValid() && (id == Id(i, i, 1)) && reg.Contains(id)) {
+            numFound++;
+        }
+    }
+    Duration lookupTime = Clock::Since(t0);
+    CHECK(numFound == numResources - numResources / 4);
+
+    // removing a label only removes its resources, newest first
+    t0 = Clock::Now();
+    Array<Id> removed = reg.Remove(3);
+    Duration removeTime = Clock::Since(t0);
+    CHECK(removed.Size() == numResources / numLabels);
+    CHECK(removed[0] == Id(numResources - 5, numResources - 5, 1));
+    CHECK(reg.GetNumResources() == numResources - removed.Size());
+    CHECK(reg.GetNumResources(3) == 0);
+    CHECK(!reg.Contains(Id(3, 3, 1)));
+    CHECK(!reg.Lookup(locs[3]).IsValid());
+    CHECK(reg.Lookup(locs[5]) == Id(5, 5, 1));
+    CHECK(reg.GetLabel(Id(5, 5, 1)) == 5);
+    CHECK(reg.GetLocator(Id(6, 6, 1)) == locs[6]);
+
+    // remove the remaining labels one by one
+    for (int label = 0; label < numLabels; label++) {
+        if (label != 3) {
+            CHECK(reg.Remove(label).Size() == numResources / numLabels);
+        }
+    }
+    CHECK(reg.GetNumResources() == 0);
+    CHECK(!reg.Lookup(locs[5]).IsValid());
+
+    // removing everything
+    for (int i = 0; i < 1000; i++) {
+        reg.Add(locs[i], Id(i, i, 1), i % numLabels);
+    }
+    CHECK(reg.Remove(ResourceLabel::All).Size() == 1000);
+    CHECK(reg.GetNumResources() == 0);
+    CHECK(reg.GetNumResources(0) == 0);
+    reg.Discard();
+
+    Log::Info("resourceRegistry (%d resources): add %.3fms, lookup %.3fms, remove label %.3fms\n",
+        numResources, addTime.AsMilliSeconds(), lookupTime.AsMilliSeconds(), removeTime.AsMilliSeconds());
+}